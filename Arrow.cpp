@@ -0,0 +1,1012 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Arrow.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+DTO_BEGIN
+
+extern DtoErrorHandler g_errorHandler;
+
+//! Arrow type ids from the Type union of the Arrow schema.
+enum ArrowTypeId
+{
+	  ArrowNull			= 1
+	, ArrowInt			= 2
+	, ArrowFloatingPoint	= 3
+	, ArrowUtf8			= 5
+	, ArrowBool			= 6
+	, ArrowTimestamp	= 10
+};
+
+//! Arrow message header types.
+enum ArrowMessageHeader
+{
+	  ArrowSchemaHeader			= 1
+	, ArrowRecordBatchHeader	= 3
+};
+
+//! An Arrow metadata version written to all messages.
+enum { ArrowMetadataV5 = 4 };
+
+//! A FieldNode structure of a record batch message.
+struct ArrowFieldNode
+{
+	int64					length;		//!< A total number of column values.
+	int64					nullCount;	//!< A total number of null values.
+};
+
+//! A Buffer structure of a record batch message.
+struct ArrowBuffer
+{
+	int64					offset;		//!< A buffer offset relative to a message body start.
+	int64					length;		//!< A buffer length in bytes.
+};
+
+//! A Block structure of a file footer.
+struct ArrowBlock
+{
+	int64					offset;			//!< A message offset relative to a file start.
+	int32					metaDataLength;	//!< A length of a message prefix and metadata.
+	int32					padding;		//!< An explicit structure padding.
+	int64					bodyLength;		//!< A message body length.
+};
+
+/*!
+ Builds a FlatBuffers encoded Arrow metadata back to front, so every object is finished before it's referenced.
+ Bytes are stored in a reverse order to make prepending cheap and are reversed once a buffer is finished.
+ */
+class ArrowMetadataBuilder
+{
+public:
+
+							//! Constructs an empty ArrowMetadataBuilder instance.
+							ArrowMetadataBuilder()
+								: m_alignment(1), m_tableStart(0) {}
+
+	//! Returns a total number of bytes written so far, objects are addressed by this value.
+	int32					size() const { return static_cast<int32>(m_bytes.size()); }
+
+	//! Prepends a scalar value and returns it's location.
+	template<typename TValue>
+	int32					scalar(TValue value);
+
+	//! Prepends a string and returns it's location.
+	int32					string(const std::string& value);
+
+	//! Prepends a vector of tables and returns it's location.
+	int32					vector(const std::vector<int32>& tables);
+
+	//! Prepends a vector of 8-byte aligned structures and returns it's location.
+	int32					structs(const void* data, int32 size, int32 count);
+
+	//! Starts a new table, table children should be prepended before a table is started.
+	void					startTable();
+
+	//! Adds a scalar table field.
+	template<typename TValue>
+	void					add(int32 slot, TValue value);
+
+	//! Adds a table field that references an object at specified location.
+	void					addOffset(int32 slot, int32 location);
+
+	//! Writes a table vtable and returns a table location.
+	int32					endTable();
+
+	//! Prepends a root table reference and appends a resulting buffer to an output.
+	void					finish(int32 root, std::vector<byte>& output);
+
+private:
+
+	//! Prepends an array of bytes.
+	void					prepend(const void* data, int32 size);
+
+	//! Prepends zero bytes so that a size becomes a multiple of an alignment after a specified number of bytes is prepended.
+	void					align(int32 length, int32 alignment);
+
+	//! Returns a relative offset from a next 4-byte aligned location to an object.
+	int32					reference(int32 location);
+
+private:
+
+	std::vector<byte>		m_bytes;		//!< Buffer bytes in a reverse order.
+	int32					m_alignment;	//!< A maximum alignment of a prepended value.
+	int32					m_tableStart;	//!< A size of a buffer when a current table was started.
+	std::vector<int32>		m_fields;		//!< Slot and location pairs of a current table fields.
+};
+
+// ** ArrowMetadataBuilder::scalar
+template<typename TValue>
+int32 ArrowMetadataBuilder::scalar(TValue value)
+{
+	align(sizeof(TValue), sizeof(TValue));
+	prepend(&value, sizeof(TValue));
+	return size();
+}
+
+// ** ArrowMetadataBuilder::string
+int32 ArrowMetadataBuilder::string(const std::string& value)
+{
+	int32 length = static_cast<int32>(value.size());
+
+	align(length + 1, 4);
+	m_bytes.push_back(0);
+	prepend(value.data(), length);
+
+	return scalar<uint32>(length);
+}
+
+// ** ArrowMetadataBuilder::vector
+int32 ArrowMetadataBuilder::vector(const std::vector<int32>& tables)
+{
+	int32 count = static_cast<int32>(tables.size());
+
+	align(count * 4, 4);
+
+	for (int32 i = count - 1; i >= 0; i--)
+	{
+		scalar<uint32>(reference(tables[i]));
+	}
+
+	return scalar<uint32>(count);
+}
+
+// ** ArrowMetadataBuilder::structs
+int32 ArrowMetadataBuilder::structs(const void* data, int32 size, int32 count)
+{
+	align(size * count, 8);
+	prepend(data, size * count);
+	return scalar<uint32>(count);
+}
+
+// ** ArrowMetadataBuilder::startTable
+void ArrowMetadataBuilder::startTable()
+{
+	m_fields.clear();
+	m_tableStart = size();
+}
+
+// ** ArrowMetadataBuilder::add
+template<typename TValue>
+void ArrowMetadataBuilder::add(int32 slot, TValue value)
+{
+	int32 location = scalar(value);
+	m_fields.push_back(slot);
+	m_fields.push_back(location);
+}
+
+// ** ArrowMetadataBuilder::addOffset
+void ArrowMetadataBuilder::addOffset(int32 slot, int32 location)
+{
+	add<uint32>(slot, reference(location));
+}
+
+// ** ArrowMetadataBuilder::endTable
+int32 ArrowMetadataBuilder::endTable()
+{
+	// A table starts with a signed offset to it's vtable that is patched once a vtable is written
+	int32 table = scalar<int32>(0);
+	int32 slots = 0;
+
+	for (size_t i = 0; i < m_fields.size(); i += 2)
+	{
+		slots = std::max(slots, m_fields[i] + 1);
+	}
+
+	// A vtable holds it's own size, a table size and field offsets relative to a table start
+	std::vector<uint16> vtable(slots + 2, 0);
+	vtable[0] = static_cast<uint16>(vtable.size() * sizeof(uint16));
+	vtable[1] = static_cast<uint16>(table - m_tableStart);
+
+	for (size_t i = 0; i < m_fields.size(); i += 2)
+	{
+		vtable[m_fields[i] + 2] = static_cast<uint16>(table - m_fields[i + 1]);
+	}
+
+	prepend(&vtable[0], static_cast<int32>(vtable.size() * sizeof(uint16)));
+
+	// A vtable precedes a table, so an offset is positive
+	int32 offset = size() - table;
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		m_bytes[table - 1 - i] = static_cast<byte>(offset >> (i * 8));
+	}
+
+	return table;
+}
+
+// ** ArrowMetadataBuilder::finish
+void ArrowMetadataBuilder::finish(int32 root, std::vector<byte>& output)
+{
+	align(4, m_alignment);
+	scalar<uint32>(reference(root));
+	output.insert(output.end(), m_bytes.rbegin(), m_bytes.rend());
+}
+
+// ** ArrowMetadataBuilder::prepend
+void ArrowMetadataBuilder::prepend(const void* data, int32 size)
+{
+	const byte* bytes = reinterpret_cast<const byte*>(data);
+
+	for (int32 i = size - 1; i >= 0; i--)
+	{
+		m_bytes.push_back(bytes[i]);
+	}
+}
+
+// ** ArrowMetadataBuilder::align
+void ArrowMetadataBuilder::align(int32 length, int32 alignment)
+{
+	m_alignment = std::max(m_alignment, alignment);
+	m_bytes.resize(m_bytes.size() + ((-(size() + length)) & (alignment - 1)), 0);
+}
+
+// ** ArrowMetadataBuilder::reference
+int32 ArrowMetadataBuilder::reference(int32 location)
+{
+	align(4, 4);
+	return size() - location + 4;
+}
+
+// ** arrowSetBit
+static void arrowSetBit(std::vector<byte>& bits, int32 index, bool value)
+{
+	if (static_cast<size_t>(index >> 3) >= bits.size())
+	{
+		bits.push_back(0);
+	}
+
+	if (value)
+	{
+		bits[index >> 3] |= static_cast<byte>(1 << (index & 7));
+	}
+}
+
+// ** arrowPush
+template<typename TValue>
+static void arrowPush(std::vector<byte>& values, TValue value)
+{
+	size_t size = values.size();
+	values.resize(size + sizeof(TValue));
+	memcpy(&values[size], &value, sizeof(TValue));
+}
+
+// ** arrowColumnBuffers
+static int32 arrowColumnBuffers(const DtoColumn& column, const void** data, int64* lengths)
+{
+	if (column.type == DtoColumnNull)
+	{
+		return 0;
+	}
+
+	// A validity bitmap may be omitted if there are no nulls
+	data[0]    = column.validity.data();
+	lengths[0] = column.nullCount ? column.validity.size() : 0;
+
+	if (column.type == DtoColumnString)
+	{
+		data[1]    = column.offsets.data();
+		lengths[1] = column.offsets.size() * sizeof(int32);
+		data[2]    = column.data.data();
+		lengths[2] = column.data.size();
+		return 3;
+	}
+
+	data[1]    = column.values.data();
+	lengths[1] = column.values.size();
+	return 2;
+}
+
+// ** arrowSchema
+static int32 arrowSchema(ArrowMetadataBuilder& builder, const std::vector<DtoColumn>& columns)
+{
+	std::vector<int32> fields;
+
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		const DtoColumn& column = columns[i];
+
+		int32 name     = builder.string(column.name);
+		int32 children = builder.vector(std::vector<int32>());
+		int32 timezone = column.type == DtoColumnDate ? builder.string("UTC") : 0;
+		byte  typeId   = 0;
+
+		builder.startTable();
+
+		switch (column.type)
+		{
+		case DtoColumnNull:
+			typeId = ArrowNull;
+			break;
+
+		case DtoColumnBool:
+			typeId = ArrowBool;
+			break;
+
+		case DtoColumnInt32:
+			typeId = ArrowInt;
+			builder.add<int32>(0, 32);
+			builder.add<byte>(1, 1);
+			break;
+
+		case DtoColumnInt64:
+		case DtoColumnUInt64:
+			typeId = ArrowInt;
+			builder.add<int32>(0, 64);
+			builder.add<byte>(1, column.type == DtoColumnInt64);
+			break;
+
+		case DtoColumnDouble:
+			typeId = ArrowFloatingPoint;
+			builder.add<uint16>(0, 2);	// DOUBLE precision
+			break;
+
+		case DtoColumnDate:
+			typeId = ArrowTimestamp;
+			builder.add<uint16>(0, 1);	// MILLISECOND unit
+			builder.addOffset(1, timezone);
+			break;
+
+		case DtoColumnString:
+			typeId = ArrowUtf8;
+			break;
+		}
+
+		int32 type = builder.endTable();
+
+		builder.startTable();
+		builder.addOffset(0, name);
+		builder.add<byte>(1, 1);		// nullable
+		builder.add<byte>(2, typeId);
+		builder.addOffset(3, type);
+		builder.addOffset(5, children);
+		fields.push_back(builder.endTable());
+	}
+
+	int32 vector = builder.vector(fields);
+
+	builder.startTable();
+	builder.add<uint16>(0, 0);			// little endian
+	builder.addOffset(1, vector);
+	return builder.endTable();
+}
+
+// ** arrowMessage
+static int32 arrowMessage(std::vector<byte>& output, ArrowMetadataBuilder& builder, ArrowMessageHeader type, int32 header, int64 bodyLength)
+{
+	builder.startTable();
+	builder.add<uint16>(0, ArrowMetadataV5);
+	builder.add<byte>(1, static_cast<byte>(type));
+	builder.addOffset(2, header);
+	builder.add<int64>(3, bodyLength);
+	int32 message = builder.endTable();
+
+	// An encapsulated message starts with a continuation marker and a metadata length padded to 8 bytes
+	size_t start = output.size();
+	arrowPush<uint32>(output, 0xFFFFFFFF);
+	arrowPush<int32>(output, 0);
+	builder.finish(message, output);
+	output.resize((output.size() + 7) & ~static_cast<size_t>(7), 0);
+
+	int32 length = static_cast<int32>(output.size() - start);
+	int32 metadata = length - 8;
+	memcpy(&output[start + 4], &metadata, sizeof(int32));
+
+	return length;
+}
+
+// ** DtoColumn::valueSize
+int32 DtoColumn::valueSize() const
+{
+	switch (type)
+	{
+	case DtoColumnInt32:
+		return sizeof(int32);
+	case DtoColumnInt64:
+	case DtoColumnUInt64:
+	case DtoColumnDouble:
+	case DtoColumnDate:
+		return sizeof(int64);
+	default:
+		return 0;
+	}
+}
+
+// ** DtoColumn::isValid
+bool DtoColumn::isValid(int32 index) const
+{
+	assert(index >= 0 && index < length);
+	return type != DtoColumnNull && ((validity[index >> 3] >> (index & 7)) & 1) != 0;
+}
+
+// ** DtoArrowTable::DtoArrowTable
+DtoArrowTable::DtoArrowTable()
+	: m_rows(0)
+	, m_stamp(0)
+{
+}
+
+// ** DtoArrowTable::rowCount
+int32 DtoArrowTable::rowCount() const
+{
+	return m_rows;
+}
+
+// ** DtoArrowTable::columnCount
+int32 DtoArrowTable::columnCount() const
+{
+	return static_cast<int32>(m_columns.size());
+}
+
+// ** DtoArrowTable::column
+const DtoColumn& DtoArrowTable::column(int32 index) const
+{
+	assert(index >= 0 && index < columnCount());
+	return m_columns[index];
+}
+
+// ** DtoArrowTable::findColumn
+int32 DtoArrowTable::findColumn(cstring name) const
+{
+	return m_names.find(DtoStringView::construct(name));
+}
+
+// ** DtoArrowTable::append
+bool DtoArrowTable::append(const Dto& record)
+{
+	if (!collect(record))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < m_fields.size(); i++)
+	{
+		const Field& field = m_fields[i];
+		int32 index = field.column;
+
+		// Create a column for a new key and fill it with nulls for all previous rows
+		if (index < 0)
+		{
+			DtoColumn column;
+			column.name		 = &m_buffer[field.name];
+			column.type		 = DtoColumnNull;
+			column.length	 = 0;
+			column.nullCount = 0;
+
+			DtoStringView name = { &m_buffer[field.name], static_cast<int32>(column.name.size()) };
+			index = m_names.add(name);
+			assert(index == columnCount());
+
+			m_columns.push_back(column);
+			m_stamps.push_back(m_stamp);
+			pad(m_columns.back(), m_rows);
+		}
+
+		appendValue(m_columns[index], field.value);
+	}
+
+	m_rows++;
+
+	// Keys that are missing in this record are stored as nulls
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		pad(m_columns[i], m_rows);
+	}
+
+	return true;
+}
+
+// ** DtoArrowTable::appendItems
+bool DtoArrowTable::appendItems(const Dto& dto)
+{
+	bool	result = true;
+	DtoIter	i = dto.iter();
+
+	while (i.next())
+	{
+		if (i != DtoKeyValue)
+		{
+			result = error("an item is not a record", std::string(i.key().value, i.key().length));
+			continue;
+		}
+
+		result = append(i.toDto()) && result;
+	}
+
+	return result;
+}
+
+// ** DtoArrowTable::appendStream
+bool DtoArrowTable::appendStream(const byte* data, int64 length)
+{
+	bool result = true;
+
+	for (int64 offset = 0; offset < length;)
+	{
+		int32 size = 0;
+
+		if (length - offset >= static_cast<int64>(sizeof(int32)))
+		{
+			memcpy(&size, data + offset, sizeof(int32));
+		}
+
+		if (size < 5 || size > length - offset)
+		{
+			return error("malformed record", std::string());
+		}
+
+		result = append(Dto(data + offset, size)) && result;
+		offset += size;
+	}
+
+	return result;
+}
+
+// ** DtoArrowTable::collect
+bool DtoArrowTable::collect(const Dto& record)
+{
+	BinaryDtoReader reader(record.data(), record.length());
+
+	m_fields.clear();
+	m_scopes.clear();
+	m_path.clear();
+	m_buffer.clear();
+	m_stamp++;
+
+	for (;;)
+	{
+		DtoEvent event = reader.next();
+
+		switch (event.type)
+		{
+		case DtoError:
+			return error("malformed record", m_path);
+
+		case DtoStreamStart:
+			break;
+
+		case DtoStreamEnd:
+			return true;
+
+		case DtoKeyValueStart:
+			m_scopes.push_back(m_path.size());
+			m_path.append(event.key.value, event.key.length);
+			m_path.append(1, '.');
+			break;
+
+		case DtoKeyValueEnd:
+			m_path.resize(m_scopes.back());
+			m_scopes.pop_back();
+			break;
+
+		case DtoSequenceStart:
+			m_path.append(event.key.value, event.key.length);
+			return error("sequences can't be stored in columns", m_path);
+
+		default:
+		{
+			size_t scope = m_path.size();
+			m_path.append(event.key.value, event.key.length);
+
+			if (!collect(event.data))
+			{
+				return false;
+			}
+
+			m_path.resize(scope);
+		}
+		}
+	}
+}
+
+// ** DtoArrowTable::collect
+bool DtoArrowTable::collect(const DtoValue& value)
+{
+	DtoColumnType type = columnType(value.type);
+
+	if (type == DtoColumnNull && value.type != DtoNull)
+	{
+		return error("unsupported value type", m_path);
+	}
+
+	Field field;
+	field.value = value;
+
+	DtoStringView name = { m_path.c_str(), static_cast<int32>(m_path.size()) };
+	field.column = m_names.find(name);
+
+	if (field.column >= 0)
+	{
+		// The first value wins if a key is repeated
+		if (m_stamps[field.column] == m_stamp)
+		{
+			return true;
+		}
+
+		DtoColumnType columnType = m_columns[field.column].type;
+
+		if (type != DtoColumnNull && columnType != DtoColumnNull && merge(columnType, type) == DtoColumnNull)
+		{
+			return error("value type does not match a column type", m_path);
+		}
+
+		// String offsets are 32-bit, so a column can't hold more than 2 GiB of characters
+		if (type == DtoColumnString && m_columns[field.column].data.size() + value.string.length > static_cast<size_t>(INT32_MAX))
+		{
+			return error("string column is too large", m_path);
+		}
+
+		m_stamps[field.column] = m_stamp;
+	}
+	else
+	{
+		for (size_t i = 0; i < m_fields.size(); i++)
+		{
+			if (m_fields[i].column < 0 && m_path == &m_buffer[m_fields[i].name])
+			{
+				return true;
+			}
+		}
+
+		if (columnCount() + m_fields.size() >= DtoKeyDictionary::MaxKeys)
+		{
+			return error("too many columns", m_path);
+		}
+
+		field.name = static_cast<int32>(m_buffer.size());
+		m_buffer.append(m_path);
+		m_buffer.append(1, '\0');
+	}
+
+	m_fields.push_back(field);
+	return true;
+}
+
+// ** DtoArrowTable::appendValue
+void DtoArrowTable::appendValue(DtoColumn& column, const DtoValue& value)
+{
+	DtoColumnType type = columnType(value.type);
+
+	if (type == DtoColumnNull)
+	{
+		pad(column, column.length + 1);
+		return;
+	}
+
+	DtoColumnType merged = merge(column.type, type);
+	assert(merged != DtoColumnNull);
+
+	if (merged != column.type)
+	{
+		convert(column, merged);
+	}
+
+	arrowSetBit(column.validity, column.length, true);
+
+	switch (column.type)
+	{
+	case DtoColumnBool:
+		arrowSetBit(column.values, column.length, value.boolean);
+		break;
+
+	case DtoColumnInt32:
+		arrowPush<int32>(column.values, value.int32);
+		break;
+
+	case DtoColumnInt64:
+		arrowPush<int64>(column.values, value.type == DtoInt32 ? value.int32 : value.int64);
+		break;
+
+	case DtoColumnUInt64:
+		arrowPush<uint64>(column.values, value.uint64);
+		break;
+
+	case DtoColumnDate:
+		arrowPush<int64>(column.values, value.int64);
+		break;
+
+	case DtoColumnDouble:
+		switch (value.type)
+		{
+		case DtoInt32:	arrowPush<double>(column.values, value.int32);
+						break;
+		case DtoInt64:	arrowPush<double>(column.values, static_cast<double>(value.int64));
+						break;
+		default:		arrowPush<double>(column.values, value.number);
+		}
+		break;
+
+	case DtoColumnString:
+		column.data.insert(column.data.end(), value.string.value, value.string.value + value.string.length);
+		column.offsets.push_back(static_cast<int32>(column.data.size()));
+		break;
+
+	default:
+		assert(false);
+	}
+
+	column.length++;
+}
+
+// ** DtoArrowTable::pad
+void DtoArrowTable::pad(DtoColumn& column, int32 length) const
+{
+	int32 size = column.valueSize();
+
+	for (; column.length < length; column.length++, column.nullCount++)
+	{
+		arrowSetBit(column.validity, column.length, false);
+
+		switch (column.type)
+		{
+		case DtoColumnNull:
+			break;
+
+		case DtoColumnBool:
+			arrowSetBit(column.values, column.length, false);
+			break;
+
+		case DtoColumnString:
+			column.offsets.push_back(static_cast<int32>(column.data.size()));
+			break;
+
+		default:
+			column.values.resize(column.values.size() + size, 0);
+		}
+	}
+}
+
+// ** DtoArrowTable::convert
+void DtoArrowTable::convert(DtoColumn& column, DtoColumnType type) const
+{
+	DtoColumnType from = column.type;
+	column.type = type;
+
+	// A column that had only nulls gets zero-filled buffers of a new type
+	if (from == DtoColumnNull)
+	{
+		switch (type)
+		{
+		case DtoColumnBool:
+			column.values.assign((column.length + 7) / 8, 0);
+			break;
+
+		case DtoColumnString:
+			column.offsets.assign(column.length + 1, 0);
+			break;
+
+		default:
+			column.values.assign(column.length * column.valueSize(), 0);
+		}
+		return;
+	}
+
+	std::vector<byte> values;
+	values.reserve(column.length * column.valueSize());
+
+	for (int32 i = 0; i < column.length; i++)
+	{
+		int64 value;
+
+		if (from == DtoColumnInt32)
+		{
+			int32 int32;
+			memcpy(&int32, &column.values[i * sizeof(int32)], sizeof(int32));
+			value = int32;
+		}
+		else
+		{
+			assert(from == DtoColumnInt64);
+			memcpy(&value, &column.values[i * sizeof(int64)], sizeof(int64));
+		}
+
+		if (type == DtoColumnDouble)
+		{
+			arrowPush<double>(values, static_cast<double>(value));
+		}
+		else
+		{
+			arrowPush<int64>(values, value);
+		}
+	}
+
+	column.values.swap(values);
+}
+
+// ** DtoArrowTable::columnType
+DtoColumnType DtoArrowTable::columnType(DtoValueType type)
+{
+	switch (type)
+	{
+	case DtoBool:		return DtoColumnBool;
+	case DtoInt32:		return DtoColumnInt32;
+	case DtoInt64:		return DtoColumnInt64;
+	case DtoTimestamp:	return DtoColumnUInt64;
+	case DtoDouble:		return DtoColumnDouble;
+	case DtoDate:		return DtoColumnDate;
+	case DtoString:		return DtoColumnString;
+	default:			return DtoColumnNull;
+	}
+}
+
+// ** DtoArrowTable::merge
+DtoColumnType DtoArrowTable::merge(DtoColumnType a, DtoColumnType b)
+{
+	if (a == b || b == DtoColumnNull)
+	{
+		return a;
+	}
+
+	if (a == DtoColumnNull)
+	{
+		return b;
+	}
+
+	bool isNumber = (a == DtoColumnInt32 || a == DtoColumnInt64 || a == DtoColumnDouble)
+				 && (b == DtoColumnInt32 || b == DtoColumnInt64 || b == DtoColumnDouble);
+
+	if (!isNumber)
+	{
+		return DtoColumnNull;
+	}
+
+	return a == DtoColumnDouble || b == DtoColumnDouble ? DtoColumnDouble : DtoColumnInt64;
+}
+
+// ** DtoArrowTable::error
+bool DtoArrowTable::error(cstring message, const std::string& name)
+{
+	if (g_errorHandler)
+	{
+		char text[DtoTokenInput::MaxMessageLength];
+		snprintf(text, sizeof(text), "error: %s '%s'", message, name.c_str());
+		g_errorHandler(text);
+	}
+
+	return false;
+}
+
+// ** DtoArrowTable::write
+void DtoArrowTable::write(std::vector<byte>& output) const
+{
+	static const byte Magic[8] = { 'A', 'R', 'R', 'O', 'W', '1', 0, 0 };
+
+	size_t start = output.size();
+	output.insert(output.end(), Magic, Magic + 8);
+
+	// Write a schema message
+	{
+		ArrowMetadataBuilder builder;
+		int32 schema = arrowSchema(builder, m_columns);
+		arrowMessage(output, builder, ArrowSchemaHeader, schema, 0);
+	}
+
+	// Lay out column buffers of a record batch body, each buffer is padded to 8 bytes
+	std::vector<ArrowFieldNode>	nodes;
+	std::vector<ArrowBuffer>	buffers;
+	int64						bodyLength = 0;
+
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		const void*	data[3];
+		int64		lengths[3];
+		int32		count = arrowColumnBuffers(m_columns[i], data, lengths);
+
+		ArrowFieldNode node = { m_columns[i].length, m_columns[i].nullCount };
+		nodes.push_back(node);
+
+		for (int32 j = 0; j < count; j++)
+		{
+			ArrowBuffer buffer = { bodyLength, lengths[j] };
+			buffers.push_back(buffer);
+			bodyLength += (lengths[j] + 7) & ~7LL;
+		}
+	}
+
+	// Write a record batch message followed by a body
+	ArrowBlock block;
+	block.offset	 = output.size() - start;
+	block.padding	 = 0;
+	block.bodyLength = bodyLength;
+
+	{
+		ArrowMetadataBuilder builder;
+		int32 nodeVector   = builder.structs(nodes.data(), sizeof(ArrowFieldNode), static_cast<int32>(nodes.size()));
+		int32 bufferVector = builder.structs(buffers.data(), sizeof(ArrowBuffer), static_cast<int32>(buffers.size()));
+
+		builder.startTable();
+		builder.add<int64>(0, m_rows);
+		builder.addOffset(1, nodeVector);
+		builder.addOffset(2, bufferVector);
+		int32 batch = builder.endTable();
+
+		block.metaDataLength = arrowMessage(output, builder, ArrowRecordBatchHeader, batch, bodyLength);
+	}
+
+	output.reserve(output.size() + bodyLength + 1024);
+
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		const void*	data[3];
+		int64		lengths[3];
+		int32		count = arrowColumnBuffers(m_columns[i], data, lengths);
+
+		for (int32 j = 0; j < count; j++)
+		{
+			const byte* bytes = reinterpret_cast<const byte*>(data[j]);
+			output.insert(output.end(), bytes, bytes + lengths[j]);
+			output.resize(output.size() + ((-lengths[j]) & 7), 0);
+		}
+	}
+
+	// Write an end of stream marker and a footer that duplicates a schema and references a record batch
+	arrowPush<uint32>(output, 0xFFFFFFFF);
+	arrowPush<int32>(output, 0);
+
+	size_t footerStart = output.size();
+	{
+		ArrowMetadataBuilder builder;
+		int32 schema		= arrowSchema(builder, m_columns);
+		int32 dictionaries	= builder.structs(NULL, sizeof(ArrowBlock), 0);
+		int32 batches		= builder.structs(&block, sizeof(ArrowBlock), 1);
+
+		builder.startTable();
+		builder.add<uint16>(0, ArrowMetadataV5);
+		builder.addOffset(1, schema);
+		builder.addOffset(2, dictionaries);
+		builder.addOffset(3, batches);
+		builder.finish(builder.endTable(), output);
+	}
+
+	arrowPush<int32>(output, static_cast<int32>(output.size() - footerStart));
+	output.insert(output.end(), Magic, Magic + 6);
+}
+
+// ** DtoArrowTable::writeFile
+bool DtoArrowTable::writeFile(cstring path) const
+{
+	std::vector<byte> output;
+	write(output);
+
+	FILE* file = fopen(path, "wb");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool result = fwrite(output.data(), 1, output.size(), file) == output.size();
+	return fclose(file) == 0 && result;
+}
+
+DTO_END
\ No newline at end of file
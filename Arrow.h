@@ -0,0 +1,164 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Arrow_H__
+#define __Dto_Arrow_H__
+
+#include <string>
+#include <vector>
+
+DTO_BEGIN
+
+	//! Value types of table columns, each one is mapped to a single Arrow data type.
+	enum DtoColumnType
+	{
+		  DtoColumnNull			//!< A column that has only null values so far.
+		, DtoColumnBool			//!< A bit-packed boolean column.
+		, DtoColumnInt32		//!< A 32-bit signed integer column.
+		, DtoColumnInt64		//!< A 64-bit signed integer column.
+		, DtoColumnUInt64		//!< A 64-bit unsigned integer column, stores DtoTimestamp values.
+		, DtoColumnDouble		//!< A 64-bit floating point column.
+		, DtoColumnDate			//!< A millisecond UTC timestamp column, stores DtoDate values.
+		, DtoColumnString		//!< A UTF-8 string column with 32-bit offsets.
+	};
+
+	//! A single column of a table stored as Arrow-compatible buffers.
+	struct DtoColumn
+	{
+		std::string			name;		//!< A column name, keys of nested key-value nodes are joined with a dot.
+		DtoColumnType		type;		//!< A column value type.
+		int32				length;		//!< A total number of values including nulls.
+		int32				nullCount;	//!< A total number of null values.
+		std::vector<byte>	validity;	//!< A validity bitmap with a least significant bit first, null values have a zero bit.
+		std::vector<byte>	values;		//!< Fixed-width values, booleans are bit-packed the same way as a validity bitmap.
+		std::vector<int32>	offsets;	//!< String start offsets followed by the end offset of the last string.
+		std::vector<byte>	data;		//!< Characters of all strings.
+
+		//! Returns a size of a single fixed-width value in bytes or 0 for bit-packed and variable-width columns.
+		int32				valueSize() const;
+
+		//! Returns true if a value at specified index is not null.
+		bool				isValid(int32 index) const;
+	};
+
+	/*!
+	 Pivots a stream of key-value records into a struct-of-arrays table and writes it as an Arrow IPC file.
+
+	 Each distinct top-level key becomes a column that is created the first time a key is seen, so records
+	 may omit keys or introduce new ones and missing values are stored as nulls. Integer columns are widened
+	 to 64-bit integers or doubles if wider numbers appear later. Records with sequences, binary blobs or
+	 values that do not match a column type are rejected as a whole.
+	 */
+	class DtoArrowTable
+	{
+	public:
+
+								//! Constructs an empty DtoArrowTable instance.
+								DtoArrowTable();
+
+		//! Appends a record as a next table row, returns false if a record was rejected, including when a string column would exceed 2 GiB of characters.
+		bool					append(const Dto& record);
+
+		//! Appends all key-value items of a DTO, such as a parsed array of records, returns false if any item was rejected.
+		bool					appendItems(const Dto& dto);
+
+		//! Appends all records of a byte stream with binary DTOs stored back to back, returns false if any record was rejected.
+		bool					appendStream(const byte* data, int64 length);
+
+		//! Returns a total number of table rows.
+		int32					rowCount() const;
+
+		//! Returns a total number of table columns.
+		int32					columnCount() const;
+
+		//! Returns a column at specified index, all columns have the same length.
+		const DtoColumn&		column(int32 index) const;
+
+		//! Returns a column index with specified name or -1 if there is no such column.
+		int32					findColumn(cstring name) const;
+
+		//! Appends an Arrow IPC file with a single record batch to an output buffer.
+		void					write(std::vector<byte>& output) const;
+
+		//! Writes an Arrow IPC file with a single record batch, returns false if a file could not be written.
+		bool					writeFile(cstring path) const;
+
+	private:
+
+		//! A record value collected before it is appended to a column.
+		struct Field
+		{
+			int32				column;		//!< A column index or -1 for a new column.
+			int32				name;		//!< A column name offset inside a name buffer.
+			DtoValue			value;		//!< A field value.
+		};
+
+		//! Reads record fields and checks them against column types, returns false if a record can't be appended.
+		bool					collect(const Dto& record);
+
+		//! Adds a leaf field of a record being collected, returns false if a value can't be stored in a column.
+		bool					collect(const DtoValue& value);
+
+		//! Appends a value to a column, converting a column type if needed.
+		void					appendValue(DtoColumn& column, const DtoValue& value);
+
+		//! Appends null values to a column until it has a specified length.
+		void					pad(DtoColumn& column, int32 length) const;
+
+		//! Converts column values to a wider numeric type or initializes buffers of a column that was typed as null.
+		void					convert(DtoColumn& column, DtoColumnType type) const;
+
+		//! Returns a column type for a DTO value type or DtoColumnNull if a value type is not supported.
+		static DtoColumnType	columnType(DtoValueType type);
+
+		//! Returns a column type that can hold values of both types or DtoColumnNull if types are not compatible.
+		static DtoColumnType	merge(DtoColumnType a, DtoColumnType b);
+
+		//! Reports a rejected record.
+		static bool				error(cstring message, const std::string& name);
+
+	private:
+
+								//! Tables are not copyable.
+								DtoArrowTable(const DtoArrowTable&);
+		DtoArrowTable&			operator = (const DtoArrowTable&);
+
+	private:
+
+		std::vector<DtoColumn>	m_columns;	//!< Table columns.
+		DtoKeyDictionary		m_names;	//!< Maps column names to column indices.
+		int32					m_rows;		//!< A total number of appended rows.
+		std::vector<Field>		m_fields;	//!< Fields of a record being appended.
+		std::vector<int32>		m_stamps;	//!< A last record that had a value for each column, used to skip duplicate keys.
+		int32					m_stamp;	//!< A total number of collected records.
+		std::vector<size_t>		m_scopes;	//!< Key path lengths of enclosing key-value nodes.
+		std::string				m_path;		//!< A dot-separated key path of a current field.
+		std::string				m_buffer;	//!< Zero-terminated names of new columns of a record being appended.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Arrow_H__	*/
\ No newline at end of file
@@ -0,0 +1,83 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+BENCHMARK(ColumnScan)
+{
+	int32 count = 200000;
+	std::vector<byte> stream(count * 64);
+	int32 length = 0;
+
+	for (int32 i = 0; i < count; i++)
+	{
+		DtoEncoder encoder(&stream[length], static_cast<int32>(stream.size()) - length);
+		encoder << "id" << i << "price" << i * 0.25 << "name" << "item" << DtoEncoder::end;
+		length += encoder.length();
+	}
+
+	DtoArrowTable table;
+	table.appendStream(&stream[0], length);
+
+	const DtoColumn& column = table.column(table.findColumn("price"));
+	double checksum = 0.0;
+
+	// Sum a single field of each record
+	double records = measure([&]()
+	{
+		double sum = 0.0;
+
+		for (int32 offset = 0; offset < length;)
+		{
+			DtoType dto(&stream[offset], length - offset);
+			sum += dto.find("price").toDouble();
+			offset += dto.length();
+		}
+
+		checksum += sum;
+	});
+	report("Dto::find", length, records);
+
+	// Sum a column buffer
+	double columns = measure([&]()
+	{
+		const double* values = reinterpret_cast<const double*>(column.values.data());
+		double sum = 0.0;
+
+		for (int32 i = 0; i < column.length; i++)
+		{
+			sum += values[i];
+		}
+
+		checksum += sum;
+	});
+
+	char label[64];
+	snprintf(label, sizeof(label), "DtoColumn scan (%.2fx)", records / columns);
+	report(label, length, columns);
+
+	printf("  checksum %g\n", checksum);
+}
\ No newline at end of file
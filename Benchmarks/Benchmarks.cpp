@@ -0,0 +1,75 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+// ** Benchmark::Benchmark
+Benchmark::Benchmark(cstring name, Function function)
+	: name(name)
+	, function(function)
+{
+	all().push_back(this);
+}
+
+// ** Benchmark::all
+std::vector<Benchmark*>& Benchmark::all()
+{
+	static std::vector<Benchmark*> benchmarks;
+	return benchmarks;
+}
+
+// ** report
+void report(cstring label, int64 bytes, double seconds)
+{
+	printf("  %-40s %10.2f ms %10.1f MB/s\n", label, seconds * 1000.0, bytes / seconds / (1024.0 * 1024.0));
+}
+
+void dtoError(cstring message)
+{
+}
+
+int main(int argc, char *argv[])
+{
+	dtoSetErrorHandler(dtoError);
+
+	// Run all benchmarks which names contain a filter string
+	cstring filter = argc > 1 ? argv[1] : "";
+
+	for (size_t i = 0; i < Benchmark::all().size(); i++)
+	{
+		Benchmark* benchmark = Benchmark::all()[i];
+
+		if (strstr(benchmark->name, filter) == NULL)
+		{
+			continue;
+		}
+
+		printf("%s\n", benchmark->name);
+		benchmark->function();
+	}
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Benchmarks_H__
+#define __Dto_Benchmarks_H__
+
+#include <Dto.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace Dto;
+
+typedef ::Dto::Dto DtoType;
+
+//! A single benchmark registered with a BENCHMARK macro.
+struct Benchmark
+{
+	typedef void (*Function)();
+
+						//! Constructs and registers a benchmark.
+						Benchmark(cstring name, Function function);
+
+	cstring				name;		//!< A benchmark name.
+	Function			function;	//!< A benchmark function.
+
+	//! Returns all registered benchmarks.
+	static std::vector<Benchmark*>& all();
+};
+
+//! Declares and registers a benchmark function.
+#define BENCHMARK(name)											\
+	static void benchmark##name();								\
+	static Benchmark s_benchmark##name(#name, benchmark##name);	\
+	static void benchmark##name()
+
+//! Runs a function specified number of times and returns the best wall clock time of a single run in seconds.
+template<typename TFunction>
+double measure(TFunction function, int32 iterations = 3)
+{
+	double best = 1e30;
+
+	for (int32 i = 0; i < iterations; i++)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		function();
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+
+	return best;
+}
+
+//! Prints a throughput of a benchmarked operation.
+void report(cstring label, int64 bytes, double seconds);
+
+#endif	/*	#ifndef __Dto_Benchmarks_H__	*/
@@ -0,0 +1,76 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+BENCHMARK(SequenceExtract)
+{
+	int32 count = 1000000;
+	std::vector<byte> document(count * 16 + 1024);
+	std::vector<double> values(count);
+
+	DtoEncoder encoder(&document[0], static_cast<int32>(document.size()));
+	encoder << "values" << DtoEncoder::sequence;
+
+	for (int32 i = 0; i < count; i++)
+	{
+		encoder << i * 0.5;
+	}
+
+	encoder << DtoEncoder::end << DtoEncoder::end;
+
+	DtoType dto(&document[0], static_cast<int32>(document.size()));
+	int64 size = dto.length();
+	double checksum = 0.0;
+
+	// Decode each item with an iterator
+	double iterated = measure([&]()
+	{
+		DtoIter i = dto.find("values").toDto().iter();
+		int32 index = 0;
+
+		while (i.next())
+		{
+			values[index++] = i.toDouble();
+		}
+
+		checksum += values[count - 1];
+	});
+	report("DtoIter::next", size, iterated);
+
+	// Copy all items at once
+	double extracted = measure([&]()
+	{
+		dto.find("values").extractDoubles(&values[0], count);
+		checksum += values[count - 1];
+	});
+
+	char label[64];
+	snprintf(label, sizeof(label), "DtoIter::extractDoubles (%.2fx)", iterated / extracted);
+	report(label, size, extracted);
+
+	printf("  checksum %g\n", checksum);
+}
\ No newline at end of file
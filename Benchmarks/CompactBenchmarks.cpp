@@ -0,0 +1,127 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+//! Encodes a set of small telemetry messages as binary DTOs stored back to back.
+static std::vector<byte> generateMessages(int32 count, std::vector<int32>& offsets)
+{
+	std::vector<byte> result(count * 512);
+	int32 length = 0;
+	char json[512];
+
+	for (int32 i = 0; i < count; i++)
+	{
+		snprintf(json, sizeof(json), "{\"id\": %d, \"type\": \"position\", \"unit\": {\"x\": %d, \"y\": %d, \"heading\": %d.25}, \"alive\": %s, \"flags\": [%d, %d, %d]}"
+			, i, i % 640, i % 480, i % 360, i % 7 ? "true" : "false", i % 2, i % 3, i % 5);
+
+		DtoType dto = dtoParse<JsonDtoReader>(json, &result[length], static_cast<int32>(result.size()) - length);
+		offsets.push_back(length);
+		length += dto.length();
+	}
+
+	offsets.push_back(length);
+	result.resize(length);
+
+	return result;
+}
+
+//! Converts each message with specified reader and writer types and returns a total number of written bytes.
+template<typename TReader, typename TWriter>
+int64 convertMessages(const byte* input, const std::vector<int32>& offsets, std::vector<byte>& output, std::vector<int32>& outputOffsets)
+{
+	int64 length = 0;
+	outputOffsets.clear();
+
+	for (size_t i = 0; i + 1 < offsets.size(); i++)
+	{
+		TReader reader(input + offsets[i], offsets[i + 1] - offsets[i]);
+		TWriter writer(&output[length], static_cast<int32>(output.size() - length));
+		DtoEvent event;
+
+		do
+		{
+			event = reader.next();
+			writer.consume(event);
+		} while (event.type != DtoStreamEnd && event.type != DtoError);
+
+		outputOffsets.push_back(static_cast<int32>(length));
+		length += DtoType(&output[length], static_cast<int32>(output.size() - length)).length();
+	}
+
+	outputOffsets.push_back(static_cast<int32>(length));
+	return length;
+}
+
+BENCHMARK(CompactLayout)
+{
+	std::vector<int32> offsets;
+	std::vector<byte> binary = generateMessages(200000, offsets);
+	int64 size = static_cast<int64>(binary.size());
+
+	std::vector<byte> output(binary.size() + 1024);
+	std::vector<int32> copyOffsets;
+	std::vector<byte> copy(binary.size() + 1024);
+
+	// Re-encoding binary messages is a baseline for a compact writer
+	double binaryWrite = measure([&]() { convertMessages<BinaryDtoReader, BinaryDtoWriter>(&binary[0], offsets, copy, copyOffsets); });
+	report("BinaryDtoWriter", size, binaryWrite);
+
+	std::vector<int32> compactOffsets;
+	int64 compactSize = 0;
+
+	double compactWrite = measure([&]()
+	{
+		compactSize = 0;
+		compactOffsets.clear();
+
+		for (size_t i = 0; i + 1 < offsets.size(); i++)
+		{
+			BinaryDtoReader reader(&binary[offsets[i]], offsets[i + 1] - offsets[i]);
+			CompactDtoWriter writer(&output[compactSize], static_cast<int32>(output.size() - compactSize));
+			DtoEvent event;
+
+			do
+			{
+				event = reader.next();
+				writer.consume(event);
+			} while (event.type != DtoStreamEnd);
+
+			compactOffsets.push_back(static_cast<int32>(compactSize));
+			compactSize += writer.length();
+		}
+
+		compactOffsets.push_back(static_cast<int32>(compactSize));
+	});
+	report("CompactDtoWriter", size, compactWrite);
+
+	// Decode compact messages back to a binary layout
+	double compactRead = measure([&]() { convertMessages<CompactDtoReader, BinaryDtoWriter>(&output[0], compactOffsets, copy, copyOffsets); });
+	report("CompactDtoReader", compactSize, compactRead);
+
+	printf("  %d messages: %lld bytes binary, %lld bytes compact (%.1f%%)\n"
+		, static_cast<int32>(offsets.size() - 1), size, compactSize, 100.0 * compactSize / size);
+}
\ No newline at end of file
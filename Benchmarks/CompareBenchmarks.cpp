@@ -0,0 +1,81 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+
+BENCHMARK(Sort)
+{
+	int32 count = 500000;
+	int32 stride = 96;
+	std::vector<byte> buffer(count * stride);
+	std::vector<DtoType> documents;
+
+	for (int32 i = 0; i < count; i++)
+	{
+		byte* data = &buffer[i * stride];
+		DtoEncoder(data, stride) << "id" << i << "name" << "sensor" << "region" << (i % 3 ? "eu" : "us") << "stats" << DtoEncoder::keyValue << "score" << static_cast<int32>(i * 7919LL % count) << DtoEncoder::end << DtoEncoder::end;
+		documents.push_back(DtoType(data, stride));
+	}
+
+	int64 bytes = static_cast<int64>(count) * stride;
+	int64 checksum = 0;
+
+	// Walk both documents on each comparison
+	double walked = measure([&]()
+	{
+		std::vector<DtoType> sorted = documents;
+		DtoFieldPath region("region");
+		DtoFieldPath score("stats.score");
+
+		std::sort(sorted.begin(), sorted.end(), [&](const DtoType& a, const DtoType& b)
+		{
+			int32 result = dtoCompare(a.find(region).value(), b.find(region).value());
+			return result ? result < 0 : dtoCompare(a.find(score).value(), b.find(score).value()) > 0;
+		});
+
+		checksum += sorted[0].find("id").toInt32();
+	}, 1);
+	report("std::sort (find per comparison)", bytes, walked);
+
+	// Extract sort keys once
+	double extracted = measure([&]()
+	{
+		std::vector<DtoType> sorted = documents;
+		DtoComparator comparator;
+		comparator.by("region").by("stats.score", DtoDescending);
+		comparator.sort(&sorted[0], count);
+
+		checksum += sorted[0].find("id").toInt32();
+	}, 1);
+
+	char label[64];
+	snprintf(label, sizeof(label), "DtoComparator::sort (%.2fx)", walked / extracted);
+	report(label, bytes, extracted);
+
+	printf("  checksum %lld\n", checksum);
+}
\ No newline at end of file
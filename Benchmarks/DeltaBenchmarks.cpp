@@ -0,0 +1,79 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+BENCHMARK(DeltaStream)
+{
+	int32 count = 100000;
+	int32 stride = 256;
+	std::vector<byte> samples(count * stride);
+	int64 total = 0;
+
+	// Synthetic sensor samples where a sequence number and a timestamp always change and readings change from time to time
+	for (int32 i = 0; i < count; i++)
+	{
+		DtoEncoder encoder(&samples[i * stride], stride);
+		encoder << "sensor" << "thermo-01" << "firmware" << "1.4.2" << "seq" << i << "ts" << static_cast<int64>(1500000000000LL + i * 1000LL);
+		encoder << "location" << DtoEncoder::keyValue << "lat" << 52.52 << "lon" << 13.405 << DtoEncoder::end;
+		encoder << "readings" << DtoEncoder::keyValue << "temperature" << 20.0 + (i / 7 % 10) * 0.1 << "humidity" << 40 + i / 13 % 5 << "pressure" << 1013.25 << DtoEncoder::end;
+		encoder << "status" << (i % 100 ? "ok" : "check") << DtoEncoder::end;
+		total += DtoType(&samples[i * stride], stride).length();
+	}
+
+	std::vector<byte> stream;
+	stream.reserve(total);
+
+	double encoded = measure([&]()
+	{
+		DtoDeltaEncoder encoder;
+		stream.clear();
+
+		for (int32 i = 0; i < count; i++)
+		{
+			encoder.encode(DtoType(&samples[i * stride], stride), stream);
+		}
+	});
+	report("DtoDeltaEncoder", total, encoded);
+
+	int64 checksum = 0;
+	std::vector<byte> output;
+
+	double decoded = measure([&]()
+	{
+		DtoDeltaDecoder decoder;
+		DtoByteBufferInput input(&stream[0], static_cast<int32>(stream.size()));
+
+		for (int32 i = 0; i < count; i++)
+		{
+			checksum += decoder.decode(input, output).length();
+		}
+	});
+	report("DtoDeltaDecoder", total, decoded);
+
+	printf("  documents %lld bytes, stream %d bytes (%.1fx)\n", total, static_cast<int32>(stream.size()), static_cast<double>(total) / stream.size());
+	printf("  checksum %lld\n", checksum);
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+BENCHMARK(Diff)
+{
+	int32 count = 20000;
+	std::string source = "{\"items\": [";
+	std::string target = source;
+
+	for (int32 i = 0; i < count; i++)
+	{
+		std::string prefix = (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"sensor\", \"value\": ";
+		source += prefix + "21.5, \"tags\": [1, 2, 3]}";
+		target += prefix + (i == count / 2 ? "22.5" : "21.5") + ", \"tags\": [1, 2, 3]}";
+	}
+
+	source += "]}";
+	target += "]}";
+
+	std::vector<byte> a(source.size() * 2), b(target.size() * 2);
+	DtoType first  = dtoParse<JsonDtoReader>(source.c_str(), &a[0], static_cast<int32>(a.size()));
+	DtoType second = dtoParse<JsonDtoReader>(target.c_str(), &b[0], static_cast<int32>(b.size()));
+
+	std::vector<byte> patch, result;
+	int64 checksum = 0;
+
+	// Compute a patch for a single changed value
+	double diffed = measure([&]()
+	{
+		checksum += dtoDiff(first, second, patch).length();
+	});
+	report("dtoDiff", second.length(), diffed);
+
+	// Apply a patch to a base document
+	DtoType diff = dtoDiff(first, second, patch);
+	double applied = measure([&]()
+	{
+		checksum += dtoApplyPatch(first, diff, result).length();
+	});
+	report("dtoApplyPatch", second.length(), applied);
+
+	printf("  document %d bytes, patch %d bytes\n", second.length(), diff.length());
+	printf("  checksum %lld\n", checksum);
+}
\ No newline at end of file
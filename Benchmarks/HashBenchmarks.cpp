@@ -0,0 +1,67 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+BENCHMARK(Hash)
+{
+	int32 count = 200000;
+	std::string json = "{\"items\": [";
+
+	for (int32 i = 0; i < count; i++)
+	{
+		json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"sensor\", \"value\": 21.5, \"tags\": [1, 2, 3]}";
+	}
+
+	json += "]}";
+
+	std::vector<byte> buffer(json.size() * 2);
+	DtoType dto = dtoParse<JsonDtoReader>(json.c_str(), &buffer[0], static_cast<int32>(buffer.size()));
+	uint64 checksum = 0;
+
+	// Checksum a binary layout as a baseline
+	double crc = measure([&]()
+	{
+		checksum += dtoCrc32c(dto.data(), dto.length());
+	});
+	report("dtoCrc32c", dto.length(), crc);
+
+	// Hash a binary layout as is
+	double layout = measure([&]()
+	{
+		checksum += dtoHash(dto);
+	});
+	report("dtoHash (layout)", dto.length(), layout);
+
+	// Hash each entry independently of an order
+	double canonical = measure([&]()
+	{
+		checksum += dtoHash(dto, DtoHashCanonical);
+	});
+	report("dtoHash (canonical)", dto.length(), canonical);
+
+	printf("  checksum %llu\n", checksum);
+}
\ No newline at end of file
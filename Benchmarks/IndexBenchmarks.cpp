@@ -0,0 +1,96 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+BENCHMARK(FieldIndex)
+{
+	int32 count = 200000;
+	std::vector<byte> buffer(count * 64);
+	std::vector<DtoType> documents;
+
+	for (int32 i = 0; i < count; i++)
+	{
+		byte* data = &buffer[i * 64];
+		DtoEncoder user(data, 64);
+		user << "name" << "user" << "user" << DtoEncoder::keyValue << "id" << static_cast<int32>(i * 7919LL % count) << DtoEncoder::end << DtoEncoder::end;
+		documents.push_back(DtoType(data, 64));
+	}
+
+	int64 checksum = 0;
+	int32 lookups = 20;
+
+	// Scan all documents for each lookup
+	double scanned = measure([&]()
+	{
+		for (int32 j = 0; j < lookups; j++)
+		{
+			for (int32 i = 0; i < count; i++)
+			{
+				if (documents[i].findDescendant("user.id").toInt32() == j)
+				{
+					checksum += i;
+				}
+			}
+		}
+	}, 1);
+	report("Dto::findDescendant scan", static_cast<int64>(lookups) * count * 64, scanned);
+
+	// Build indices serially and in parallel
+	DtoThreadPool pool;
+	DtoFieldIndex hash("user.id", DtoHashIndex);
+	DtoFieldIndex sorted("user.id", DtoSortedIndex);
+
+	double serial = measure([&]() { sorted.build(&documents[0], count); });
+	report("DtoFieldIndex::build, sorted", static_cast<int64>(count) * 64, serial);
+
+	double parallel = measure([&]() { sorted.build(&documents[0], count, &pool); });
+
+	char label[64];
+	snprintf(label, sizeof(label), "DtoFieldIndex::build, sorted, %d threads (%.2fx)", pool.size(), serial / parallel);
+	report(label, static_cast<int64>(count) * 64, parallel);
+
+	double hashed = measure([&]() { hash.build(&documents[0], count, &pool); });
+	report("DtoFieldIndex::build, hash", static_cast<int64>(count) * 64, hashed);
+
+	// Look up the same values through an index
+	std::vector<int64> locations;
+
+	double found = measure([&]()
+	{
+		for (int32 j = 0; j < lookups; j++)
+		{
+			locations.clear();
+			hash.find(j, locations);
+			checksum += locations[0];
+		}
+	});
+
+	snprintf(label, sizeof(label), "DtoFieldIndex::find (%.0fx)", scanned / found);
+	report(label, static_cast<int64>(lookups) * count * 64, found);
+
+	printf("  checksum %lld\n", checksum);
+}
\ No newline at end of file
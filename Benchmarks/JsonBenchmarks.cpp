@@ -0,0 +1,155 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+//! Generates a JSON response of approximately specified size with a few fields at the end.
+static std::string generateResponse(int32 size)
+{
+	std::string result = "{\"items\": [";
+	char item[256];
+
+	for (int32 i = 0; result.size() < static_cast<size_t>(size); i++)
+	{
+		snprintf(item, sizeof(item), "%s{\"id\": %d, \"title\": \"item number %d\", \"tags\": [\"x\", \"y\"], \"price\": %d.5}", i ? ", " : "", i, i, i % 100);
+		result += item;
+	}
+
+	result += "], \"status\": \"ok\", \"page\": {\"index\": 3, \"total\": 17}}";
+	return result;
+}
+
+BENCHMARK(JsonLookup)
+{
+	std::string input = generateResponse(200 * 1024);
+	const byte* data  = reinterpret_cast<const byte*>(input.c_str());
+	int32 size        = static_cast<int32>(input.size());
+	int32 iterations  = 100;
+	int32 checksum    = 0;
+
+	// Convert a whole document to a binary DTO before looking up fields
+	std::vector<byte> output(dtoJsonBinaryBound(size));
+	double parsed = measure([&]()
+	{
+		for (int32 i = 0; i < iterations; i++)
+		{
+			DtoType dto = dtoParse<JsonDtoReader>(input.c_str(), &output[0], static_cast<int32>(output.size()));
+			checksum += dto.find("status").toString().length + dto.findDescendant("page.index").toInt32() + dto.findDescendant("page.total").toInt32();
+		}
+	});
+	report("dtoParse + find", static_cast<int64>(size) * iterations, parsed);
+
+	// Look up the same fields directly inside a JSON text
+	double lazy = measure([&]()
+	{
+		for (int32 i = 0; i < iterations; i++)
+		{
+			JsonDtoView view(data, size);
+			checksum += view.find("status").toString().length + view.findDescendant("page.index").toInt32() + view.findDescendant("page.total").toInt32();
+		}
+	});
+
+	char label[64];
+	snprintf(label, sizeof(label), "JsonDtoView (%.2fx)", parsed / lazy);
+	report(label, static_cast<int64>(size) * iterations, lazy);
+
+	printf("  checksum %d\n", checksum);
+}
+
+//! Reformats a JSON text with a two-space indentation and CRLF line breaks.
+static std::string prettify(const std::string& input)
+{
+	std::string result;
+	int32 depth = 0;
+	bool quoted = false;
+
+	for (size_t i = 0; i < input.size(); i++)
+	{
+		char c = input[i];
+
+		if (quoted)
+		{
+			result += c;
+			quoted = !(c == '"' && input[i - 1] != '\\');
+			continue;
+		}
+
+		switch (c)
+		{
+		case '"':
+			quoted = true;
+			result += c;
+			break;
+
+		case '{':
+		case '[':
+			result += c;
+			result += "\r\n" + std::string(++depth * 2, ' ');
+			break;
+
+		case '}':
+		case ']':
+			result += "\r\n" + std::string(--depth * 2, ' ') + c;
+			break;
+
+		case ',':
+			result += ",\r\n" + std::string(depth * 2, ' ');
+			break;
+
+		case ' ':
+			if (input[i - 1] == ':')
+			{
+				result += c;
+			}
+			break;
+
+		default:
+			result += c;
+		}
+	}
+
+	return result;
+}
+
+BENCHMARK(JsonPrettyPrinted)
+{
+	// Most of a pretty-printed input is an indentation
+	std::string compact = generateResponse(4 * 1024 * 1024);
+	std::string pretty  = prettify(compact);
+	std::vector<byte> binary(dtoJsonBinaryBound(static_cast<int32>(pretty.size())));
+
+	double seconds = measure([&]()
+	{
+		dtoConvert<JsonDtoReader, BinaryDtoWriter>(reinterpret_cast<const byte*>(pretty.c_str()), static_cast<int32>(pretty.size()), &binary[0], static_cast<int32>(binary.size()));
+	});
+	report("pretty-printed", static_cast<int64>(pretty.size()), seconds);
+
+	seconds = measure([&]()
+	{
+		dtoConvert<JsonDtoReader, BinaryDtoWriter>(reinterpret_cast<const byte*>(compact.c_str()), static_cast<int32>(compact.size()), &binary[0], static_cast<int32>(binary.size()));
+	});
+	report("compact", static_cast<int64>(compact.size()), seconds);
+}
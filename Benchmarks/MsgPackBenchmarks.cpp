@@ -0,0 +1,82 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+//! Generates a JSON document of approximately specified size made of small records.
+static std::string generateRecords(int32 size)
+{
+	std::string result = "{\"records\": [";
+	char record[384];
+
+	for (int32 i = 0; result.size() < static_cast<size_t>(size); i++)
+	{
+		snprintf(record, sizeof(record), "%s{\"id\": %d, \"name\": \"user-%d\", \"email\": \"user-%d@example.com\", \"score\": %d.75, \"active\": %s, \"groups\": [\"staff\", \"group-%d\"], \"location\": {\"lat\": %d.125, \"lon\": -%d.5}}"
+			, i ? ", " : "", i, i, i, i % 1000, i % 3 ? "true" : "false", i % 16, i % 90, i % 180);
+		result += record;
+	}
+
+	result += "]}";
+	return result;
+}
+
+BENCHMARK(MsgPackReader)
+{
+	std::string json = generateRecords(4 * 1024 * 1024);
+	int32 jsonSize   = static_cast<int32>(json.size());
+	std::vector<byte> binary(dtoJsonBinaryBound(jsonSize));
+
+	double parsed = measure([&]()
+	{
+		dtoConvert<JsonDtoReader, BinaryDtoWriter>(reinterpret_cast<const byte*>(json.c_str()), jsonSize, &binary[0], static_cast<int32>(binary.size()));
+	});
+	report("JsonDtoReader", static_cast<int64>(jsonSize), parsed);
+
+	// Encode the same data as a MessagePack document
+	std::vector<byte> msgpack(binary.size());
+	BinaryDtoReader reader(&binary[0], static_cast<int32>(binary.size()));
+	MsgPackDtoWriter writer(&msgpack[0], static_cast<int32>(msgpack.size()));
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	int32 msgpackSize = writer.length();
+
+	double decoded = measure([&]()
+	{
+		dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(&msgpack[0], msgpackSize, &binary[0], static_cast<int32>(binary.size()));
+	});
+
+	char label[64];
+	snprintf(label, sizeof(label), "MsgPackDtoReader (%.2fx)", parsed / decoded);
+	report(label, static_cast<int64>(msgpackSize), decoded);
+
+	printf("  %d bytes JSON, %d bytes MessagePack (%.1f%%)\n", jsonSize, msgpackSize, 100.0 * msgpackSize / jsonSize);
+}
\ No newline at end of file
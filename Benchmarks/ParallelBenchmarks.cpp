@@ -0,0 +1,162 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <thread>
+
+//! Generates a newline-delimited JSON log with specified number of records.
+static std::string generateJsonLines(int32 count)
+{
+	std::string result;
+	char line[256];
+
+	for (int32 i = 0; i < count; i++)
+	{
+		int32 length = snprintf(line, sizeof(line), "{\"id\": %d, \"user\": {\"name\": \"user%d\", \"active\": %s}, \"score\": %d.%d, \"tags\": [\"a\", \"b\", \"c\"], \"path\": \"/api/v1/items/%d\"}\n"
+			, i, i % 1000, i % 3 ? "true" : "false", i % 100, i % 10, i);
+		result.append(line, length);
+	}
+
+	return result;
+}
+
+BENCHMARK(JsonLinesReader)
+{
+	std::string input = generateJsonLines(500000);
+	const byte* data  = reinterpret_cast<const byte*>(input.c_str());
+	int64 size        = static_cast<int64>(input.size());
+
+	// A single-threaded baseline that parses one line after another
+	std::vector<byte> output(dtoJsonBinaryBound(1024));
+	double serial = measure([&]()
+	{
+		for (const byte* ptr = data, *end = data + size; ptr < end;)
+		{
+			const byte* newLine = reinterpret_cast<const byte*>(memchr(ptr, '\n', end - ptr));
+			dtoConvert<JsonDtoReader, BinaryDtoWriter>(ptr, static_cast<int32>(newLine - ptr), &output[0], static_cast<int32>(output.size()));
+			ptr = newLine + 1;
+		}
+	});
+	report("serial", size, serial);
+
+	// Now parse the same input on a growing number of threads
+	int32 hardware = std::max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+
+	for (int32 threads = 1; threads <= hardware; threads *= 2)
+	{
+		DtoThreadPool pool(threads);
+		DtoJsonLinesReader reader(pool);
+		double seconds = measure([&]() { reader.parse(data, size); });
+
+		char label[64];
+		snprintf(label, sizeof(label), "%d threads (%.2fx)", threads, serial / seconds);
+		report(label, size, seconds);
+	}
+}
+
+BENCHMARK(JsonLinesWriter)
+{
+	// Parse records once, so only a formatting is measured
+	std::string input = generateJsonLines(500000);
+	DtoThreadPool parsePool;
+	DtoJsonLinesReader reader(parsePool);
+	reader.parse(reinterpret_cast<const byte*>(input.c_str()), static_cast<int64>(input.size()));
+
+	std::vector<DtoType> records;
+	for (int32 i = 0; i < reader.documentCount(); i++)
+	{
+		records.push_back(reader.document(i));
+	}
+
+	int32 count = static_cast<int32>(records.size());
+	int64 size  = static_cast<int64>(input.size());
+
+	// A single-threaded baseline that formats one record after another
+	std::vector<byte> output;
+	double serial = measure([&]()
+	{
+		std::vector<byte> text;
+
+		for (int32 i = 0; i < count; i++)
+		{
+			int32 capacity = dtoBinaryJsonBound(records[i].length());
+			output.resize(capacity);
+			dtoConvert<BinaryDtoReader, JsonDtoWriter>(records[i].data(), records[i].length(), &output[0], capacity);
+			text.insert(text.end(), output.begin(), output.begin() + strlen(reinterpret_cast<cstring>(&output[0])));
+			text.push_back('\n');
+		}
+	});
+	report("serial", size, serial);
+
+	// Now format the same records on a growing number of threads
+	int32 hardware = std::max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+
+	for (int32 threads = 1; threads <= hardware; threads *= 2)
+	{
+		DtoThreadPool pool(threads);
+		DtoJsonLinesWriter writer(pool);
+		double seconds = measure([&]() { output.clear(); writer.write(&records[0], count, output); });
+
+		char label[64];
+		snprintf(label, sizeof(label), "%d threads (%.2fx)", threads, serial / seconds);
+		report(label, size, seconds);
+	}
+}
+
+BENCHMARK(JsonArrayReader)
+{
+	// Turn a JSON Lines log into a single top-level array
+	std::string input = "[" + generateJsonLines(500000);
+	std::replace(input.begin(), input.end(), '\n', ',');
+	input[input.size() - 1] = ']';
+
+	const byte* data = reinterpret_cast<const byte*>(input.c_str());
+	int64 size       = static_cast<int64>(input.size());
+
+	// A single-threaded baseline
+	std::vector<byte> output(dtoJsonBinaryBound(static_cast<int32>(size)));
+	double serial = measure([&]()
+	{
+		dtoConvert<JsonDtoReader, BinaryDtoWriter>(data, static_cast<int32>(size), &output[0], static_cast<int32>(output.size()));
+	});
+	report("serial", size, serial);
+
+	// Now parse the same input on a growing number of threads
+	int32 hardware = std::max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+
+	for (int32 threads = 1; threads <= hardware; threads *= 2)
+	{
+		DtoThreadPool pool(threads);
+		DtoJsonArrayReader reader(pool);
+		double seconds = measure([&]() { reader.parse(data, size); });
+
+		char label[64];
+		snprintf(label, sizeof(label), "%d threads (%.2fx)", threads, serial / seconds);
+		report(label, size, seconds);
+	}
+}
@@ -0,0 +1,186 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+#include <thread>
+
+BENCHMARK(StoreOpen)
+{
+	cstring path = "dto_store_benchmark.bson";
+	int32 count = 200000;
+	std::string json;
+	std::vector<byte> buffer(256);
+
+	remove(path);
+	remove("dto_store_benchmark.bson.idx");
+
+	{
+		DtoStore store;
+		store.open(path);
+
+		for (int32 i = 0; i < count; i++)
+		{
+			std::string line = "{\"id\": " + std::to_string(i) + ", \"name\": \"sensor\", \"value\": 21.5, \"tags\": [1, 2, 3]}";
+			store.append(dtoParse<JsonDtoReader>(line.c_str(), &buffer[0], static_cast<int32>(buffer.size())));
+			json += line + "\n";
+		}
+	}
+
+	std::vector<byte> output(json.size() * 2);
+	int64 checksum = 0;
+
+	// Parse all records from JSON text
+	double parsed = measure([&]()
+	{
+		cstring line = json.c_str();
+		int32 offset = 0;
+
+		for (int32 i = 0; i < count; i++)
+		{
+			cstring end = strchr(line, '\n');
+			std::string text(line, end);
+			DtoType dto = dtoParse<JsonDtoReader>(text.c_str(), &output[offset], static_cast<int32>(output.size()) - offset);
+			offset += dto.length();
+			line = end + 1;
+		}
+
+		checksum += offset;
+	});
+	report("JsonDtoReader", json.size(), parsed);
+
+	// Reopen a store and access the last record
+	double opened = measure([&]()
+	{
+		DtoStore store;
+		store.open(path);
+		checksum += store.record(store.count() - 1).find("id").toInt32();
+	});
+
+	char label[64];
+	snprintf(label, sizeof(label), "DtoStore::open (%.2fx)", parsed / opened);
+	report(label, json.size(), opened);
+
+	printf("  checksum %lld\n", checksum);
+
+	remove(path);
+	remove("dto_store_benchmark.bson.idx");
+}
+
+BENCHMARK(RecordLog)
+{
+	cstring path = "dto_record_log_benchmark.log";
+	std::vector<byte> record(256);
+	DtoEncoder(&record[0], static_cast<int32>(record.size())) << "id" << 1 << "name" << "sensor" << "value" << 21.5 << DtoEncoder::end;
+	DtoType dto(&record[0], static_cast<int32>(record.size()));
+	int64 checksum = 0;
+
+	// Checksum a large buffer
+	std::vector<byte> block(64 << 20, 0x5A);
+	double crc = measure([&]()
+	{
+		checksum += dtoCrc32c(&block[0], block.size());
+	});
+	report("dtoCrc32c", block.size(), crc);
+
+	// Commit each record with it's own sync from a single thread
+	int32 count = 2000;
+	remove(path);
+
+	double single = measure([&]()
+	{
+		DtoRecordLog log;
+		log.open(path);
+
+		for (int32 i = 0; i < count; i++)
+		{
+			log.append(dto);
+		}
+	}, 1);
+	report("DtoRecordLog::append, 1 thread", static_cast<int64>(count) * dto.length(), single);
+
+	// Commit the same number of records from many threads that share syncs
+	remove(path);
+
+	double grouped = measure([&]()
+	{
+		DtoRecordLog log;
+		log.open(path);
+
+		std::vector<std::thread> threads;
+
+		for (int32 i = 0; i < 16; i++)
+		{
+			threads.push_back(std::thread([&]()
+			{
+				for (int32 j = 0; j < count / 16; j++)
+				{
+					log.append(dto);
+				}
+			}));
+		}
+
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i].join();
+		}
+	}, 1);
+
+	char label[64];
+	snprintf(label, sizeof(label), "DtoRecordLog::append, 16 threads (%.2fx)", single / grouped);
+	report(label, static_cast<int64>(count) * dto.length(), grouped);
+
+	// Recover a log by reading all records
+	{
+		DtoRecordLog log;
+		log.open(path);
+
+		for (int32 i = 0; i < 200000; i++)
+		{
+			log.write(dto);
+		}
+	}
+
+	int64 size = 0;
+
+	double recovered = measure([&]()
+	{
+		DtoRecordLogReader reader;
+		reader.open(path);
+
+		DtoType next;
+
+		while (reader.next(next))
+		{
+		}
+
+		size = reader.offset();
+	});
+	report("DtoRecordLogReader::next", size, recovered);
+
+	printf("  checksum %lld\n", checksum);
+	remove(path);
+}
\ No newline at end of file
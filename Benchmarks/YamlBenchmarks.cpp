@@ -0,0 +1,78 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Benchmarks.h"
+
+//! Generates a Yaml config file of approximately specified size made of block mappings, sequences and flow collections.
+static std::string generateConfig(int32 size)
+{
+	std::string result = "# generated service configuration\nversion: 3\nservices:\n";
+	char service[512];
+
+	for (int32 i = 0; result.size() < static_cast<size_t>(size); i++)
+	{
+		snprintf(service, sizeof(service),
+			"  - name: service-%d\n"
+			"    image: \"registry.example.com/team/service-%d:1.%d\"\n"
+			"    replicas: %d\n"
+			"    enabled: %s   # toggled by a deploy script\n"
+			"    ports: [%d, %d]\n"
+			"    limits: {cpu: 0.%d, memory: '%dMi'}\n"
+			"    env:\n"
+			"      LOG_LEVEL: info\n"
+			"      ENDPOINT: http://service-%d.internal:8080/api\n"
+			"    hosts:\n"
+			"      - a%d.example.com\n"
+			"      - b%d.example.com\n"
+			, i, i, i % 10, i % 5 + 1, i % 2 ? "true" : "false", 8000 + i % 1000, 9000 + i % 1000, i % 10, 128 * (i % 8 + 1), i, i, i);
+		result += service;
+	}
+
+	return result;
+}
+
+BENCHMARK(YamlReader)
+{
+	std::string config = generateConfig(4 * 1024 * 1024);
+	std::vector<byte> binary(dtoJsonBinaryBound(static_cast<int32>(config.size())));
+
+	double seconds = measure([&]()
+	{
+		dtoConvert<YamlDtoReader, BinaryDtoWriter>(reinterpret_cast<const byte*>(config.c_str()), static_cast<int32>(config.size()), &binary[0], static_cast<int32>(binary.size()));
+	});
+	report("block config", static_cast<int64>(config.size()), seconds);
+
+	// The same amount of events read by a JSON reader as a baseline
+	std::vector<byte> json(binary.size());
+	dtoConvert<YamlDtoReader, JsonDtoWriter>(reinterpret_cast<const byte*>(config.c_str()), static_cast<int32>(config.size()), &json[0], static_cast<int32>(json.size()));
+	int32 length = static_cast<int32>(strlen(reinterpret_cast<cstring>(&json[0])));
+
+	seconds = measure([&]()
+	{
+		dtoConvert<JsonDtoReader, BinaryDtoWriter>(&json[0], length, &binary[0], static_cast<int32>(binary.size()));
+	});
+	report("same data as JSON", static_cast<int64>(length), seconds);
+}
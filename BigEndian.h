@@ -0,0 +1,90 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_BigEndian_H__
+#define __Dto_BigEndian_H__
+
+#include <stdint.h>
+
+DTO_BEGIN
+
+	// Helpers shared by MessagePack and CBOR encoders, both formats store integers in a big-endian order.
+	// This header is internal to a library and is not included by Dto.h.
+
+	//! Stores a lower bytes of an integer in a big-endian order.
+	inline void dtoStoreBigEndian(byte* output, uint64 value, int32 size)
+	{
+		for (int32 i = size - 1; i >= 0; i--)
+		{
+			output[i] = static_cast<byte>(value);
+			value >>= 8;
+		}
+	}
+
+	//! Loads a big-endian unsigned integer of a specified size.
+	inline uint64 dtoLoadBigEndian(const byte* input, int32 size)
+	{
+		uint64 value = 0;
+
+		for (int32 i = 0; i < size; i++)
+		{
+			value = (value << 8) | input[i];
+		}
+
+		return value;
+	}
+
+	//! Stores an integer as a 32-bit value if it fits, otherwise as a 64-bit one.
+	inline void dtoSetInteger(DtoValue& value, int64 number)
+	{
+		if (number >= INT32_MIN && number <= INT32_MAX)
+		{
+			value.type  = DtoInt32;
+			value.int32 = static_cast<int32>(number);
+		}
+		else
+		{
+			value.type  = DtoInt64;
+			value.int64 = number;
+		}
+	}
+
+	//! Converts seconds since the epoch and a non-negative number of extra milliseconds to milliseconds, returns false if a result does not fit into 64 bits.
+	inline bool dtoEpochMilliseconds(int64 seconds, int64 milliseconds, int64& result)
+	{
+		// A range is checked before scaling, so a signed overflow never happens
+		if (seconds > (INT64_MAX - milliseconds) / 1000 || seconds < INT64_MIN / 1000)
+		{
+			return false;
+		}
+
+		result = seconds * 1000 + milliseconds;
+		return true;
+	}
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_BigEndian_H__	*/
\ No newline at end of file
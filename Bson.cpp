@@ -35,8 +35,9 @@ SOFTWARE.
 
 DTO_BEGIN
 
-BinaryDtoWriter::BinaryDtoWriter(byte* output, int32 capacity)
+BinaryDtoWriter::BinaryDtoWriter(byte* output, int32 capacity, const DtoKeyDictionary* dictionary)
 	: m_output(output, capacity)
+	, m_dictionary(dictionary)
 {
 
 }
@@ -55,15 +56,15 @@ int32 BinaryDtoWriter::consume(const DtoEvent& event)
 		break;
 
 	case DtoSequenceStart:
-		start(event.key, DtoSequence);
+		start(entryKey(event.key), DtoSequence);
 		break;
 
 	case DtoKeyValueStart:
-		start(event.key, DtoKeyValue);
+		start(entryKey(event.key), DtoKeyValue);
 		break;
 
 	case DtoEntry:
-		encode(m_output, event.key, event.data);
+		encode(m_output, entryKey(event.key), event.data);
 		break;
 
 	case DtoKeyValueEnd:
@@ -102,6 +103,22 @@ void BinaryDtoWriter::finish()
 	m_stack.pop();
 }
 
+// ** BinaryDtoWriter::entryKey
+DtoStringView BinaryDtoWriter::entryKey(const DtoStringView& key)
+{
+	int32 id = m_dictionary ? m_dictionary->find(key) : -1;
+
+	if (id < 0)
+	{
+		return key;
+	}
+
+	DtoStringView result;
+	result.value  = reinterpret_cast<cstring>(m_key);
+	result.length = DtoKeyDictionary::encode(id, m_key);
+	return result;
+}
+
 // ** BinaryDtoWriter::encode
 int32 BinaryDtoWriter::encode(DtoByteArrayOutput& output, const DtoStringView& key, const DtoValue& value)
 {
@@ -115,7 +132,7 @@ int32 BinaryDtoWriter::encode(DtoByteArrayOutput& output, const DtoStringView& k
 	switch (value.type)
 	{
 	case DtoString:
-		output << value.string.length + 1 << value.string.value << DtoEnd;
+		output << value.string.length + 1 << value.string << DtoEnd;
 		break;
 
 	case DtoBool:
@@ -127,6 +144,7 @@ int32 BinaryDtoWriter::encode(DtoByteArrayOutput& output, const DtoStringView& k
 		break;
 
 	case DtoInt64:
+	case DtoDate:
 		output << value.int64;
 		break;
 
@@ -139,7 +157,12 @@ int32 BinaryDtoWriter::encode(DtoByteArrayOutput& output, const DtoStringView& k
 		break;
 
 	case DtoBinary:
-		output << value.binary.length << value.binary.subtype << DtoByteArrayOutput::size(value.binary.length) << value.binary.data;
+		output << value.binary.length << value.binary.subtype;
+
+		if (value.binary.length)
+		{
+			output << DtoByteArrayOutput::size(value.binary.length) << value.binary.data;
+		}
 		break;
 
 	case DtoUUID:
@@ -150,6 +173,9 @@ int32 BinaryDtoWriter::encode(DtoByteArrayOutput& output, const DtoStringView& k
 		output << value.regex.value << DtoEnd << value.regex.options << DtoEnd;
 		break;
 
+	case DtoNull:
+		break;
+
 	default:
 		assert(0);
 	}
@@ -331,6 +357,18 @@ DtoEncoder& DtoEncoder::operator << (const DtoUuid& value)
 	return *this;
 }
 
+// ** DtoEncoder::operator <<
+DtoEncoder& DtoEncoder::operator << (const DtoPackedArray& value)
+{
+	assert(!complete());
+	DtoBinaryBlob blob;
+	blob.data    = static_cast<const byte*>(value.data);
+	blob.subtype = static_cast<byte>(value.type);
+	blob.length  = value.count * value.elementSize();
+	BinaryDtoWriter::encode(m_output, entryKey(), constructValue(blob));
+	return *this;
+}
+
 // ** DtoEncoder::operator <<
 DtoEncoder& DtoEncoder::operator << (const DtoEncoder& value)
 {
@@ -430,8 +468,9 @@ bool DtoEncoder::complete() const
 // --------------------------------------------------------- BinaryDtoReader --------------------------------------------------------- //
 
 // ** BinaryDtoReader::BinaryDtoReader
-BinaryDtoReader::BinaryDtoReader(const byte* input, int32 length)
+BinaryDtoReader::BinaryDtoReader(const byte* input, int32 length, const DtoKeyDictionary* dictionary)
 	: m_input(input, length)
+	, m_dictionary(dictionary)
 {
 
 }
@@ -443,7 +482,7 @@ int32 BinaryDtoReader::consumed() const
 }
 
 // ** BinaryDtoReader::decode
-int32 BinaryDtoReader::decode(DtoByteBufferInput& input, DtoStringView& key, DtoValue& value)
+int32 BinaryDtoReader::decode(DtoByteBufferInput& input, DtoStringView& key, DtoValue& value, const DtoKeyDictionary* dictionary)
 {
 	// Save current amount of consumed bytes
 	int32 count = input.consumed();
@@ -461,17 +500,28 @@ int32 BinaryDtoReader::decode(DtoByteBufferInput& input, DtoStringView& key, Dto
 	input >> key.value >> DtoByteBufferInput::skip(1);
 	key.length = static_cast<int32>(strlen(key.value));
 
+	// Replace an encoded key with a dictionary one, keys with unknown ids are left as is
+	if (dictionary)
+	{
+		dictionary->resolve(key);
+	}
+
 	// Read value data according to it's type
 	switch (value.type)
 	{
 	case DtoString:
-		input >> value.string.length >> value.string.value >> DtoByteBufferInput::skip(1);
+		input >> value.string.length;
+		value.string.value = reinterpret_cast<cstring>(input.advance(value.string.length));
 		value.string.length--; // Decrease the string length as it counts the zero terminator.
 		break;
 
 	case DtoBinary:
 		input >> value.binary.length >> value.binary.subtype >> value.binary.data;
-		input >> DtoByteBufferInput::skip(value.binary.length);
+
+		if (value.binary.length)
+		{
+			input >> DtoByteBufferInput::skip(value.binary.length);
+		}
 		break;
 
 	case DtoBool:
@@ -536,7 +586,7 @@ DtoEvent BinaryDtoReader::next()
 	else
 	{
 		// Decode next entry from an input stream.
-		decode(m_input, event.key, event.data);
+		decode(m_input, event.key, event.data, m_dictionary);
 
 		// Set an event type as DtoEntry by default
 		event.type = DtoEntry;
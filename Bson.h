@@ -71,6 +71,9 @@ DTO_BEGIN
 		//! Appends a UUID to an output buffer
 		DtoEncoder&			operator << (const DtoUuid& value);
 
+		//! Appends a packed homogeneous array to an output buffer as a binary blob.
+		DtoEncoder&			operator << (const DtoPackedArray& value);
+
 		//! Appends a nested key-value node to an output buffer.
 		DtoEncoder&			operator << (const DtoEncoder& value);
 
@@ -118,8 +121,8 @@ DTO_BEGIN
 	{
 	public:
 
-							//! Constructs a BSON data writer.
-							BinaryDtoWriter(byte* output, int32 capacity);
+							//! Constructs a BSON data writer, keys found in an optional dictionary are written as ids.
+							BinaryDtoWriter(byte* output, int32 capacity, const DtoKeyDictionary* dictionary = NULL);
 
 		//! Consumes an event an writes next entry to an output stream.
 		virtual int32		consume(const DtoEvent& event);
@@ -135,10 +138,15 @@ DTO_BEGIN
 		//! Finalizes a topmost DTO on stack by writing a zero-terminator and calculating the final DTO length.
 		void				finish();
 
+		//! Returns an encoded key if it is found in a dictionary, otherwise returns a key as is.
+		DtoStringView		entryKey(const DtoStringView& key);
+
 	private:
 
-		DtoByteArrayOutput	m_output;	//!< An output data buffer.
-		std::stack<byte*>	m_stack;	//!< An object stack to track nesting.
+		DtoByteArrayOutput		m_output;		//!< An output data buffer.
+		std::stack<byte*>		m_stack;		//!< An object stack to track nesting.
+		const DtoKeyDictionary*	m_dictionary;	//!< A key dictionary.
+		byte					m_key[DtoKeyDictionary::MaxEncodedLength];	//!< A last encoded key.
 	};
 
 	//! A BSON compatible DTO reader.
@@ -146,7 +154,8 @@ DTO_BEGIN
 	{
 	public:
 
-							BinaryDtoReader(const byte* input, int32 length);
+							//! Constructs a BSON data reader, encoded keys are resolved through an optional dictionary.
+							BinaryDtoReader(const byte* input, int32 length, const DtoKeyDictionary* dictionary = NULL);
 
 		//! Decodes next event from an input stream.
 		virtual DtoEvent	next();
@@ -155,7 +164,7 @@ DTO_BEGIN
 		virtual int32		consumed() const;
 
 		//! Decodes a single entry from an input stream and returns a total number of consumed bytes.
-		static int32		decode(DtoByteBufferInput& input, DtoStringView& key, DtoValue& value);
+		static int32		decode(DtoByteBufferInput& input, DtoStringView& key, DtoValue& value, const DtoKeyDictionary* dictionary = NULL);
 
 	private:
 
@@ -178,8 +187,9 @@ DTO_BEGIN
 								: length(length), type(type) {}
 		};
 
-		DtoByteBufferInput	m_input;	//!< An input byte buffer stream.
-		std::stack<Nested>	m_stack;	//!< An object stack to track nesting.
+		DtoByteBufferInput		m_input;		//!< An input byte buffer stream.
+		std::stack<Nested>		m_stack;		//!< An object stack to track nesting.
+		const DtoKeyDictionary*	m_dictionary;	//!< A key dictionary.
 	};
 
 DTO_END
@@ -33,6 +33,16 @@ SOFTWARE.
 #include <cctype>
 #include <algorithm>
 
+#if defined(DTO_AVX2)
+	#include <immintrin.h>
+#elif defined(DTO_SSE2)
+	#include <emmintrin.h>
+#endif	//	#if defined(DTO_AVX2)
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif	//	#ifdef _MSC_VER
+
 #ifdef _WINDOWS
 	#define snprintf _snprintf_s
 #endif	//	#ifdef _WINDOWS
@@ -41,6 +51,106 @@ DTO_BEGIN
 
 extern DtoErrorHandler g_errorHandler;
 
+//! Returns an index of the least significant bit set in a non-zero mask.
+static int32 countTrailingZeros(uint32 value)
+{
+	assert(value != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return static_cast<int32>(index);
+#else
+	return __builtin_ctz(value);
+#endif	//	#ifdef _MSC_VER
+}
+
+//! Returns a total number of bits set in a mask.
+static int32 countBits(uint32 value)
+{
+#ifdef _MSC_VER
+	return static_cast<int32>(__popcnt(value));
+#else
+	return __builtin_popcount(value);
+#endif	//	#ifdef _MSC_VER
+}
+
+//! Returns an index of the most significant bit set in a non-zero mask.
+static int32 highestBit(uint32 value)
+{
+	assert(value != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return static_cast<int32>(index);
+#else
+	return 31 - __builtin_clz(value);
+#endif	//	#ifdef _MSC_VER
+}
+
+//! Returns true if a specified character can not appear inside a quoted string as is.
+static bool isEscapedCharacter(byte value, bool asciiOnly)
+{
+	return value < 0x20 || value == '"' || value == '\\' || (asciiOnly && value >= 0x80);
+}
+
+//! Returns a pointer to the first character in range that should be escaped or an end of range if there are no such characters.
+static const byte* findEscapedCharacter(const byte* input, const byte* end, bool asciiOnly)
+{
+#if defined(DTO_AVX2)
+	const __m256i quote32     = _mm256_set1_epi8('"');
+	const __m256i backslash32 = _mm256_set1_epi8('\\');
+	const __m256i control32   = _mm256_set1_epi8(0x1F);
+
+	while (end - input >= 32)
+	{
+		__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+		__m256i mask  = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32), _mm256_cmpeq_epi8(chunk, backslash32));
+		mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control32), control32));
+
+		// A sign bit of each byte is set for all non-ASCII characters
+		uint32 bits = static_cast<uint32>(_mm256_movemask_epi8(mask)) | (asciiOnly ? static_cast<uint32>(_mm256_movemask_epi8(chunk)) : 0);
+
+		if (bits)
+		{
+			return input + countTrailingZeros(bits);
+		}
+
+		input += 32;
+	}
+#endif	//	#if defined(DTO_AVX2)
+
+#if defined(DTO_SSE2)
+	const __m128i quote     = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i control   = _mm_set1_epi8(0x1F);
+
+	while (end - input >= 16)
+	{
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+		__m128i mask  = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+		mask = _mm_or_si128(mask, _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+
+		// A sign bit of each byte is set for all non-ASCII characters
+		uint32 bits = static_cast<uint32>(_mm_movemask_epi8(mask)) | (asciiOnly ? static_cast<uint32>(_mm_movemask_epi8(chunk)) : 0);
+
+		if (bits)
+		{
+			return input + countTrailingZeros(bits);
+		}
+
+		input += 16;
+	}
+#endif	//	#if defined(DTO_SSE2)
+
+	// Process the remaining characters one by one
+	while (input < end && !isEscapedCharacter(*input, asciiOnly))
+	{
+		input++;
+	}
+
+	return input;
+}
+
 // ------------------------------------------------------- DtoByteArrayOutput ------------------------------------------------------- //
 
 // ** DtoByteArrayOutput::DtoByteArrayOutput
@@ -141,6 +251,22 @@ DtoByteArrayOutput& DtoByteArrayOutput::operator << (const size& size)
 	return *this;
 }
 
+// ** DtoByteArrayOutput::operator <<
+DtoByteArrayOutput& DtoByteArrayOutput::operator << (const varint& value)
+{
+	uint64 remaining = value.value;
+
+	while (remaining >= 0x80)
+	{
+		*advance(1) = static_cast<byte>(remaining | 0x80);
+		remaining >>= 7;
+	}
+
+	*advance(1) = static_cast<byte>(remaining);
+
+	return *this;
+}
+
 // ** DtoByteArrayOutput::operator <<
 DtoByteArrayOutput& DtoByteArrayOutput::operator << (const byte* bytes)
 {
@@ -202,12 +328,21 @@ int32 DtoByteArrayOutput::available() const
 	return capacity() - length();
 }
 
+// ** DtoByteArrayOutput::rewind
+void DtoByteArrayOutput::rewind(int32 count)
+{
+	assert(count >= 0 && count <= length());
+	m_ptr -= count;
+}
+
 // --------------------------------------------------------- DtoTextOutput --------------------------------------------------------- //
 
 // ** DtoTextOutput::DtoTextOutput
 DtoTextOutput::DtoTextOutput(byte* output, int32 capacity)
 	: DtoByteArrayOutput(output, capacity)
 	, m_isQuotedString(false)
+	, m_isAsciiOnly(false)
+	, m_isLuaEscapes(false)
 {
 }
 
@@ -278,15 +413,12 @@ DtoTextOutput& DtoTextOutput::operator << (cstring value)
 
 	if (m_isQuotedString)
 	{
-		memcpy(advance(1), "\"", 1);
+		writeQuoted(value, length);
+		m_isQuotedString = false;
 	}
-
-	memcpy(advance(length), value, length);
-
-	if (m_isQuotedString)
+	else
 	{
-		memcpy(advance(1), "\"", 1);
-		m_isQuotedString = false;
+		memcpy(advance(length), value, length);
 	}
 
 	return *this;
@@ -297,15 +429,12 @@ DtoTextOutput& DtoTextOutput::operator << (const DtoStringView& value)
 {
 	if (m_isQuotedString)
 	{
-		memcpy(advance(1), "\"", 1);
+		writeQuoted(value.value, value.length);
+		m_isQuotedString = false;
 	}
-
-	memcpy(advance(value.length), value.value, value.length);
-
-	if (m_isQuotedString)
+	else
 	{
-		memcpy(advance(1), "\"", 1);
-		m_isQuotedString = false;
+		memcpy(advance(value.length), value.value, value.length);
 	}
 
 	return *this;
@@ -345,6 +474,10 @@ DtoTextOutput& DtoTextOutput::operator << (const DtoValue& value)
 		operator << ("<binary>");
 		break;
 
+	case DtoNull:
+		memcpy(advance(4), "null", 4);
+		break;
+
 	default:
 		assert(0);
 	}
@@ -373,18 +506,177 @@ DtoTextOutput& DtoTextOutput::operator << (marker value)
 	return *this;
 }
 
-// ** DtoTextOutput::rewind
-void DtoTextOutput::rewind(int32 count)
-{
-	m_ptr -= count;
-}
-
 // ** DtoTextOutput::text
 cstring DtoTextOutput::text() const
 {
 	return reinterpret_cast<cstring>(ptr());
 }
 
+// ** DtoTextOutput::setAsciiOnly
+void DtoTextOutput::setAsciiOnly(bool value)
+{
+	m_isAsciiOnly = value;
+}
+
+// ** DtoTextOutput::setLuaEscapes
+void DtoTextOutput::setLuaEscapes(bool value)
+{
+	m_isLuaEscapes = value;
+}
+
+// ** DtoTextOutput::writeQuoted
+void DtoTextOutput::writeQuoted(cstring value, int32 length)
+{
+	const byte* input = reinterpret_cast<const byte*>(value);
+	const byte* end   = input + length;
+
+	*advance(1) = '"';
+
+	while (input < end)
+	{
+		// Copy a whole run of characters that do not need escaping
+		const byte* escaped = findEscapedCharacter(input, end, m_isAsciiOnly);
+		int32		count   = static_cast<int32>(escaped - input);
+		memcpy(advance(count), input, count);
+
+		// Now output an escape sequence for a character that stopped the run
+		input = escaped;
+
+		if (input < end)
+		{
+			input += writeEscaped(input, end);
+		}
+	}
+
+	*advance(1) = '"';
+}
+
+// ** DtoTextOutput::writeEscaped
+int32 DtoTextOutput::writeEscaped(const byte* input, const byte* end)
+{
+	static const char kHex[] = "0123456789abcdef";
+
+	byte   c         = *input;
+	uint32 codepoint = c;
+	int32  count     = 1;
+
+	// Most common control characters have a short escape sequence
+	char shorthand = 0;
+
+	switch (c)
+	{
+	case '"':
+	case '\\':
+		shorthand = c;
+		break;
+	case '\b':
+		shorthand = 'b';
+		break;
+	case '\f':
+		shorthand = 'f';
+		break;
+	case '\n':
+		shorthand = 'n';
+		break;
+	case '\r':
+		shorthand = 'r';
+		break;
+	case '\t':
+		shorthand = 't';
+		break;
+	}
+
+	if (shorthand)
+	{
+		char* sequence = reinterpret_cast<char*>(advance(2));
+		sequence[0] = '\\';
+		sequence[1] = shorthand;
+		return 1;
+	}
+
+	// Lua has no unicode escapes in older versions, so any other byte is written as a three-digit decimal escape
+	if (m_isLuaEscapes)
+	{
+		char* sequence = reinterpret_cast<char*>(advance(4));
+		sequence[0] = '\\';
+		sequence[1] = static_cast<char>('0' + c / 100);
+		sequence[2] = static_cast<char>('0' + c / 10 % 10);
+		sequence[3] = static_cast<char>('0' + c % 10);
+		return 1;
+	}
+
+	// Decode a multibyte UTF-8 sequence to a code point
+	if (c >= 0x80)
+	{
+		if ((c & 0xE0) == 0xC0)
+		{
+			count     = 2;
+			codepoint = c & 0x1F;
+		}
+		else if ((c & 0xF0) == 0xE0)
+		{
+			count     = 3;
+			codepoint = c & 0x0F;
+		}
+		else if ((c & 0xF8) == 0xF0)
+		{
+			count     = 4;
+			codepoint = c & 0x07;
+		}
+		else
+		{
+			count = 0;
+		}
+
+		if (count > end - input)
+		{
+			count = 0;
+		}
+
+		for (int32 i = 1; i < count; i++)
+		{
+			if ((input[i] & 0xC0) != 0x80)
+			{
+				count = 0;
+				break;
+			}
+			codepoint = (codepoint << 6) | (input[i] & 0x3F);
+		}
+
+		// Replace malformed sequences with a replacement character
+		if (count == 0)
+		{
+			count     = 1;
+			codepoint = 0xFFFD;
+		}
+	}
+
+	// Code points outside of a basic multilingual plane are written as a surrogate pair
+	uint32 units[2] = { codepoint, 0 };
+	int32  total    = 1;
+
+	if (codepoint >= 0x10000)
+	{
+		codepoint -= 0x10000;
+		units[0] = 0xD800 + (codepoint >> 10);
+		units[1] = 0xDC00 + (codepoint & 0x3FF);
+		total    = 2;
+	}
+
+	for (int32 i = 0; i < total; i++)
+	{
+		char* sequence = reinterpret_cast<char*>(advance(6));
+		sequence[0] = '\\';
+		sequence[1] = 'u';
+		sequence[2] = kHex[(units[i] >> 12) & 0xF];
+		sequence[3] = kHex[(units[i] >>  8) & 0xF];
+		sequence[4] = kHex[(units[i] >>  4) & 0xF];
+		sequence[5] = kHex[(units[i]      ) & 0xF];
+	}
+
+	return count;
+}
+
 // ------------------------------------------------------- DtoByteArrayInput ------------------------------------------------------- //
 
 // ** DtoByteBufferInput::DtoByteBufferInput
@@ -483,6 +775,25 @@ DtoByteBufferInput& DtoByteBufferInput::operator >> (const skip& count)
 	return *this;
 }
 
+// ** DtoByteBufferInput::operator >>
+DtoByteBufferInput& DtoByteBufferInput::operator >> (varint& value)
+{
+	value.value = 0;
+
+	for (int32 shift = 0; shift < 64 && available(); shift += 7)
+	{
+		byte group = *m_ptr++;
+		value.value |= static_cast<uint64>(group & 0x7F) << shift;
+
+		if ((group & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	return *this;
+}
+
 // ** DtoByteBufferInput::advance
 const byte* DtoByteBufferInput::advance(int32 count)
 {
@@ -525,8 +836,215 @@ void DtoByteBufferInput::setPtr(const byte* value)
 	m_ptr = value;
 }
 
+// ----------------------------------------------------------- DtoArena ---------------------------------------------------------- //
+
+// ** DtoArena::DtoArena
+DtoArena::DtoArena(int32 blockSize)
+	: m_current(0)
+	, m_blockSize(blockSize)
+{
+	assert(blockSize > 0);
+}
+
+// ** DtoArena::~DtoArena
+DtoArena::~DtoArena()
+{
+	for (size_t i = 0; i < m_blocks.size(); i++)
+	{
+		delete[] m_blocks[i].data;
+	}
+}
+
+// ** DtoArena::reserve
+byte* DtoArena::reserve(int32 count)
+{
+	assert(count >= 0);
+
+	// Look for a next block that has enough free space
+	while (m_current < static_cast<int32>(m_blocks.size()))
+	{
+		Block& block = m_blocks[m_current];
+
+		if (block.capacity - block.length >= count)
+		{
+			return block.data + block.length;
+		}
+
+		m_current++;
+	}
+
+	// Allocate a new block
+	Block block;
+	block.capacity = std::max(count, m_blockSize);
+	block.length   = 0;
+	block.data     = new byte[block.capacity];
+	m_blocks.push_back(block);
+
+	return block.data;
+}
+
+// ** DtoArena::commit
+void DtoArena::commit(int32 count)
+{
+	Block& block = m_blocks[m_current];
+	assert(block.length + count <= block.capacity);
+	block.length += count;
+}
+
+// ** DtoArena::length
+int64 DtoArena::length() const
+{
+	int64 result = 0;
+
+	for (size_t i = 0; i < m_blocks.size(); i++)
+	{
+		result += m_blocks[i].length;
+	}
+
+	return result;
+}
+
+// ** DtoArena::clear
+void DtoArena::clear()
+{
+	for (size_t i = 0; i < m_blocks.size(); i++)
+	{
+		m_blocks[i].length = 0;
+	}
+
+	m_current = 0;
+}
+
 // ------------------------------------------------------- DtoTokenInput ------------------------------------------------------- //
 
+//! Character classes used by a tokenizer, unlike ctype functions they do not depend on a current locale.
+enum CharacterClass
+{
+	  ClassSpace		= 1 << 0	//!< A space or a tab.
+	, ClassNewLine		= 1 << 1	//!< A line feed.
+	, ClassDigit		= 1 << 2	//!< A decimal digit.
+	, ClassAlpha		= 1 << 3	//!< A latin letter that starts an identifier.
+	, ClassIdentifier	= 1 << 4	//!< A symbol that continues an identifier.
+};
+
+#define S	ClassSpace
+#define L	ClassNewLine
+#define D	ClassDigit | ClassIdentifier
+#define A	ClassAlpha | ClassIdentifier
+#define I	ClassIdentifier
+
+//! A character class table.
+static const byte s_characterClasses[256] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, S, L, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,
+	0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, I,
+	0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+#undef S
+#undef L
+#undef D
+#undef A
+#undef I
+
+//! Returns true if a character belongs to any of specified classes.
+static bool isCharacterOf(byte value, int32 classes)
+{
+	return (s_characterClasses[value] & classes) != 0;
+}
+
+//! Skips spaces, tabs and line breaks, returns a pointer to the first other character.
+static const byte* skipWhitespace(const byte* input, const byte* end)
+{
+	for (;;)
+	{
+#if defined(DTO_SSE2)
+		const __m128i space   = _mm_set1_epi8(' ');
+		const __m128i tab     = _mm_set1_epi8('\t');
+		const __m128i newLine = _mm_set1_epi8('\n');
+
+		while (end - input >= 16)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+			__m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)), _mm_cmpeq_epi8(chunk, newLine));
+			uint32  other = ~static_cast<uint32>(_mm_movemask_epi8(blank)) & 0xFFFF;
+
+			if (other)
+			{
+				input += countTrailingZeros(other);
+				break;
+			}
+
+			input += 16;
+		}
+#endif	//	#if defined(DTO_SSE2)
+
+		// Process the remaining characters one by one
+		while (input < end && isCharacterOf(*input, ClassSpace | ClassNewLine))
+		{
+			input++;
+		}
+
+		// A carriage return is only a part of a line break when it is followed by a line feed
+		if (end - input < 2 || input[0] != '\r' || input[1] != '\n')
+		{
+			return input;
+		}
+
+		input += 2;
+	}
+}
+
+//! Counts line feeds in range and outputs a pointer to a character that follows the last one (or a beginning of range if there are no line feeds).
+static int32 countLineFeeds(const byte* input, const byte* end, const byte*& lineStart)
+{
+	int32 lines = 0;
+	lineStart = input;
+
+#if defined(DTO_SSE2)
+	const __m128i newLine = _mm_set1_epi8('\n');
+
+	while (end - input >= 16)
+	{
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+		uint32  feeds = static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newLine)));
+
+		if (feeds)
+		{
+			lines    += countBits(feeds);
+			lineStart = input + highestBit(feeds) + 1;
+		}
+
+		input += 16;
+	}
+#endif	//	#if defined(DTO_SSE2)
+
+	// Process the remaining characters one by one
+	for (; input < end; input++)
+	{
+		if (*input == '\n')
+		{
+			lines++;
+			lineStart = input + 1;
+		}
+	}
+
+	return lines;
+}
+
 // ** DtoTokenInput::s_tokens
 cstring DtoTokenInput::s_tokens[TotalTokens] =
 {
@@ -548,26 +1066,33 @@ cstring DtoTokenInput::s_tokens[TotalTokens] =
 	, "bracket open"
 	, "bracket close"
 	, "comma"
+	, "semicolon"
+	, "equals"
+	, "scalar"
 };
 
 // ** DtoTokenInput::DtoTokenInput
 DtoTokenInput::DtoTokenInput(const byte* input, int32 capacity)
 	: DtoByteBufferInput(input, capacity)
-	, m_line(1)
-	, m_column(1)
+	, m_prev(Nonterminal)
+	, m_singleQuotedEscapes(false)
+	, m_hexNumbers(false)
+	, m_unescapedIndex(0)
 {
-	memset(&m_prev, 0, sizeof(m_prev));
 	memset(&m_token, 0, sizeof(m_token));
+	m_token.input = m_input;
 }
 
 // ** DtoTokenInput::DtoTokenInput
 DtoTokenInput::DtoTokenInput(cstring input)
 	: DtoByteBufferInput(reinterpret_cast<const byte*>(input), static_cast<int32>(strlen(input) + 1))
-	, m_line(1)
-	, m_column(1)
+	, m_prev(Nonterminal)
+	, m_singleQuotedEscapes(false)
+	, m_hexNumbers(false)
+	, m_unescapedIndex(0)
 {
-	memset(&m_prev, 0, sizeof(m_prev));
 	memset(&m_token, 0, sizeof(m_token));
+	m_token.input = m_input;
 }
 
 // ** DtoTokenInput::consumed
@@ -601,7 +1126,7 @@ bool DtoTokenInput::expect(TokenType type, bool nextNonSpace)
 	if (g_errorHandler)
 	{
 		char message[MaxMessageLength];
-		snprintf(message, MaxMessageLength, "error: %d:%d : expected '%s' after '%s', got '%s'", m_token.line, m_token.line, s_tokens[type], s_tokens[m_prev.type], s_tokens[m_token.type]);
+		snprintf(message, MaxMessageLength, "error: %d:%d : expected '%s' after '%s', got '%s'", m_token.line(), m_token.column(), s_tokens[type], s_tokens[m_prev], s_tokens[m_token.type]);
 		g_errorHandler(message);
 	}
 
@@ -617,7 +1142,7 @@ void DtoTokenInput::emitUnexpectedToken() const
 	}
 
 	char message[MaxMessageLength];
-	snprintf(message, MaxMessageLength, "error: %d:%d : unexpected token '%s' after '%s'", m_token.line, m_token.line, s_tokens[m_token.type], s_tokens[m_prev.type]);
+	snprintf(message, MaxMessageLength, "error: %d:%d : unexpected token '%s' after '%s'", m_token.line(), m_token.column(), s_tokens[m_token.type], s_tokens[m_prev]);
 	g_errorHandler(message);
 }
 
@@ -697,58 +1222,364 @@ DtoValue DtoTokenInput::consumeString(bool nextNonSpace)
 	DtoValue result;
 	result.type = DtoString;
 	result.string = m_token.text;
+
+	// Most strings have no escape sequences and are returned as a view of an input stream
+	bool escapes = m_token == DoubleQuotedString || (m_token == SingleQuotedString && m_singleQuotedEscapes);
+	bool literal = m_token == SingleQuotedString && !m_singleQuotedEscapes;
+
+	if ((escapes || literal) && m_token.text.length && memchr(m_token.text.value, escapes ? '\\' : '\'', m_token.text.length))
+	{
+		std::string& buffer = m_unescaped[m_unescapedIndex];
+		m_unescapedIndex = (m_unescapedIndex + 1) % 2;
+
+		buffer.assign(m_token.text.value, m_token.text.length);
+		result.string.value = &buffer[0];
+
+		if (escapes)
+		{
+			result.string.length = unescape(&buffer[0], static_cast<int32>(buffer.size()), &buffer[0]);
+		}
+		else
+		{
+			// A literal single-quoted string only escapes a quote by doubling it
+			int32 length = 0;
+
+			for (size_t i = 0; i < buffer.size(); i++)
+			{
+				buffer[length++] = buffer[i];
+				i += buffer[i] == '\'' ? 1 : 0;
+			}
+
+			result.string.length = length;
+		}
+	}
+
 	consume(m_token.type, nextNonSpace);
 	return result;
 }
 
-// ** DtoTokenInput::nextNonSpace
-const DtoTokenInput::Token& DtoTokenInput::nextNonSpace()
+// ** DtoTokenInput::setSingleQuotedEscapes
+void DtoTokenInput::setSingleQuotedEscapes(bool value)
 {
-	do
+	m_singleQuotedEscapes = value;
+}
+
+// ** DtoTokenInput::setHexNumbers
+void DtoTokenInput::setHexNumbers(bool value)
+{
+	m_hexNumbers = value;
+}
+
+// ** DtoTokenInput::unescape
+int32 DtoTokenInput::unescape(cstring input, int32 length, char* output)
+{
+	cstring end = input + length;
+	char*   out = output;
+
+	while (input < end)
 	{
-		next();
-	} while (m_token == Space || m_token == Tab || m_token == NewLine);
+		if (*input != '\\' || input + 1 == end)
+		{
+			*out++ = *input++;
+			continue;
+		}
 
-	return m_token;
+		char symbol = input[1];
+		input += 2;
+
+		switch (symbol)
+		{
+		case 'a':	*out++ = '\a'; break;
+		case 'b':	*out++ = '\b'; break;
+		case 'f':	*out++ = '\f'; break;
+		case 'n':	*out++ = '\n'; break;
+		case 'r':	*out++ = '\r'; break;
+		case 't':	*out++ = '\t'; break;
+		case 'v':	*out++ = '\v'; break;
+		case 'e':	*out++ = '\x1b'; break;
+		case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+		{
+			// A Lua decimal escape of up to three digits, a YAML null escape is the same \0
+			int32 code = symbol - '0';
+
+			for (int32 i = 0; i < 2 && input < end && *input >= '0' && *input <= '9' && code * 10 + (*input - '0') <= 255; i++)
+			{
+				code = code * 10 + (*input++ - '0');
+			}
+
+			*out++ = static_cast<char>(code);
+		}
+		break;
+		case 'x':
+		{
+			uint32 code = 0;
+			int32  digits = readHex(input, end, 2, code);
+			input += digits;
+
+			if (digits)
+			{
+				*out++ = static_cast<char>(code);
+			}
+			else
+			{
+				*out++ = symbol;
+			}
+		}
+		break;
+		case 'u':
+		case 'U':
+		{
+			uint32 code = 0;
+			int32  digits = 0;
+
+			if (symbol == 'u' && input < end && *input == '{')
+			{
+				// A Lua escape with a variable number of digits in braces
+				digits = readHex(input + 1, end, 8, code);
+
+				if (digits && input + 1 + digits < end && input[1 + digits] == '}')
+				{
+					input += digits + 2;
+				}
+				else
+				{
+					digits = 0;
+				}
+			}
+			else
+			{
+				digits = readHex(input, end, symbol == 'u' ? 4 : 8, code);
+				input += digits;
+
+				// Combine a JSON surrogate pair into a single code point
+				if (digits == 4 && code >= 0xD800 && code <= 0xDBFF && end - input >= 6 && input[0] == '\\' && input[1] == 'u')
+				{
+					uint32 low = 0;
+
+					if (readHex(input + 2, end, 4, low) == 4 && low >= 0xDC00 && low <= 0xDFFF)
+					{
+						code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+						input += 6;
+					}
+				}
+			}
+
+			if (digits)
+			{
+				out += writeUtf8(code, out);
+			}
+			else
+			{
+				*out++ = symbol;
+			}
+		}
+		break;
+		case 'z':
+			// A Lua escape that skips a following whitespace
+			while (input < end && (*input == ' ' || *input == '\t' || *input == '\n' || *input == '\r'))
+			{
+				input++;
+			}
+			break;
+		default:
+			// Quotes, slashes and unknown escapes stand for the escaped character itself
+			*out++ = symbol;
+		}
+	}
+
+	return static_cast<int32>(out - output);
 }
 
-// ** DtoTokenInput::next
-const DtoTokenInput::Token& DtoTokenInput::next()
+// ** DtoTokenInput::readHex
+int32 DtoTokenInput::readHex(cstring input, cstring end, int32 count, uint32& value)
 {
-	// Save the current token as a previous one
-	m_prev = m_token;
+	int32 digits = 0;
+	value = 0;
 
-	// Read the next token
-	m_token.line        = m_line;
-	m_token.column      = m_column;
-	m_token.text.value  = reinterpret_cast<cstring>(m_ptr);
-	m_token.type        = readToken();
-	m_token.text.length = reinterpret_cast<cstring>(m_ptr) - m_token.text.value;
+	for (; digits < count && input + digits < end; digits++)
+	{
+		char symbol = input[digits];
+		uint32 digit;
+
+		if (symbol >= '0' && symbol <= '9')			digit = symbol - '0';
+		else if (symbol >= 'a' && symbol <= 'f')	digit = symbol - 'a' + 10;
+		else if (symbol >= 'A' && symbol <= 'F')	digit = symbol - 'A' + 10;
+		else break;
+
+		value = (value << 4) | digit;
+	}
 
-	// Postprocess token
-	if (m_token.type == NewLine)
+	return digits;
+}
+
+// ** DtoTokenInput::writeUtf8
+int32 DtoTokenInput::writeUtf8(uint32 code, char* output)
+{
+	// A longest UTF-8 sequence is four bytes, which is never longer than an escape sequence that produced it
+	code = code > 0x10FFFF ? 0xFFFD : code;
+
+	if (code < 0x80)
 	{
-		m_line++;
-		m_column = 1;
+		output[0] = static_cast<char>(code);
+		return 1;
 	}
-	else
+	if (code < 0x800)
+	{
+		output[0] = static_cast<char>(0xC0 | (code >> 6));
+		output[1] = static_cast<char>(0x80 | (code & 0x3F));
+		return 2;
+	}
+	if (code < 0x10000)
 	{
-		m_column += m_token.text.length;
+		output[0] = static_cast<char>(0xE0 | (code >> 12));
+		output[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		output[2] = static_cast<char>(0x80 | (code & 0x3F));
+		return 3;
+	}
+
+	output[0] = static_cast<char>(0xF0 | (code >> 18));
+	output[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+	output[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+	output[3] = static_cast<char>(0x80 | (code & 0x3F));
+	return 4;
+}
 
-		if (m_token == DoubleQuotedString || m_token == SingleQuotedString)
+// ** DtoTokenInput::nextNonSpace
+const DtoTokenInput::Token& DtoTokenInput::nextNonSpace()
+{
+	// Skip a whole whitespace run at once instead of reading a token per character
+	advance(static_cast<int32>(skipWhitespace(m_ptr, m_ptr + available()) - m_ptr));
+	return next();
+}
+
+// ** DtoTokenInput::readScalar
+const DtoTokenInput::Token& DtoTokenInput::readScalar(cstring indicators)
+{
+	// Rewind to the beginning of a current token
+	const byte* start = m_token.text.value ? m_token.start() : m_ptr;
+	const byte* end   = m_ptr + available();
+	const byte* ptr   = start;
+	const byte* last  = start;
+
+	assert(start <= m_ptr);
+
+	for (; ptr < end; ptr++)
+	{
+		byte symbol = *ptr;
+
+		// A scalar never spans across a line break
+		if (symbol == 0 || symbol == '\n' || (symbol == '\r' && ptr + 1 < end && ptr[1] == '\n'))
 		{
-			if (m_token.text.length == 2)
+			break;
+		}
+
+		if (isCharacterOf(symbol, ClassSpace))
+		{
+			// A comment should be separated from a scalar by a whitespace
+			if (ptr + 1 < end && ptr[1] == '#')
 			{
-				m_token.text = DtoStringView::construct("");
+				break;
 			}
-			else
+			continue;
+		}
+
+		if (strchr(indicators, symbol))
+		{
+			break;
+		}
+
+		// A colon is a part of a scalar unless it is followed by a whitespace or an indicator
+		if (symbol == ':')
+		{
+			byte following = ptr + 1 < end ? ptr[1] : 0;
+
+			if (following == 0 || following == '\r' || isCharacterOf(following, ClassSpace | ClassNewLine) || strchr(indicators, following))
 			{
-				m_token.text.value++;
-				m_token.text.length -= 2;
+				break;
 			}
 		}
+
+		// Trailing whitespaces are not a part of a scalar
+		last = ptr + 1;
 	}
-	
+
+	m_prev				= m_token.type;
+	m_token.type		= Scalar;
+	m_token.text.value	= reinterpret_cast<cstring>(start);
+	m_token.text.length	= static_cast<int32>(last - start);
+	m_ptr				= last;
+
+	return m_token;
+}
+
+// ** DtoTokenInput::skipLine
+const DtoTokenInput::Token& DtoTokenInput::skipLine()
+{
+	const byte* lineBreak = static_cast<const byte*>(memchr(m_ptr, '\n', available()));
+
+	if (!lineBreak)
+	{
+		advance(available());
+	}
+	else
+	{
+		// Stop at the beginning of a '\r\n' sequence
+		if (lineBreak > m_ptr && lineBreak[-1] == '\r')
+		{
+			lineBreak--;
+		}
+
+		advance(static_cast<int32>(lineBreak - m_ptr));
+	}
+
+	return next();
+}
+
+// ** DtoTokenInput::skipPast
+const DtoTokenInput::Token& DtoTokenInput::skipPast(cstring symbols)
+{
+	int32 length = static_cast<int32>(strlen(symbols));
+	const byte* end = m_ptr + available();
+
+	for (const byte* ptr = m_ptr; end - ptr >= length; ptr++)
+	{
+		ptr = static_cast<const byte*>(memchr(ptr, symbols[0], end - ptr));
+
+		if (!ptr || end - ptr < length)
+		{
+			break;
+		}
+
+		if (memcmp(ptr, symbols, length) == 0)
+		{
+			advance(static_cast<int32>(ptr - m_ptr) + length);
+			return next();
+		}
+	}
+
+	// No such sequence, so skip everything
+	advance(available());
+	return next();
+}
+
+// ** DtoTokenInput::next
+const DtoTokenInput::Token& DtoTokenInput::next()
+{
+	// Only a type of the previous token is needed to format error messages
+	m_prev = m_token.type;
+
+	// Read the next token, a position is not tracked here and is derived from a token text on demand
+	m_token.text.value  = reinterpret_cast<cstring>(m_ptr);
+	m_token.type        = readToken();
+	m_token.text.length = reinterpret_cast<cstring>(m_ptr) - m_token.text.value;
+
+	// Strip quotes, an empty string still points inside an input stream so it's position can be recovered
+	if (m_token == DoubleQuotedString || m_token == SingleQuotedString)
+	{
+		m_token.text.value++;
+		m_token.text.length -= 2;
+	}
+
 	return m_token;
 }
 
@@ -786,18 +1617,30 @@ DtoTokenInput::TokenType DtoTokenInput::readToken()
 		return readAs(Colon);
 	case ',':
 		return readAs(Comma);
+	case ';':
+		return readAs(Semicolon);
+	case '=':
+		return readAs(Equals);
 	case '"':
 		return readString('"', DoubleQuotedString);
 	case '\'':
 		return readString('\'', SingleQuotedString);
 	}
 
+	byte symbol = static_cast<byte>(currentSymbol());
+
 	// Is it a number?
-	if (isdigit(currentSymbol()))
+	if (isCharacterOf(symbol, ClassDigit))
 	{
 		return readNumber();
 	}
 
+	// Only identifiers and keywords are left
+	if (!isCharacterOf(symbol, ClassAlpha))
+	{
+		return Nonterminal;
+	}
+
 	// May be a boolean value?
 	if (read("true"))
 	{
@@ -808,38 +1651,42 @@ DtoTokenInput::TokenType DtoTokenInput::readToken()
 		return False;
 	}
 
-	// This can only be an identifier, so consume all symbols until the space, tab or new line
-	if (isalpha(currentSymbol()))
-	{
-		char c = 0;
-
-		do
-		{
-			advance(1);
-			c = currentSymbol();
-		} while (isalnum(c) || c == '_');
+	// This can only be an identifier, so consume all identifier symbols
+	advance(skipClass(ClassIdentifier));
 
-		return Identifier;
-	}
-
-	return Nonterminal;
+	return Identifier;
 }
 
 // ** DtoTokenInput::readNumber
 DtoTokenInput::TokenType DtoTokenInput::readNumber()
 {
-	// First consume an integer part
-	while (isdigit(currentSymbol()))
+	// A hexadecimal integer is accepted only when enabled by a reader
+	if (m_hexNumbers && currentSymbol() == '0' && (nextSymbol() == 'x' || nextSymbol() == 'X'))
 	{
-		advance(1);
+		uint32 value;
+		advance(2);
+		advance(readHex(reinterpret_cast<cstring>(m_ptr), reinterpret_cast<cstring>(m_ptr) + available(), available(), value));
+		return Number;
 	}
 
+	// First consume an integer part
+	advance(skipClass(ClassDigit));
+
 	// Probably a decimal value
 	if (read("."))
 	{
-		while (isdigit(currentSymbol()))
+		advance(skipClass(ClassDigit));
+	}
+
+	// An optional exponent should contain at least one digit
+	if (currentSymbol() == 'e' || currentSymbol() == 'E')
+	{
+		int32 sign = nextSymbol() == '+' || nextSymbol() == '-' ? 1 : 0;
+
+		if (isCharacterOf(static_cast<byte>(lookAhead(1 + sign)), ClassDigit))
 		{
-			advance(1);
+			advance(1 + sign);
+			advance(skipClass(ClassDigit));
 		}
 	}
 
@@ -854,10 +1701,18 @@ DtoTokenInput::TokenType DtoTokenInput::readString(char quote, TokenType type)
 	// Consume an opening quote symbol
 	advance(1);
 
-	// Keep going until the next quote is reached
-	while (currentSymbol() != quote)
+	// A backslash is a literal inside YAML single-quoted strings unless a reader enables escapes
+	bool escapes = quote == '"' || m_singleQuotedEscapes;
+
+	// Keep going until the next quote is reached, skipping escaped characters and YAML doubled quotes
+	while (currentSymbol() != quote || (!escapes && nextSymbol() == quote))
 	{
-		advance(1);
+		if (currentSymbol() == 0 || (escapes && currentSymbol() == '\\' && nextSymbol() == 0))
+		{
+			return Nonterminal;
+		}
+
+		advance((escapes && currentSymbol() == '\\') || currentSymbol() == quote ? 2 : 1);
 	}
 
 	// Consume a trailing quote
@@ -881,9 +1736,29 @@ char DtoTokenInput::nextSymbol() const
 // ** DtoTokenInput::currentSymbol
 char DtoTokenInput::lookAhead(int32 offset) const
 {
+	// Treat everything past the end of an input buffer as a zero terminator
+	if (offset >= available())
+	{
+		return 0;
+	}
+
 	return *(m_ptr + offset);
 }
 
+// ** DtoTokenInput::skipClass
+int32 DtoTokenInput::skipClass(int32 classes) const
+{
+	const byte* ptr = m_ptr;
+	const byte* end = m_ptr + available();
+
+	while (ptr < end && isCharacterOf(*ptr, classes))
+	{
+		ptr++;
+	}
+
+	return static_cast<int32>(ptr - m_ptr);
+}
+
 // ** DtoTokenInput::read
 bool DtoTokenInput::read(cstring symbols)
 {
@@ -918,4 +1793,40 @@ bool DtoTokenInput::Token::operator == (TokenType type) const
 	return this->type == type;
 }
 
+// ** DtoTokenInput::Token::start
+const byte* DtoTokenInput::Token::start() const
+{
+	const byte* result = reinterpret_cast<const byte*>(text.value);
+	return type == DoubleQuotedString || type == SingleQuotedString ? result - 1 : result;
+}
+
+// ** DtoTokenInput::Token::line
+int32 DtoTokenInput::Token::line() const
+{
+	assert(input != NULL);
+
+	if (!text.value)
+	{
+		return 1;
+	}
+
+	const byte* lineStart;
+	return countLineFeeds(input, start(), lineStart) + 1;
+}
+
+// ** DtoTokenInput::Token::column
+int32 DtoTokenInput::Token::column() const
+{
+	assert(input != NULL);
+
+	if (!text.value)
+	{
+		return 1;
+	}
+
+	const byte* lineStart;
+	countLineFeeds(input, start(), lineStart);
+	return static_cast<int32>(start() - lineStart) + 1;
+}
+
 DTO_END
\ No newline at end of file
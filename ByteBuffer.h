@@ -27,6 +27,9 @@ SOFTWARE.
 #ifndef __Dto_ByteBuffer_H__
 #define __Dto_ByteBuffer_H__
 
+#include <string>
+#include <vector>
+
 DTO_BEGIN
 
 	//! This class implements an output stream in which the data is written into a byte array.
@@ -41,6 +44,13 @@ DTO_BEGIN
 			int32				value;	//!< A total number of bytes to be written by a following call.
 		};
 
+		//! A proxy type to write an unsigned integer in a variable-length LEB128 encoding.
+		struct varint
+		{
+								varint(uint64 value) : value(value) {}
+			uint64				value;	//!< An integer value to be written.
+		};
+
 								//! Constructs DtoByteArrayOutput instance.
 								DtoByteArrayOutput(byte* output, int32 capacity);
 
@@ -77,6 +87,9 @@ DTO_BEGIN
 		//! Sets a source byte buffer size that if followed after this call.
 		DtoByteArrayOutput&		operator << (const size& size);
 
+		//! Writes an unsigned integer value using from 1 to 10 bytes, 7 bits per byte.
+		DtoByteArrayOutput&		operator << (const varint& value);
+
 		//! Writes a byte buffer to an output stream (expects a previous call to operator << (const Size&)).
 		DtoByteArrayOutput&		operator << (const byte* bytes);
 
@@ -97,6 +110,9 @@ DTO_BEGIN
 		//! Returns a total number of bytes available for writing.
 		int32					available() const;
 
+		//! Rewinds a write pointer back by a specified number of bytes.
+		void					rewind(int32 count);
+
 	protected:
 
 		//! Returns a writable pointer and advances a write head position by a specified number of bytes.
@@ -155,15 +171,28 @@ DTO_BEGIN
 		//! Controls an output formatting.
 		DtoTextOutput&			operator << (marker value);
 
-		//! Rewinds a write pointer back by a specified number of bytes.
-		void					rewind(int32 count);
-
 		//! Returns an output buffer as a C string.
 		cstring					text() const;
 
+		//! Enables or disables escaping of non-ASCII characters inside quoted strings as '\uXXXX' sequences.
+		void					setAsciiOnly(bool value);
+
+		//! Switches quoted strings to Lua escape sequences, where a control character is written as a '\ddd' decimal byte.
+		void					setLuaEscapes(bool value);
+
+	private:
+
+		//! Writes a string surrounded by quote symbols and escapes all characters that can not appear inside a JSON string.
+		void					writeQuoted(cstring value, int32 length);
+
+		//! Writes an escape sequence for a character at specified position and returns a total number of consumed bytes.
+		int32					writeEscaped(const byte* input, const byte* end);
+
 	private:
 
 		bool					m_isQuotedString;	//!< True if a next string value should be surrounded by quote symbols.
+		bool					m_isAsciiOnly;		//!< True if non-ASCII characters inside quoted strings should be escaped.
+		bool					m_isLuaEscapes;		//!< True if quoted strings use Lua escape sequences instead of JSON ones.
 	};
 
 	//! This class implements an input stream that contains bytes that may be read from the it.
@@ -178,6 +207,13 @@ DTO_BEGIN
 			int32				value;	//!< A total number of bytes to skip from an input stream.
 		};
 
+		//! A proxy type to read an unsigned integer in a variable-length LEB128 encoding.
+		struct varint
+		{
+								varint() : value(0) {}
+			uint64				value;	//!< A decoded integer value.
+		};
+
 								//! Constructs DtoByteBufferInput instance.
 								DtoByteBufferInput(const byte* input, int32 capacity);
 
@@ -214,6 +250,9 @@ DTO_BEGIN
 		//! Skips a specified number of bytes.
 		DtoByteBufferInput&		operator >> (const skip& count);
 
+		//! Reads a LEB128 encoded unsigned integer value, never reads past the end of an input stream.
+		DtoByteBufferInput&		operator >> (varint& value);
+
 		//! Returns an input byte buffer capacity.
 		int32					capacity() const;
 
@@ -239,6 +278,49 @@ DTO_BEGIN
 		int32					m_capacity;	//!< A maximum number of bytes that can be read from this byte array.
 	};
 
+	//! A growable memory arena that hands out byte buffers from large blocks, so allocated buffers are never moved.
+	class DtoArena
+	{
+	public:
+
+								//! Constructs a DtoArena instance with specified minimum block size.
+								DtoArena(int32 blockSize = 1 << 20);
+
+								~DtoArena();
+
+		//! Returns a pointer to at least specified number of writable bytes, that are not allocated until committed.
+		byte*					reserve(int32 count);
+
+		//! Allocates a specified number of bytes from a region returned by the last reserve call.
+		void					commit(int32 count);
+
+		//! Returns a total number of allocated bytes.
+		int64					length() const;
+
+		//! Marks all blocks as empty, so they can be reused without any allocations.
+		void					clear();
+
+	private:
+
+								//! Arenas are not copyable.
+								DtoArena(const DtoArena&);
+		DtoArena&				operator = (const DtoArena&);
+
+	private:
+
+		//! A single memory block.
+		struct Block
+		{
+			byte*				data;		//!< A block memory.
+			int32				capacity;	//!< A total block size.
+			int32				length;		//!< A total number of allocated bytes.
+		};
+
+		std::vector<Block>		m_blocks;		//!< All allocated blocks.
+		int32					m_current;		//!< An index of a block that is used for allocations.
+		int32					m_blockSize;	//!< A minimum block size.
+	};
+
 	/*!
 	 This class implements an input stream in which the data is treated as a sequence of tokens.
 	 */
@@ -270,6 +352,9 @@ DTO_BEGIN
 			, BracketOpen			//!< An opening bracket symbol '['
 			, BracketClose			//!< A closing bracket symbol ']'
 			, Comma					//!< A comma symbol ','
+			, Semicolon				//!< A semicolon symbol ';'
+			, Equals				//!< An equals sign '='
+			, Scalar				//!< An unquoted scalar that spans up to a line break, a comment or an indicator symbol.
 			, TotalTokens			//!< A total number of tokens.
 		};
 
@@ -281,11 +366,19 @@ DTO_BEGIN
 		{
 			DtoStringView		text;	//!< A token text.
 			TokenType			type;	//!< A token type.
-			int32				line;	//!< A line number this token occured.
-			int32				column;	//!< A column number of a first character of this token.
+			const byte*			input;	//!< A beginning of an input stream this token was read from.
 
 			//! Returns true if this token is of specified type.
 			bool				operator == (TokenType type) const;
+
+			//! Returns a pointer to the first character of this token.
+			const byte*			start() const;
+
+			//! Returns a line number this token occured, calculated by counting line feeds that precede it.
+			int32				line() const;
+
+			//! Returns a column number of a first character of this token.
+			int32				column() const;
 		};
 
 								//! Constructs a DtoTokenInput class.
@@ -300,6 +393,15 @@ DTO_BEGIN
 		//! Reads a next non whitespace token from an input stream.
 		const Token&			nextNonSpace();
 
+		//! Re-reads an input stream starting from a current token as an unquoted scalar that is terminated by any of specified indicator symbols.
+		const Token&			readScalar(cstring indicators);
+
+		//! Skips the rest of a current line and reads a line break token.
+		const Token&			skipLine();
+
+		//! Skips an input stream past the next occurrence of a specified sequence of symbols and reads a next token.
+		const Token&			skipPast(cstring symbols);
+
 		//! Returns a total numner of consumed bytes.
 		int32					consumed() const;
 
@@ -312,9 +414,19 @@ DTO_BEGIN
 		//! Consumes a boolean value from an input stream.
 		DtoValue				consumeBoolean(bool nextNonSpace = false);
 
-		//! Consumes a string value from an input stream.
+		//! Consumes a string value from an input stream, escape sequences are decoded and a decoded string stays valid until a second next string is consumed.
 		DtoValue				consumeString(bool nextNonSpace = false);
 
+		//! Enables backslash escape sequences inside single-quoted strings, otherwise a backslash is a literal and two quotes in a row stand for a single quote.
+		void					setSingleQuotedEscapes(bool value);
+
+		//! Enables hexadecimal integer numbers that start with a '0x' prefix.
+		void					setHexNumbers(bool value);
+
+		//! Decodes backslash escape sequences of JSON, YAML and Lua strings to an output buffer that is at least as long as an input, returns a decoded length.
+		//! An output may point to an input. Hexadecimal and decimal byte escapes produce raw bytes, unicode escapes produce UTF-8 sequences.
+		static int32			unescape(cstring input, int32 length, char* output);
+
 		//! Expects that a current token matches the specified one and if so, reads the next one.
 		bool					expect(TokenType type, bool nextNonSpace = false);
 
@@ -347,18 +459,29 @@ DTO_BEGIN
 		//! Returns a symbol that is located at specified offset.
 		char					lookAhead(int32 offset) const;
 
+		//! Returns a length of a run of symbols that belong to any of specified character classes.
+		int32					skipClass(int32 classes) const;
+
 		//! Returns true if a specified sequence of symbols can be consumed and if so consumes it.
 		bool					read(cstring symbols);
 
 		//! A shortcut to consume symbol an return a token type.
 		TokenType				readAs(TokenType type, int32 count = 1);
 
+		//! Parses up to a specified number of hexadecimal digits and returns a number of digits consumed.
+		static int32			readHex(cstring input, cstring end, int32 count, uint32& value);
+
+		//! Writes a code point as a UTF-8 sequence and returns a number of bytes written.
+		static int32			writeUtf8(uint32 code, char* output);
+
 	private:
 
-		int32					m_line;		//!< A current line number.
-		int32					m_column;	//!< A current column number.
-		Token					m_token;	//!< A current token.
-		Token					m_prev;		//!< A previous token (used by error message formatter).
+		Token					m_token;				//!< A current token.
+		TokenType				m_prev;					//!< A previous token type (used by error message formatter).
+		bool					m_singleQuotedEscapes;	//!< True if backslash escapes are allowed inside single-quoted strings.
+		bool					m_hexNumbers;			//!< True if hexadecimal numbers are allowed.
+		std::string				m_unescaped[2];			//!< Buffers that hold decoded strings, a key and a value are decoded to different buffers.
+		int32					m_unescapedIndex;		//!< An index of a buffer that is used to decode a next string.
 	};
 
 DTO_END
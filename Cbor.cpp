@@ -0,0 +1,790 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Cbor.h"
+#include "BigEndian.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+DTO_BEGIN
+
+extern DtoErrorHandler g_errorHandler;
+
+//! Major types of CBOR data items.
+enum CborMajorType
+{
+	  CborUnsigned	= 0
+	, CborNegative	= 1
+	, CborBytes		= 2
+	, CborText		= 3
+	, CborArray		= 4
+	, CborMap		= 5
+	, CborTag		= 6
+	, CborSimple	= 7
+};
+
+//! Additional information values, initial bytes and tags used by a CBOR encoding.
+enum CborConstant
+{
+	  CborMaxImmediate		= 23
+	, CborFalseInfo			= 20
+	, CborTrueInfo			= 21
+	, CborNullInfo			= 22
+	, CborUndefinedInfo		= 23
+	, CborFloat16Info		= 25
+	, CborFloat32Info		= 26
+	, CborFloat64Info		= 27
+	, CborIndefinite		= 31
+	, CborFalse				= 0xF4
+	, CborTrue				= 0xF5
+	, CborNull				= 0xF6
+	, CborFloat32			= 0xFA
+	, CborFloat64			= 0xFB
+	, CborBreak				= 0xFF
+	, CborIndefiniteArray	= 0x9F
+	, CborIndefiniteMap		= 0xBF
+	, CborEpochTag			= 1		//!< An epoch-based date and time.
+	, CborRegExTag			= 35	//!< A regular expression.
+	, CborUuidTag			= 37	//!< A binary UUID.
+};
+
+//! Decodes a half-precision floating point value.
+static double decodeHalf(uint32 half)
+{
+	int32  exponent = (half >> 10) & 0x1F;
+	int32  mantissa = half & 0x3FF;
+	double value;
+
+	if (exponent == 0)
+	{
+		value = ldexp(mantissa, -24);
+	}
+	else if (exponent != 31)
+	{
+		value = ldexp(mantissa + 1024, exponent - 25);
+	}
+	else
+	{
+		value = mantissa == 0 ? INFINITY : NAN;
+	}
+
+	return half & 0x8000 ? -value : value;
+}
+
+// --------------------------------------------------------- CborDtoWriter --------------------------------------------------------- //
+
+// ** CborDtoWriter::CborDtoWriter
+CborDtoWriter::CborDtoWriter(byte* output, int32 capacity)
+	: m_output(output, capacity)
+{
+
+}
+
+// ** CborDtoWriter::consume
+int32 CborDtoWriter::consume(const DtoEvent& event)
+{
+	int32 length = m_output.length();
+
+	switch (event.type)
+	{
+	case DtoStreamStart:
+		m_output << static_cast<byte>(CborIndefiniteMap);
+		m_stack.push(DtoKeyValue);
+		break;
+
+	case DtoKeyValueStart:
+		entry(event.key);
+		m_output << static_cast<byte>(CborIndefiniteMap);
+		m_stack.push(DtoKeyValue);
+		break;
+
+	case DtoSequenceStart:
+		entry(event.key);
+		m_output << static_cast<byte>(CborIndefiniteArray);
+		m_stack.push(DtoSequence);
+		break;
+
+	case DtoStreamEnd:
+	case DtoKeyValueEnd:
+	case DtoSequenceEnd:
+		m_output << static_cast<byte>(CborBreak);
+		m_stack.pop();
+		break;
+
+	case DtoEntry:
+		entry(event.key);
+		writeValue(event.data);
+		break;
+
+	default:
+		assert(0);
+	}
+
+	return m_output.length() - length;
+}
+
+// ** CborDtoWriter::length
+int32 CborDtoWriter::length() const
+{
+	return m_output.length();
+}
+
+// ** CborDtoWriter::entry
+void CborDtoWriter::entry(const DtoStringView& key)
+{
+	if (m_stack.top() == DtoKeyValue)
+	{
+		writeString(CborText, key.value, key.length);
+	}
+}
+
+// ** CborDtoWriter::writeValue
+void CborDtoWriter::writeValue(const DtoValue& value)
+{
+	switch (value.type)
+	{
+	case DtoNull:
+		m_output << static_cast<byte>(CborNull);
+		break;
+
+	case DtoBool:
+		m_output << static_cast<byte>(value.boolean ? CborTrue : CborFalse);
+		break;
+
+	case DtoInt32:
+	case DtoInt64:
+		{
+			int64 number = value.type == DtoInt32 ? value.int32 : value.int64;
+
+			if (number >= 0)
+			{
+				writeHead(CborUnsigned, static_cast<uint64>(number));
+			}
+			else
+			{
+				writeHead(CborNegative, static_cast<uint64>(-(number + 1)));
+			}
+		}
+		break;
+
+	case DtoTimestamp:
+		writeHead(CborUnsigned, value.uint64);
+		break;
+
+	case DtoDouble:
+		{
+			byte  bytes[9];
+			float single = static_cast<float>(value.number);
+
+			// Use a single precision when it does not lose any bits
+			if (single == value.number || value.number != value.number)
+			{
+				uint32 bits;
+				memcpy(&bits, &single, sizeof(bits));
+				bytes[0] = CborFloat32;
+				dtoStoreBigEndian(bytes + 1, bits, 4);
+				m_output << DtoByteArrayOutput::size(5) << bytes;
+			}
+			else
+			{
+				uint64 bits;
+				memcpy(&bits, &value.number, sizeof(bits));
+				bytes[0] = CborFloat64;
+				dtoStoreBigEndian(bytes + 1, bits, 8);
+				m_output << DtoByteArrayOutput::size(9) << bytes;
+			}
+		}
+		break;
+
+	case DtoDate:
+		writeHead(CborTag, CborEpochTag);
+
+		// Whole seconds are written as integers, otherwise as a fractional number of seconds
+		if (value.int64 % 1000 == 0)
+		{
+			DtoValue seconds;
+			seconds.type  = DtoInt64;
+			seconds.int64 = value.int64 / 1000;
+			writeValue(seconds);
+		}
+		else
+		{
+			byte   bytes[9];
+			double seconds = value.int64 / 1000.0;
+			uint64 bits;
+			memcpy(&bits, &seconds, sizeof(bits));
+			bytes[0] = CborFloat64;
+			dtoStoreBigEndian(bytes + 1, bits, 8);
+			m_output << DtoByteArrayOutput::size(9) << bytes;
+		}
+		break;
+
+	case DtoString:
+		writeString(CborText, value.string.value, value.string.length);
+		break;
+
+	case DtoBinary:
+		writeString(CborBytes, value.binary.data, value.binary.length);
+		break;
+
+	case DtoUUID:
+		writeHead(CborTag, CborUuidTag);
+		writeString(CborBytes, value.uuid.value, 16);
+		break;
+
+	case DtoRegEx:
+		writeHead(CborTag, CborRegExTag);
+		writeString(CborText, value.regex.value.value, value.regex.value.length);
+		break;
+
+	default:
+		assert(0);
+	}
+}
+
+// ** CborDtoWriter::writeHead
+void CborDtoWriter::writeHead(byte major, uint64 argument)
+{
+	byte  bytes[9];
+	int32 size;
+
+	if (argument <= CborMaxImmediate)
+	{
+		bytes[0] = static_cast<byte>((major << 5) | argument);
+		size = 0;
+	}
+	else if (argument <= 0xFF)
+	{
+		bytes[0] = static_cast<byte>((major << 5) | 24);
+		size = 1;
+	}
+	else if (argument <= 0xFFFF)
+	{
+		bytes[0] = static_cast<byte>((major << 5) | 25);
+		size = 2;
+	}
+	else if (argument <= 0xFFFFFFFF)
+	{
+		bytes[0] = static_cast<byte>((major << 5) | 26);
+		size = 4;
+	}
+	else
+	{
+		bytes[0] = static_cast<byte>((major << 5) | 27);
+		size = 8;
+	}
+
+	dtoStoreBigEndian(bytes + 1, argument, size);
+	m_output << DtoByteArrayOutput::size(size + 1) << bytes;
+}
+
+// ** CborDtoWriter::writeString
+void CborDtoWriter::writeString(byte major, const void* data, int32 length)
+{
+	writeHead(major, length);
+
+	if (length)
+	{
+		m_output << DtoByteArrayOutput::size(length) << reinterpret_cast<const byte*>(data);
+	}
+}
+
+// --------------------------------------------------------- CborDtoReader --------------------------------------------------------- //
+
+// ** CborDtoReader::CborDtoReader
+CborDtoReader::CborDtoReader(const byte* input, int32 length)
+	: m_input(input, length)
+{
+
+}
+
+// ** CborDtoReader::consumed
+int32 CborDtoReader::consumed() const
+{
+	return m_input.consumed();
+}
+
+// ** CborDtoReader::next
+DtoEvent CborDtoReader::next()
+{
+	DtoValue value;
+	int32	 count;
+
+	// A root node is either a map or an array
+	if (m_stack.empty())
+	{
+		if (!readObject(value, count, m_value) || (value.type != DtoKeyValue && value.type != DtoSequence))
+		{
+			return error("a CBOR data item should be a map or an array");
+		}
+
+		return push(value.type, count);
+	}
+
+	Nested& top = m_stack.top();
+
+	// Indefinite length nodes are terminated by a break byte
+	if (top.remaining < 0)
+	{
+		if (m_input.available() < 1)
+		{
+			return error("unexpected end of a CBOR data item");
+		}
+
+		if (*m_input.ptr() == CborBreak)
+		{
+			m_input.advance(1);
+			return pop();
+		}
+	}
+	else if (top.remaining == 0)
+	{
+		return pop();
+	}
+	else
+	{
+		top.remaining--;
+	}
+
+	DtoEvent event(DtoEntry);
+
+	// Array items have no keys, so generate them
+	if (top.type == DtoSequence)
+	{
+		event.key.value  = m_text;
+		event.key.length = sprintf_s(m_text, "%d", top.index++);
+	}
+	else
+	{
+		if (!readObject(value, count, m_key))
+		{
+			return error("malformed CBOR map key");
+		}
+
+		switch (value.type)
+		{
+		case DtoString:
+			event.key = value.string;
+			break;
+
+		case DtoInt32:
+			event.key.value  = m_text;
+			event.key.length = sprintf_s(m_text, "%d", value.int32);
+			break;
+
+		case DtoInt64:
+			event.key.value  = m_text;
+			event.key.length = sprintf_s(m_text, "%lld", static_cast<long long>(value.int64));
+			break;
+
+		case DtoTimestamp:
+			event.key.value  = m_text;
+			event.key.length = sprintf_s(m_text, "%llu", static_cast<unsigned long long>(value.uint64));
+			break;
+
+		default:
+			return error("CBOR map keys should be text strings or integers");
+		}
+	}
+
+	if (!readObject(event.data, count, m_value))
+	{
+		return error("malformed CBOR data item");
+	}
+
+	if (event.data.type == DtoKeyValue || event.data.type == DtoSequence)
+	{
+		event.type = push(event.data.type, count);
+	}
+
+	return event;
+}
+
+// ** CborDtoReader::readHead
+bool CborDtoReader::readHead(byte& major, byte& info, uint64& argument)
+{
+	const byte* data;
+	byte		initial;
+
+	if (m_input.available() < 1)
+	{
+		return false;
+	}
+
+	m_input >> initial;
+	major = initial >> 5;
+	info  = initial & 0x1F;
+
+	if (info <= CborMaxImmediate)
+	{
+		argument = info;
+	}
+	else if (info <= CborFloat64Info)
+	{
+		int32 size = 1 << (info - 24);
+
+		if (!readBytes(size, data))
+		{
+			return false;
+		}
+
+		argument = dtoLoadBigEndian(data, size);
+	}
+	else if (info == CborIndefinite)
+	{
+		// Only strings, arrays, maps and a break byte may have an indefinite length
+		argument = 0;
+		return major >= CborBytes && major != CborTag;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// ** CborDtoReader::readObject
+bool CborDtoReader::readObject(DtoValue& value, int32& count, std::string& buffer)
+{
+	byte   major;
+	byte   info;
+	uint64 argument;
+	bool   hasTag = false;
+	uint64 tag    = 0;
+
+	if (!readHead(major, info, argument))
+	{
+		return false;
+	}
+
+	// Only a tag that is the closest to a data item is taken into account
+	while (major == CborTag)
+	{
+		hasTag = true;
+		tag    = argument;
+
+		if (!readHead(major, info, argument))
+		{
+			return false;
+		}
+	}
+
+	count = 0;
+
+	switch (major)
+	{
+	case CborUnsigned:
+		if (argument > INT64_MAX)
+		{
+			value.type   = DtoTimestamp;
+			value.uint64 = argument;
+		}
+		else
+		{
+			dtoSetInteger(value, static_cast<int64>(argument));
+		}
+		break;
+
+	case CborNegative:
+		if (argument > INT64_MAX)
+		{
+			value.type   = DtoDouble;
+			value.number = -1.0 - static_cast<double>(argument);
+		}
+		else
+		{
+			dtoSetInteger(value, -1 - static_cast<int64>(argument));
+		}
+		break;
+
+	case CborBytes:
+		{
+			DtoStringView bytes;
+
+			if (!readString(major, info, argument, bytes, buffer))
+			{
+				return false;
+			}
+
+			value.type           = DtoBinary;
+			value.binary.subtype = 0;
+			value.binary.data    = reinterpret_cast<const byte*>(bytes.value);
+			value.binary.length  = bytes.length;
+		}
+		break;
+
+	case CborText:
+		value.type = DtoString;
+
+		if (!readString(major, info, argument, value.string, buffer))
+		{
+			return false;
+		}
+		break;
+
+	case CborArray:
+	case CborMap:
+		value.type = major == CborMap ? DtoKeyValue : DtoSequence;
+
+		if (info == CborIndefinite)
+		{
+			count = -1;
+		}
+		else
+		{
+			// Each element takes at least one byte, so reject counts that can not fit into a rest of an input stream
+			uint64 elements = major == CborMap ? argument * 2 : argument;
+
+			if (argument > INT32_MAX || elements > static_cast<uint64>(m_input.available()))
+			{
+				return false;
+			}
+
+			count = static_cast<int32>(argument);
+		}
+		break;
+
+	case CborSimple:
+		switch (info)
+		{
+		case CborFalseInfo:
+		case CborTrueInfo:
+			value.type    = DtoBool;
+			value.boolean = info == CborTrueInfo;
+			break;
+
+		case CborNullInfo:
+		case CborUndefinedInfo:
+			value.type = DtoNull;
+			break;
+
+		case CborFloat16Info:
+			value.type   = DtoDouble;
+			value.number = decodeHalf(static_cast<uint32>(argument));
+			break;
+
+		case CborFloat32Info:
+			{
+				float  single;
+				uint32 bits = static_cast<uint32>(argument);
+				memcpy(&single, &bits, sizeof(single));
+				value.type   = DtoDouble;
+				value.number = single;
+			}
+			break;
+
+		case CborFloat64Info:
+			value.type = DtoDouble;
+			memcpy(&value.number, &argument, sizeof(value.number));
+			break;
+
+		default:
+			// A break byte outside of an indefinite length node or an unassigned simple value
+			return false;
+		}
+		break;
+	}
+
+	if (!hasTag)
+	{
+		return true;
+	}
+
+	// Map known tags to DTO value types
+	switch (tag)
+	{
+	case CborEpochTag:
+		{
+			// Times that don't fit into 64-bit milliseconds are left untagged
+			int64 milliseconds;
+
+			if (value.type == DtoInt32)
+			{
+				milliseconds = static_cast<int64>(value.int32) * 1000;
+			}
+			else if (value.type == DtoInt64)
+			{
+				if (!dtoEpochMilliseconds(value.int64, 0, milliseconds))
+				{
+					break;
+				}
+			}
+			else if (value.type == DtoDouble)
+			{
+				double scaled = value.number * 1000.0;
+
+				// Comparisons are false for NaN, so it is rejected here as well
+				if (!(scaled >= -9223372036854775808.0 && scaled < 9223372036854775808.0))
+				{
+					break;
+				}
+
+				milliseconds = llround(scaled);
+			}
+			else
+			{
+				break;
+			}
+
+			value.type  = DtoDate;
+			value.int64 = milliseconds;
+		}
+		break;
+
+	case CborRegExTag:
+		if (value.type == DtoString)
+		{
+			DtoStringView pattern = value.string;
+			value.type                 = DtoRegEx;
+			value.regex.value          = pattern;
+			value.regex.options.value  = "";
+			value.regex.options.length = 0;
+		}
+		break;
+
+	case CborUuidTag:
+		if (value.type == DtoBinary && value.binary.length == 16)
+		{
+			const byte* data = value.binary.data;
+			value.type = DtoUUID;
+			memcpy(value.uuid.value, data, 16);
+		}
+		break;
+	}
+
+	return true;
+}
+
+// ** CborDtoReader::readString
+bool CborDtoReader::readString(byte major, byte info, uint64 length, DtoStringView& value, std::string& buffer)
+{
+	const byte* data;
+
+	if (info != CborIndefinite)
+	{
+		if (!readBytes(length, data))
+		{
+			return false;
+		}
+
+		value.value  = reinterpret_cast<cstring>(data);
+		value.length = static_cast<int32>(length);
+		return true;
+	}
+
+	// Concatenate definite length chunks of the same major type until a break byte
+	buffer.clear();
+
+	for (;;)
+	{
+		if (m_input.available() < 1)
+		{
+			return false;
+		}
+
+		if (*m_input.ptr() == CborBreak)
+		{
+			m_input.advance(1);
+			break;
+		}
+
+		byte chunkMajor;
+		byte chunkInfo;
+
+		if (!readHead(chunkMajor, chunkInfo, length) || chunkMajor != major || chunkInfo == CborIndefinite || !readBytes(length, data))
+		{
+			return false;
+		}
+
+		buffer.append(reinterpret_cast<cstring>(data), static_cast<size_t>(length));
+	}
+
+	value.value  = buffer.c_str();
+	value.length = static_cast<int32>(buffer.size());
+
+	return true;
+}
+
+// ** CborDtoReader::readBytes
+bool CborDtoReader::readBytes(uint64 length, const byte*& data)
+{
+	if (length > static_cast<uint64>(m_input.available()))
+	{
+		return false;
+	}
+
+	data = m_input.advance(static_cast<int32>(length));
+	return true;
+}
+
+// ** CborDtoReader::push
+DtoEventType CborDtoReader::push(DtoValueType type, int32 count)
+{
+	m_stack.push(Nested(type, count));
+
+	if (m_stack.size() == 1)
+	{
+		return DtoStreamStart;
+	}
+
+	return type == DtoSequence ? DtoSequenceStart : DtoKeyValueStart;
+}
+
+// ** CborDtoReader::pop
+DtoEventType CborDtoReader::pop()
+{
+	assert(m_stack.size());
+	DtoValueType type = m_stack.top().type;
+	m_stack.pop();
+
+	if (m_stack.empty())
+	{
+		return DtoStreamEnd;
+	}
+
+	return type == DtoSequence ? DtoSequenceEnd : DtoKeyValueEnd;
+}
+
+// ** CborDtoReader::error
+DtoEvent CborDtoReader::error(cstring message) const
+{
+	if (g_errorHandler)
+	{
+		char text[DtoTokenInput::MaxMessageLength];
+		snprintf(text, sizeof(text), "error: %s", message);
+		g_errorHandler(text);
+	}
+
+	return DtoError;
+}
+
+DTO_END
\ No newline at end of file
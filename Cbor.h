@@ -0,0 +1,147 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Cbor_H__
+#define __Dto_Cbor_H__
+
+#include <stack>
+#include <string>
+
+DTO_BEGIN
+
+	/*!
+	 Writes a DTO as an RFC 8949 CBOR data item with a map at the root.
+
+	 Maps and arrays are written with an indefinite length and terminated by a break byte,
+	 so a writer never seeks back and an output can be streamed as soon as it is produced.
+
+	 Integers and timestamps use a shortest head, doubles are written as float32 values when
+	 it is lossless, dates are tagged (1) epoch-based values, UUIDs are tagged (37) byte strings
+	 and regular expressions are tagged (35) text strings without options.
+	 */
+	class CborDtoWriter : public DtoWriter
+	{
+	public:
+
+							//! Constructs a CBOR writer.
+							CborDtoWriter(byte* output, int32 capacity);
+
+		//! Consumes an event an writes next entry to an output stream.
+		virtual int32		consume(const DtoEvent& event);
+
+		//! Returns a total number of bytes written to an output.
+		int32				length() const;
+
+	private:
+
+		//! Writes an entry key if a parent node is a map.
+		void				entry(const DtoStringView& key);
+
+		//! Writes a scalar value.
+		void				writeValue(const DtoValue& value);
+
+		//! Writes a head of a data item with a shortest argument encoding.
+		void				writeHead(byte major, uint64 argument);
+
+		//! Writes a byte or a text string.
+		void				writeString(byte major, const void* data, int32 length);
+
+	private:
+
+		DtoByteArrayOutput			m_output;	//!< An output data buffer.
+		std::stack<DtoValueType>	m_stack;	//!< A node type stack.
+	};
+
+	/*!
+	 Reads an RFC 8949 CBOR data item with a map or an array at the root.
+
+	 Both definite and indefinite length maps, arrays and strings are supported. Definite
+	 length strings are returned as views into an input buffer, while indefinite length
+	 strings are concatenated into an internal buffer that is valid until a next event.
+
+	 Unsigned integers that do not fit into a signed 64-bit integer are reported as timestamps,
+	 tags 1, 35 and 37 are reported as dates, regular expressions and UUIDs, all other tags are ignored.
+	 */
+	class CborDtoReader : public DtoReader
+	{
+	public:
+
+							//! Constructs a CBOR reader.
+							CborDtoReader(const byte* input, int32 length);
+
+		//! Decodes next event from an input stream.
+		virtual DtoEvent	next();
+
+		//! Returns a total number of consumed bytes.
+		virtual int32		consumed() const;
+
+	private:
+
+		//! Reads a data item head, returns false if an input stream is malformed.
+		bool				readHead(byte& major, byte& info, uint64& argument);
+
+		//! Reads a next data item, for maps and arrays outputs a total number of elements or -1 for indefinite length ones.
+		bool				readObject(DtoValue& value, int32& count, std::string& buffer);
+
+		//! Reads a byte or a text string, indefinite length strings are concatenated into a specified buffer.
+		bool				readString(byte major, byte info, uint64 length, DtoStringView& value, std::string& buffer);
+
+		//! Reads a view of a specified length, returns false if an input stream is too short.
+		bool				readBytes(uint64 length, const byte*& data);
+
+		//! Pushes a new node to the stack.
+		DtoEventType		push(DtoValueType type, int32 count);
+
+		//! Pops a node from the stack.
+		DtoEventType		pop();
+
+		//! Emits an error message and returns an error event.
+		DtoEvent			error(cstring message) const;
+
+	private:
+
+		//! A structure to hold nested node info.
+		struct Nested
+		{
+			DtoValueType	type;		//!< A node type.
+			int32			remaining;	//!< A total number of elements left to read or -1 for indefinite length nodes.
+			int32			index;		//!< A next array item index.
+
+							//! Constructs a Nested instance.
+							Nested(DtoValueType type, int32 count)
+								: type(type), remaining(count), index(0) {}
+		};
+
+		DtoByteBufferInput	m_input;	//!< An input byte buffer stream.
+		std::stack<Nested>	m_stack;	//!< A node stack to track nesting.
+		std::string			m_key;		//!< A buffer for indefinite length map keys.
+		std::string			m_value;	//!< A buffer for indefinite length string values.
+		char				m_text[24];	//!< A temporary buffer used for array item and integer map keys.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Cbor_H__	*/
\ No newline at end of file
@@ -0,0 +1,550 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Compact.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+DTO_BEGIN
+
+extern DtoErrorHandler g_errorHandler;
+
+//! Tags of a compact binary layout.
+enum CompactTag
+{
+	  CompactEnd		= 0x00
+	, CompactKeyValue	= 0x01
+	, CompactSequence	= 0x02
+	, CompactNull		= 0x03
+	, CompactFalse		= 0x04
+	, CompactTrue		= 0x05
+	, CompactDouble		= 0x06
+	, CompactIntegral	= 0x07
+	, CompactInt32		= 0x08
+	, CompactInt64		= 0x09
+	, CompactTimestamp	= 0x0A
+	, CompactDate		= 0x0B
+	, CompactString		= 0x0C
+	, CompactBinary		= 0x0D
+	, CompactUuid		= 0x0E
+	, CompactRegEx		= 0x0F
+	, CompactSmallIntegral	= 0x40
+	, CompactSmallInt32		= 0x60
+	, CompactShortString	= 0x80
+	, CompactMaxSmallInteger	= 0x1F
+	, CompactMaxShortString		= 0x7F
+};
+
+//! Maps a signed integer to an unsigned one, so small negative values are encoded with a few bytes.
+static uint64 zigZagEncode(int64 value)
+{
+	return (static_cast<uint64>(value) << 1) ^ static_cast<uint64>(value >> 63);
+}
+
+//! Maps a zig-zag encoded integer back to a signed one.
+static int64 zigZagDecode(uint64 value)
+{
+	return static_cast<int64>(value >> 1) ^ -static_cast<int64>(value & 1);
+}
+
+//! Returns true if a double value holds an integer that survives a round trip through a 64-bit integer.
+static bool isIntegral(double value)
+{
+	return fabs(value) < 9007199254740992.0 && value == static_cast<double>(static_cast<int64>(value)) && !(value == 0.0 && signbit(value));
+}
+
+// -------------------------------------------------------- CompactDtoWriter -------------------------------------------------------- //
+
+// ** CompactDtoWriter::CompactDtoWriter
+CompactDtoWriter::CompactDtoWriter(byte* output, int32 capacity)
+	: m_output(output, capacity)
+{
+
+}
+
+// ** CompactDtoWriter::consume
+int32 CompactDtoWriter::consume(const DtoEvent& event)
+{
+	int32 length = m_output.length();
+
+	switch (event.type)
+	{
+	case DtoStreamStart:
+		m_output << static_cast<byte>(CompactKeyValue);
+		m_stack.push(DtoKeyValue);
+		break;
+
+	case DtoKeyValueStart:
+		start(event.key, DtoKeyValue);
+		break;
+
+	case DtoSequenceStart:
+		start(event.key, DtoSequence);
+		break;
+
+	case DtoStreamEnd:
+	case DtoKeyValueEnd:
+	case DtoSequenceEnd:
+		m_output << static_cast<byte>(CompactEnd);
+		m_stack.pop();
+		break;
+
+	case DtoEntry:
+		encode(m_output, entryKey(event.key), event.data);
+		break;
+
+	default:
+		assert(0);
+	}
+
+	return m_output.length() - length;
+}
+
+// ** CompactDtoWriter::length
+int32 CompactDtoWriter::length() const
+{
+	return m_output.length();
+}
+
+// ** CompactDtoWriter::start
+void CompactDtoWriter::start(const DtoStringView& key, DtoValueType type)
+{
+	const DtoStringView* entry = entryKey(key);
+
+	m_output << static_cast<byte>(type == DtoSequence ? CompactSequence : CompactKeyValue);
+
+	if (entry)
+	{
+		m_output << DtoByteArrayOutput::varint(entry->length);
+
+		if (entry->length)
+		{
+			m_output << DtoByteArrayOutput::size(entry->length) << reinterpret_cast<const byte*>(entry->value);
+		}
+	}
+
+	m_stack.push(type);
+}
+
+// ** CompactDtoWriter::entryKey
+const DtoStringView* CompactDtoWriter::entryKey(const DtoStringView& key) const
+{
+	return m_stack.top() == DtoKeyValue ? &key : NULL;
+}
+
+// ** CompactDtoWriter::encode
+int32 CompactDtoWriter::encode(DtoByteArrayOutput& output, const DtoStringView* key, const DtoValue& value)
+{
+	// Save current stream length
+	int32 length = output.length();
+
+	// First, write a tag, small values are packed right into it
+	byte tag = CompactNull;
+
+	switch (value.type)
+	{
+	case DtoNull:		tag = CompactNull;
+						break;
+	case DtoBool:		tag = value.boolean ? CompactTrue : CompactFalse;
+						break;
+	case DtoInt32:		tag = value.int32 >= 0 && value.int32 <= CompactMaxSmallInteger ? CompactSmallInt32 + value.int32 : CompactInt32;
+						break;
+	case DtoInt64:		tag = CompactInt64;
+						break;
+	case DtoTimestamp:	tag = CompactTimestamp;
+						break;
+	case DtoDate:		tag = CompactDate;
+						break;
+	case DtoString:		tag = value.string.length <= CompactMaxShortString ? CompactShortString + value.string.length : CompactString;
+						break;
+	case DtoBinary:		tag = CompactBinary;
+						break;
+	case DtoUUID:		tag = CompactUuid;
+						break;
+	case DtoRegEx:		tag = CompactRegEx;
+						break;
+	case DtoDouble:
+		if (!isIntegral(value.number))
+		{
+			tag = CompactDouble;
+		}
+		else if (value.number >= 0 && value.number <= CompactMaxSmallInteger)
+		{
+			tag = CompactSmallIntegral + static_cast<int32>(value.number);
+		}
+		else
+		{
+			tag = CompactIntegral;
+		}
+		break;
+
+	default:
+		assert(0);
+	}
+
+	output << tag;
+
+	// Then write an entry key
+	if (key)
+	{
+		output << DtoByteArrayOutput::varint(key->length);
+
+		if (key->length)
+		{
+			output << DtoByteArrayOutput::size(key->length) << reinterpret_cast<const byte*>(key->value);
+		}
+	}
+
+	// And finally an actual value if it was not packed into a tag
+	switch (tag)
+	{
+	case CompactDouble:
+		output << value.number;
+		break;
+
+	case CompactIntegral:
+		output << DtoByteArrayOutput::varint(zigZagEncode(static_cast<int64>(value.number)));
+		break;
+
+	case CompactInt32:
+		output << DtoByteArrayOutput::varint(zigZagEncode(value.int32));
+		break;
+
+	case CompactInt64:
+	case CompactDate:
+		output << DtoByteArrayOutput::varint(zigZagEncode(value.int64));
+		break;
+
+	case CompactTimestamp:
+		output << DtoByteArrayOutput::varint(value.uint64);
+		break;
+
+	case CompactString:
+		output << DtoByteArrayOutput::varint(value.string.length) << DtoByteArrayOutput::size(value.string.length) << reinterpret_cast<const byte*>(value.string.value);
+		break;
+
+	case CompactBinary:
+		output << value.binary.subtype << DtoByteArrayOutput::varint(value.binary.length);
+
+		if (value.binary.length)
+		{
+			output << DtoByteArrayOutput::size(value.binary.length) << value.binary.data;
+		}
+		break;
+
+	case CompactUuid:
+		output << DtoByteArrayOutput::size(16) << value.uuid.value;
+		break;
+
+	case CompactRegEx:
+		output << DtoByteArrayOutput::varint(value.regex.value.length);
+
+		if (value.regex.value.length)
+		{
+			output << DtoByteArrayOutput::size(value.regex.value.length) << reinterpret_cast<const byte*>(value.regex.value.value);
+		}
+
+		output << DtoByteArrayOutput::varint(value.regex.options.length);
+
+		if (value.regex.options.length)
+		{
+			output << DtoByteArrayOutput::size(value.regex.options.length) << reinterpret_cast<const byte*>(value.regex.options.value);
+		}
+		break;
+
+	default:
+		// A short string payload follows a tag
+		if (tag >= CompactShortString && value.string.length)
+		{
+			output << DtoByteArrayOutput::size(value.string.length) << reinterpret_cast<const byte*>(value.string.value);
+		}
+	}
+
+	return output.length() - length;
+}
+
+// -------------------------------------------------------- CompactDtoReader -------------------------------------------------------- //
+
+// ** CompactDtoReader::CompactDtoReader
+CompactDtoReader::CompactDtoReader(const byte* input, int32 length)
+	: m_input(input, length)
+{
+
+}
+
+// ** CompactDtoReader::consumed
+int32 CompactDtoReader::consumed() const
+{
+	return m_input.consumed();
+}
+
+// ** CompactDtoReader::next
+DtoEvent CompactDtoReader::next()
+{
+	if (m_input.available() == 0)
+	{
+		return error("unexpected end of a compact DTO");
+	}
+
+	byte tag;
+	m_input >> tag;
+
+	// A root node is always a key-value one
+	if (m_stack.empty())
+	{
+		if (tag != CompactKeyValue)
+		{
+			return error("a compact DTO should start with a key-value node");
+		}
+
+		return push(DtoKeyValue);
+	}
+
+	if (tag == CompactEnd)
+	{
+		return pop();
+	}
+
+	DtoEvent event(DtoEntry);
+
+	// Sequence items have no keys, so generate them
+	Nested& top = m_stack.top();
+
+	if (top.type == DtoSequence)
+	{
+		event.key.value  = m_text;
+		event.key.length = sprintf_s(m_text, "%d", top.index++);
+	}
+	else if (!readString(event.key))
+	{
+		return error("unexpected end of a compact DTO");
+	}
+
+	switch (tag)
+	{
+	case CompactKeyValue:
+		event.type = push(DtoKeyValue);
+		break;
+
+	case CompactSequence:
+		event.type = push(DtoSequence);
+		break;
+
+	default:
+		if (!decode(tag, event.data))
+		{
+			return error("malformed compact DTO entry");
+		}
+	}
+
+	return event;
+}
+
+// ** CompactDtoReader::decode
+bool CompactDtoReader::decode(byte tag, DtoValue& value)
+{
+	DtoByteBufferInput::varint number;
+
+	// Small values are packed right into a tag
+	if (tag >= CompactShortString)
+	{
+		value.type = DtoString;
+		value.string.length = tag - CompactShortString;
+
+		if (value.string.length > m_input.available())
+		{
+			return false;
+		}
+
+		value.string.value = reinterpret_cast<cstring>(m_input.advance(value.string.length));
+		return true;
+	}
+
+	if (tag >= CompactSmallInt32)
+	{
+		value.type  = DtoInt32;
+		value.int32 = tag - CompactSmallInt32;
+		return true;
+	}
+
+	if (tag >= CompactSmallIntegral)
+	{
+		value.type   = DtoDouble;
+		value.number = tag - CompactSmallIntegral;
+		return true;
+	}
+
+	switch (tag)
+	{
+	case CompactNull:
+		value.type = DtoNull;
+		break;
+
+	case CompactFalse:
+	case CompactTrue:
+		value.type    = DtoBool;
+		value.boolean = tag == CompactTrue;
+		break;
+
+	case CompactDouble:
+		if (m_input.available() < 8)
+		{
+			return false;
+		}
+		value.type = DtoDouble;
+		m_input >> value.number;
+		break;
+
+	case CompactIntegral:
+		m_input >> number;
+		value.type   = DtoDouble;
+		value.number = static_cast<double>(zigZagDecode(number.value));
+		break;
+
+	case CompactInt32:
+		m_input >> number;
+		value.type  = DtoInt32;
+		value.int32 = static_cast<int32>(zigZagDecode(number.value));
+		break;
+
+	case CompactInt64:
+	case CompactDate:
+		m_input >> number;
+		value.type  = tag == CompactDate ? DtoDate : DtoInt64;
+		value.int64 = zigZagDecode(number.value);
+		break;
+
+	case CompactTimestamp:
+		m_input >> number;
+		value.type   = DtoTimestamp;
+		value.uint64 = number.value;
+		break;
+
+	case CompactString:
+		value.type = DtoString;
+		return readString(value.string);
+
+	case CompactBinary:
+		if (m_input.available() < 1)
+		{
+			return false;
+		}
+
+		value.type = DtoBinary;
+		m_input >> value.binary.subtype >> number;
+
+		if (number.value > static_cast<uint64>(m_input.available()))
+		{
+			return false;
+		}
+
+		value.binary.length = static_cast<int32>(number.value);
+		value.binary.data   = m_input.advance(value.binary.length);
+		break;
+
+	case CompactUuid:
+		if (m_input.available() < 16)
+		{
+			return false;
+		}
+		value.type = DtoUUID;
+		memcpy(value.uuid.value, m_input.advance(16), 16);
+		break;
+
+	case CompactRegEx:
+		value.type = DtoRegEx;
+		return readString(value.regex.value) && readString(value.regex.options);
+
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+// ** CompactDtoReader::readString
+bool CompactDtoReader::readString(DtoStringView& value)
+{
+	DtoByteBufferInput::varint length;
+	m_input >> length;
+
+	if (length.value > static_cast<uint64>(m_input.available()))
+	{
+		return false;
+	}
+
+	value.length = static_cast<int32>(length.value);
+	value.value  = reinterpret_cast<cstring>(m_input.advance(value.length));
+
+	return true;
+}
+
+// ** CompactDtoReader::push
+DtoEventType CompactDtoReader::push(DtoValueType type)
+{
+	m_stack.push(Nested(type));
+
+	if (m_stack.size() == 1)
+	{
+		return DtoStreamStart;
+	}
+
+	return type == DtoSequence ? DtoSequenceStart : DtoKeyValueStart;
+}
+
+// ** CompactDtoReader::pop
+DtoEventType CompactDtoReader::pop()
+{
+	assert(m_stack.size());
+	DtoValueType type = m_stack.top().type;
+	m_stack.pop();
+
+	if (m_stack.empty())
+	{
+		return DtoStreamEnd;
+	}
+
+	return type == DtoSequence ? DtoSequenceEnd : DtoKeyValueEnd;
+}
+
+// ** CompactDtoReader::error
+DtoEvent CompactDtoReader::error(cstring message) const
+{
+	if (g_errorHandler)
+	{
+		char text[DtoTokenInput::MaxMessageLength];
+		snprintf(text, sizeof(text), "error: %s", message);
+		g_errorHandler(text);
+	}
+
+	return DtoError;
+}
+
+DTO_END
\ No newline at end of file
@@ -0,0 +1,139 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Compact_H__
+#define __Dto_Compact_H__
+
+#include <stack>
+
+DTO_BEGIN
+
+	/*!
+	 A compact binary DTO layout for small messages sent over bandwidth-bound links.
+
+	 Each value starts with a single tag byte. Entries of key-value nodes are followed by a key
+	 stored as a LEB128 length and UTF-8 bytes without a zero terminator, sequence items have no keys.
+	 Nodes are terminated by an end tag instead of being prefixed with a length, so a writer never seeks back.
+
+	 0x00        - an end of a key-value or sequence node.
+	 0x01, 0x02  - a key-value or a sequence node start.
+	 0x03        - null.
+	 0x04, 0x05  - false and true.
+	 0x06        - a double value, 8 bytes.
+	 0x07        - a double value that holds an integer, zig-zag LEB128.
+	 0x08, 0x09  - 32-bit and 64-bit integers, zig-zag LEB128.
+	 0x0A        - a timestamp, LEB128.
+	 0x0B        - a date, zig-zag LEB128.
+	 0x0C        - a string, LEB128 length followed by bytes.
+	 0x0D        - a binary blob, a subtype byte, LEB128 length and bytes.
+	 0x0E        - a UUID, 16 bytes.
+	 0x0F        - a regular expression, two strings encoded as 0x0C payloads.
+	 0x40 - 0x5F - a double value that holds an integer in [0, 31] range.
+	 0x60 - 0x7F - a 32-bit integer in [0, 31] range.
+	 0x80 - 0xFF - a string of up to 127 bytes, a length is stored in lower 7 bits.
+	 */
+	class CompactDtoWriter : public DtoWriter
+	{
+	public:
+
+							//! Constructs a compact binary data writer.
+							CompactDtoWriter(byte* output, int32 capacity);
+
+		//! Consumes an event an writes next entry to an output stream.
+		virtual int32		consume(const DtoEvent& event);
+
+		//! Returns a total number of bytes written to an output.
+		int32				length() const;
+
+		//! Encodes a tagged value with an optional key and returns a total number of bytes that was written.
+		static int32		encode(DtoByteArrayOutput& output, const DtoStringView* key, const DtoValue& value);
+
+	private:
+
+		//! Writes a node start tag followed by a key if a parent node is a key-value one.
+		void				start(const DtoStringView& key, DtoValueType type);
+
+		//! Returns a key pointer for a next entry, sequence items have no keys.
+		const DtoStringView* entryKey(const DtoStringView& key) const;
+
+	private:
+
+		DtoByteArrayOutput			m_output;	//!< An output data buffer.
+		std::stack<DtoValueType>	m_stack;	//!< A node type stack.
+	};
+
+	//! Reads a compact binary DTO layout produced by CompactDtoWriter.
+	class CompactDtoReader : public DtoReader
+	{
+	public:
+
+							//! Constructs a compact binary DTO reader.
+							CompactDtoReader(const byte* input, int32 length);
+
+		//! Decodes next event from an input stream.
+		virtual DtoEvent	next();
+
+		//! Returns a total number of consumed bytes.
+		virtual int32		consumed() const;
+
+	private:
+
+		//! Decodes a value payload for a specified tag, returns false if an input stream is malformed.
+		bool				decode(byte tag, DtoValue& value);
+
+		//! Reads a LEB128 length prefixed string, returns false if an input stream is too short.
+		bool				readString(DtoStringView& value);
+
+		//! Pushes a new node to the stack.
+		DtoEventType		push(DtoValueType type);
+
+		//! Pops a node from the stack.
+		DtoEventType		pop();
+
+		//! Emits an error message and returns an error event.
+		DtoEvent			error(cstring message) const;
+
+	private:
+
+		//! A structure to hold nested node info.
+		struct Nested
+		{
+			DtoValueType	type;	//!< A node type.
+			int32			index;	//!< A next sequence item index.
+
+							//! Constructs a Nested instance.
+							Nested(DtoValueType type)
+								: type(type), index(0) {}
+		};
+
+		DtoByteBufferInput	m_input;	//!< An input byte buffer stream.
+		std::stack<Nested>	m_stack;	//!< A node stack to track nesting.
+		char				m_text[16];	//!< A temporary buffer used for sequence item keys.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Compact_H__	*/
\ No newline at end of file
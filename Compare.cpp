@@ -0,0 +1,465 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Compare.h"
+#include "Order.h"
+
+#include <string.h>
+#include <algorithm>
+
+DTO_BEGIN
+
+extern const byte g_emptyNode[5];
+
+//! Value kinds in an ascending order.
+enum DtoValueRank
+{
+	  DtoRankNull
+	, DtoRankNumber
+	, DtoRankString
+	, DtoRankBoolean
+	, DtoRankDate
+	, DtoRankTimestamp
+	, DtoRankBinary
+	, DtoRankUuid
+	, DtoRankRegEx
+	, DtoRankKeyValue
+	, DtoRankSequence
+};
+
+// ** dtoRank
+static int32 dtoRank(DtoValueType type)
+{
+	switch (type)
+	{
+	case DtoDouble:
+	case DtoInt32:
+	case DtoInt64:		return DtoRankNumber;
+	case DtoString:		return DtoRankString;
+	case DtoBool:		return DtoRankBoolean;
+	case DtoDate:		return DtoRankDate;
+	case DtoTimestamp:	return DtoRankTimestamp;
+	case DtoBinary:		return DtoRankBinary;
+	case DtoUUID:		return DtoRankUuid;
+	case DtoRegEx:		return DtoRankRegEx;
+	case DtoKeyValue:	return DtoRankKeyValue;
+	case DtoSequence:	return DtoRankSequence;
+	default:			return DtoRankNull;
+	}
+}
+
+// ** dtoCompareStrings
+static int32 dtoCompareStrings(const DtoStringView& a, const DtoStringView& b)
+{
+	return dtoOrderBytes(a.value, a.length, b.value, b.length);
+}
+
+// ** dtoNormalize
+static bool dtoNormalize(const DtoValue& value, int64& integer, double& number)
+{
+	switch (value.type)
+	{
+	case DtoInt32:
+		integer = value.int32;
+		return true;
+
+	case DtoInt64:
+		integer = value.int64;
+		return true;
+
+	default:
+		number = value.number;
+		return dtoIntegralNumber(number, integer);
+	}
+}
+
+// ** dtoCompareNumbers
+static int32 dtoCompareNumbers(const DtoValue& a, const DtoValue& b)
+{
+	// Numbers of the same type are compared directly
+	if (a.type == b.type)
+	{
+		switch (a.type)
+		{
+		case DtoInt32:	return dtoOrder(a.int32, b.int32);
+		case DtoInt64:	return dtoOrder(a.int64, b.int64);
+		default:		return dtoOrderDoubles(a.number, b.number);
+		}
+	}
+
+	int64  aInteger = 0, bInteger = 0;
+	double aNumber  = 0, bNumber  = 0;
+	bool   aIsInteger = dtoNormalize(a, aInteger, aNumber);
+	bool   bIsInteger = dtoNormalize(b, bInteger, bNumber);
+
+	return dtoOrderNumbers(aIsInteger, aInteger, aNumber, bIsInteger, bInteger, bNumber);
+}
+
+// ** dtoCompareNodes
+static int32 dtoCompareNodes(const DtoBinaryBlob& a, const DtoBinaryBlob& b, bool hasKeys)
+{
+	// Nodes with the same length prefixed bytes are equal
+	if (a.length == b.length && memcmp(a.data, b.data, a.length) == 0)
+	{
+		return 0;
+	}
+
+	DtoIter i = Dto(a.data, a.length).iter();
+	DtoIter j = Dto(b.data, b.length).iter();
+
+	while (true)
+	{
+		bool hasA = i.next();
+		bool hasB = j.next();
+
+		if (!hasA || !hasB)
+		{
+			return static_cast<int32>(hasA) - static_cast<int32>(hasB);
+		}
+
+		int32 result = hasKeys ? dtoCompareStrings(i.key(), j.key()) : 0;
+
+		if (result == 0)
+		{
+			result = dtoCompare(i.value(), j.value());
+		}
+
+		if (result)
+		{
+			return result;
+		}
+	}
+}
+
+// ** dtoCompare
+int32 dtoCompare(const DtoValue& a, const DtoValue& b)
+{
+	int32 rank = dtoRank(a.type);
+
+	if (rank != dtoRank(b.type))
+	{
+		return rank < dtoRank(b.type) ? -1 : 1;
+	}
+
+	switch (rank)
+	{
+	case DtoRankNumber:
+		return dtoCompareNumbers(a, b);
+
+	case DtoRankString:
+		return dtoCompareStrings(a.string, b.string);
+
+	case DtoRankBoolean:
+		return dtoOrder(a.boolean, b.boolean);
+
+	case DtoRankDate:
+		return dtoOrder(a.int64, b.int64);
+
+	case DtoRankTimestamp:
+		return dtoOrder(a.uint64, b.uint64);
+
+	case DtoRankBinary:
+		{
+			int32 result = dtoOrderBytes(a.binary.data, a.binary.length, b.binary.data, b.binary.length);
+			return result ? result : dtoOrder(a.binary.subtype, b.binary.subtype);
+		}
+
+	case DtoRankUuid:
+		return memcmp(a.uuid.value, b.uuid.value, sizeof(a.uuid.value));
+
+	case DtoRankRegEx:
+		{
+			int32 result = dtoCompareStrings(a.regex.value, b.regex.value);
+			return result ? result : dtoCompareStrings(a.regex.options, b.regex.options);
+		}
+
+	case DtoRankKeyValue:
+		return dtoCompareNodes(a.binary, b.binary, true);
+
+	case DtoRankSequence:
+		return dtoCompareNodes(a.binary, b.binary, false);
+	}
+
+	return 0;
+}
+
+// ** dtoCompare
+int32 dtoCompare(const Dto& a, const Dto& b)
+{
+	DtoValue aNode, bNode;
+
+	aNode.type			= DtoKeyValue;
+	aNode.binary.data	= a ? a.data() : g_emptyNode;
+	aNode.binary.length = a ? a.length() : sizeof(g_emptyNode);
+
+	bNode.type			= DtoKeyValue;
+	bNode.binary.data	= b ? b.data() : g_emptyNode;
+	bNode.binary.length = b ? b.length() : sizeof(g_emptyNode);
+
+	return dtoCompare(aNode, bNode);
+}
+
+// ** dtoEquals
+bool dtoEquals(const Dto& a, const Dto& b)
+{
+	if (a && b && a.length() == b.length() && memcmp(a.data(), b.data(), a.length()) == 0)
+	{
+		return true;
+	}
+
+	return dtoCompare(a, b) == 0;
+}
+
+// ** dtoSortPrefix
+static uint64 dtoSortPrefix(const DtoValue& value, bool& exact)
+{
+	// A value rank takes four highest bits, so values of different kinds never share a prefix
+	int32  rank	   = dtoRank(value.type);
+	uint64 payload = 0;
+
+	exact = true;
+
+	switch (rank)
+	{
+	case DtoRankNumber:
+		{
+			double number = value.number;
+
+			if (value.type == DtoInt32)
+			{
+				number = value.int32;
+			}
+			else if (value.type == DtoInt64)
+			{
+				number = static_cast<double>(value.int64);
+				exact  = value.int64 >= -(1LL << 53) && value.int64 <= (1LL << 53);
+			}
+
+			// Map doubles to unsigned integers with the same order, NaN goes first and negative zero equals zero
+			if (number == number)
+			{
+				number = number == 0 ? 0.0 : number;
+				memcpy(&payload, &number, sizeof(payload));
+				payload = (payload & 0x8000000000000000ULL) ? ~payload : payload | 0x8000000000000000ULL;
+			}
+		}
+		break;
+
+	case DtoRankString:
+		{
+			// Seven leading bytes are followed by a length clamped to eight, a length of longer strings is unknown
+			int32 length = std::min(value.string.length, 7);
+
+			for (int32 i = 0; i < 7; i++)
+			{
+				payload = (payload << 8) | (i < length ? static_cast<byte>(value.string.value[i]) : 0);
+			}
+
+			payload = (payload << 8) | (std::min(value.string.length, 8) << 4);
+			exact	= value.string.length < 8;
+		}
+		break;
+
+	case DtoRankBoolean:
+		payload = static_cast<uint64>(value.boolean) << 4;
+		break;
+
+	case DtoRankDate:
+		payload = static_cast<uint64>(value.int64) ^ 0x8000000000000000ULL;
+		break;
+
+	case DtoRankTimestamp:
+		payload = value.uint64;
+		break;
+
+	case DtoRankNull:
+		break;
+
+	default:
+		exact = false;
+	}
+
+	// Four lowest payload bits are dropped, so a prefix identifies a value only if these bits are zero
+	exact = exact && (payload & 0xF) == 0;
+
+	return (static_cast<uint64>(rank) << 60) | (payload >> 4);
+}
+
+// ------------------------------------------------------- DtoComparator ------------------------------------------------------- //
+
+// ** DtoComparator::by
+DtoComparator& DtoComparator::by(cstring path, DtoSortOrder order)
+{
+	m_paths.push_back(DtoFieldPath(path));
+	m_orders.push_back(order);
+	return *this;
+}
+
+// ** DtoComparator::extract
+void DtoComparator::extract(const Dto* documents, int64 count, DtoThreadPool* pool)
+{
+	int32 fields	 = static_cast<int32>(m_paths.size());
+	int32 chunkCount = pool ? static_cast<int32>(std::min<int64>(pool->size() * 4, std::max<int64>(count / 1024, 1))) : 1;
+
+	m_values.resize(count * fields);
+
+	DtoThreadPool::Task extract = [&](int32 task, int32)
+	{
+		int64 begin = count * task / chunkCount;
+		int64 end	= count * (task + 1) / chunkCount;
+
+		for (int64 index = begin; index < end; index++)
+		{
+			for (int32 field = 0; field < fields; field++)
+			{
+				DtoIter	  i		= documents[index].find(m_paths[field]);
+				DtoValue& value = m_values[index * fields + field];
+
+				if (i)
+				{
+					value = i.value();
+				}
+				else
+				{
+					value.type = DtoNull;
+				}
+			}
+		}
+	};
+
+	if (pool)
+	{
+		pool->run(chunkCount, extract);
+	}
+	else
+	{
+		extract(0, 0);
+	}
+}
+
+// ** DtoComparator::compare
+int32 DtoComparator::compare(int64 a, int64 b) const
+{
+	int32			fields = static_cast<int32>(m_paths.size());
+	const DtoValue* x	   = &m_values[a * fields];
+	const DtoValue* y	   = &m_values[b * fields];
+
+	for (int32 field = 0; field < fields; field++)
+	{
+		int32 result = dtoCompare(x[field], y[field]);
+
+		if (result)
+		{
+			return m_orders[field] == DtoDescending ? -result : result;
+		}
+	}
+
+	return 0;
+}
+
+// ** DtoComparator::operator ()
+bool DtoComparator::operator () (int64 a, int64 b) const
+{
+	return compare(a, b) < 0;
+}
+
+// ** DtoComparator::sort
+void DtoComparator::sort(Dto* documents, int64 count, DtoThreadPool* pool)
+{
+	extract(documents, count, pool);
+
+	//! A sort record with an abbreviated field value.
+	struct Record
+	{
+		uint64	prefix;	//!< An order preserving value prefix.
+		int64	index;	//!< A document index.
+		bool	exact;	//!< Indicates that a prefix identifies a value.
+	};
+
+	int32				fields = static_cast<int32>(m_paths.size());
+	std::vector<int64>	order(count);
+	std::vector<Record> records(count);
+
+	for (int64 i = 0; i < count; i++)
+	{
+		order[i] = i;
+	}
+
+	// Stable sort by each field starting from the last one, records are small and compared by prefixes,
+	// so a sort rarely touches extracted values and never touches documents for short strings and numbers.
+	for (int32 field = fields - 1; field >= 0; field--)
+	{
+		bool isDescending = m_orders[field] == DtoDescending;
+
+		for (int64 i = 0; i < count; i++)
+		{
+			Record& record = records[i];
+			record.index  = order[i];
+			record.prefix = dtoSortPrefix(m_values[order[i] * fields + field], record.exact);
+
+			if (isDescending)
+			{
+				record.prefix = ~record.prefix;
+			}
+		}
+
+		std::stable_sort(records.begin(), records.end(), [&](const Record& a, const Record& b)
+		{
+			if (a.prefix != b.prefix)
+			{
+				return a.prefix < b.prefix;
+			}
+
+			if (a.exact && b.exact)
+			{
+				return false;
+			}
+
+			int32 result = dtoCompare(m_values[a.index * fields + field], m_values[b.index * fields + field]);
+			return isDescending ? result > 0 : result < 0;
+		});
+
+		for (int64 i = 0; i < count; i++)
+		{
+			order[i] = records[i].index;
+		}
+	}
+
+	// Reorder documents along with extracted values, so that indices match sorted documents
+	std::vector<Dto>	  sorted(documents, documents + count);
+	std::vector<DtoValue> values(m_values.size());
+
+	for (int64 i = 0; i < count; i++)
+	{
+		documents[i] = sorted[order[i]];
+		std::copy(m_values.begin() + order[i] * fields, m_values.begin() + (order[i] + 1) * fields, values.begin() + i * fields);
+	}
+
+	m_values.swap(values);
+}
+
+DTO_END
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Compare_H__
+#define __Dto_Compare_H__
+
+#include <vector>
+
+DTO_BEGIN
+
+	/*!
+	 Compares two values and returns a negative value, zero or a positive value if a is less than, equal to or greater than b.
+
+	 Values of different kinds are ordered as: null, number, string, boolean, date, timestamp, binary, UUID, regular
+	 expression, key-value and sequence, so the ordering of scalars matches the one of DtoIndexKey. Numbers of all types are
+	 compared by a value and NaN is ordered before other numbers. Strings and binaries are compared bytewise. Nested
+	 nodes are compared entry by entry, key-value entries are compared by a key first, and a shorter node is ordered first.
+	 */
+	int32 dtoCompare(const DtoValue& a, const DtoValue& b);
+
+	//! Compares two documents as key-value nodes, an empty DTO is equal to an empty key-value node.
+	int32 dtoCompare(const Dto& a, const Dto& b);
+
+	//! Returns true if two documents are equal. Documents with the same binary layout are compared with a single memcmp,
+	//! otherwise documents are compared with dtoCompare, so an int32 value equals a double with the same value.
+	bool dtoEquals(const Dto& a, const Dto& b);
+
+	//! A sort order of a single comparator field.
+	enum DtoSortOrder
+	{
+		  DtoAscending	//!< Smaller values go first.
+		, DtoDescending	//!< Greater values go first.
+	};
+
+	/*!
+	 Orders documents by values of a list of fields. Field values are extracted once for all documents and stored in a
+	 single array, so a comparison never walks a document. Documents without a field are ordered as if a field value was null.
+	 Extracted values reference documents, so documents should outlive a comparator.
+
+	 A comparator orders document indices, it may be passed to std::sort with std::ref to avoid copying extracted values.
+	 */
+	class DtoComparator
+	{
+	public:
+
+		//! Appends a dot-separated field path, documents are compared by fields in the order they were added.
+		DtoComparator&			by(cstring path, DtoSortOrder order = DtoAscending);
+
+		//! Extracts field values of all documents, values are extracted in parallel if a thread pool is passed.
+		void					extract(const Dto* documents, int64 count, DtoThreadPool* pool = NULL);
+
+		//! Compares documents with specified indices.
+		int32					compare(int64 a, int64 b) const;
+
+		//! Returns true if a document a goes before a document b.
+		bool					operator () (int64 a, int64 b) const;
+
+		//! Extracts field values and sorts documents in place, documents with equal values keep their relative order.
+		//! Documents are sorted by one field at a time starting from the last one, comparing order preserving 64-bit prefixes of values.
+		void					sort(Dto* documents, int64 count, DtoThreadPool* pool = NULL);
+
+	private:
+
+		std::vector<DtoFieldPath>	m_paths;	//!< Compiled field paths.
+		std::vector<DtoSortOrder>	m_orders;	//!< Sort orders of fields.
+		std::vector<DtoValue>		m_values;	//!< Field values of all documents, values of a single document are stored together.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Compare_H__	*/
\ No newline at end of file
@@ -0,0 +1,528 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Delta.h"
+
+#include <string.h>
+#include <algorithm>
+
+DTO_BEGIN
+
+extern DtoErrorHandler g_errorHandler;
+
+//! Frame operation codes stored in two low bits of an operation.
+enum DtoDeltaOperation
+{
+	  DtoDeltaCopy		//!< Copies tokens from a previous document.
+	, DtoDeltaValue		//!< Replaces a value of a previous document token.
+	, DtoDeltaInsert	//!< Inserts a new token.
+	, DtoDeltaSkip		//!< Skips tokens of a previous document or ends a frame.
+};
+
+// ** dtoWriteOperation
+static void dtoWriteOperation(std::vector<byte>& output, DtoDeltaOperation operation, uint64 count)
+{
+	uint64 value = (count << 2) | operation;
+
+	while (value >= 0x80)
+	{
+		output.push_back(static_cast<byte>(value | 0x80));
+		value >>= 7;
+	}
+
+	output.push_back(static_cast<byte>(value));
+}
+
+// ** dtoHasValidPayload
+//! Returns true if a value payload of a token has exactly the length it declares, so a BinaryDtoReader never reads past a token.
+static bool dtoHasValidPayload(byte type, const byte* payload, int32 length)
+{
+	switch (type)
+	{
+	case DtoString:
+	case DtoBinary:
+		{
+			int32 size;
+
+			if (length < static_cast<int32>(sizeof(size)))
+			{
+				return false;
+			}
+
+			memcpy(&size, payload, sizeof(size));
+
+			// A string length counts a zero terminator and a binary length is followed by a subtype byte
+			if (type == DtoString)
+			{
+				return size > 0 && size == length - static_cast<int32>(sizeof(size)) && payload[length - 1] == 0;
+			}
+
+			return size >= 0 && size == length - static_cast<int32>(sizeof(size)) - 1;
+		}
+
+	case DtoRegEx:
+		{
+			// A pattern and options are zero terminated strings
+			const byte* options = reinterpret_cast<const byte*>(memchr(payload, 0, length));
+
+			if (!options)
+			{
+				return false;
+			}
+
+			return memchr(options + 1, 0, payload + length - options - 1) == payload + length - 1;
+		}
+
+	case DtoBool:		return length == 1;
+	case DtoInt32:		return length == sizeof(int32);
+	case DtoDate:
+	case DtoInt64:
+	case DtoTimestamp:
+	case DtoDouble:		return length == sizeof(int64);
+	case DtoUUID:		return length == 16;
+	case DtoNull:		return length == 0;
+	default:			return false;
+	}
+}
+
+// ------------------------------------------------------- DtoDeltaCodec::State ------------------------------------------------------- //
+
+// ** DtoDeltaCodec::State::State
+DtoDeltaCodec::State::State()
+{
+	clear();
+}
+
+// ** DtoDeltaCodec::State::clear
+void DtoDeltaCodec::State::clear()
+{
+	bytes.clear();
+	offsets.assign(1, 0);
+	headers.clear();
+}
+
+// ** DtoDeltaCodec::State::size
+int32 DtoDeltaCodec::State::size() const
+{
+	return static_cast<int32>(headers.size());
+}
+
+// ** DtoDeltaCodec::State::token
+const byte* DtoDeltaCodec::State::token(int32 index) const
+{
+	return &bytes[offsets[index]];
+}
+
+// ** DtoDeltaCodec::State::length
+int32 DtoDeltaCodec::State::length(int32 index) const
+{
+	return offsets[index + 1] - offsets[index];
+}
+
+// ** DtoDeltaCodec::State::append
+void DtoDeltaCodec::State::append(const byte* header, int32 headerLength, const byte* value, int32 valueLength)
+{
+	bytes.insert(bytes.end(), header, header + headerLength);
+	bytes.insert(bytes.end(), value, value + valueLength);
+	offsets.push_back(static_cast<int32>(bytes.size()));
+	headers.push_back(headerLength);
+}
+
+// ** DtoDeltaCodec::State::append
+void DtoDeltaCodec::State::append(const State& state, int32 index, int32 count)
+{
+	// Tokens are stored one after another, so a whole range is copied at once
+	int32 offset = static_cast<int32>(bytes.size()) - state.offsets[index];
+	bytes.insert(bytes.end(), state.bytes.begin() + state.offsets[index], state.bytes.begin() + state.offsets[index + count]);
+
+	for (int32 i = index; i < index + count; i++)
+	{
+		offsets.push_back(state.offsets[i + 1] + offset);
+		headers.push_back(state.headers[i]);
+	}
+}
+
+// ----------------------------------------------------------- DtoDeltaCodec ----------------------------------------------------------- //
+
+// ** DtoDeltaCodec::reset
+void DtoDeltaCodec::reset()
+{
+	m_previous.clear();
+	m_current.clear();
+}
+
+// ---------------------------------------------------------- DtoDeltaEncoder ---------------------------------------------------------- //
+
+// ** DtoDeltaEncoder::encode
+void DtoDeltaEncoder::encode(const Dto& dto, std::vector<byte>& output)
+{
+	tokenize(dto);
+
+	const State& previous = m_previous;
+	const State& current  = m_current;
+	int32		 copied	  = 0;
+	int32		 skipped  = 0;
+
+	for (int32 i = 0, j = 0; i < current.size();)
+	{
+		int32 length = current.length(i);
+		int32 header = current.headers[i];
+
+		// Extend a run of unchanged tokens
+		if (j < previous.size() && length == previous.length(j) && memcmp(current.token(i), previous.token(j), length) == 0)
+		{
+			if (skipped)
+			{
+				dtoWriteOperation(output, DtoDeltaSkip, skipped);
+				skipped = 0;
+			}
+
+			copied++, i++, j++;
+			continue;
+		}
+
+		if (copied)
+		{
+			dtoWriteOperation(output, DtoDeltaCopy, copied);
+			copied = 0;
+		}
+
+		// A type and a key did not change, so write a value only
+		if (j < previous.size() && header == previous.headers[j] && memcmp(current.token(i), previous.token(j), header) == 0)
+		{
+			if (skipped)
+			{
+				dtoWriteOperation(output, DtoDeltaSkip, skipped);
+				skipped = 0;
+			}
+
+			dtoWriteOperation(output, DtoDeltaValue, length - header);
+			output.insert(output.end(), current.token(i) + header, current.token(i) + length);
+			i++, j++;
+			continue;
+		}
+
+		// A previous token was removed if a token after it has the same type and key
+		if (j + 1 < previous.size() && header == previous.headers[j + 1] && memcmp(current.token(i), previous.token(j + 1), header) == 0)
+		{
+			skipped++, j++;
+			continue;
+		}
+
+		if (skipped)
+		{
+			dtoWriteOperation(output, DtoDeltaSkip, skipped);
+			skipped = 0;
+		}
+
+		dtoWriteOperation(output, DtoDeltaInsert, length);
+		output.insert(output.end(), current.token(i), current.token(i) + length);
+		i++;
+	}
+
+	if (copied)
+	{
+		dtoWriteOperation(output, DtoDeltaCopy, copied);
+	}
+
+	// Remaining tokens of a previous document are dropped by an end of a frame
+	dtoWriteOperation(output, DtoDeltaSkip, 0);
+
+	std::swap(m_previous, m_current);
+}
+
+// ** DtoDeltaEncoder::tokenize
+void DtoDeltaEncoder::tokenize(const Dto& dto)
+{
+	m_current.clear();
+
+	if (!dto)
+	{
+		return;
+	}
+
+	// Tokens never take more space than a document itself
+	m_current.bytes.resize(dto.length());
+	DtoByteArrayOutput output(&m_current.bytes[0], dto.length());
+	BinaryDtoReader	   reader(dto.data(), dto.length());
+
+	for (DtoEvent event = reader.next(); event.type != DtoStreamEnd; event = reader.next())
+	{
+		int32 header = 1;
+
+		switch (event.type)
+		{
+		case DtoStreamStart:
+			continue;
+
+		case DtoEntry:
+			BinaryDtoWriter::encode(output, event.key, event.data);
+			header += event.key.length + 1;
+			break;
+
+		case DtoKeyValueStart:
+			output << DtoKeyValue << event.key << DtoEnd;
+			header += event.key.length + 1;
+			break;
+
+		case DtoSequenceStart:
+			output << DtoSequence << event.key << DtoEnd;
+			header += event.key.length + 1;
+			break;
+
+		default:
+			output << DtoEnd;
+		}
+
+		m_current.offsets.push_back(output.length());
+		m_current.headers.push_back(header);
+	}
+
+	m_current.bytes.resize(output.length());
+}
+
+// ---------------------------------------------------------- DtoDeltaDecoder ---------------------------------------------------------- //
+
+// ** DtoDeltaDecoder::decode
+Dto DtoDeltaDecoder::decode(DtoByteBufferInput& input, std::vector<byte>& output)
+{
+	if (!apply(input))
+	{
+		return error("malformed delta frame");
+	}
+
+	if (!write(output))
+	{
+		return error("malformed delta document");
+	}
+
+	std::swap(m_previous, m_current);
+
+	return Dto(&output[0], static_cast<int32>(output.size()));
+}
+
+// ** DtoDeltaDecoder::apply
+bool DtoDeltaDecoder::apply(DtoByteBufferInput& input)
+{
+	m_current.clear();
+
+	for (int32 j = 0; input.available();)
+	{
+		DtoByteBufferInput::varint operation;
+		input >> operation;
+
+		uint64 count = operation.value >> 2;
+
+		switch (operation.value & 3)
+		{
+		case DtoDeltaCopy:
+			if (count > static_cast<uint64>(m_previous.size() - j))
+			{
+				return false;
+			}
+
+			m_current.append(m_previous, j, static_cast<int32>(count));
+			j += static_cast<int32>(count);
+			break;
+
+		case DtoDeltaValue:
+			{
+				if (j >= m_previous.size() || count > static_cast<uint64>(input.available()))
+				{
+					return false;
+				}
+
+				// Only entries have values
+				const byte* token = m_previous.token(j);
+
+				if (token[0] == DtoEnd || token[0] == DtoKeyValue || token[0] == DtoSequence)
+				{
+					return false;
+				}
+
+				m_current.append(token, m_previous.headers[j], input.advance(static_cast<int32>(count)), static_cast<int32>(count));
+				j++;
+			}
+			break;
+
+		case DtoDeltaInsert:
+			{
+				if (count == 0 || count > static_cast<uint64>(input.available()))
+				{
+					return false;
+				}
+
+				int32		length = static_cast<int32>(count);
+				const byte* token  = input.advance(length);
+				int32		header = 1;
+
+				// A header of an entry or a nested node start ends with a key terminator
+				if (token[0] != DtoEnd)
+				{
+					const byte* terminator = reinterpret_cast<const byte*>(memchr(token + 1, 0, length - 1));
+
+					if (!terminator)
+					{
+						return false;
+					}
+
+					header = static_cast<int32>(terminator - token) + 1;
+				}
+
+				m_current.append(token, header, token + header, length - header);
+			}
+			break;
+
+		case DtoDeltaSkip:
+			if (count == 0)
+			{
+				return true;
+			}
+
+			if (count > static_cast<uint64>(m_previous.size() - j))
+			{
+				return false;
+			}
+
+			j += static_cast<int32>(count);
+			break;
+		}
+	}
+
+	// A frame was truncated
+	return false;
+}
+
+// ** DtoDeltaDecoder::write
+bool DtoDeltaDecoder::write(std::vector<byte>& output) const
+{
+	// Each nested node start takes a token header and a length prefix
+	int32 nodes = 0;
+
+	for (int32 i = 0; i < m_current.size(); i++)
+	{
+		byte type = *m_current.token(i);
+		nodes += type == DtoKeyValue || type == DtoSequence;
+	}
+
+	output.resize(m_current.bytes.size() + (nodes + 1) * sizeof(int32) + 1);
+
+	BinaryDtoWriter writer(&output[0], static_cast<int32>(output.size()));
+	writer.consume(DtoEvent(DtoStreamStart));
+
+	int32 depth = 0;
+
+	for (int32 i = 0; i < m_current.size(); i++)
+	{
+		const byte*	  token = m_current.token(i);
+		DtoStringView key;
+		key.value  = reinterpret_cast<cstring>(token + 1);
+		key.length = m_current.headers[i] - 2;
+
+		switch (token[0])
+		{
+		case DtoEnd:
+			if (depth-- == 0)
+			{
+				return false;
+			}
+
+			writer.consume(DtoEvent(DtoKeyValueEnd));
+			break;
+
+		case DtoKeyValue:
+			writer.consume(DtoEvent(DtoKeyValueStart, key));
+			depth++;
+			break;
+
+		case DtoSequence:
+			writer.consume(DtoEvent(DtoSequenceStart, key));
+			depth++;
+			break;
+
+		case DtoDouble:
+		case DtoString:
+		case DtoBinary:
+		case DtoUUID:
+		case DtoBool:
+		case DtoDate:
+		case DtoNull:
+		case DtoRegEx:
+		case DtoInt32:
+		case DtoTimestamp:
+		case DtoInt64:
+			{
+				int32 header = m_current.headers[i];
+				int32 length = m_current.length(i);
+
+				// Inserted and replaced values come straight from a frame, so length prefixes are checked before decoding
+				if (!dtoHasValidPayload(token[0], token + header, length - header))
+				{
+					return false;
+				}
+
+				DtoValue		   value;
+				DtoByteBufferInput input(token, length);
+
+				if (BinaryDtoReader::decode(input, key, value) != length)
+				{
+					return false;
+				}
+
+				writer.consume(DtoEvent(key, value));
+			}
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	if (depth != 0)
+	{
+		return false;
+	}
+
+	writer.consume(DtoEvent(DtoStreamEnd));
+
+	return true;
+}
+
+// ** DtoDeltaDecoder::error
+Dto DtoDeltaDecoder::error(cstring message)
+{
+	if (g_errorHandler)
+	{
+		char text[DtoTokenInput::MaxMessageLength];
+		snprintf(text, sizeof(text), "error: %s", message);
+		g_errorHandler(text);
+	}
+
+	return Dto();
+}
+
+DTO_END
\ No newline at end of file
@@ -0,0 +1,123 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Delta_H__
+#define __Dto_Delta_H__
+
+#include <vector>
+
+DTO_BEGIN
+
+	/*!
+	 A base class of a stateful delta codec for streams of similar documents, such as telemetry samples from a single
+	 source. A document is split into tokens, which are the binary layout without length prefixes: an entry with it's
+	 type, key and value, a nested node start with it's type and key or a nested node end. A frame is a list of LEB128
+	 encoded operations over tokens of a previous document:
+
+	 - copy N tokens that did not change;
+	 - keep a type and a key of a next token, but replace it's value with N following bytes;
+	 - insert a new N bytes long token;
+	 - skip N tokens, zero skip ends a frame.
+	 */
+	class DtoDeltaCodec
+	{
+	public:
+
+		//! Forgets a previous document, so that a next frame is a key frame that does not depend on a stream history.
+		void					reset();
+
+	protected:
+
+		//! Tokens of a single document.
+		struct State
+		{
+			std::vector<byte>	bytes;		//!< All tokens one after another.
+			std::vector<int32>	offsets;	//!< Token start offsets followed by a total length of all tokens.
+			std::vector<int32>	headers;	//!< Token header lengths, a header is a token type followed by it's key.
+
+								//! Constructs a State instance.
+								State();
+
+			//! Removes all tokens.
+			void				clear();
+
+			//! Returns a total number of tokens.
+			int32				size() const;
+
+			//! Returns a token start.
+			const byte*			token(int32 index) const;
+
+			//! Returns a token length.
+			int32				length(int32 index) const;
+
+			//! Appends a token composed of a header and a value to the end.
+			void				append(const byte* header, int32 headerLength, const byte* value, int32 valueLength);
+
+			//! Appends a range of tokens from another state.
+			void				append(const State& state, int32 index, int32 count);
+		};
+
+		State					m_previous;	//!< Tokens of a previous document.
+		State					m_current;	//!< Tokens of a current document.
+	};
+
+	//! Encodes documents from a single stream as deltas against a previous document.
+	class DtoDeltaEncoder : public DtoDeltaCodec
+	{
+	public:
+
+		//! Encodes a document and appends a frame to an output buffer.
+		void					encode(const Dto& dto, std::vector<byte>& output);
+
+	private:
+
+		//! Splits a document into tokens by reading it with a BinaryDtoReader.
+		void					tokenize(const Dto& dto);
+	};
+
+	//! Decodes frames produced by a DtoDeltaEncoder.
+	class DtoDeltaDecoder : public DtoDeltaCodec
+	{
+	public:
+
+		//! Decodes a next frame from an input stream and writes a document to an output buffer, returns an empty DTO on a malformed frame.
+		Dto						decode(DtoByteBufferInput& input, std::vector<byte>& output);
+
+	private:
+
+		//! Reads frame operations and applies them to a previous document.
+		bool					apply(DtoByteBufferInput& input);
+
+		//! Writes current tokens to a document with a BinaryDtoWriter.
+		bool					write(std::vector<byte>& output) const;
+
+		//! Reports a decoding error.
+		Dto						error(cstring message);
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Delta_H__	*/
\ No newline at end of file
@@ -0,0 +1,228 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Dictionary.h"
+
+#include <assert.h>
+#include <string.h>
+
+DTO_BEGIN
+
+//! Adds keys of all key-value nodes of a DTO to a dictionary in a depth-first order.
+static void learnKeys(DtoKeyDictionary& dictionary, const Dto& dto, bool isSequence)
+{
+	DtoIter i = dto.iter();
+
+	while (i.next())
+	{
+		// Sequence item keys are indices, and keys with unknown ids can not be learned
+		if (!isSequence && !DtoKeyDictionary::isEncoded(i.key()))
+		{
+			dictionary.add(i.key());
+		}
+
+		if (i == DtoKeyValue || i == DtoSequence)
+		{
+			learnKeys(dictionary, i.toDto(), i == DtoSequence);
+		}
+	}
+}
+
+// ** DtoKeyDictionary::DtoKeyDictionary
+DtoKeyDictionary::DtoKeyDictionary()
+	: m_storage(4096)
+{
+	rehash(64);
+}
+
+// ** DtoKeyDictionary::add
+int32 DtoKeyDictionary::add(const DtoStringView& key)
+{
+	assert(!isEncoded(key));
+
+	uint32 mask  = static_cast<uint32>(m_buckets.size()) - 1;
+	uint32 index = bucket(key);
+
+	// Look for an existing key or an empty bucket
+	for (; m_buckets[index] >= 0; index = (index + 1) & mask)
+	{
+		if (m_keys[m_buckets[index]] == key)
+		{
+			return m_buckets[index];
+		}
+	}
+
+	if (size() >= MaxKeys)
+	{
+		return -1;
+	}
+
+	// Copy key characters to a storage
+	DtoStringView stored;
+	byte* characters = m_storage.reserve(key.length);
+	memcpy(characters, key.value, key.length);
+	m_storage.commit(key.length);
+
+	stored.value  = reinterpret_cast<cstring>(characters);
+	stored.length = key.length;
+
+	int32 id = size();
+	m_keys.push_back(stored);
+	m_buckets[index] = id;
+
+	// Keep a load factor below one half
+	if (m_keys.size() * 2 > m_buckets.size())
+	{
+		rehash(static_cast<int32>(m_buckets.size()) * 2);
+	}
+
+	return id;
+}
+
+// ** DtoKeyDictionary::learn
+void DtoKeyDictionary::learn(const Dto& dto)
+{
+	learnKeys(*this, Dto(dto.data(), dto.capacity(), this), false);
+}
+
+// ** DtoKeyDictionary::find
+int32 DtoKeyDictionary::find(const DtoStringView& key) const
+{
+	uint32 mask = static_cast<uint32>(m_buckets.size()) - 1;
+
+	for (uint32 index = bucket(key); m_buckets[index] >= 0; index = (index + 1) & mask)
+	{
+		if (m_keys[m_buckets[index]] == key)
+		{
+			return m_buckets[index];
+		}
+	}
+
+	return -1;
+}
+
+// ** DtoKeyDictionary::key
+const DtoStringView& DtoKeyDictionary::key(int32 id) const
+{
+	assert(id >= 0 && id < size());
+	return m_keys[id];
+}
+
+// ** DtoKeyDictionary::size
+int32 DtoKeyDictionary::size() const
+{
+	return static_cast<int32>(m_keys.size());
+}
+
+// ** DtoKeyDictionary::resolve
+bool DtoKeyDictionary::resolve(DtoStringView& key) const
+{
+	if (!isEncoded(key))
+	{
+		return true;
+	}
+
+	const byte* digits = reinterpret_cast<const byte*>(key.value) + 1;
+	int32 id;
+
+	switch (key.length)
+	{
+	case 2:		id = digits[0] - 1;
+				break;
+	case 3:		id = (digits[0] - 1) + (digits[1] - 1) * 255;
+				break;
+	default:	return false;
+	}
+
+	if (id >= size())
+	{
+		return false;
+	}
+
+	key = m_keys[id];
+	return true;
+}
+
+// ** DtoKeyDictionary::encode
+int32 DtoKeyDictionary::encode(int32 id, byte* output)
+{
+	assert(id >= 0 && id < MaxKeys);
+
+	output[0] = 0xFF;
+	output[1] = static_cast<byte>(id % 255 + 1);
+
+	if (id < 255)
+	{
+		return 2;
+	}
+
+	output[2] = static_cast<byte>(id / 255 + 1);
+	return 3;
+}
+
+// ** DtoKeyDictionary::isEncoded
+bool DtoKeyDictionary::isEncoded(const DtoStringView& key)
+{
+	return key.length > 0 && static_cast<byte>(key.value[0]) == 0xFF;
+}
+
+// ** DtoKeyDictionary::bucket
+uint32 DtoKeyDictionary::bucket(const DtoStringView& key) const
+{
+	// A 32-bit FNV-1a hash
+	uint32 hash = 2166136261u;
+
+	for (int32 i = 0; i < key.length; i++)
+	{
+		hash = (hash ^ static_cast<byte>(key.value[i])) * 16777619u;
+	}
+
+	return hash & (static_cast<uint32>(m_buckets.size()) - 1);
+}
+
+// ** DtoKeyDictionary::rehash
+void DtoKeyDictionary::rehash(int32 count)
+{
+	assert((count & (count - 1)) == 0);
+
+	m_buckets.assign(count, -1);
+	uint32 mask = static_cast<uint32>(count) - 1;
+
+	for (int32 id = 0; id < size(); id++)
+	{
+		uint32 index = bucket(m_keys[id]);
+
+		while (m_buckets[index] >= 0)
+		{
+			index = (index + 1) & mask;
+		}
+
+		m_buckets[index] = id;
+	}
+}
+
+DTO_END
\ No newline at end of file
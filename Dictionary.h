@@ -0,0 +1,105 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Dictionary_H__
+#define __Dto_Dictionary_H__
+
+#include <vector>
+
+DTO_BEGIN
+
+	/*!
+	 A table of entry keys that lets a binary DTO layout replace repeated keys with small integer ids.
+
+	 An encoded key is stored in place of a regular zero-terminated key and starts with a 0xFF byte, which
+	 never appears in a UTF-8 text, followed by one or two base-255 digits in a [1, 255] range, so an encoded
+	 key never contains a zero byte.
+
+	 A dictionary may be static, when both sides add the same keys in the same order, or adaptive, when both
+	 a writer and a reader call learn() for each message of a stream, so keys of previous messages are encoded
+	 as ids in the following ones.
+	 */
+	class DtoKeyDictionary
+	{
+	public:
+
+		//! A maximum number of keys in a dictionary.
+		enum { MaxKeys = 255 * 255 };
+
+		//! A maximum length of an encoded key.
+		enum { MaxEncodedLength = 3 };
+
+								//! Constructs an empty DtoKeyDictionary instance.
+								DtoKeyDictionary();
+
+		//! Adds a key to a dictionary if it was not added before and returns it's id, returns -1 if a dictionary is full.
+		int32					add(const DtoStringView& key);
+
+		//! Adds keys of all key-value nodes of a DTO in a depth-first order.
+		void					learn(const Dto& dto);
+
+		//! Returns a key id or -1 if a key is missing.
+		int32					find(const DtoStringView& key) const;
+
+		//! Returns a key with specified id.
+		const DtoStringView&	key(int32 id) const;
+
+		//! Returns a total number of keys in a dictionary.
+		int32					size() const;
+
+		//! Replaces an encoded key with a dictionary key, returns false if a key is malformed or is missing.
+		bool					resolve(DtoStringView& key) const;
+
+		//! Writes an encoded key to an output buffer and returns a total number of written bytes.
+		static int32			encode(int32 id, byte* output);
+
+		//! Returns true if a key is encoded.
+		static bool				isEncoded(const DtoStringView& key);
+
+	private:
+
+		//! Returns a bucket index for a specified key.
+		uint32					bucket(const DtoStringView& key) const;
+
+		//! Rebuilds a hash table with a specified number of buckets.
+		void					rehash(int32 count);
+
+	private:
+
+								//! Dictionaries are not copyable.
+								DtoKeyDictionary(const DtoKeyDictionary&);
+		DtoKeyDictionary&		operator = (const DtoKeyDictionary&);
+
+	private:
+
+		DtoArena					m_storage;	//!< Key characters, stored so that added keys are never moved.
+		std::vector<DtoStringView>	m_keys;		//!< Keys indexed by ids.
+		std::vector<int32>			m_buckets;	//!< An open addressing hash table that maps keys to ids, empty buckets are -1.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Dictionary_H__	*/
\ No newline at end of file
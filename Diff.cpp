@@ -0,0 +1,368 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Diff.h"
+
+#include <string.h>
+
+DTO_BEGIN
+
+extern DtoErrorHandler g_errorHandler;
+
+//! An empty key-value node used in place of missing documents, dtoCompare uses it as well.
+extern const byte g_emptyNode[5] = { 5, 0, 0, 0, DtoEnd };
+
+//! A raw view of an encoded entry.
+struct DtoRawEntry
+{
+	const byte*		start;	//!< An entry start, points to a type tag.
+	const byte*		value;	//!< An encoded value start.
+	const byte*		next;	//!< A next entry start.
+	DtoStringView	key;	//!< An entry key.
+	DtoValueType	type;	//!< An entry value type.
+};
+
+// ** dtoIsNode
+static bool dtoIsNode(DtoValueType type)
+{
+	return type == DtoKeyValue || type == DtoSequence;
+}
+
+// ** dtoNodeLength
+static int32 dtoNodeLength(const byte* node)
+{
+	// Nested nodes start at arbitrary offsets, so a length prefix is copied instead of being dereferenced
+	int32 length;
+	memcpy(&length, node, sizeof(length));
+	return length;
+}
+
+// ** dtoNodeEnd
+static const byte* dtoNodeEnd(const byte* node)
+{
+	return node + dtoNodeLength(node);
+}
+
+// ** dtoKeyEquals
+static bool dtoKeyEquals(const DtoStringView& a, const DtoStringView& b)
+{
+	return a.length == b.length && memcmp(a.value, b.value, a.length) == 0;
+}
+
+// ** dtoReadEntry
+static bool dtoReadEntry(const byte*& input, const byte* end, DtoRawEntry& entry)
+{
+	DtoValue		   value;
+	DtoByteBufferInput stream(input, static_cast<int32>(end - input));
+
+	entry.start = input;
+	input	   += BinaryDtoReader::decode(stream, entry.key, value);
+	entry.type  = value.type;
+
+	if (value.type == DtoEnd)
+	{
+		return false;
+	}
+
+	// A value follows a type tag and a zero terminated key
+	entry.value = entry.start + entry.key.length + 2;
+
+	// Skip a nested node body
+	if (dtoIsNode(value.type))
+	{
+		input += value.binary.length;
+	}
+
+	entry.next = input;
+	return true;
+}
+
+// ** dtoFindEntry
+static bool dtoFindEntry(const byte* node, const DtoStringView& key, const byte*& hint, DtoRawEntry& entry)
+{
+	const byte* end   = dtoNodeEnd(node);
+	const byte* input = hint;
+
+	// Most documents keep the same entry order, so an entry that follows a previous match is checked first
+	if (dtoReadEntry(input, end, entry) && dtoKeyEquals(entry.key, key))
+	{
+		hint = input;
+		return true;
+	}
+
+	for (input = node + sizeof(int32); dtoReadEntry(input, end, entry);)
+	{
+		if (dtoKeyEquals(entry.key, key))
+		{
+			hint = input;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ** dtoWriteBytes
+static void dtoWriteBytes(std::vector<byte>& output, const byte* data, int64 length)
+{
+	output.insert(output.end(), data, data + length);
+}
+
+// ** dtoWriteHeader
+static void dtoWriteHeader(std::vector<byte>& output, DtoValueType type, const DtoStringView& key)
+{
+	output.push_back(static_cast<byte>(type));
+	dtoWriteBytes(output, reinterpret_cast<const byte*>(key.value), key.length);
+	output.push_back(0);
+}
+
+// ** dtoBeginNode
+static size_t dtoBeginNode(std::vector<byte>& output)
+{
+	size_t offset = output.size();
+	output.resize(offset + sizeof(int32));
+	return offset;
+}
+
+// ** dtoEndNode
+static void dtoEndNode(std::vector<byte>& output, size_t offset)
+{
+	output.push_back(DtoEnd);
+	int32 length = static_cast<int32>(output.size() - offset);
+	memcpy(&output[offset], &length, sizeof(length));
+}
+
+// ** dtoWriteSet
+static void dtoWriteSet(std::vector<byte>& output, const DtoRawEntry& entry)
+{
+	// Scalars are written as is
+	if (!dtoIsNode(entry.type) && entry.type != DtoNull)
+	{
+		dtoWriteBytes(output, entry.start, entry.next - entry.start);
+		return;
+	}
+
+	// Containers and nulls would be confused with nested patches and unsets, so they are wrapped into a single item sequence
+	static const DtoStringView index = DtoStringView::construct("0");
+
+	dtoWriteHeader(output, DtoSequence, entry.key);
+	size_t node = dtoBeginNode(output);
+	dtoWriteHeader(output, entry.type, index);
+	dtoWriteBytes(output, entry.value, entry.next - entry.value);
+	dtoEndNode(output, node);
+}
+
+// ** dtoDiffNode
+static void dtoDiffNode(const byte* a, const byte* b, std::vector<byte>& output)
+{
+	DtoRawEntry source;
+	DtoRawEntry target;
+	const byte* hint = b + sizeof(int32);
+
+	// Unset, replace or patch entries of a source node in order
+	for (const byte* input = a + sizeof(int32); dtoReadEntry(input, dtoNodeEnd(a), source);)
+	{
+		if (!dtoFindEntry(b, source.key, hint, target))
+		{
+			dtoWriteHeader(output, DtoNull, source.key);
+			continue;
+		}
+
+		// Nested nodes start with a length prefix, so different subtrees are usually rejected without touching their bodies
+		int64 length = source.next - source.value;
+
+		if (source.type == target.type && length == target.next - target.value && memcmp(source.value, target.value, length) == 0)
+		{
+			continue;
+		}
+
+		if (!dtoIsNode(source.type) || source.type != target.type)
+		{
+			dtoWriteSet(output, target);
+			continue;
+		}
+
+		// Both entries are nodes of the same type, so write a nested patch unless nodes differ only by an entry order
+		size_t start = output.size();
+		dtoWriteHeader(output, DtoKeyValue, source.key);
+		size_t node = dtoBeginNode(output);
+		dtoDiffNode(source.value, target.value, output);
+
+		if (output.size() == node + sizeof(int32))
+		{
+			output.resize(start);
+		}
+		else
+		{
+			dtoEndNode(output, node);
+		}
+	}
+
+	// Append entries that are missing in a source node
+	hint = a + sizeof(int32);
+
+	for (const byte* input = b + sizeof(int32); dtoReadEntry(input, dtoNodeEnd(b), target);)
+	{
+		if (!dtoFindEntry(a, target.key, hint, source))
+		{
+			dtoWriteSet(output, target);
+		}
+	}
+}
+
+// ** dtoWriteOperation
+static bool dtoWriteOperation(std::vector<byte>& output, const DtoRawEntry& operation)
+{
+	if (operation.type != DtoSequence)
+	{
+		dtoWriteBytes(output, operation.start, operation.next - operation.start);
+		return true;
+	}
+
+	// Unwrap a single item sequence
+	DtoRawEntry item;
+	const byte* input = operation.value + sizeof(int32);
+
+	if (!dtoReadEntry(input, dtoNodeEnd(operation.value), item))
+	{
+		return false;
+	}
+
+	dtoWriteHeader(output, item.type, operation.key);
+	dtoWriteBytes(output, item.value, item.next - item.value);
+	return true;
+}
+
+// ** dtoApplyNode
+static bool dtoApplyNode(const byte* base, const byte* patch, std::vector<byte>& output)
+{
+	DtoRawEntry entry;
+	DtoRawEntry operation;
+	const byte* operations	 = patch + sizeof(int32);
+	bool		hasOperation = dtoReadEntry(operations, dtoNodeEnd(patch), operation);
+
+	// Operations follow base entries in order, so a single cursor is enough to merge them
+	for (const byte* input = base + sizeof(int32); dtoReadEntry(input, dtoNodeEnd(base), entry);)
+	{
+		if (!hasOperation || !dtoKeyEquals(entry.key, operation.key))
+		{
+			dtoWriteBytes(output, entry.start, entry.next - entry.start);
+			continue;
+		}
+
+		switch (operation.type)
+		{
+		case DtoNull:
+			break;
+
+		case DtoKeyValue:
+			{
+				if (!dtoIsNode(entry.type))
+				{
+					return false;
+				}
+
+				dtoWriteHeader(output, entry.type, entry.key);
+				size_t node = dtoBeginNode(output);
+
+				if (!dtoApplyNode(entry.value, operation.value, output))
+				{
+					return false;
+				}
+
+				dtoEndNode(output, node);
+			}
+			break;
+
+		default:
+			if (!dtoWriteOperation(output, operation))
+			{
+				return false;
+			}
+		}
+
+		hasOperation = dtoReadEntry(operations, dtoNodeEnd(patch), operation);
+	}
+
+	// All remaining operations should add new entries
+	for (; hasOperation; hasOperation = dtoReadEntry(operations, dtoNodeEnd(patch), operation))
+	{
+		if (operation.type == DtoNull || operation.type == DtoKeyValue || !dtoWriteOperation(output, operation))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// ** dtoDiff
+Dto dtoDiff(const Dto& a, const Dto& b, std::vector<byte>& output)
+{
+	const byte* source = a ? a.data() : g_emptyNode;
+	const byte* target = b ? b.data() : g_emptyNode;
+	int32		length = dtoNodeLength(source);
+
+	output.clear();
+	size_t root = dtoBeginNode(output);
+
+	// Skip a whole document walk when layouts are equal
+	if (length != dtoNodeLength(target) || memcmp(source, target, length) != 0)
+	{
+		dtoDiffNode(source, target, output);
+	}
+
+	dtoEndNode(output, root);
+
+	return Dto(&output[0], static_cast<int32>(output.size()));
+}
+
+// ** dtoApplyPatch
+Dto dtoApplyPatch(const Dto& base, const Dto& patch, std::vector<byte>& output)
+{
+	output.clear();
+	size_t root = dtoBeginNode(output);
+
+	if (!dtoApplyNode(base ? base.data() : g_emptyNode, patch ? patch.data() : g_emptyNode, output))
+	{
+		if (g_errorHandler)
+		{
+			char text[DtoTokenInput::MaxMessageLength];
+			snprintf(text, sizeof(text), "error: a patch does not match a base document");
+			g_errorHandler(text);
+		}
+
+		output.clear();
+		return Dto();
+	}
+
+	dtoEndNode(output, root);
+
+	return Dto(&output[0], static_cast<int32>(output.size()));
+}
+
+DTO_END
\ No newline at end of file
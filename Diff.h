@@ -0,0 +1,57 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Diff_H__
+#define __Dto_Diff_H__
+
+#include <vector>
+
+DTO_BEGIN
+
+	/*!
+	 Computes a structural patch that transforms a document a into a document b and writes it to an output buffer.
+	 A patch is a key-value DTO that mirrors a structure of a source document, each entry is an operation on a
+	 source entry with the same key:
+
+	 - a null value unsets an entry;
+	 - a key-value node is a nested patch applied to a key-value or sequence entry;
+	 - a single item sequence sets or replaces an entry with a container or a null value;
+	 - any other value sets or replaces an entry with that value.
+
+	 Operations on existing entries follow their order in a source document and are followed by new entries, so a
+	 patch can be applied in a single pass. Identical subtrees are skipped by comparing their length prefixed bytes.
+	 Sequence items are matched by index. Both documents are expected to use the same key dictionary, if any.
+	 Returns a patch, which is empty when documents are equal.
+	 */
+	Dto dtoDiff(const Dto& a, const Dto& b, std::vector<byte>& output);
+
+	//! Applies a patch produced by dtoDiff to a base document in a single pass and writes a result to an output buffer.
+	//! Returns an empty DTO if a patch does not match a base document.
+	Dto dtoApplyPatch(const Dto& base, const Dto& patch, std::vector<byte>& output);
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Diff_H__	*/
\ No newline at end of file
@@ -45,13 +45,15 @@ void dtoSetErrorHandler(DtoErrorHandler value)
 Dto::Dto()
 	: m_data(0)
 	, m_capacity(0)
+	, m_dictionary(NULL)
 {
 }
 
 // ** Dto::Dto
-Dto::Dto(const byte* data, int32 capacity)
+Dto::Dto(const byte* data, int32 capacity, const DtoKeyDictionary* dictionary)
 	: m_data(data)
 	, m_capacity(capacity)
+	, m_dictionary(dictionary)
 {
 	assert(capacity >= 0);
 	assert(data != 0);
@@ -89,7 +91,7 @@ const byte* Dto::data() const
 // ** Dto::iter
 DtoIter Dto::iter() const
 {
-	return DtoIter(m_data + sizeof(int32), m_capacity);
+	return DtoIter(m_data + sizeof(int32), m_capacity, m_dictionary);
 }
 
 // ** Dto::find
@@ -162,6 +164,35 @@ DtoIter Dto::findDescendant(cstring key) const
 	return i;
 }
 
+// ** Dto::find
+DtoIter Dto::find(const DtoFieldPath& path) const
+{
+	DtoIter i(NULL, 0);
+	Dto dto = *this;
+
+	for (int32 index = 0; index < path.size(); index++)
+	{
+		if (index > 0)
+		{
+			if (i != DtoSequence && i != DtoKeyValue)
+			{
+				return DtoIter(NULL, 0);
+			}
+
+			dto = i.toDto();
+		}
+
+		i = dto.find(path.key(index));
+
+		if (!i)
+		{
+			return i;
+		}
+	}
+
+	return i;
+}
+
 // ** Dto::entryCount
 int32 Dto::entryCount() const
 {
@@ -178,10 +209,66 @@ int32 Dto::entryCount() const
 
 // ---------------------------------------------------- DtoIter ---------------------------------------------------- //
 
+/*!
+ Copies values of a sequence in which all items have the same type without decoding each entry.
+
+ Sequence items are keyed by decimal indices, so all items with the same number of index digits
+ have the same size. Each run of such items is copied with a constant stride, while types, key
+ lengths and zero terminators are validated once per run. Returns -1 if a sequence layout does
+ not match, so a caller can fall back to a regular iteration.
+ */
+template<typename TValue, typename TOutput>
+static int32 extractRuns(const byte* items, const byte* end, DtoValueType type, TOutput* output, int32 capacity)
+{
+	int32 count = 0;
+
+	for (int32 digits = 1, first = 0, last = 10; items < end; digits++, first = last, last *= 10)
+	{
+		int32 stride = 2 + digits + sizeof(TValue);
+		int32 total  = static_cast<int32>(end - items) / stride;
+		int32 length = total < last - first ? total : last - first;
+
+		if (length == 0 || count + length > capacity)
+		{
+			return -1;
+		}
+
+		// Accumulate mismatches instead of branching on each item
+		int32 mismatch = 0;
+
+		for (int32 i = 0; i < length; i++)
+		{
+			const byte* item = items + i * stride;
+
+			mismatch |= (item[0] ^ type) | item[1 + digits];
+
+			for (int32 j = 1; j <= digits; j++)
+			{
+				mismatch |= item[j] == 0;
+			}
+
+			TValue value;
+			memcpy(&value, item + 2 + digits, sizeof(value));
+			output[count + i] = static_cast<TOutput>(value);
+		}
+
+		if (mismatch)
+		{
+			return -1;
+		}
+
+		items += length * stride;
+		count += length;
+	}
+
+	return items == end ? count : -1;
+}
+
 // ** DtoIter::DtoIter
-DtoIter::DtoIter(const byte* input, int32 length)
+DtoIter::DtoIter(const byte* input, int32 length, const DtoKeyDictionary* dictionary)
 	: m_input(input)
 	, m_length(length)
+	, m_dictionary(dictionary)
 {
 	memset(&m_key, 0, sizeof(m_key));
 	memset(&m_value, 0, sizeof(m_value));
@@ -210,7 +297,7 @@ bool DtoIter::next()
 {
 	// Decode next entry from an input stream.
 	DtoByteBufferInput input(m_input, m_length);
-	m_input += BinaryDtoReader::decode(input, m_key, m_value);
+	m_input += BinaryDtoReader::decode(input, m_key, m_value, m_dictionary);
 
 	// Skip a nested DTO body
 	if (m_value.type == DtoKeyValue || m_value.type == DtoSequence)
@@ -271,11 +358,193 @@ double DtoIter::toDouble() const
 	return m_value.number;
 }
 
+// ** DtoIter::value
+const DtoValue& DtoIter::value() const
+{
+	return m_value;
+}
+
+// ** DtoIter::isPackedArray
+bool DtoIter::isPackedArray() const
+{
+	return m_value.type == DtoBinary && DtoPackedArray::elementSize(m_value.binary.subtype) > 0;
+}
+
+// ** DtoIter::toPackedArray
+DtoPackedArray DtoIter::toPackedArray() const
+{
+	assert(isPackedArray());
+
+	DtoPackedArray result;
+	result.data  = m_value.binary.data;
+	result.type  = static_cast<DtoPackedType>(m_value.binary.subtype);
+	result.count = m_value.binary.length / result.elementSize();
+	return result;
+}
+
+// ** DtoIter::extractDoubles
+int32 DtoIter::extractDoubles(double* output, int32 capacity) const
+{
+	if (isPackedArray())
+	{
+		DtoPackedArray array = toPackedArray();
+
+		if (array.type != DtoPackedDouble || array.count > capacity)
+		{
+			return -1;
+		}
+
+		memcpy(output, array.data, array.count * sizeof(double));
+		return array.count;
+	}
+
+	if (m_value.type != DtoSequence)
+	{
+		return -1;
+	}
+
+	const byte* items = m_value.binary.data + sizeof(int32);
+	const byte* end   = m_value.binary.data + m_value.binary.length - 1;
+	int32		count = extractRuns<double>(items, end, DtoDouble, output, capacity);
+
+	if (count >= 0)
+	{
+		return count;
+	}
+
+	// Fall back to a regular iteration if a sequence layout does not match
+	DtoIter i = toDto().iter();
+	count = 0;
+
+	while (i.next())
+	{
+		if (count == capacity || i != DtoDouble)
+		{
+			return -1;
+		}
+
+		output[count++] = i.m_value.number;
+	}
+
+	return count;
+}
+
+// ** DtoIter::extractInt64s
+int32 DtoIter::extractInt64s(int64* output, int32 capacity) const
+{
+	if (isPackedArray())
+	{
+		DtoPackedArray array = toPackedArray();
+
+		if ((array.type != DtoPackedInt64 && array.type != DtoPackedInt32) || array.count > capacity)
+		{
+			return -1;
+		}
+
+		if (array.type == DtoPackedInt64)
+		{
+			memcpy(output, array.data, array.count * sizeof(int64));
+			return array.count;
+		}
+
+		for (int32 i = 0; i < array.count; i++)
+		{
+			int32 value;
+			memcpy(&value, static_cast<const byte*>(array.data) + i * sizeof(int32), sizeof(int32));
+			output[i] = value;
+		}
+
+		return array.count;
+	}
+
+	if (m_value.type != DtoSequence)
+	{
+		return -1;
+	}
+
+	// A type of the first item selects a stride
+	const byte* items = m_value.binary.data + sizeof(int32);
+	const byte* end   = m_value.binary.data + m_value.binary.length - 1;
+	int32		count = *items == DtoInt32 ? extractRuns<int32>(items, end, DtoInt32, output, capacity) : extractRuns<int64>(items, end, DtoInt64, output, capacity);
+
+	if (count >= 0)
+	{
+		return count;
+	}
+
+	// Fall back to a regular iteration if a sequence layout does not match
+	DtoIter i = toDto().iter();
+	count = 0;
+
+	while (i.next())
+	{
+		if (count == capacity || (i != DtoInt32 && i != DtoInt64))
+		{
+			return -1;
+		}
+
+		output[count++] = i == DtoInt32 ? i.m_value.int32 : i.m_value.int64;
+	}
+
+	return count;
+}
+
 // ** DtoIter::toDto
 Dto DtoIter::toDto() const
 {
 	assert(m_value.type == DtoSequence || m_value.type == DtoKeyValue);
-	return Dto(m_value.binary.data, m_value.binary.length);
+	return Dto(m_value.binary.data, m_value.binary.length, m_dictionary);
+}
+
+// ---------------------------------------------------- DtoPackedArray ---------------------------------------------------- //
+
+// ** DtoPackedArray::elementSize
+int32 DtoPackedArray::elementSize() const
+{
+	return elementSize(static_cast<byte>(type));
+}
+
+// ** DtoPackedArray::elementSize
+int32 DtoPackedArray::elementSize(byte subtype)
+{
+	switch (subtype)
+	{
+	case DtoPackedInt32:	return sizeof(int32);
+	case DtoPackedInt64:	return sizeof(int64);
+	case DtoPackedDouble:	return sizeof(double);
+	case DtoPackedBool:		return 1;
+	}
+
+	return 0;
+}
+
+// ** DtoPackedArray::construct
+DtoPackedArray DtoPackedArray::construct(const int32* values, int32 count)
+{
+	DtoPackedArray result = { values, DtoPackedInt32, count };
+	return result;
+}
+
+// ** DtoPackedArray::construct
+DtoPackedArray DtoPackedArray::construct(const int64* values, int32 count)
+{
+	DtoPackedArray result = { values, DtoPackedInt64, count };
+	return result;
+}
+
+// ** DtoPackedArray::construct
+DtoPackedArray DtoPackedArray::construct(const double* values, int32 count)
+{
+	DtoPackedArray result = { values, DtoPackedDouble, count };
+	return result;
+}
+
+// ** DtoPackedArray::construct
+DtoPackedArray DtoPackedArray::construct(const bool* values, int32 count)
+{
+	assert(sizeof(bool) == 1);
+	DtoPackedArray result = { values, DtoPackedBool, count };
+	return result;
 }
 
 // ---------------------------------------------------- DtoStringView ---------------------------------------------------- //
@@ -34,11 +34,24 @@ SOFTWARE.
 #define DTO_BEGIN	namespace DTO_NAMESPACE {
 #define DTO_END		}
 
+#if defined(__AVX2__)
+	#define DTO_AVX2
+#endif	//	#if defined(__AVX2__)
+
+#if defined(__SSE4_2__) || defined(__AVX__)
+	#define DTO_SSE42
+#endif	//	#if defined(__SSE4_2__) || defined(__AVX__)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define DTO_SSE2
+#endif	//	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
 DTO_BEGIN
 
 	typedef unsigned char		byte;
 	typedef unsigned short		uint16;
 	typedef int					int32;
+	typedef unsigned int		uint32;
 	typedef long long			int64;
 	typedef unsigned long long	uint64;
 	typedef byte				decimal128[16];
@@ -51,6 +64,9 @@ DTO_BEGIN
 		, DtoJson	//!< A JavaScript object notation file format.
 		, DtoYaml	//!< A Yaml file format.
 		, DtoLson	//!< A Lua script object notation file format.
+		, DtoCompact	//!< A compact binary format with variable-length integers and tagged small values.
+		, DtoMsgPack	//!< A MessagePack binary format.
+		, DtoCbor		//!< A concise binary object representation format (RFC 8949).
 	};
 
 	//! Enumeration of all available value types.
@@ -113,6 +129,46 @@ DTO_BEGIN
 		int32					length;		//!< A total number of bytes comprising the binary blob.
 	};
 
+	//! Binary blob subtypes used to store packed homogeneous arrays, elements are stored contiguously in a native byte order.
+	enum DtoPackedType
+	{
+		  DtoPackedInt32	= 0x80	//!< An array of 32-bit signed integers.
+		, DtoPackedInt64	= 0x81	//!< An array of 64-bit signed integers.
+		, DtoPackedDouble	= 0x82	//!< An array of 64-bit decimal floating point values.
+		, DtoPackedBool		= 0x83	//!< An array of booleans stored as single bytes.
+	};
+
+	//! A view of a packed homogeneous array.
+	/*!
+	 Elements of an array that was read from a binary DTO are not aligned, because a binary blob may start at
+	 any offset inside a document. A data pointer should never be cast to an element pointer and indexed, elements
+	 should be copied out with memcpy or with DtoIter::extractDoubles and DtoIter::extractInt64s instead.
+	 */
+	struct DtoPackedArray
+	{
+		const void*				data;		//!< A pointer to the first array element, it is usually misaligned for an element type.
+		DtoPackedType			type;		//!< An array element type.
+		int32					count;		//!< A total number of array elements.
+
+		//! Returns a size of a single array element in bytes.
+		int32					elementSize() const;
+
+		//! Returns a size of a packed array element for a specified binary subtype or 0 if it is not a packed array subtype.
+		static int32			elementSize(byte subtype);
+
+		//! Constructs a packed array of 32-bit signed integers.
+		static DtoPackedArray	construct(const int32* values, int32 count);
+
+		//! Constructs a packed array of 64-bit signed integers.
+		static DtoPackedArray	construct(const int64* values, int32 count);
+
+		//! Constructs a packed array of 64-bit decimal floating point values.
+		static DtoPackedArray	construct(const double* values, int32 count);
+
+		//! Constructs a packed array of booleans.
+		static DtoPackedArray	construct(const bool* values, int32 count);
+	};
+
 	//! A regular expression value.
 	struct DtoRegularExpression
 	{
@@ -154,6 +210,9 @@ DTO_BEGIN
 		};
 	};
 
+	class DtoKeyDictionary;
+	class DtoFieldPath;
+
 	//! An iterator is used to traverse entries stored inside a DTO.
 	class DtoIter
 	{
@@ -190,18 +249,34 @@ DTO_BEGIN
 		//! Returns double iterator value.
 		double					toDouble() const;
 
+		//! Returns a raw iterator value of any type.
+		const DtoValue&			value() const;
+
+		//! Returns true if this iterator points to a packed homogeneous array.
+		bool					isPackedArray() const;
+
+		//! Returns packed array iterator value, array elements are not aligned and should be read with memcpy.
+		DtoPackedArray			toPackedArray() const;
+
+		//! Copies items of a sequence of doubles or a packed array of doubles, returns a total number of copied items or -1 if types do not match or an output is too small.
+		int32					extractDoubles(double* output, int32 capacity) const;
+
+		//! Copies items of a sequence of 32-bit or 64-bit integers or a packed integer array, returns a total number of copied items or -1 if types do not match or an output is too small.
+		int32					extractInt64s(int64* output, int32 capacity) const;
+
 		//! Returns a DTO this iterator points to.
 		Dto						toDto() const;
 
 	private:
 
 								//!< Constructs a DtoIter instance.
-								DtoIter(const byte* input, int32 length);
+								DtoIter(const byte* input, int32 length, const DtoKeyDictionary* dictionary = NULL);
 
 	private:
 
 		const byte*				m_input;	//!< An input DTO data.
 		int32					m_length;	//!< An input DTO length.
+		const DtoKeyDictionary*	m_dictionary;	//!< A dictionary used to resolve encoded keys.
 		DtoStringView			m_key;		//!< Entry key this iterator points to.
 		DtoValue				m_value;	//!< Entry value this iterator points to.
 	};
@@ -214,8 +289,8 @@ DTO_BEGIN
 								//! Constructs an empty DTO instance.
 								Dto();
 
-								//! Constructs a DTO instance from an array of bytes.
-								Dto(const byte* data, int32 capacity);
+								//! Constructs a DTO instance from an array of bytes, encoded keys are resolved through an optional dictionary.
+								Dto(const byte* data, int32 capacity, const DtoKeyDictionary* dictionary = NULL);
 
 								//! Returns true if this DTO instance is valid (has a non-zero length and valid data pointer).
 								operator bool() const;
@@ -241,6 +316,9 @@ DTO_BEGIN
 		//! Searches for an entry with specified key, including nested objects.
 		DtoIter					findDescendant(cstring key) const;
 
+		//! Searches for a nested entry at a compiled path.
+		DtoIter					find(const DtoFieldPath& path) const;
+
 		//! Returns a total number of entries inside this DTO.
 		int32					entryCount() const;
 
@@ -248,6 +326,7 @@ DTO_BEGIN
 
 		const byte*				m_data;		//!< An array of bytes with encoded data.
 		int32					m_capacity;	//!< Data buffer capacity.
+		const DtoKeyDictionary*	m_dictionary;	//!< A dictionary used to resolve encoded keys.
 	};
 
 	/*!
@@ -360,8 +439,23 @@ DTO_BEGIN
 DTO_END
 
 #include "ByteBuffer.h"
+#include "Dictionary.h"
 #include "Bson.h"
+#include "Compact.h"
+#include "MsgPack.h"
+#include "Cbor.h"
 #include "Json.h"
 #include "Yaml.h"
+#include "Lson.h"
+#include "File.h"
+#include "Storage.h"
+#include "Parallel.h"
+#include "Tape.h"
+#include "Hash.h"
+#include "Diff.h"
+#include "Delta.h"
+#include "Index.h"
+#include "Compare.h"
+#include "Arrow.h"
 
 #endif	/*	#ifndef __Dto_H__	*/
\ No newline at end of file
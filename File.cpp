@@ -0,0 +1,226 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "File.h"
+
+#include <assert.h>
+
+#ifdef _WINDOWS
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif	//	#ifdef _WINDOWS
+
+DTO_BEGIN
+
+// -------------------------------------------------------- DtoMappedFile -------------------------------------------------------- //
+
+// ** DtoMappedFile::DtoMappedFile
+DtoMappedFile::DtoMappedFile()
+	: m_data(NULL)
+	, m_size(0)
+#ifdef _WINDOWS
+	, m_file(NULL)
+	, m_mapping(NULL)
+#endif	//	#ifdef _WINDOWS
+{
+}
+
+// ** DtoMappedFile::~DtoMappedFile
+DtoMappedFile::~DtoMappedFile()
+{
+	close();
+}
+
+// ** DtoMappedFile::operator bool
+DtoMappedFile::operator bool() const
+{
+	return m_data != NULL;
+}
+
+// ** DtoMappedFile::data
+const byte* DtoMappedFile::data() const
+{
+	return m_data;
+}
+
+// ** DtoMappedFile::size
+int64 DtoMappedFile::size() const
+{
+	return m_size;
+}
+
+#ifdef _WINDOWS
+
+// ** DtoMappedFile::size
+int64 DtoMappedFile::size(cstring path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA info;
+
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info))
+	{
+		return -1;
+	}
+
+	return (static_cast<int64>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+}
+
+// ** DtoMappedFile::open
+bool DtoMappedFile::open(cstring path)
+{
+	close();
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	m_data    = reinterpret_cast<const byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	m_size    = size.QuadPart;
+	m_file    = file;
+	m_mapping = mapping;
+
+	if (m_data == NULL)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+// ** DtoMappedFile::close
+void DtoMappedFile::close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+	}
+	if (m_file)
+	{
+		CloseHandle(m_file);
+	}
+
+	m_data    = NULL;
+	m_size    = 0;
+	m_file    = NULL;
+	m_mapping = NULL;
+}
+
+#else
+
+// ** DtoMappedFile::size
+int64 DtoMappedFile::size(cstring path)
+{
+	struct stat info;
+
+	if (stat(path, &info) != 0)
+	{
+		return -1;
+	}
+
+	return info.st_size;
+}
+
+// ** DtoMappedFile::open
+bool DtoMappedFile::open(cstring path)
+{
+	close();
+
+	int descriptor = ::open(path, O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+
+	if (fstat(descriptor, &info) != 0 || info.st_size == 0)
+	{
+		::close(descriptor);
+		return false;
+	}
+
+	// A mapping stays valid after a file descriptor is closed
+	void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	::close(descriptor);
+
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// Mapped files are usually scanned from the beginning to the end
+	madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+	m_data = reinterpret_cast<const byte*>(data);
+	m_size = info.st_size;
+
+	return true;
+}
+
+// ** DtoMappedFile::close
+void DtoMappedFile::close()
+{
+	if (m_data)
+	{
+		munmap(const_cast<byte*>(m_data), m_size);
+	}
+
+	m_data = NULL;
+	m_size = 0;
+}
+
+#endif	//	#ifdef _WINDOWS
+
+DTO_END
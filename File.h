@@ -0,0 +1,78 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_File_H__
+#define __Dto_File_H__
+
+DTO_BEGIN
+
+	//! A read-only view of a whole file mapped to memory.
+	class DtoMappedFile
+	{
+	public:
+
+								//! Constructs an empty DtoMappedFile instance.
+								DtoMappedFile();
+
+								~DtoMappedFile();
+
+								//! Returns true if a file is mapped.
+								operator bool() const;
+
+		//! Maps a file at specified path to memory and returns true on success.
+		bool					open(cstring path);
+
+		//! Unmaps a file.
+		void					close();
+
+		//! Returns a pointer to the first byte of a mapped file.
+		const byte*				data() const;
+
+		//! Returns a total file size in bytes.
+		int64					size() const;
+
+		//! Returns a size of a file at specified path in bytes or -1 if it can't be queried, so a file that failed to map can be told apart from an empty one.
+		static int64			size(cstring path);
+
+	private:
+
+								//! Mapped files are not copyable.
+								DtoMappedFile(const DtoMappedFile&);
+		DtoMappedFile&			operator = (const DtoMappedFile&);
+
+	private:
+
+		const byte*				m_data;		//!< A pointer to a mapped file contents.
+		int64					m_size;		//!< A mapped file size.
+	#ifdef _WINDOWS
+		void*					m_file;		//!< A file handle.
+		void*					m_mapping;	//!< A file mapping handle.
+	#endif	//	#ifdef _WINDOWS
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_File_H__	*/
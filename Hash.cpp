@@ -0,0 +1,211 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Hash.h"
+
+#include <string.h>
+
+DTO_BEGIN
+
+// XXH64 prime constants
+static const uint64 Prime1 = 11400714785074694791ULL;
+static const uint64 Prime2 = 14029467366897019727ULL;
+static const uint64 Prime3 = 1609587929392839161ULL;
+static const uint64 Prime4 = 9650029242287828579ULL;
+static const uint64 Prime5 = 2870177450012600261ULL;
+
+// ** dtoRotl64
+static uint64 dtoRotl64(uint64 value, int32 bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// ** dtoRead64
+static uint64 dtoRead64(const byte* bytes)
+{
+	uint64 value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+// ** dtoRead32
+static uint32 dtoRead32(const byte* bytes)
+{
+	uint32 value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+// ** dtoHashRound
+static uint64 dtoHashRound(uint64 accumulator, uint64 input)
+{
+	accumulator += input * Prime2;
+	accumulator  = dtoRotl64(accumulator, 31);
+	return accumulator * Prime1;
+}
+
+// ** dtoHashMerge
+static uint64 dtoHashMerge(uint64 accumulator, uint64 value)
+{
+	accumulator ^= dtoHashRound(0, value);
+	return accumulator * Prime1 + Prime4;
+}
+
+// ** dtoHashAvalanche
+static uint64 dtoHashAvalanche(uint64 hash)
+{
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+// ** dtoHashBytes
+uint64 dtoHashBytes(const void* data, int64 length, uint64 seed)
+{
+	const byte* bytes = reinterpret_cast<const byte*>(data);
+	const byte* end   = bytes + length;
+	uint64		hash;
+
+	if (length >= 32)
+	{
+		// Consume 32-byte stripes with four independent lanes
+		uint64 v1 = seed + Prime1 + Prime2;
+		uint64 v2 = seed + Prime2;
+		uint64 v3 = seed;
+		uint64 v4 = seed - Prime1;
+
+		for (const byte* limit = end - 32; bytes <= limit; bytes += 32)
+		{
+			v1 = dtoHashRound(v1, dtoRead64(bytes));
+			v2 = dtoHashRound(v2, dtoRead64(bytes + 8));
+			v3 = dtoHashRound(v3, dtoRead64(bytes + 16));
+			v4 = dtoHashRound(v4, dtoRead64(bytes + 24));
+		}
+
+		hash = dtoRotl64(v1, 1) + dtoRotl64(v2, 7) + dtoRotl64(v3, 12) + dtoRotl64(v4, 18);
+		hash = dtoHashMerge(hash, v1);
+		hash = dtoHashMerge(hash, v2);
+		hash = dtoHashMerge(hash, v3);
+		hash = dtoHashMerge(hash, v4);
+	}
+	else
+	{
+		hash = seed + Prime5;
+	}
+
+	hash += static_cast<uint64>(length);
+
+	// Consume a tail
+	for (; bytes + 8 <= end; bytes += 8)
+	{
+		hash ^= dtoHashRound(0, dtoRead64(bytes));
+		hash  = dtoRotl64(hash, 27) * Prime1 + Prime4;
+	}
+
+	if (bytes + 4 <= end)
+	{
+		hash ^= static_cast<uint64>(dtoRead32(bytes)) * Prime1;
+		hash  = dtoRotl64(hash, 23) * Prime2 + Prime3;
+		bytes += 4;
+	}
+
+	for (; bytes < end; bytes++)
+	{
+		hash ^= *bytes * Prime5;
+		hash  = dtoRotl64(hash, 11) * Prime1;
+	}
+
+	return dtoHashAvalanche(hash);
+}
+
+// ** dtoHashNode
+static uint64 dtoHashNode(const byte* data, uint64 seed)
+{
+	// A node length includes a length prefix and an end tag
+	int32		length = static_cast<int32>(dtoRead32(data));
+	const byte* input  = data + sizeof(int32);
+	const byte* end    = data + length;
+	uint64		sum    = 0;
+	uint64		count  = 0;
+
+	DtoStringView key;
+	DtoValue	  value;
+
+	while (true)
+	{
+		const byte*		   entry = input;
+		DtoByteBufferInput stream(input, static_cast<int32>(end - input));
+		input += BinaryDtoReader::decode(stream, key, value);
+
+		if (value.type == DtoEnd)
+		{
+			break;
+		}
+
+		uint64 hash;
+
+		if (value.type == DtoKeyValue || value.type == DtoSequence)
+		{
+			// Hash a type tag and a key seeded with a nested node hash, then skip a nested node body
+			hash   = dtoHashBytes(entry, key.length + 2, dtoHashNode(value.binary.data, seed));
+			input += value.binary.length;
+		}
+		else
+		{
+			// Scalar entries are hashed as is, including a type tag, a key and a value
+			hash = dtoHashBytes(entry, input - entry, seed);
+		}
+
+		// A sum does not depend on an order of entries, each hash is avalanched once more so that
+		// entries can not cancel each other out by a simple arithmetic relation between their hashes.
+		sum += dtoHashAvalanche(hash + Prime5);
+		count++;
+	}
+
+	return dtoHashAvalanche(sum ^ dtoRotl64(count * Prime1 + seed, 29));
+}
+
+// ** dtoHash
+uint64 dtoHash(const Dto& dto, DtoHashMode mode, uint64 seed)
+{
+	if (!dto)
+	{
+		return dtoHashBytes(NULL, 0, seed);
+	}
+
+	if (mode == DtoHashCanonical)
+	{
+		return dtoHashNode(dto.data(), seed);
+	}
+
+	return dtoHashBytes(dto.data(), dto.length(), seed);
+}
+
+DTO_END
\ No newline at end of file
@@ -0,0 +1,48 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Hash_H__
+#define __Dto_Hash_H__
+
+DTO_BEGIN
+
+	//! Available DTO hashing modes.
+	enum DtoHashMode
+	{
+		  DtoHashLayout		//!< Hashes a binary layout as is, so documents with the same entries in a different order differ.
+		, DtoHashCanonical	//!< Hashes entries of each key-value node independently of their order, sequences are still order-sensitive.
+	};
+
+	//! Computes a 64-bit XXH64 hash of a byte array.
+	uint64 dtoHashBytes(const void* data, int64 length, uint64 seed = 0);
+
+	//! Computes a 64-bit hash of a binary DTO. A canonical mode walks nested nodes without any allocations and combines
+	//! per-entry hashes with a commutative sum, so two documents that differ only in an entry order get the same hash.
+	uint64 dtoHash(const Dto& dto, DtoHashMode mode = DtoHashLayout, uint64 seed = 0);
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Hash_H__	*/
\ No newline at end of file
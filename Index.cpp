@@ -0,0 +1,545 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Index.h"
+#include "Order.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+DTO_BEGIN
+
+// ** dtoMix64
+static uint64 dtoMix64(uint64 value)
+{
+	// A finalizer of the SplitMix64 generator spreads all input bits over the whole output
+	value ^= value >> 30;
+	value *= 0xBF58476D1CE4E5B9ULL;
+	value ^= value >> 27;
+	value *= 0x94D049BB133111EBULL;
+	value ^= value >> 31;
+	return value;
+}
+
+// -------------------------------------------------------- DtoFieldPath -------------------------------------------------------- //
+
+// ** DtoFieldPath::DtoFieldPath
+DtoFieldPath::DtoFieldPath()
+{
+}
+
+// ** DtoFieldPath::DtoFieldPath
+DtoFieldPath::DtoFieldPath(cstring path)
+	: m_path(path)
+{
+	for (int32 i = 0, length = static_cast<int32>(m_path.size()); i < length;)
+	{
+		int32 end = i;
+
+		while (end < length && m_path[end] != '.')
+		{
+			end++;
+		}
+
+		if (end > i)
+		{
+			m_keys.push_back(i);
+			m_keys.push_back(end - i);
+		}
+
+		i = end + 1;
+	}
+}
+
+// ** DtoFieldPath::size
+int32 DtoFieldPath::size() const
+{
+	return static_cast<int32>(m_keys.size() / 2);
+}
+
+// ** DtoFieldPath::key
+DtoStringView DtoFieldPath::key(int32 index) const
+{
+	assert(index >= 0 && index < size());
+
+	DtoStringView key;
+	key.value  = m_path.c_str() + m_keys[index * 2];
+	key.length = m_keys[index * 2 + 1];
+
+	return key;
+}
+
+// ** DtoFieldPath::str
+cstring DtoFieldPath::str() const
+{
+	return m_path.c_str();
+}
+
+// -------------------------------------------------------- DtoIndexKey -------------------------------------------------------- //
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey()
+	: m_rank(Invalid)
+	, m_isInteger(false)
+	, m_length(0)
+	, m_integer(0)
+{
+}
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey(bool value)
+	: m_rank(Boolean)
+	, m_isInteger(true)
+	, m_length(0)
+	, m_integer(value ? 1 : 0)
+{
+}
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey(int32 value)
+	: m_rank(Number)
+	, m_isInteger(true)
+	, m_length(0)
+	, m_integer(value)
+{
+}
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey(int64 value)
+	: m_rank(Number)
+	, m_isInteger(true)
+	, m_length(0)
+	, m_integer(value)
+{
+}
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey(double value)
+	: m_rank(Number)
+	, m_isInteger(false)
+	, m_length(0)
+	, m_number(value)
+{
+	// Integral doubles are stored as integers, so they are equal to integer keys with the same value
+	int64 integer;
+
+	if (dtoIntegralNumber(value, integer))
+	{
+		m_integer   = integer;
+		m_isInteger = true;
+	}
+}
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey(cstring value)
+	: m_rank(String)
+	, m_isInteger(false)
+	, m_length(static_cast<int32>(strlen(value)))
+	, m_string(value)
+{
+}
+
+// ** DtoIndexKey::DtoIndexKey
+DtoIndexKey::DtoIndexKey(const DtoStringView& value)
+	: m_rank(String)
+	, m_isInteger(false)
+	, m_length(value.length)
+	, m_string(value.value)
+{
+}
+
+// ** DtoIndexKey::operator bool
+DtoIndexKey::operator bool() const
+{
+	return m_rank != Invalid;
+}
+
+// ** DtoIndexKey::compare
+int32 DtoIndexKey::compare(const DtoIndexKey& other) const
+{
+	if (m_rank != other.m_rank)
+	{
+		return m_rank < other.m_rank ? -1 : 1;
+	}
+
+	switch (m_rank)
+	{
+	case Number:
+		{
+			// Only one of number fields is used, so an inactive one is replaced with zero
+			int64  aInteger = m_isInteger ? m_integer : 0;
+			int64  bInteger = other.m_isInteger ? other.m_integer : 0;
+			double aNumber  = m_isInteger ? 0.0 : m_number;
+			double bNumber  = other.m_isInteger ? 0.0 : other.m_number;
+
+			return dtoOrderNumbers(m_isInteger, aInteger, aNumber, other.m_isInteger, bInteger, bNumber);
+		}
+
+	case String:
+		return dtoOrderBytes(m_string, m_length, other.m_string, other.m_length);
+
+	case Timestamp:
+		return dtoOrder(m_unsigned, other.m_unsigned);
+
+	case Boolean:
+	case Date:
+		return dtoOrder(m_integer, other.m_integer);
+	}
+
+	return 0;
+}
+
+// ** DtoIndexKey::operator ==
+bool DtoIndexKey::operator == (const DtoIndexKey& other) const
+{
+	return compare(other) == 0;
+}
+
+// ** DtoIndexKey::operator <
+bool DtoIndexKey::operator < (const DtoIndexKey& other) const
+{
+	return compare(other) < 0;
+}
+
+// ** DtoIndexKey::hash
+uint64 DtoIndexKey::hash() const
+{
+	uint64 value;
+
+	switch (m_rank)
+	{
+	case String:
+		value = dtoHashBytes(m_string, m_length);
+		break;
+
+	case Number:
+		if (m_isInteger)
+		{
+			value = m_unsigned;
+		}
+		else
+		{
+			memcpy(&value, &m_number, sizeof(value));
+		}
+		break;
+
+	default:
+		value = m_unsigned;
+	}
+
+	return dtoMix64(value ^ m_rank);
+}
+
+// ** DtoIndexKey::construct
+DtoIndexKey DtoIndexKey::construct(const DtoValue& value)
+{
+	DtoIndexKey key;
+
+	switch (value.type)
+	{
+	case DtoDouble:		return DtoIndexKey(value.number);
+	case DtoInt32:		return DtoIndexKey(value.int32);
+	case DtoInt64:		return DtoIndexKey(value.int64);
+	case DtoString:		return DtoIndexKey(value.string);
+	case DtoBool:		return DtoIndexKey(value.boolean);
+
+	case DtoDate:
+		key.m_rank    = Date;
+		key.m_integer = value.int64;
+		break;
+
+	case DtoTimestamp:
+		key.m_rank     = Timestamp;
+		key.m_unsigned = value.uint64;
+		break;
+
+	default:
+		// Other value types are not indexed and produce an invalid key
+		break;
+	}
+
+	return key;
+}
+
+// ------------------------------------------------------- DtoFieldIndex ------------------------------------------------------- //
+
+// ** DtoFieldIndex::DtoFieldIndex
+DtoFieldIndex::DtoFieldIndex(cstring path, DtoIndexType type)
+	: m_path(path)
+	, m_type(type)
+{
+}
+
+// ** DtoFieldIndex::path
+const DtoFieldPath& DtoFieldIndex::path() const
+{
+	return m_path;
+}
+
+// ** DtoFieldIndex::type
+DtoIndexType DtoFieldIndex::type() const
+{
+	return m_type;
+}
+
+// ** DtoFieldIndex::size
+int64 DtoFieldIndex::size() const
+{
+	return static_cast<int64>(m_entries.size());
+}
+
+// ** DtoFieldIndex::build
+void DtoFieldIndex::build(const Dto* documents, int64 count, DtoThreadPool* pool)
+{
+	build(count, [documents](int64 index) { return documents[index]; }, NULL, pool);
+}
+
+// ** DtoFieldIndex::build
+void DtoFieldIndex::build(const DtoStore& store, DtoThreadPool* pool)
+{
+	build(store.count(), [&store](int64 index) { return store.record(index); }, NULL, pool);
+}
+
+// ** DtoFieldIndex::build
+void DtoFieldIndex::build(const Dto& sequence, DtoThreadPool* pool)
+{
+	// Items are located with a single serial pass that only skips over item bodies
+	std::vector<Dto>	items;
+	std::vector<int64>	offsets;
+	DtoIter				i = sequence.iter();
+
+	while (i.next())
+	{
+		if (i == DtoKeyValue)
+		{
+			items.push_back(i.toDto());
+			offsets.push_back(items.back().data() - sequence.data());
+		}
+	}
+
+	build(static_cast<int64>(items.size()), [&items](int64 index) { return items[index]; }, offsets.data(), pool);
+}
+
+// ** DtoFieldIndex::build
+void DtoFieldIndex::build(int64 count, const Source& source, const int64* locations, DtoThreadPool* pool)
+{
+	int32 chunkCount = pool ? static_cast<int32>(std::min<int64>(pool->size() * 4, std::max<int64>(count / 1024, 1))) : 1;
+	std::vector< std::vector<Entry> > chunks(chunkCount);
+
+	// Extract field values of each chunk of documents, a sorted index also sorts each chunk
+	DtoThreadPool::Task extract = [&](int32 task, int32)
+	{
+		std::vector<Entry>& entries = chunks[task];
+		int64 begin = count * task / chunkCount;
+		int64 end	= count * (task + 1) / chunkCount;
+
+		entries.reserve(end - begin);
+
+		for (int64 index = begin; index < end; index++)
+		{
+			DtoIter i = source(index).find(m_path);
+
+			if (!i)
+			{
+				continue;
+			}
+
+			Entry entry;
+			entry.key	   = DtoIndexKey::construct(i.value());
+			entry.location = locations ? locations[index] : index;
+
+			if (entry.key)
+			{
+				entries.push_back(entry);
+			}
+		}
+
+		if (m_type == DtoSortedIndex)
+		{
+			std::stable_sort(entries.begin(), entries.end());
+		}
+	};
+
+	if (pool)
+	{
+		pool->run(chunkCount, extract);
+	}
+	else
+	{
+		extract(0, 0);
+	}
+
+	// Chunks are concatenated in a document order
+	std::vector<int64> starts(chunkCount + 1, 0);
+
+	for (int32 i = 0; i < chunkCount; i++)
+	{
+		starts[i + 1] = starts[i] + static_cast<int64>(chunks[i].size());
+	}
+
+	m_entries.clear();
+	m_entries.reserve(starts[chunkCount]);
+
+	for (int32 i = 0; i < chunkCount; i++)
+	{
+		m_entries.insert(m_entries.end(), chunks[i].begin(), chunks[i].end());
+		std::vector<Entry>().swap(chunks[i]);
+	}
+
+	if (m_type == DtoSortedIndex)
+	{
+		// Merge adjacent sorted runs pairwise, merges of the same level are independent
+		for (int32 width = 1; width < chunkCount; width *= 2)
+		{
+			int32 merges = (chunkCount + width * 2 - 1) / (width * 2);
+
+			DtoThreadPool::Task merge = [&](int32 task, int32)
+			{
+				int32 first  = task * width * 2;
+				int32 middle = std::min(first + width, chunkCount);
+				int32 last	 = std::min(first + width * 2, chunkCount);
+				std::inplace_merge(m_entries.begin() + starts[first], m_entries.begin() + starts[middle], m_entries.begin() + starts[last]);
+			};
+
+			if (pool)
+			{
+				pool->run(merges, merge);
+			}
+			else
+			{
+				for (int32 i = 0; i < merges; i++)
+				{
+					merge(i, 0);
+				}
+			}
+		}
+
+		m_buckets.clear();
+		return;
+	}
+
+	// Group entries by hash buckets with a stable counting sort, a number of buckets is a power of two
+	int64 bucketCount = 1;
+
+	while (bucketCount < size())
+	{
+		bucketCount *= 2;
+	}
+
+	m_buckets.assign(bucketCount + 1, 0);
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		m_buckets[bucket(m_entries[i].key) + 1]++;
+	}
+
+	for (int64 i = 0; i < bucketCount; i++)
+	{
+		m_buckets[i + 1] += m_buckets[i];
+	}
+
+	std::vector<Entry>	grouped(m_entries.size());
+	std::vector<int64>	next(m_buckets.begin(), m_buckets.end() - 1);
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		grouped[next[bucket(m_entries[i].key)]++] = m_entries[i];
+	}
+
+	m_entries.swap(grouped);
+}
+
+// ** DtoFieldIndex::find
+int64 DtoFieldIndex::find(const DtoIndexKey& key, std::vector<int64>& locations) const
+{
+	if (m_entries.empty() || !key)
+	{
+		return 0;
+	}
+
+	std::vector<Entry>::const_iterator begin, end;
+
+	if (m_type == DtoSortedIndex)
+	{
+		Entry probe;
+		probe.key = key;
+		std::pair<std::vector<Entry>::const_iterator, std::vector<Entry>::const_iterator> range = std::equal_range(m_entries.begin(), m_entries.end(), probe);
+		begin = range.first;
+		end	  = range.second;
+	}
+	else
+	{
+		int64 index = bucket(key);
+		begin = m_entries.begin() + m_buckets[index];
+		end	  = m_entries.begin() + m_buckets[index + 1];
+	}
+
+	int64 count = 0;
+
+	for (; begin != end; ++begin)
+	{
+		if (begin->key == key)
+		{
+			locations.push_back(begin->location);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+// ** DtoFieldIndex::range
+int64 DtoFieldIndex::range(const DtoIndexKey& low, const DtoIndexKey& high, std::vector<int64>& locations) const
+{
+	if (m_type != DtoSortedIndex)
+	{
+		return -1;
+	}
+
+	Entry first, last;
+	first.key = low;
+	last.key  = high;
+
+	std::vector<Entry>::const_iterator begin = std::lower_bound(m_entries.begin(), m_entries.end(), first);
+	std::vector<Entry>::const_iterator end	 = std::upper_bound(begin, m_entries.end(), last);
+
+	for (std::vector<Entry>::const_iterator i = begin; i != end; ++i)
+	{
+		locations.push_back(i->location);
+	}
+
+	return std::max<int64>(end - begin, 0);
+}
+
+// ** DtoFieldIndex::bucket
+int64 DtoFieldIndex::bucket(const DtoIndexKey& key) const
+{
+	return static_cast<int64>(key.hash() & (m_buckets.size() - 2));
+}
+
+DTO_END
\ No newline at end of file
@@ -0,0 +1,213 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Index_H__
+#define __Dto_Index_H__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+DTO_BEGIN
+
+	//! A dot-separated path to a nested field, such as "user.id", split into keys once so it can be reused for many documents.
+	class DtoFieldPath
+	{
+	public:
+
+								//! Constructs an empty path.
+								DtoFieldPath();
+
+								//! Constructs a path from a dot-separated string, empty keys are skipped.
+		explicit				DtoFieldPath(cstring path);
+
+		//! Returns a total number of keys in a path.
+		int32					size() const;
+
+		//! Returns a key at specified index.
+		DtoStringView			key(int32 index) const;
+
+		//! Returns a source path string.
+		cstring					str() const;
+
+	private:
+
+		std::string				m_path;		//!< A source path string.
+		std::vector<int32>		m_keys;		//!< Start offsets and lengths of all keys.
+	};
+
+	//! A scalar value used as an index key. Numbers of all types are normalized, so equal values compare equal regardless of a type.
+	class DtoIndexKey
+	{
+	public:
+
+								//! Constructs an invalid key.
+								DtoIndexKey();
+
+								//! Constructs a boolean key.
+								DtoIndexKey(bool value);
+
+								//! Constructs a number key.
+								DtoIndexKey(int32 value);
+
+								//! Constructs a number key.
+								DtoIndexKey(int64 value);
+
+								//! Constructs a number key.
+								DtoIndexKey(double value);
+
+								//! Constructs a string key, a key references a string and does not copy it.
+								DtoIndexKey(cstring value);
+
+								//! Constructs a string key, a key references a string and does not copy it.
+								DtoIndexKey(const DtoStringView& value);
+
+								//! Returns true if this is a valid key.
+								operator bool() const;
+
+		//! Returns a negative value, zero or a positive value if this key is less than, equal to or greater than other one.
+		int32					compare(const DtoIndexKey& other) const;
+
+		//! Returns true if two keys are equal.
+		bool					operator == (const DtoIndexKey& other) const;
+
+		//! Returns true if this key is less than other one.
+		bool					operator < (const DtoIndexKey& other) const;
+
+		//! Returns a key hash value.
+		uint64					hash() const;
+
+		//! Constructs a key from a DTO value, returns an invalid key if a value is not a number, string, boolean, date or timestamp.
+		static DtoIndexKey		construct(const DtoValue& value);
+
+	private:
+
+		//! Key kinds in an ascending order.
+		enum Rank
+		{
+			  Invalid
+			, Number
+			, String
+			, Boolean
+			, Date
+			, Timestamp
+		};
+
+		byte					m_rank;			//!< A key kind.
+		bool					m_isInteger;	//!< Indicates that a number key holds an integral value.
+		int32					m_length;		//!< A string key length.
+
+		union
+		{
+			int64				m_integer;		//!< An integral number, boolean or date value.
+			uint64				m_unsigned;		//!< A timestamp value.
+			double				m_number;		//!< A non-integral number value.
+			cstring				m_string;		//!< A string key characters.
+		};
+	};
+
+	//! Supported field index types.
+	enum DtoIndexType
+	{
+		  DtoHashIndex		//!< Supports equality lookups in a constant time.
+		, DtoSortedIndex	//!< Supports both equality lookups and range queries in a logarithmic time.
+	};
+
+	/*!
+	 A secondary index that maps values of a single field of a document collection to document locations.
+
+	 A meaning of a location depends on a collection: it is an array index for an array of documents,
+	 a record index for a DtoStore and an item offset relative to a sequence data for a DTO sequence.
+	 Only documents that have a number, string, boolean, date or timestamp value at an indexed path are
+	 indexed. String keys reference documents, so documents should outlive an index.
+
+	 Field values are extracted in parallel if a thread pool is passed to build. A hash index groups
+	 entries by a hash bucket with a counting sort, a sorted index sorts chunks of entries concurrently
+	 and merges them pairwise. Documents with equal keys are returned in a location order.
+	 */
+	class DtoFieldIndex
+	{
+	public:
+
+								//! Constructs an empty index of a specified type over a dot-separated field path.
+								DtoFieldIndex(cstring path, DtoIndexType type);
+
+		//! Returns an indexed field path.
+		const DtoFieldPath&		path() const;
+
+		//! Returns an index type.
+		DtoIndexType			type() const;
+
+		//! Returns a total number of indexed documents.
+		int64					size() const;
+
+		//! Builds an index over an array of documents, locations are array indices.
+		void					build(const Dto* documents, int64 count, DtoThreadPool* pool = NULL);
+
+		//! Builds an index over all records of a store, locations are record indices.
+		void					build(const DtoStore& store, DtoThreadPool* pool = NULL);
+
+		//! Builds an index over key-value items of a sequence, locations are item offsets relative to a sequence data.
+		void					build(const Dto& sequence, DtoThreadPool* pool = NULL);
+
+		//! Appends locations of documents with a field equal to a key and returns a total number of found documents.
+		int64					find(const DtoIndexKey& key, std::vector<int64>& locations) const;
+
+		//! Appends locations of documents with a field in an inclusive range in an ascending key order and returns a total number of found documents, returns -1 for a hash index.
+		int64					range(const DtoIndexKey& low, const DtoIndexKey& high, std::vector<int64>& locations) const;
+
+	private:
+
+		//! A function that returns a document at specified index.
+		typedef std::function<Dto(int64 index)> Source;
+
+		//! An indexed field value with a document location.
+		struct Entry
+		{
+			DtoIndexKey			key;		//!< A field value.
+			int64				location;	//!< A document location.
+
+			//! Compares entries by keys.
+			bool				operator < (const Entry& other) const { return key < other.key; }
+		};
+
+		//! Builds an index over a specified number of documents, locations are document indices if no locations are passed.
+		void					build(int64 count, const Source& source, const int64* locations, DtoThreadPool* pool);
+
+		//! Returns a hash bucket for a key.
+		int64					bucket(const DtoIndexKey& key) const;
+
+	private:
+
+		DtoFieldPath			m_path;		//!< An indexed field path.
+		DtoIndexType			m_type;		//!< An index type.
+		std::vector<Entry>		m_entries;	//!< Entries ordered by keys or grouped by hash buckets.
+		std::vector<int64>		m_buckets;	//!< First entry indices of hash buckets followed by a total number of entries.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Index_H__	*/
\ No newline at end of file
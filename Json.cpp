@@ -31,9 +31,17 @@ SOFTWARE.
 #include <stdio.h>
 #include <cctype>
 #include <algorithm>
+#include <string>
+#include <stdlib.h>
+
+#ifdef _WINDOWS
+	#define snprintf _snprintf_s
+#endif	//	#ifdef _WINDOWS
 
 DTO_BEGIN
 
+extern DtoErrorHandler g_errorHandler;
+
 // -------------------------------------------------------- JsonDtoWriter -------------------------------------------------------- //
 
 // ** JsonDtoWriter::JsonDtoWriter
@@ -80,7 +88,15 @@ int32 JsonDtoWriter::consume(const DtoEvent& event)
 		break;
 
 	case DtoEntry:
-		key(event.key) << DtoTextOutput::quotedString << event.data << ",";
+		if (event.data.type == DtoBinary && DtoPackedArray::elementSize(event.data.binary.subtype))
+		{
+			key(event.key);
+			packedArray(event.data.binary) << ",";
+		}
+		else
+		{
+			key(event.key) << DtoTextOutput::quotedString << event.data << ",";
+		}
 		break;
 
 	default:
@@ -89,7 +105,19 @@ int32 JsonDtoWriter::consume(const DtoEvent& event)
 	return 0;
 }
 
-// ** JsonDtoWriter::indentation
+// ** JsonDtoWriter::setAsciiOnly
+void JsonDtoWriter::setAsciiOnly(bool value)
+{
+	m_output.setAsciiOnly(value);
+}
+
+// ** JsonDtoWriter::length
+int32 JsonDtoWriter::length() const
+{
+	return m_output.length();
+}
+
+// ** JsonDtoWriter::key
 DtoTextOutput& JsonDtoWriter::key(const DtoStringView& value)
 {
 	// Output keys only for key-value objects
@@ -101,6 +129,40 @@ DtoTextOutput& JsonDtoWriter::key(const DtoStringView& value)
 	return m_output;
 }
 
+// ** JsonDtoWriter::packedArray
+DtoTextOutput& JsonDtoWriter::packedArray(const DtoBinaryBlob& value)
+{
+	int32 size  = DtoPackedArray::elementSize(value.subtype);
+	int32 count = value.length / size;
+
+	m_output << "[";
+
+	for (int32 i = 0; i < count; i++)
+	{
+		const byte* element = value.data + i * size;
+
+		if (i)
+		{
+			m_output << ",";
+		}
+
+		// Elements are not aligned inside a binary blob, so copy them before formatting
+		switch (value.subtype)
+		{
+		case DtoPackedInt32:	{ int32 number; memcpy(&number, element, size); m_output << number; }
+								break;
+		case DtoPackedInt64:	{ int64 number; memcpy(&number, element, size); m_output << number; }
+								break;
+		case DtoPackedDouble:	{ double number; memcpy(&number, element, size); m_output << number; }
+								break;
+		case DtoPackedBool:		m_output << (*element != 0);
+								break;
+		}
+	}
+
+	return m_output << "]";
+}
+
 // ** JsonDtoWriter::removeTrailingComma
 DtoTextOutput& JsonDtoWriter::removeTrailingComma()
 {
@@ -376,7 +438,7 @@ DtoEvent JsonDtoReader::parsePrimitive(const DtoStringView& key)
 		return DtoEvent(key, m_input.consumeString(true));
 
 	case DtoTokenInput::Number:
-		return DtoEvent(key, m_input.consumeNumber(true));
+		return DtoEvent(key, m_input.consumeNumber(1, true));
 
 	case DtoTokenInput::Minus:
 		m_input.nextNonSpace();
@@ -400,4 +462,908 @@ int32 JsonDtoReader::consumed() const
 	return m_input.consumed();
 }
 
+// ----------------------------------------------------- JsonDtoStreamReader ----------------------------------------------------- //
+
+// ** JsonDtoStreamReader::JsonDtoStreamReader
+JsonDtoStreamReader::JsonDtoStreamReader(DtoWriter& writer)
+	: m_writer(writer)
+{
+	reset();
+}
+
+// ** JsonDtoStreamReader::reset
+void JsonDtoStreamReader::reset()
+{
+	m_state    = ExpectStream;
+	m_escaped  = false;
+	m_consumed = 0;
+	m_key.clear();
+	m_token.clear();
+
+	while (!m_stack.empty())
+	{
+		m_stack.pop();
+	}
+}
+
+// ** JsonDtoStreamReader::complete
+bool JsonDtoStreamReader::complete() const
+{
+	return m_state == Complete;
+}
+
+// ** JsonDtoStreamReader::consumed
+int64 JsonDtoStreamReader::consumed() const
+{
+	return m_consumed;
+}
+
+// ** JsonDtoStreamReader::finish
+bool JsonDtoStreamReader::finish()
+{
+	if (m_state == Complete || m_state == Failed)
+	{
+		return m_state == Complete;
+	}
+
+	return fail("unexpected end of input");
+}
+
+// ** JsonDtoStreamReader::feed
+bool JsonDtoStreamReader::feed(const byte* input, int32 length)
+{
+	const byte* end = input + length;
+	const byte* ptr = input;
+
+	while (ptr < end && m_state != Failed)
+	{
+		bool closed = false;
+
+		switch (m_state)
+		{
+		case ReadKey:
+			{
+				const byte* quote = readQuoted(ptr, end, closed);
+				m_key.insert(m_key.end(), reinterpret_cast<cstring>(ptr), reinterpret_cast<cstring>(quote));
+				ptr = quote;
+			}
+
+			if (closed)
+			{
+				if (!m_key.empty())
+				{
+					m_key.resize(DtoTokenInput::unescape(&m_key[0], static_cast<int32>(m_key.size()), &m_key[0]));
+				}
+
+				m_state = ExpectColon;
+				ptr++;
+			}
+			break;
+
+		case ReadString:
+			{
+				const byte* quote = readQuoted(ptr, end, closed);
+				DtoValue	value;
+				value.type = DtoString;
+
+				if (closed && m_token.empty() && !memchr(ptr, '\\', quote - ptr))
+				{
+					// A whole string without escapes is inside this chunk, so emit it without copying
+					value.string.value  = reinterpret_cast<cstring>(ptr);
+					value.string.length = static_cast<int32>(quote - ptr);
+				}
+				else
+				{
+					// Otherwise accumulate string characters until the closing quote is reached and decode them
+					m_token.insert(m_token.end(), reinterpret_cast<cstring>(ptr), reinterpret_cast<cstring>(quote));
+
+					if (closed && !m_token.empty())
+					{
+						m_token.resize(DtoTokenInput::unescape(&m_token[0], static_cast<int32>(m_token.size()), &m_token[0]));
+					}
+
+					value.string.value  = m_token.empty() ? "" : &m_token[0];
+					value.string.length = static_cast<int32>(m_token.size());
+				}
+
+				ptr = quote;
+
+				if (closed)
+				{
+					emitEntry(value);
+					ptr++;
+				}
+			}
+			break;
+
+		case ReadNumber:
+		case ReadLiteral:
+			ptr = readWord(ptr, end, closed);
+
+			if (closed && !emitWord())
+			{
+				return false;
+			}
+			break;
+
+		default:
+			// Skip whitespace characters between structural tokens
+			if (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r')
+			{
+				ptr++;
+				break;
+			}
+
+			if (!parseCharacter(*ptr))
+			{
+				m_consumed += ptr - input;
+				return false;
+			}
+
+			ptr++;
+		}
+	}
+
+	m_consumed += ptr - input;
+
+	return m_state != Failed;
+}
+
+// ** JsonDtoStreamReader::parseCharacter
+bool JsonDtoStreamReader::parseCharacter(byte c)
+{
+	switch (m_state)
+	{
+	case ExpectStream:
+		if (c != '{' && c != '[')
+		{
+			return fail("expected '{' or '['");
+		}
+		m_stack.push(Nested(c == '{' ? DtoKeyValue : DtoSequence));
+		m_state = c == '{' ? ExpectKeyOrEnd : ExpectValueOrEnd;
+		m_writer.consume(DtoStreamStart);
+		return true;
+
+	case ExpectKeyOrEnd:
+	case ExpectKey:
+		if (m_state == ExpectKeyOrEnd && c == '}')
+		{
+			return close(DtoKeyValue);
+		}
+		if (c != '"')
+		{
+			return fail("expected a key");
+		}
+		m_key.clear();
+		m_state = ReadKey;
+		return true;
+
+	case ExpectColon:
+		if (c != ':')
+		{
+			return fail("expected ':'");
+		}
+		m_state = ExpectValue;
+		return true;
+
+	case ExpectValueOrEnd:
+	case ExpectValue:
+		if (m_state == ExpectValueOrEnd && c == ']')
+		{
+			return close(DtoSequence);
+		}
+
+		switch (c)
+		{
+		case '{':
+			m_writer.consume(DtoEvent(DtoKeyValueStart, key()));
+			m_stack.push(Nested(DtoKeyValue));
+			m_state = ExpectKeyOrEnd;
+			return true;
+
+		case '[':
+			m_writer.consume(DtoEvent(DtoSequenceStart, key()));
+			m_stack.push(Nested(DtoSequence));
+			m_state = ExpectValueOrEnd;
+			return true;
+
+		case '"':
+			m_token.clear();
+			m_state = ReadString;
+			return true;
+
+		case 't':
+		case 'f':
+		case 'n':
+			m_token.assign(1, static_cast<char>(c));
+			m_state = ReadLiteral;
+			return true;
+		}
+
+		if (c == '-' || (c >= '0' && c <= '9'))
+		{
+			m_token.assign(1, static_cast<char>(c));
+			m_state = ReadNumber;
+			return true;
+		}
+		return fail("expected a value");
+
+	case ExpectSeparator:
+		switch (c)
+		{
+		case ',':
+			m_state = m_stack.top().type == DtoKeyValue ? ExpectKey : ExpectValue;
+			return true;
+
+		case '}':
+			return close(DtoKeyValue);
+
+		case ']':
+			return close(DtoSequence);
+		}
+		return fail("expected ',' or a closing bracket");
+
+	case Complete:
+		return fail("unexpected characters after the end of a document");
+
+	default:
+		assert(0);
+	}
+
+	return false;
+}
+
+// ** JsonDtoStreamReader::readQuoted
+const byte* JsonDtoStreamReader::readQuoted(const byte* input, const byte* end, bool& closed)
+{
+	const byte* ptr = input;
+
+	// Look for an unescaped closing quote
+	while (ptr < end)
+	{
+		if (m_escaped)
+		{
+			m_escaped = false;
+		}
+		else if (*ptr == '\\')
+		{
+			m_escaped = true;
+		}
+		else if (*ptr == '"')
+		{
+			closed = true;
+			break;
+		}
+
+		ptr++;
+	}
+
+	return ptr;
+}
+
+// ** JsonDtoStreamReader::readWord
+const byte* JsonDtoStreamReader::readWord(const byte* input, const byte* end, bool& closed)
+{
+	const byte* ptr = input;
+
+	if (m_state == ReadNumber)
+	{
+		while (ptr < end && ((*ptr >= '0' && *ptr <= '9') || *ptr == '.' || *ptr == 'e' || *ptr == 'E' || *ptr == '+' || *ptr == '-'))
+		{
+			ptr++;
+		}
+	}
+	else
+	{
+		while (ptr < end && *ptr >= 'a' && *ptr <= 'z')
+		{
+			ptr++;
+		}
+	}
+
+	m_token.insert(m_token.end(), reinterpret_cast<cstring>(input), reinterpret_cast<cstring>(ptr));
+
+	// A word is complete only when a character that does not belong to it was encountered
+	closed = ptr < end;
+
+	return ptr;
+}
+
+// ** JsonDtoStreamReader::emitWord
+bool JsonDtoStreamReader::emitWord()
+{
+	DtoValue value;
+
+	if (m_state == ReadLiteral)
+	{
+		DtoStringView text = { &m_token[0], static_cast<int32>(m_token.size()) };
+
+		if (text == DtoStringView::construct("true") || text == DtoStringView::construct("false"))
+		{
+			value.type	  = DtoBool;
+			value.boolean = text.length == 4;
+			emitEntry(value);
+			return true;
+		}
+
+		if (text == DtoStringView::construct("null"))
+		{
+			value.type = DtoNull;
+			emitEntry(value);
+			return true;
+		}
+
+		return fail("unexpected literal");
+	}
+
+	if (m_token.size() >= sizeof(m_text))
+	{
+		return fail("a number is too long");
+	}
+
+	memcpy(m_text, &m_token[0], m_token.size());
+	m_text[m_token.size()] = 0;
+
+	char* parsed = NULL;
+	value.type   = DtoDouble;
+	value.number = strtod(m_text, &parsed);
+
+	if (parsed != m_text + m_token.size())
+	{
+		return fail("malformed number");
+	}
+
+	emitEntry(value);
+	return true;
+}
+
+// ** JsonDtoStreamReader::emitEntry
+void JsonDtoStreamReader::emitEntry(const DtoValue& value)
+{
+	m_writer.consume(DtoEvent(key(), value));
+	m_state = ExpectSeparator;
+}
+
+// ** JsonDtoStreamReader::close
+bool JsonDtoStreamReader::close(DtoValueType type)
+{
+	if (m_stack.top().type != type)
+	{
+		return fail("mismatched closing bracket");
+	}
+
+	m_stack.pop();
+
+	if (m_stack.empty())
+	{
+		m_writer.consume(DtoStreamEnd);
+		m_state = Complete;
+	}
+	else
+	{
+		m_writer.consume(type == DtoKeyValue ? DtoKeyValueEnd : DtoSequenceEnd);
+		m_state = ExpectSeparator;
+	}
+
+	return true;
+}
+
+// ** JsonDtoStreamReader::key
+DtoStringView JsonDtoStreamReader::key()
+{
+	DtoStringView result;
+	Nested&		  topmost = m_stack.top();
+
+	if (topmost.type == DtoSequence)
+	{
+		result.value  = m_text;
+		result.length = snprintf(m_text, sizeof(m_text), "%d", topmost.index++);
+	}
+	else
+	{
+		result.value  = m_key.empty() ? "" : &m_key[0];
+		result.length = static_cast<int32>(m_key.size());
+	}
+
+	return result;
+}
+
+// ** JsonDtoStreamReader::fail
+bool JsonDtoStreamReader::fail(cstring message)
+{
+	m_state = Failed;
+
+	if (g_errorHandler)
+	{
+		char text[DtoTokenInput::MaxMessageLength];
+		snprintf(text, sizeof(text), "error: %lld : %s", static_cast<long long>(m_consumed), message);
+		g_errorHandler(text);
+	}
+
+	return false;
+}
+
+// ---------------------------------------------------------- JsonDtoIter ---------------------------------------------------------- //
+
+//! Returns a pointer to a first non-space character.
+static const byte* skipSpaces(const byte* input, const byte* end)
+{
+	while (input < end && (*input == ' ' || *input == '\t' || *input == '\n' || *input == '\r'))
+	{
+		input++;
+	}
+
+	return input;
+}
+
+//! Returns a pointer past the closing quote of a string that starts at specified position or NULL if a string is not closed.
+static const byte* skipString(const byte* input, const byte* end)
+{
+	for (const byte* ptr = input + 1; ptr < end; ptr++)
+	{
+		ptr = reinterpret_cast<const byte*>(memchr(ptr, '"', end - ptr));
+
+		if (ptr == NULL)
+		{
+			return NULL;
+		}
+
+		// A quote is escaped if it is preceded by an odd number of backslashes
+		int32 count = 0;
+
+		while (ptr[-count - 1] == '\\')
+		{
+			count++;
+		}
+
+		if (count % 2 == 0)
+		{
+			return ptr + 1;
+		}
+	}
+
+	return NULL;
+}
+
+//! Returns a pointer past the bracket that closes an object or an array that starts at specified position.
+static const byte* skipNested(const byte* input, const byte* end)
+{
+	int32 depth = 0;
+
+	for (const byte* ptr = input; ptr < end; ptr++)
+	{
+		switch (*ptr)
+		{
+		case '"':
+			ptr = skipString(ptr, end);
+
+			if (ptr == NULL)
+			{
+				return NULL;
+			}
+
+			ptr--;
+			break;
+
+		case '{':
+		case '[':
+			depth++;
+			break;
+
+		case '}':
+		case ']':
+			if (--depth == 0)
+			{
+				return ptr + 1;
+			}
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+// ** JsonDtoIter::JsonDtoIter
+JsonDtoIter::JsonDtoIter(const byte* input, const byte* end, bool isSequence)
+	: m_input(input)
+	, m_end(end)
+	, m_isSequence(isSequence)
+	, m_index(0)
+{
+	memset(&m_key, 0, sizeof(m_key));
+	memset(&m_value, 0, sizeof(m_value));
+}
+
+// ** JsonDtoIter::operator bool
+JsonDtoIter::operator bool() const
+{
+	return m_value.type != DtoEnd;
+}
+
+// ** JsonDtoIter::operator ==
+bool JsonDtoIter::operator == (DtoValueType type) const
+{
+	return m_value.type == type;
+}
+
+// ** JsonDtoIter::operator !=
+bool JsonDtoIter::operator != (DtoValueType type) const
+{
+	return m_value.type != type;
+}
+
+// ** JsonDtoIter::next
+bool JsonDtoIter::next()
+{
+	m_value.type = DtoEnd;
+
+	const byte* ptr = skipSpaces(m_input, m_end);
+
+	// Stop at the end of a node
+	if (ptr == m_end || *ptr == '}' || *ptr == ']')
+	{
+		m_input = ptr;
+		return false;
+	}
+
+	// Read an entry key
+	if (m_isSequence)
+	{
+		m_key.length = snprintf(m_text, sizeof(m_text), "%d", m_index++);
+	}
+	else
+	{
+		const byte* close = *ptr == '"' ? skipString(ptr, m_end) : NULL;
+
+		if (close == NULL)
+		{
+			m_input = m_end;
+			return false;
+		}
+
+		m_key.value  = reinterpret_cast<cstring>(ptr + 1);
+		m_key.length = static_cast<int32>(close - ptr) - 2;
+
+		ptr = skipSpaces(close, m_end);
+
+		if (ptr == m_end || *ptr != ':')
+		{
+			m_input = m_end;
+			return false;
+		}
+
+		ptr = skipSpaces(ptr + 1, m_end);
+	}
+
+	// Now parse a value
+	m_input = ptr;
+
+	if (ptr == m_end || !parseValue())
+	{
+		m_value.type = DtoEnd;
+		m_input = m_end;
+		return false;
+	}
+
+	// Skip a separator, any other symbol except a closing bracket stops an iteration
+	ptr = skipSpaces(m_input, m_end);
+
+	if (ptr < m_end && *ptr == ',')
+	{
+		ptr++;
+	}
+	else if (ptr < m_end && *ptr != '}' && *ptr != ']')
+	{
+		ptr = m_end;
+	}
+
+	m_input = ptr;
+
+	return true;
+}
+
+// ** JsonDtoIter::parseValue
+bool JsonDtoIter::parseValue()
+{
+	const byte* ptr = m_input;
+	const byte* end = NULL;
+
+	switch (*ptr)
+	{
+	case '{':
+	case '[':
+		end = skipNested(ptr, m_end);
+
+		if (end)
+		{
+			m_value.type           = *ptr == '{' ? DtoKeyValue : DtoSequence;
+			m_value.binary.data    = ptr;
+			m_value.binary.length  = static_cast<int32>(end - ptr);
+			m_value.binary.subtype = 0;
+		}
+		break;
+
+	case '"':
+		end = skipString(ptr, m_end);
+
+		if (end)
+		{
+			m_value.type          = DtoString;
+			m_value.string.value  = reinterpret_cast<cstring>(ptr + 1);
+			m_value.string.length = static_cast<int32>(end - ptr) - 2;
+		}
+		break;
+
+	case 't':
+		if (m_end - ptr >= 4 && memcmp(ptr, "true", 4) == 0)
+		{
+			m_value.type    = DtoBool;
+			m_value.boolean = true;
+			end = ptr + 4;
+		}
+		break;
+
+	case 'f':
+		if (m_end - ptr >= 5 && memcmp(ptr, "false", 5) == 0)
+		{
+			m_value.type    = DtoBool;
+			m_value.boolean = false;
+			end = ptr + 5;
+		}
+		break;
+
+	case 'n':
+		if (m_end - ptr >= 4 && memcmp(ptr, "null", 4) == 0)
+		{
+			m_value.type = DtoNull;
+			end = ptr + 4;
+		}
+		break;
+
+	default:
+		{
+			// Find a number end first, an input is not guaranteed to be zero terminated
+			int32 length = 0;
+
+			while (ptr + length < m_end && ((ptr[length] >= '0' && ptr[length] <= '9') || (ptr[length] && strchr("+-.eE", ptr[length]))))
+			{
+				length++;
+			}
+
+			// Copy a number before conversion, long numbers take a slow path through a heap buffer
+			char		small[32];
+			std::string large;
+			char*		buffer = small;
+
+			if (length >= static_cast<int32>(sizeof(small)))
+			{
+				large.resize(length + 1);
+				buffer = &large[0];
+			}
+
+			memcpy(buffer, ptr, length);
+			buffer[length] = 0;
+
+			char* last;
+			m_value.number = strtod(buffer, &last);
+
+			if (last != buffer)
+			{
+				m_value.type = DtoDouble;
+				end = ptr + (last - buffer);
+			}
+		}
+	}
+
+	if (end == NULL)
+	{
+		return false;
+	}
+
+	m_input = end;
+	return true;
+}
+
+// ** JsonDtoIter::type
+DtoValueType JsonDtoIter::type() const
+{
+	return m_value.type;
+}
+
+// ** JsonDtoIter::key
+const DtoStringView& JsonDtoIter::key() const
+{
+	// An index text is stored inside an iterator, so a view should follow an iterator when it is copied
+	if (m_isSequence)
+	{
+		m_key.value = m_text;
+	}
+
+	return m_key;
+}
+
+// ** JsonDtoIter::toBool
+bool JsonDtoIter::toBool() const
+{
+	assert(m_value.type == DtoBool);
+	return m_value.boolean;
+}
+
+// ** JsonDtoIter::toString
+const DtoStringView& JsonDtoIter::toString() const
+{
+	assert(m_value.type == DtoString);
+	return m_value.string;
+}
+
+// ** JsonDtoIter::toInt32
+int32 JsonDtoIter::toInt32() const
+{
+	assert(m_value.type == DtoDouble);
+	return static_cast<int32>(m_value.number);
+}
+
+// ** JsonDtoIter::toDouble
+double JsonDtoIter::toDouble() const
+{
+	assert(m_value.type == DtoDouble);
+	return m_value.number;
+}
+
+// ** JsonDtoIter::toDto
+JsonDtoView JsonDtoIter::toDto() const
+{
+	assert(m_value.type == DtoSequence || m_value.type == DtoKeyValue);
+	return JsonDtoView(m_value.binary.data, m_value.binary.length);
+}
+
+// ---------------------------------------------------------- JsonDtoView ---------------------------------------------------------- //
+
+// ** JsonDtoView::JsonDtoView
+JsonDtoView::JsonDtoView()
+	: m_data(NULL)
+	, m_length(0)
+{
+}
+
+// ** JsonDtoView::JsonDtoView
+JsonDtoView::JsonDtoView(const byte* input, int32 length)
+	: m_data(NULL)
+	, m_length(0)
+{
+	const byte* ptr = skipSpaces(input, input + length);
+
+	if (ptr < input + length && (*ptr == '{' || *ptr == '['))
+	{
+		m_data   = ptr;
+		m_length = length - static_cast<int32>(ptr - input);
+	}
+}
+
+// ** JsonDtoView::operator bool
+JsonDtoView::operator bool() const
+{
+	return m_data != NULL;
+}
+
+// ** JsonDtoView::length
+int32 JsonDtoView::length() const
+{
+	return m_length;
+}
+
+// ** JsonDtoView::data
+const byte* JsonDtoView::data() const
+{
+	return m_data;
+}
+
+// ** JsonDtoView::iter
+JsonDtoIter JsonDtoView::iter() const
+{
+	if (m_data == NULL)
+	{
+		return JsonDtoIter(NULL, NULL, false);
+	}
+
+	return JsonDtoIter(m_data + 1, m_data + m_length, *m_data == '[');
+}
+
+// ** JsonDtoView::find
+JsonDtoIter JsonDtoView::find(cstring key) const
+{
+	assert(key);
+	return find(DtoStringView::construct(key));
+}
+
+// ** JsonDtoView::find
+JsonDtoIter JsonDtoView::find(const DtoStringView& key) const
+{
+	assert(key);
+
+	JsonDtoIter i = iter();
+	std::string decoded;
+
+	while (i.next())
+	{
+		const DtoStringView& raw = i.key();
+
+		// Most keys have no escape sequences and are compared in place
+		if (!memchr(raw.value, '\\', raw.length))
+		{
+			if (raw == key)
+			{
+				return i;
+			}
+
+			continue;
+		}
+
+		decoded.resize(raw.length);
+		int32 length = DtoTokenInput::unescape(raw.value, raw.length, &decoded[0]);
+
+		if (length == key.length && memcmp(decoded.data(), key.value, length) == 0)
+		{
+			return i;
+		}
+	}
+
+	return i;
+}
+
+// ** JsonDtoView::findDescendant
+JsonDtoIter JsonDtoView::findDescendant(cstring key) const
+{
+	JsonDtoIter i = iter();
+	JsonDtoView view = *this;
+
+	while (*key)
+	{
+		if (*key == '.')
+		{
+			key++;
+			continue;
+		}
+
+		DtoStringView nextKey;
+		nextKey.value = key;
+
+		while (*key && *key != '.')
+		{
+			key++;
+		}
+		nextKey.length = key - nextKey.value;
+
+		i = view.find(nextKey);
+
+		if (i && *key == 0)
+		{
+			return i;
+		}
+
+		if (!i || (i != DtoSequence && i != DtoKeyValue))
+		{
+			return JsonDtoIter(NULL, NULL, false);
+		}
+
+		view = i.toDto();
+	}
+
+	return i;
+}
+
+// ** JsonDtoView::entryCount
+int32 JsonDtoView::entryCount() const
+{
+	JsonDtoIter i = iter();
+	int32 count = 0;
+
+	while (i.next())
+	{
+		count++;
+	}
+
+	return count;
+}
+
 DTO_END
@@ -27,6 +27,8 @@ SOFTWARE.
 #ifndef __Dto_Json_H__
 #define __Dto_Json_H__
 
+#include <vector>
+
 DTO_BEGIN
 
 	//! Consumes a sequence of DTO events and produces a compact JSON string.
@@ -40,6 +42,12 @@ DTO_BEGIN
 		//! Consumes an event an writes next entry to an output stream.
 		virtual int32				consume(const DtoEvent& event);
 
+		//! Enables or disables escaping of non-ASCII characters inside strings and keys for ASCII-only consumers.
+		void						setAsciiOnly(bool value);
+
+		//! Returns a total number of bytes written to an output (including a zero terminator once a stream is ended).
+		int32						length() const;
+
 	private:
 		
 		//! Removes a trailing comma symbol from an output.
@@ -48,6 +56,9 @@ DTO_BEGIN
 		//! Outputs an entry key based on a current node.
 		DtoTextOutput&				key(const DtoStringView& value);
 
+		//! Outputs a packed homogeneous array as a JSON array.
+		DtoTextOutput&				packedArray(const DtoBinaryBlob& value);
+
 	protected:
 
 		DtoTextOutput				m_output;				//!< An output data buffer.
@@ -133,6 +144,210 @@ DTO_BEGIN
 		char						m_text[64];	//!< An internal temporary string buffer.
     };
 
+	/*!
+	 Parses a JSON string that arrives in chunks of arbitrary size and pushes DTO events
+	 to a writer as soon as they are complete. A parser state along with a partially read
+	 token is preserved between chunks, so input buffers can be reused right after a call.
+	 */
+	class JsonDtoStreamReader
+	{
+	public:
+
+									//! Constructs a streaming JSON reader that emits events to a specified writer.
+									JsonDtoStreamReader(DtoWriter& writer);
+
+		//! Parses a next chunk of an input stream, returns false if a parsing error occured.
+		bool						feed(const byte* input, int32 length);
+
+		//! Notifies a reader that no more input is available and returns true if a complete document was parsed.
+		bool						finish();
+
+		//! Returns true if a complete document was parsed.
+		bool						complete() const;
+
+		//! Returns a total number of consumed bytes, a stream may be longer than a 32-bit offset allows.
+		int64						consumed() const;
+
+		//! Resets a reader state so a next document can be parsed.
+		void						reset();
+
+	private:
+
+		//! Available parser states.
+		enum State
+		{
+			  ExpectStream		//!< Expects an opening brace or bracket of a root node.
+			, ExpectKeyOrEnd	//!< Expects a first key of a key-value node or a closing brace.
+			, ExpectKey			//!< Expects a key after a comma.
+			, ReadKey			//!< Reads a quoted key.
+			, ExpectColon		//!< Expects a colon after a key.
+			, ExpectValueOrEnd	//!< Expects a first item of a sequence or a closing bracket.
+			, ExpectValue		//!< Expects a value.
+			, ReadString		//!< Reads a quoted string value.
+			, ReadNumber		//!< Reads a number value.
+			, ReadLiteral		//!< Reads a 'true', 'false' or 'null' literal.
+			, ExpectSeparator	//!< Expects a comma or a closing brace or bracket after a value.
+			, Complete			//!< A whole document was parsed.
+			, Failed			//!< A parsing error occured.
+		};
+
+		//! A nested node info.
+		struct Nested
+		{
+			DtoValueType			type;	//!< A node type.
+			int32					index;	//!< Next item index used by sequences.
+
+									//! Constructs a Nested instance.
+									Nested(DtoValueType type)
+										: type(type), index(0) {}
+		};
+
+		//! Processes a single non-space character in a structural state and returns false on error.
+		bool						parseCharacter(byte c);
+
+		//! Scans a quoted string and returns a pointer to the closing quote or to the end of a chunk.
+		const byte*					readQuoted(const byte* input, const byte* end, bool& closed);
+
+		//! Reads a run of number or literal characters and returns a pointer past the consumed characters.
+		const byte*					readWord(const byte* input, const byte* end, bool& closed);
+
+		//! Emits an entry event for a number or literal stored in a token buffer.
+		bool						emitWord();
+
+		//! Emits an entry event with a specified value.
+		void						emitEntry(const DtoValue& value);
+
+		//! Closes a topmost node and emits a corresponding event.
+		bool						close(DtoValueType type);
+
+		//! Returns a key for a next value of a topmost node.
+		DtoStringView				key();
+
+		//! Switches to a failed state and emits an error message.
+		bool						fail(cstring message);
+
+	private:
+
+		DtoWriter&					m_writer;		//!< A writer that consumes parsed events.
+		State						m_state;		//!< A current parser state.
+		std::stack<Nested>			m_stack;		//!< A nested node stack.
+		std::vector<char>			m_key;			//!< A last parsed key.
+		std::vector<char>			m_token;		//!< A partially read token from a previous chunk.
+		bool						m_escaped;		//!< True if the last character of a previous chunk was an escape symbol.
+		int64						m_consumed;		//!< A total number of consumed bytes.
+		char						m_text[64];		//!< An internal temporary string buffer.
+	};
+
+	class JsonDtoView;
+
+	/*!
+	 An iterator over entries of a raw JSON object or array. Values are parsed only when an iterator
+	 reaches them and nested objects or arrays are skipped by bracket matching without tokenizing.
+	 Keys and string values are views into an input text with escape sequences left as is, while JsonDtoView::find
+	 decodes escaped keys before comparing them, so it finds the same entries as a parsed document.
+	 */
+	class JsonDtoIter
+	{
+	friend class JsonDtoView;
+	public:
+
+								//! Returns true if this iter points to a valid item.
+								operator bool() const;
+
+		//! Returns true if a entry value type this iter points to matches a specified one.
+		bool					operator == (DtoValueType type) const;
+
+		//! Returns true if a entry value type this iter points does not match a specified one.
+		bool					operator != (DtoValueType type) const;
+
+		//! Switches to a next value, returns false when the end of a node is reached or an input is malformed.
+		bool					next();
+
+		//! Returns iterator value type.
+		DtoValueType			type() const;
+
+		//! Returns current iterator key (an item index for arrays).
+		const DtoStringView&	key() const;
+
+		//! Returns boolean iterator value.
+		bool					toBool() const;
+
+		//! Returns string iterator value.
+		const DtoStringView&	toString() const;
+
+		//! Returns integer iterator value.
+		int32					toInt32() const;
+
+		//! Returns double iterator value.
+		double					toDouble() const;
+
+		//! Returns a nested object or array this iterator points to.
+		JsonDtoView				toDto() const;
+
+	private:
+
+								//! Constructs a JsonDtoIter instance that starts after an opening brace or bracket.
+								JsonDtoIter(const byte* input, const byte* end, bool isSequence);
+
+		//! Parses a value at current position.
+		bool					parseValue();
+
+	private:
+
+		const byte*				m_input;		//!< A position of a next entry.
+		const byte*				m_end;			//!< The end of an input text.
+		bool					m_isSequence;	//!< Indicates that an iterator traverses array items.
+		int32					m_index;		//!< A current array item index.
+		mutable DtoStringView	m_key;			//!< Entry key this iterator points to.
+		DtoValue				m_value;		//!< Entry value this iterator points to.
+		char					m_text[12];		//!< A buffer to store an array item index.
+	};
+
+	/*!
+	 A read-only view of a JSON text with the same navigation interface as Dto. Unlike
+	 dtoParse it does not convert a document upfront, so looking up a few fields of a
+	 large document only touches a text that precedes them.
+	 */
+	class JsonDtoView
+	{
+	public:
+
+								//! Constructs an empty view.
+								JsonDtoView();
+
+								//! Constructs a view of a JSON text that starts with an object or an array.
+								JsonDtoView(const byte* input, int32 length);
+
+								//! Returns true if this view points to an object or an array.
+								operator bool() const;
+
+		//! Returns a JSON text length.
+		int32					length() const;
+
+		//! Returns a JSON text.
+		const byte*				data() const;
+
+		//! Returns an iterator instance.
+		JsonDtoIter				iter() const;
+
+		//! Searches for an entry with specified key.
+		JsonDtoIter				find(cstring key) const;
+
+		//! Searches for an entry with specified key.
+		JsonDtoIter				find(const DtoStringView& key) const;
+
+		//! Searches for an entry with specified key, including nested objects.
+		JsonDtoIter				findDescendant(cstring key) const;
+
+		//! Returns a total number of entries inside this object or array.
+		int32					entryCount() const;
+
+	private:
+
+		const byte*				m_data;		//!< A JSON text that starts with an opening brace or bracket.
+		int32					m_length;	//!< A JSON text length.
+	};
+
 DTO_END
 
 #endif	/*	#ifndef __Dto_Json_H__	*/
\ No newline at end of file
@@ -0,0 +1,573 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Lson.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+DTO_BEGIN
+
+// -------------------------------------------------------- LsonDtoWriter -------------------------------------------------------- //
+
+// ** LsonDtoWriter::LsonDtoWriter
+LsonDtoWriter::LsonDtoWriter(byte* output, int32 capacity)
+	: m_output(output, capacity)
+{
+	m_output.setLuaEscapes(true);
+}
+
+// ** LsonDtoWriter::consume
+int32 LsonDtoWriter::consume(const DtoEvent& event)
+{
+	switch (event.type)
+	{
+	case DtoStreamStart:
+		m_output << "{";
+		m_stack.push(DtoKeyValue);
+		break;
+
+	case DtoStreamEnd:
+		m_stack.pop();
+		removeTrailingComma() << "}" << DtoTextOutput::zero;
+		break;
+
+	case DtoSequenceStart:
+		key(event.key) << "{";
+		m_stack.push(DtoSequence);
+		break;
+
+	case DtoKeyValueStart:
+		key(event.key) << "{";
+		m_stack.push(DtoKeyValue);
+		break;
+
+	case DtoSequenceEnd:
+	case DtoKeyValueEnd:
+		removeTrailingComma() << "}" << ",";
+		m_stack.pop();
+		break;
+
+	case DtoEntry:
+		if (event.data.type == DtoNull)
+		{
+			key(event.key) << "nil" << ",";
+		}
+		else
+		{
+			key(event.key) << DtoTextOutput::quotedString << event.data << ",";
+		}
+		break;
+
+	default:
+		assert(0);
+	}
+
+	return 0;
+}
+
+// ** LsonDtoWriter::length
+int32 LsonDtoWriter::length() const
+{
+	return m_output.length();
+}
+
+// ** LsonDtoWriter::key
+DtoTextOutput& LsonDtoWriter::key(const DtoStringView& value)
+{
+	// Sequence items are positional fields
+	if (m_stack.top() != DtoKeyValue)
+	{
+		return m_output;
+	}
+
+	if (isName(value))
+	{
+		m_output << value << "=";
+	}
+	else
+	{
+		m_output << "[" << DtoTextOutput::quotedString << value << "]=";
+	}
+
+	return m_output;
+}
+
+// ** LsonDtoWriter::removeTrailingComma
+DtoTextOutput& LsonDtoWriter::removeTrailingComma()
+{
+	cstring text = m_output.text() - 1;
+
+	if (*text == ',')
+	{
+		m_output.rewind(1);
+	}
+
+	return m_output;
+}
+
+// ** LsonDtoWriter::isName
+bool LsonDtoWriter::isName(const DtoStringView& value)
+{
+	static cstring s_keywords[] =
+	{
+		  "and", "break", "do", "else", "elseif", "end", "false", "for", "function", "goto", "if"
+		, "in", "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while"
+	};
+
+	if (value.length == 0 || (value.value[0] >= '0' && value.value[0] <= '9'))
+	{
+		return false;
+	}
+
+	// Lua names are limited to ASCII letters, digits and underscores regardless of a locale
+	for (int32 i = 0; i < value.length; i++)
+	{
+		char symbol = value.value[i];
+
+		if (!(symbol >= 'a' && symbol <= 'z') && !(symbol >= 'A' && symbol <= 'Z') && !(symbol >= '0' && symbol <= '9') && symbol != '_')
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < sizeof(s_keywords) / sizeof(s_keywords[0]); i++)
+	{
+		if (value == DtoStringView::construct(s_keywords[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// -------------------------------------------------------- LsonDtoReader -------------------------------------------------------- //
+
+// ** LsonDtoReader::LsonDtoReader
+LsonDtoReader::LsonDtoReader(const byte* input, int32 length)
+	: m_input(input, length)
+{
+	// Lua strings accept backslash escapes regardless of a quote symbol
+	m_input.setSingleQuotedEscapes(true);
+	m_input.setHexNumbers(true);
+}
+
+// ** LsonDtoReader::consumed
+int32 LsonDtoReader::consumed() const
+{
+	return m_input.consumed();
+}
+
+// ** LsonDtoReader::next
+DtoEvent LsonDtoReader::next()
+{
+	// A node stack is empty, this means that we have just started parsing
+	if (m_stack.empty())
+	{
+		m_stack.push(&LsonDtoReader::parseStream);
+	}
+
+	// Pop a topmost parser from a stack
+	EventParser parser = m_stack.top();
+	m_stack.pop();
+
+	// Now parse a next event from a stream.
+	DtoEvent event = (this->*parser)();
+
+	return event;
+}
+
+// ** LsonDtoReader::parseStream
+DtoEvent LsonDtoReader::parseStream()
+{
+	m_input.next();
+	skipSpaces();
+
+	// A table may be returned from a chunk
+	const DtoTokenInput::Token& token = m_input.currentToken();
+
+	if (token == DtoTokenInput::Identifier && token.text == DtoStringView::construct("return"))
+	{
+		m_input.next();
+		skipSpaces();
+	}
+
+	switch (token.type)
+	{
+	case DtoTokenInput::BraceOpen:
+		m_input.next();
+		skipSpaces();
+
+		if (isPositional())
+		{
+			m_stack.push(&LsonDtoReader::expectSequenceStreamEnd);
+			m_stack.push(&LsonDtoReader::parseItem);
+			m_index.push(0);
+		}
+		else
+		{
+			m_stack.push(&LsonDtoReader::expectBraceStreamEnd);
+
+			if (!m_input.check(DtoTokenInput::BraceClose))
+			{
+				m_stack.push(&LsonDtoReader::parseField);
+			}
+		}
+		return DtoStreamStart;
+
+	case DtoTokenInput::Identifier:
+		// A list of global assignments
+		m_stack.push(&LsonDtoReader::expectStreamEnd);
+		m_stack.push(&LsonDtoReader::parseField);
+		return DtoStreamStart;
+
+	default:
+		m_input.emitUnexpectedToken();
+	}
+
+	return DtoError;
+}
+
+// ** LsonDtoReader::parseField
+DtoEvent LsonDtoReader::parseField()
+{
+	const DtoTokenInput::Token& token = m_input.currentToken();
+	DtoStringView key;
+
+	m_stack.push(&LsonDtoReader::continueKeyValue);
+
+	switch (token.type)
+	{
+	case DtoTokenInput::Identifier:
+		key = token.text;
+		m_input.next();
+		break;
+
+	case DtoTokenInput::BracketOpen:
+		m_input.next();
+		skipSpaces();
+
+		if (!m_input.check(DtoTokenInput::DoubleQuotedString) && !m_input.check(DtoTokenInput::SingleQuotedString) && !m_input.check(DtoTokenInput::Number))
+		{
+			m_input.emitUnexpectedToken();
+			return DtoError;
+		}
+
+		if (m_input.check(DtoTokenInput::Number))
+		{
+			key = token.text;
+			m_input.next();
+		}
+		else
+		{
+			key = m_input.consumeString().string;
+		}
+		skipSpaces();
+
+		if (!m_input.expect(DtoTokenInput::BracketClose))
+		{
+			return DtoError;
+		}
+		break;
+
+	default:
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+
+	skipSpaces();
+
+	if (!m_input.expect(DtoTokenInput::Equals))
+	{
+		return DtoError;
+	}
+
+	skipSpaces();
+
+	return parseValue(key);
+}
+
+// ** LsonDtoReader::parseItem
+DtoEvent LsonDtoReader::parseItem()
+{
+	DtoStringView key;
+	key.value = m_text;
+	key.length = sprintf_s(m_text, "%d", m_index.top()++);
+
+	m_stack.push(&LsonDtoReader::continueSequence);
+
+	return parseValue(key);
+}
+
+// ** LsonDtoReader::parseValue
+DtoEvent LsonDtoReader::parseValue(const DtoStringView& key)
+{
+	const DtoTokenInput::Token& token = m_input.currentToken();
+	DtoEvent event;
+
+	switch (token.type)
+	{
+	case DtoTokenInput::BraceOpen:
+		m_input.next();
+		skipSpaces();
+
+		if (isPositional())
+		{
+			m_stack.push(&LsonDtoReader::expectSequenceEnd);
+			m_stack.push(&LsonDtoReader::parseItem);
+			m_index.push(0);
+			return DtoEvent(DtoSequenceStart, key);
+		}
+
+		m_stack.push(&LsonDtoReader::expectKeyValueEnd);
+
+		if (!m_input.check(DtoTokenInput::BraceClose))
+		{
+			m_stack.push(&LsonDtoReader::parseField);
+		}
+		return DtoEvent(DtoKeyValueStart, key);
+
+	case DtoTokenInput::DoubleQuotedString:
+	case DtoTokenInput::SingleQuotedString:
+		event = DtoEvent(key, m_input.consumeString());
+		break;
+
+	case DtoTokenInput::Number:
+		event = DtoEvent(key, m_input.consumeNumber());
+		break;
+
+	case DtoTokenInput::Minus:
+		m_input.next();
+
+		if (!m_input.check(DtoTokenInput::Number))
+		{
+			m_input.emitUnexpectedToken();
+			return DtoError;
+		}
+
+		event = DtoEvent(key, m_input.consumeNumber(-1));
+		break;
+
+	case DtoTokenInput::True:
+	case DtoTokenInput::False:
+		event = DtoEvent(key, m_input.consumeBoolean());
+		break;
+
+	case DtoTokenInput::Identifier:
+		if (!(token.text == DtoStringView::construct("nil")))
+		{
+			m_input.emitUnexpectedToken();
+			return DtoError;
+		}
+
+		m_input.next();
+		event = DtoEvent(key, DtoValue());
+		event.data.type = DtoNull;
+		break;
+
+	default:
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+
+	skipSpaces();
+
+	return event;
+}
+
+// ** LsonDtoReader::continueKeyValue
+DtoEvent LsonDtoReader::continueKeyValue()
+{
+	bool isSeparated = consumeSeparator();
+
+	if (m_input.check(DtoTokenInput::BraceClose) || m_input.check(DtoTokenInput::End))
+	{
+		return next();
+	}
+
+	// Root assignments do not require separators
+	if (!isSeparated && m_stack.top() != &LsonDtoReader::expectStreamEnd)
+	{
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+
+	return parseField();
+}
+
+// ** LsonDtoReader::continueSequence
+DtoEvent LsonDtoReader::continueSequence()
+{
+	if (!consumeSeparator() || m_input.check(DtoTokenInput::BraceClose))
+	{
+		return next();
+	}
+
+	return parseItem();
+}
+
+// ** LsonDtoReader::expectKeyValueEnd
+DtoEvent LsonDtoReader::expectKeyValueEnd()
+{
+	if (m_input.expect(DtoTokenInput::BraceClose))
+	{
+		skipSpaces();
+		return DtoKeyValueEnd;
+	}
+
+	return DtoError;
+}
+
+// ** LsonDtoReader::expectSequenceEnd
+DtoEvent LsonDtoReader::expectSequenceEnd()
+{
+	if (m_input.expect(DtoTokenInput::BraceClose))
+	{
+		skipSpaces();
+		m_index.pop();
+		return DtoSequenceEnd;
+	}
+
+	return DtoError;
+}
+
+// ** LsonDtoReader::expectBraceStreamEnd
+DtoEvent LsonDtoReader::expectBraceStreamEnd()
+{
+	if (m_input.expect(DtoTokenInput::BraceClose))
+	{
+		return DtoStreamEnd;
+	}
+
+	return DtoError;
+}
+
+// ** LsonDtoReader::expectSequenceStreamEnd
+DtoEvent LsonDtoReader::expectSequenceStreamEnd()
+{
+	if (m_input.expect(DtoTokenInput::BraceClose))
+	{
+		m_index.pop();
+		return DtoStreamEnd;
+	}
+
+	return DtoError;
+}
+
+// ** LsonDtoReader::expectStreamEnd
+DtoEvent LsonDtoReader::expectStreamEnd()
+{
+	if (m_input.check(DtoTokenInput::End))
+	{
+		return DtoStreamEnd;
+	}
+
+	m_input.emitUnexpectedToken();
+	return DtoError;
+}
+
+// ** LsonDtoReader::consumeSeparator
+bool LsonDtoReader::consumeSeparator()
+{
+	if (m_input.consume(DtoTokenInput::Comma) || m_input.consume(DtoTokenInput::Semicolon))
+	{
+		skipSpaces();
+		return true;
+	}
+
+	return false;
+}
+
+// ** LsonDtoReader::skipSpaces
+void LsonDtoReader::skipSpaces()
+{
+	for (;;)
+	{
+		const DtoTokenInput::Token& token = m_input.currentToken();
+
+		if (token == DtoTokenInput::Space || token == DtoTokenInput::Tab || token == DtoTokenInput::NewLine)
+		{
+			m_input.nextNonSpace();
+			continue;
+		}
+
+		if (!(token == DtoTokenInput::Minus))
+		{
+			return;
+		}
+
+		// A comment starts with a double minus
+		DtoTokenInput input = m_input;
+
+		if (!(input.next() == DtoTokenInput::Minus))
+		{
+			return;
+		}
+
+		// A block comment is enclosed into double brackets
+		if (input.next() == DtoTokenInput::BracketOpen && input.next() == DtoTokenInput::BracketOpen)
+		{
+			m_input = input;
+			m_input.skipPast("]]");
+		}
+		else
+		{
+			m_input.skipLine();
+		}
+	}
+}
+
+// ** LsonDtoReader::isPositional
+bool LsonDtoReader::isPositional() const
+{
+	switch (m_input.currentToken().type)
+	{
+	case DtoTokenInput::BraceClose:
+	case DtoTokenInput::BracketOpen:
+		return false;
+
+	case DtoTokenInput::Identifier:
+		break;
+
+	default:
+		return true;
+	}
+
+	// A name is a key only if it is followed by an equals sign
+	DtoTokenInput input = m_input;
+
+	if (input.next() == DtoTokenInput::Space || input.currentToken() == DtoTokenInput::Tab || input.currentToken() == DtoTokenInput::NewLine)
+	{
+		input.nextNonSpace();
+	}
+
+	return !(input.currentToken() == DtoTokenInput::Equals);
+}
+
+DTO_END
\ No newline at end of file
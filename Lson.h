@@ -0,0 +1,137 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Lson_H__
+#define __Dto_Lson_H__
+
+DTO_BEGIN
+
+	//! Consumes a sequence of DTO events and produces a compact Lua table constructor.
+	class LsonDtoWriter : public DtoWriter
+	{
+	public:
+
+									//! Constructs a Lua object notation writer.
+									LsonDtoWriter(byte* output, int32 capacity);
+
+		//! Consumes an event an writes next entry to an output stream.
+		virtual int32				consume(const DtoEvent& event);
+
+		//! Returns a total number of bytes written to an output (including a zero terminator once a stream is ended).
+		int32						length() const;
+
+	private:
+
+		//! Removes a trailing comma symbol from an output.
+		DtoTextOutput&				removeTrailingComma();
+
+		//! Outputs an entry key based on a current node.
+		DtoTextOutput&				key(const DtoStringView& value);
+
+		//! Returns true if a key can be written as a Lua name instead of a bracketed string.
+		static bool					isName(const DtoStringView& value);
+
+	protected:
+
+		DtoTextOutput				m_output;	//!< An output data buffer.
+		std::stack<DtoValueType>	m_stack;	//!< A DTO value type stack.
+	};
+
+	//! Parses a Lua table constructor and produces a sequence of DTO events consumable by writer.
+	/*!
+	 A root table may be preceded by a 'return' keyword or replaced by a list of 'name = value' assignments.
+	 A table that starts with a positional field is parsed as a sequence, all other tables are parsed as key-value objects.
+	 */
+	class LsonDtoReader : public DtoReader
+	{
+	public:
+
+									//! Constructs a Lua object notation reader instance.
+									LsonDtoReader(const byte* input, int32 length);
+
+		//! Parses a next event from an input stream.
+		virtual DtoEvent			next();
+
+		//! Returns a total number of consumed bytes.
+		virtual int32				consumed() const;
+
+	protected:
+
+		typedef DtoEvent (LsonDtoReader::*EventParser)();
+
+		//! A root event parser.
+		DtoEvent					parseStream();
+
+		//! Parses a named field of a key-value table.
+		DtoEvent					parseField();
+
+		//! Parses a positional field of a sequence table.
+		DtoEvent					parseItem();
+
+		//! Parses a field value.
+		DtoEvent					parseValue(const DtoStringView& key);
+
+		//! Continues parsing a key-value table if a field separator encountered.
+		DtoEvent					continueKeyValue();
+
+		//! Continues parsing a sequence table if a field separator encountered.
+		DtoEvent					continueSequence();
+
+		//! Expects to parse a closing brace at the end of a key-value table.
+		DtoEvent					expectKeyValueEnd();
+
+		//! Expects to parse a closing brace at the end of a sequence table.
+		DtoEvent					expectSequenceEnd();
+
+		//! Expects to parse a closing brace at the end of a root table.
+		DtoEvent					expectBraceStreamEnd();
+
+		//! Expects to parse a closing brace at the end of a root sequence table.
+		DtoEvent					expectSequenceStreamEnd();
+
+		//! Expects to reach the end of an input after a list of root assignments.
+		DtoEvent					expectStreamEnd();
+
+		//! Skips whitespaces and comments.
+		void						skipSpaces();
+
+		//! Consumes a field separator if any and returns true if it was found.
+		bool						consumeSeparator();
+
+		//! Returns true if a table field at a current position has no key.
+		bool						isPositional() const;
+
+	protected:
+
+		DtoTokenInput				m_input;	//!< An input token stream.
+		std::stack<EventParser>		m_stack;	//!< A event parser stack.
+		std::stack<int>				m_index;	//!< A sequence item index stack.
+		char						m_text[64];	//!< An internal temporary string buffer.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Lson_H__	*/
\ No newline at end of file
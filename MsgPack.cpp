@@ -0,0 +1,816 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "MsgPack.h"
+#include "BigEndian.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+DTO_BEGIN
+
+extern DtoErrorHandler g_errorHandler;
+
+//! Format bytes used by a MessagePack encoding.
+enum MsgPackFormat
+{
+	  MsgPackPositiveFixInt	= 0x00
+	, MsgPackFixMap			= 0x80
+	, MsgPackFixArray		= 0x90
+	, MsgPackFixStr			= 0xA0
+	, MsgPackNil			= 0xC0
+	, MsgPackFalse			= 0xC2
+	, MsgPackTrue			= 0xC3
+	, MsgPackBin8			= 0xC4
+	, MsgPackBin16			= 0xC5
+	, MsgPackBin32			= 0xC6
+	, MsgPackExt8			= 0xC7
+	, MsgPackExt16			= 0xC8
+	, MsgPackExt32			= 0xC9
+	, MsgPackFloat32		= 0xCA
+	, MsgPackFloat64		= 0xCB
+	, MsgPackUInt8			= 0xCC
+	, MsgPackUInt16			= 0xCD
+	, MsgPackUInt32			= 0xCE
+	, MsgPackUInt64			= 0xCF
+	, MsgPackInt8			= 0xD0
+	, MsgPackInt16			= 0xD1
+	, MsgPackInt32			= 0xD2
+	, MsgPackInt64			= 0xD3
+	, MsgPackFixExt1		= 0xD4
+	, MsgPackFixExt2		= 0xD5
+	, MsgPackFixExt4		= 0xD6
+	, MsgPackFixExt8		= 0xD7
+	, MsgPackFixExt16		= 0xD8
+	, MsgPackStr8			= 0xD9
+	, MsgPackStr16			= 0xDA
+	, MsgPackStr32			= 0xDB
+	, MsgPackArray16		= 0xDC
+	, MsgPackArray32		= 0xDD
+	, MsgPackMap16			= 0xDE
+	, MsgPackMap32			= 0xDF
+	, MsgPackNegativeFixInt	= 0xE0
+	, MsgPackTimestampExt	= 0xFF	//!< A timestamp extension type (-1).
+	, MsgPackMaxFixCount	= 0x0F
+	, MsgPackMaxFixStr		= 0x1F
+	, MsgPackMaxHeader		= 5		//!< A size of map32 and array32 headers reserved for each node.
+};
+
+//! Writes a lower bytes of an integer in a big-endian order to an output stream.
+static void writeBigEndian(DtoByteArrayOutput& output, uint64 value, int32 size)
+{
+	byte bytes[8];
+	dtoStoreBigEndian(bytes, value, size);
+	output << DtoByteArrayOutput::size(size) << bytes;
+}
+
+// -------------------------------------------------------- MsgPackDtoWriter -------------------------------------------------------- //
+
+// ** MsgPackDtoWriter::MsgPackDtoWriter
+MsgPackDtoWriter::MsgPackDtoWriter(byte* output, int32 capacity)
+	: m_output(output, capacity)
+{
+
+}
+
+// ** MsgPackDtoWriter::consume
+int32 MsgPackDtoWriter::consume(const DtoEvent& event)
+{
+	int32 length = m_output.length();
+
+	switch (event.type)
+	{
+	case DtoStreamStart:
+		start(DtoKeyValue);
+		break;
+
+	case DtoKeyValueStart:
+		entry(event.key);
+		start(DtoKeyValue);
+		break;
+
+	case DtoSequenceStart:
+		entry(event.key);
+		start(DtoSequence);
+		break;
+
+	case DtoStreamEnd:
+	case DtoKeyValueEnd:
+	case DtoSequenceEnd:
+		finish();
+		break;
+
+	case DtoEntry:
+		entry(event.key);
+		writeValue(event.data);
+		break;
+
+	default:
+		assert(0);
+	}
+
+	return m_output.length() - length;
+}
+
+// ** MsgPackDtoWriter::length
+int32 MsgPackDtoWriter::length() const
+{
+	return m_output.length();
+}
+
+// ** MsgPackDtoWriter::entry
+void MsgPackDtoWriter::entry(const DtoStringView& key)
+{
+	Nested& top = m_stack.top();
+	top.count++;
+
+	if (top.type == DtoKeyValue)
+	{
+		writeString(key);
+	}
+}
+
+// ** MsgPackDtoWriter::start
+void MsgPackDtoWriter::start(DtoValueType type)
+{
+	static const byte reserved[MsgPackMaxHeader] = { 0 };
+
+	m_stack.push(Nested(type, m_output.length()));
+	m_output << DtoByteArrayOutput::size(MsgPackMaxHeader) << reserved;
+}
+
+// ** MsgPackDtoWriter::finish
+void MsgPackDtoWriter::finish()
+{
+	Nested node = m_stack.top();
+	m_stack.pop();
+
+	byte*  header = m_output.buffer() + node.offset;
+	int32  body   = m_output.length() - node.offset - MsgPackMaxHeader;
+	uint32 count  = static_cast<uint32>(node.count);
+	bool   isMap  = node.type == DtoKeyValue;
+	int32  length;
+
+	if (count <= MsgPackMaxFixCount)
+	{
+		header[0] = static_cast<byte>((isMap ? MsgPackFixMap : MsgPackFixArray) | count);
+		length = 1;
+	}
+	else if (count <= 0xFFFF)
+	{
+		header[0] = static_cast<byte>(isMap ? MsgPackMap16 : MsgPackArray16);
+		dtoStoreBigEndian(header + 1, count, 2);
+		length = 3;
+	}
+	else
+	{
+		header[0] = static_cast<byte>(isMap ? MsgPackMap32 : MsgPackArray32);
+		dtoStoreBigEndian(header + 1, count, 4);
+		length = 5;
+	}
+
+	// Move a node body right after a written header
+	if (length < MsgPackMaxHeader)
+	{
+		memmove(header + length, header + MsgPackMaxHeader, body);
+		m_output.rewind(MsgPackMaxHeader - length);
+	}
+}
+
+// ** MsgPackDtoWriter::writeValue
+void MsgPackDtoWriter::writeValue(const DtoValue& value)
+{
+	switch (value.type)
+	{
+	case DtoNull:
+		m_output << static_cast<byte>(MsgPackNil);
+		break;
+
+	case DtoBool:
+		m_output << static_cast<byte>(value.boolean ? MsgPackTrue : MsgPackFalse);
+		break;
+
+	case DtoInt32:
+		writeInteger(value.int32);
+		break;
+
+	case DtoInt64:
+		writeInteger(value.int64);
+		break;
+
+	case DtoTimestamp:
+		writeUnsigned(value.uint64);
+		break;
+
+	case DtoDouble:
+		{
+			uint64 bits;
+			memcpy(&bits, &value.number, sizeof(bits));
+			writeTagged(MsgPackFloat64, bits, 8);
+		}
+		break;
+
+	case DtoDate:
+		{
+			// Dates are stored as milliseconds, while a timestamp extension holds seconds and nanoseconds
+			int64 seconds      = value.int64 / 1000;
+			int64 milliseconds = value.int64 % 1000;
+
+			if (milliseconds < 0)
+			{
+				milliseconds += 1000;
+				seconds--;
+			}
+
+			uint64 nanoseconds = static_cast<uint64>(milliseconds) * 1000000;
+
+			if (seconds >= 0 && seconds <= 0xFFFFFFFF && nanoseconds == 0)
+			{
+				writeTagged(MsgPackFixExt4, MsgPackTimestampExt, 1);
+				writeBigEndian(m_output, seconds, 4);
+			}
+			else if (seconds >= 0 && seconds < (1LL << 34))
+			{
+				writeTagged(MsgPackFixExt8, MsgPackTimestampExt, 1);
+				writeBigEndian(m_output, (nanoseconds << 34) | static_cast<uint64>(seconds), 8);
+			}
+			else
+			{
+				writeTagged(MsgPackExt8, 12, 1);
+				m_output << static_cast<byte>(MsgPackTimestampExt);
+				writeBigEndian(m_output, nanoseconds, 4);
+				writeBigEndian(m_output, seconds, 8);
+			}
+		}
+		break;
+
+	case DtoString:
+		writeString(value.string);
+		break;
+
+	case DtoBinary:
+		writeBinary(value.binary.data, value.binary.length);
+		break;
+
+	case DtoUUID:
+		writeBinary(value.uuid.value, 16);
+		break;
+
+	case DtoRegEx:
+		writeString(value.regex.value);
+		break;
+
+	default:
+		assert(0);
+	}
+}
+
+// ** MsgPackDtoWriter::writeString
+void MsgPackDtoWriter::writeString(const DtoStringView& value)
+{
+	uint32 length = static_cast<uint32>(value.length);
+
+	if (length <= MsgPackMaxFixStr)
+	{
+		m_output << static_cast<byte>(MsgPackFixStr | length);
+	}
+	else if (length <= 0xFF)
+	{
+		writeTagged(MsgPackStr8, length, 1);
+	}
+	else if (length <= 0xFFFF)
+	{
+		writeTagged(MsgPackStr16, length, 2);
+	}
+	else
+	{
+		writeTagged(MsgPackStr32, length, 4);
+	}
+
+	if (length)
+	{
+		m_output << DtoByteArrayOutput::size(length) << reinterpret_cast<const byte*>(value.value);
+	}
+}
+
+// ** MsgPackDtoWriter::writeBinary
+void MsgPackDtoWriter::writeBinary(const byte* data, int32 length)
+{
+	if (length <= 0xFF)
+	{
+		writeTagged(MsgPackBin8, length, 1);
+	}
+	else if (length <= 0xFFFF)
+	{
+		writeTagged(MsgPackBin16, length, 2);
+	}
+	else
+	{
+		writeTagged(MsgPackBin32, length, 4);
+	}
+
+	if (length)
+	{
+		m_output << DtoByteArrayOutput::size(length) << data;
+	}
+}
+
+// ** MsgPackDtoWriter::writeInteger
+void MsgPackDtoWriter::writeInteger(int64 value)
+{
+	if (value >= 0)
+	{
+		writeUnsigned(static_cast<uint64>(value));
+	}
+	else if (value >= -32)
+	{
+		m_output << static_cast<byte>(value);
+	}
+	else if (value >= INT8_MIN)
+	{
+		writeTagged(MsgPackInt8, value, 1);
+	}
+	else if (value >= INT16_MIN)
+	{
+		writeTagged(MsgPackInt16, value, 2);
+	}
+	else if (value >= INT32_MIN)
+	{
+		writeTagged(MsgPackInt32, value, 4);
+	}
+	else
+	{
+		writeTagged(MsgPackInt64, value, 8);
+	}
+}
+
+// ** MsgPackDtoWriter::writeUnsigned
+void MsgPackDtoWriter::writeUnsigned(uint64 value)
+{
+	if (value <= 0x7F)
+	{
+		m_output << static_cast<byte>(value);
+	}
+	else if (value <= 0xFF)
+	{
+		writeTagged(MsgPackUInt8, value, 1);
+	}
+	else if (value <= 0xFFFF)
+	{
+		writeTagged(MsgPackUInt16, value, 2);
+	}
+	else if (value <= 0xFFFFFFFF)
+	{
+		writeTagged(MsgPackUInt32, value, 4);
+	}
+	else
+	{
+		writeTagged(MsgPackUInt64, value, 8);
+	}
+}
+
+// ** MsgPackDtoWriter::writeTagged
+void MsgPackDtoWriter::writeTagged(byte tag, uint64 value, int32 size)
+{
+	byte bytes[9];
+	bytes[0] = tag;
+	dtoStoreBigEndian(bytes + 1, value, size);
+	m_output << DtoByteArrayOutput::size(size + 1) << bytes;
+}
+
+// -------------------------------------------------------- MsgPackDtoReader -------------------------------------------------------- //
+
+// ** MsgPackDtoReader::MsgPackDtoReader
+MsgPackDtoReader::MsgPackDtoReader(const byte* input, int32 length)
+	: m_input(input, length)
+{
+
+}
+
+// ** MsgPackDtoReader::consumed
+int32 MsgPackDtoReader::consumed() const
+{
+	return m_input.consumed();
+}
+
+// ** MsgPackDtoReader::next
+DtoEvent MsgPackDtoReader::next()
+{
+	DtoValue value;
+	int32	 count;
+
+	// A root node is either a map or an array
+	if (m_stack.empty())
+	{
+		if (!readObject(value, count) || (value.type != DtoKeyValue && value.type != DtoSequence))
+		{
+			return error("a MessagePack document should start with a map or an array");
+		}
+
+		return push(value.type, count);
+	}
+
+	Nested& top = m_stack.top();
+
+	if (top.remaining == 0)
+	{
+		return pop();
+	}
+
+	top.remaining--;
+
+	DtoEvent event(DtoEntry);
+
+	// Array items have no keys, so generate them
+	if (top.type == DtoSequence)
+	{
+		event.key.value  = m_text;
+		event.key.length = sprintf_s(m_text, "%d", top.index++);
+	}
+	else
+	{
+		if (!readObject(value, count))
+		{
+			return error("malformed MessagePack map key");
+		}
+
+		switch (value.type)
+		{
+		case DtoString:
+			event.key = value.string;
+			break;
+
+		case DtoInt32:
+			event.key.value  = m_text;
+			event.key.length = sprintf_s(m_text, "%d", value.int32);
+			break;
+
+		case DtoInt64:
+			event.key.value  = m_text;
+			event.key.length = sprintf_s(m_text, "%lld", static_cast<long long>(value.int64));
+			break;
+
+		case DtoTimestamp:
+			event.key.value  = m_text;
+			event.key.length = sprintf_s(m_text, "%llu", static_cast<unsigned long long>(value.uint64));
+			break;
+
+		default:
+			return error("MessagePack map keys should be strings or integers");
+		}
+	}
+
+	if (!readObject(event.data, count))
+	{
+		return error("malformed MessagePack object");
+	}
+
+	if (event.data.type == DtoKeyValue || event.data.type == DtoSequence)
+	{
+		event.type = push(event.data.type, count);
+	}
+
+	return event;
+}
+
+// ** MsgPackDtoReader::readObject
+bool MsgPackDtoReader::readObject(DtoValue& value, int32& count)
+{
+	if (m_input.available() < 1)
+	{
+		return false;
+	}
+
+	byte   tag;
+	uint64 number = 0;
+
+	m_input >> tag;
+
+	// Small integers, strings, maps and arrays are packed right into a tag
+	if (tag < MsgPackFixMap)
+	{
+		value.type  = DtoInt32;
+		value.int32 = tag;
+		return true;
+	}
+
+	if (tag >= MsgPackNegativeFixInt)
+	{
+		value.type  = DtoInt32;
+		value.int32 = static_cast<int32>(tag) - 0x100;
+		return true;
+	}
+
+	if (tag < MsgPackNil)
+	{
+		if (tag >= MsgPackFixStr)
+		{
+			value.type = DtoString;
+			value.string.length = tag - MsgPackFixStr;
+			return readBytes(value.string.length, reinterpret_cast<const byte*&>(value.string.value));
+		}
+
+		value.type = tag >= MsgPackFixArray ? DtoSequence : DtoKeyValue;
+		number = tag & MsgPackMaxFixCount;
+	}
+	else
+	{
+		switch (tag)
+		{
+		case MsgPackNil:
+			value.type = DtoNull;
+			return true;
+
+		case MsgPackFalse:
+		case MsgPackTrue:
+			value.type    = DtoBool;
+			value.boolean = tag == MsgPackTrue;
+			return true;
+
+		case MsgPackBin8:
+		case MsgPackBin16:
+		case MsgPackBin32:
+			if (!readUnsigned(1 << (tag - MsgPackBin8), number) || !readBytes(number, value.binary.data))
+			{
+				return false;
+			}
+			value.type           = DtoBinary;
+			value.binary.subtype = 0;
+			value.binary.length  = static_cast<int32>(number);
+			return true;
+
+		case MsgPackExt8:
+		case MsgPackExt16:
+		case MsgPackExt32:
+			return readUnsigned(1 << (tag - MsgPackExt8), number) && number <= INT32_MAX && readExtension(value, static_cast<int32>(number));
+
+		case MsgPackFloat32:
+			{
+				float single;
+				uint32 bits;
+
+				if (!readUnsigned(4, number))
+				{
+					return false;
+				}
+
+				bits = static_cast<uint32>(number);
+				memcpy(&single, &bits, sizeof(single));
+				value.type   = DtoDouble;
+				value.number = single;
+			}
+			return true;
+
+		case MsgPackFloat64:
+			if (!readUnsigned(8, number))
+			{
+				return false;
+			}
+			value.type = DtoDouble;
+			memcpy(&value.number, &number, sizeof(value.number));
+			return true;
+
+		case MsgPackUInt8:
+		case MsgPackUInt16:
+		case MsgPackUInt32:
+		case MsgPackUInt64:
+			if (!readUnsigned(1 << (tag - MsgPackUInt8), number))
+			{
+				return false;
+			}
+
+			if (number > INT64_MAX)
+			{
+				value.type   = DtoTimestamp;
+				value.uint64 = number;
+			}
+			else
+			{
+				dtoSetInteger(value, static_cast<int64>(number));
+			}
+			return true;
+
+		case MsgPackInt8:
+		case MsgPackInt16:
+		case MsgPackInt32:
+		case MsgPackInt64:
+			{
+				int32 size = 1 << (tag - MsgPackInt8);
+
+				if (!readUnsigned(size, number))
+				{
+					return false;
+				}
+
+				// Sign-extend a value to 64 bits
+				int32 shift = 64 - size * 8;
+				dtoSetInteger(value, static_cast<int64>(number << shift) >> shift);
+			}
+			return true;
+
+		case MsgPackFixExt1:
+		case MsgPackFixExt2:
+		case MsgPackFixExt4:
+		case MsgPackFixExt8:
+		case MsgPackFixExt16:
+			return readExtension(value, 1 << (tag - MsgPackFixExt1));
+
+		case MsgPackStr8:
+		case MsgPackStr16:
+		case MsgPackStr32:
+			if (!readUnsigned(1 << (tag - MsgPackStr8), number) || !readBytes(number, reinterpret_cast<const byte*&>(value.string.value)))
+			{
+				return false;
+			}
+			value.type          = DtoString;
+			value.string.length = static_cast<int32>(number);
+			return true;
+
+		case MsgPackArray16:
+		case MsgPackArray32:
+		case MsgPackMap16:
+		case MsgPackMap32:
+			value.type = tag >= MsgPackMap16 ? DtoKeyValue : DtoSequence;
+
+			if (!readUnsigned(2 << (tag - (value.type == DtoKeyValue ? MsgPackMap16 : MsgPackArray16)), number))
+			{
+				return false;
+			}
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	// Each element takes at least one byte, so reject counts that can not fit into a rest of an input stream
+	uint64 elements = value.type == DtoKeyValue ? number * 2 : number;
+
+	if (elements > static_cast<uint64>(m_input.available()))
+	{
+		return false;
+	}
+
+	count = static_cast<int32>(number);
+	return true;
+}
+
+// ** MsgPackDtoReader::readExtension
+bool MsgPackDtoReader::readExtension(DtoValue& value, int32 length)
+{
+	const byte* data;
+	byte		type;
+
+	if (m_input.available() < 1)
+	{
+		return false;
+	}
+
+	m_input >> type;
+
+	if (!readBytes(length, data))
+	{
+		return false;
+	}
+
+	if (type == MsgPackTimestampExt)
+	{
+		// Convert a timestamp extension to milliseconds
+		int64  seconds;
+		uint64 nanoseconds;
+
+		switch (length)
+		{
+		case 4:
+			seconds     = static_cast<int64>(dtoLoadBigEndian(data, 4));
+			nanoseconds = 0;
+			break;
+
+		case 8:
+			{
+				uint64 packed = dtoLoadBigEndian(data, 8);
+				seconds     = static_cast<int64>(packed & 0x3FFFFFFFFULL);
+				nanoseconds = packed >> 34;
+			}
+			break;
+
+		case 12:
+			nanoseconds = dtoLoadBigEndian(data, 4);
+			seconds     = static_cast<int64>(dtoLoadBigEndian(data + 4, 8));
+			break;
+
+		default:
+			return false;
+		}
+
+		if (dtoEpochMilliseconds(seconds, static_cast<int64>(nanoseconds / 1000000), value.int64))
+		{
+			value.type = DtoDate;
+			return true;
+		}
+
+		// A timestamp that does not fit into 64-bit milliseconds is kept as raw extension bytes
+	}
+
+	value.type           = DtoBinary;
+	value.binary.subtype = 0;
+	value.binary.data    = data;
+	value.binary.length  = length;
+
+	return true;
+}
+
+// ** MsgPackDtoReader::readUnsigned
+bool MsgPackDtoReader::readUnsigned(int32 size, uint64& value)
+{
+	const byte* data;
+
+	if (!readBytes(size, data))
+	{
+		return false;
+	}
+
+	value = dtoLoadBigEndian(data, size);
+	return true;
+}
+
+// ** MsgPackDtoReader::readBytes
+bool MsgPackDtoReader::readBytes(uint64 length, const byte*& data)
+{
+	if (length > static_cast<uint64>(m_input.available()))
+	{
+		return false;
+	}
+
+	data = m_input.advance(static_cast<int32>(length));
+	return true;
+}
+
+// ** MsgPackDtoReader::push
+DtoEventType MsgPackDtoReader::push(DtoValueType type, int32 count)
+{
+	m_stack.push(Nested(type, count));
+
+	if (m_stack.size() == 1)
+	{
+		return DtoStreamStart;
+	}
+
+	return type == DtoSequence ? DtoSequenceStart : DtoKeyValueStart;
+}
+
+// ** MsgPackDtoReader::pop
+DtoEventType MsgPackDtoReader::pop()
+{
+	assert(m_stack.size());
+	DtoValueType type = m_stack.top().type;
+	m_stack.pop();
+
+	if (m_stack.empty())
+	{
+		return DtoStreamEnd;
+	}
+
+	return type == DtoSequence ? DtoSequenceEnd : DtoKeyValueEnd;
+}
+
+// ** MsgPackDtoReader::error
+DtoEvent MsgPackDtoReader::error(cstring message) const
+{
+	if (g_errorHandler)
+	{
+		char text[DtoTokenInput::MaxMessageLength];
+		snprintf(text, sizeof(text), "error: %s", message);
+		g_errorHandler(text);
+	}
+
+	return DtoError;
+}
+
+DTO_END
\ No newline at end of file
@@ -0,0 +1,169 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_MsgPack_H__
+#define __Dto_MsgPack_H__
+
+#include <stack>
+
+DTO_BEGIN
+
+	/*!
+	 Writes a DTO as a MessagePack document with a map or an array at the root.
+
+	 Node sizes are not known until a node is closed, so a writer reserves a widest
+	 header for each node and moves a node body back once a final element count is known.
+
+	 Doubles are written as float64, integers and timestamps use a shortest integer form, dates
+	 are written as a timestamp extension (-1), binary blobs and UUIDs are written as bin objects
+	 and regular expressions are written as strings.
+	 */
+	class MsgPackDtoWriter : public DtoWriter
+	{
+	public:
+
+							//! Constructs a MessagePack writer.
+							MsgPackDtoWriter(byte* output, int32 capacity);
+
+		//! Consumes an event an writes next entry to an output stream.
+		virtual int32		consume(const DtoEvent& event);
+
+		//! Returns a total number of bytes written to an output.
+		int32				length() const;
+
+	private:
+
+		//! Writes an entry key if a parent node is a map and increments an element counter of a parent node.
+		void				entry(const DtoStringView& key);
+
+		//! Reserves a node header and pushes a node to the stack.
+		void				start(DtoValueType type);
+
+		//! Pops a node from the stack and writes the shortest header for a total number of node elements.
+		void				finish();
+
+		//! Writes a scalar value.
+		void				writeValue(const DtoValue& value);
+
+		//! Writes a string header followed by string bytes.
+		void				writeString(const DtoStringView& value);
+
+		//! Writes a binary header followed by binary data.
+		void				writeBinary(const byte* data, int32 length);
+
+		//! Writes a signed integer using the shortest form.
+		void				writeInteger(int64 value);
+
+		//! Writes an unsigned integer using the shortest form.
+		void				writeUnsigned(uint64 value);
+
+		//! Writes a tag byte followed by a big-endian integer of a specified size.
+		void				writeTagged(byte tag, uint64 value, int32 size);
+
+	private:
+
+		//! A structure to hold nested node info.
+		struct Nested
+		{
+			DtoValueType	type;	//!< A node type.
+			int32			offset;	//!< A node header offset.
+			int32			count;	//!< A total number of node elements written so far.
+
+							//! Constructs a Nested instance.
+							Nested(DtoValueType type, int32 offset)
+								: type(type), offset(offset), count(0) {}
+		};
+
+		DtoByteArrayOutput	m_output;	//!< An output data buffer.
+		std::stack<Nested>	m_stack;	//!< A node stack to track nesting.
+	};
+
+	/*!
+	 Reads a MessagePack document with a map or an array at the root.
+
+	 Strings and binary objects are returned as views into an input buffer. Integer and string
+	 map keys are supported, array items get index keys. Unsigned integers that do not fit into
+	 a signed 64-bit integer are reported as timestamps, timestamp extensions (-1) are reported as dates
+	 and all other extension types are reported as binary blobs.
+	 */
+	class MsgPackDtoReader : public DtoReader
+	{
+	public:
+
+							//! Constructs a MessagePack reader.
+							MsgPackDtoReader(const byte* input, int32 length);
+
+		//! Decodes next event from an input stream.
+		virtual DtoEvent	next();
+
+		//! Returns a total number of consumed bytes.
+		virtual int32		consumed() const;
+
+	private:
+
+		//! Reads a next object, for maps and arrays outputs a total number of elements, returns false if an input stream is malformed.
+		bool				readObject(DtoValue& value, int32& count);
+
+		//! Reads an extension object payload of a specified length.
+		bool				readExtension(DtoValue& value, int32 length);
+
+		//! Reads a big-endian unsigned integer of a specified size, returns false if an input stream is too short.
+		bool				readUnsigned(int32 size, uint64& value);
+
+		//! Reads a view of a specified length, returns false if an input stream is too short.
+		bool				readBytes(uint64 length, const byte*& data);
+
+		//! Pushes a new node to the stack.
+		DtoEventType		push(DtoValueType type, int32 count);
+
+		//! Pops a node from the stack.
+		DtoEventType		pop();
+
+		//! Emits an error message and returns an error event.
+		DtoEvent			error(cstring message) const;
+
+	private:
+
+		//! A structure to hold nested node info.
+		struct Nested
+		{
+			DtoValueType	type;		//!< A node type.
+			int32			remaining;	//!< A total number of elements left to read.
+			int32			index;		//!< A next array item index.
+
+							//! Constructs a Nested instance.
+							Nested(DtoValueType type, int32 count)
+								: type(type), remaining(count), index(0) {}
+		};
+
+		DtoByteBufferInput	m_input;	//!< An input byte buffer stream.
+		std::stack<Nested>	m_stack;	//!< A node stack to track nesting.
+		char				m_text[24];	//!< A temporary buffer used for array item and integer map keys.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_MsgPack_H__	*/
\ No newline at end of file
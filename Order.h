@@ -0,0 +1,90 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Order_H__
+#define __Dto_Order_H__
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+DTO_BEGIN
+
+	// Ordering helpers shared by dtoCompare and DtoIndexKey, so a sort order and an index order can't drift apart.
+	// This header is internal to a library and is not included by Dto.h.
+
+	//! Returns a negative value, zero or a positive value if a is less than, equal to or greater than b.
+	template<typename TValue>
+	inline int32 dtoOrder(TValue a, TValue b)
+	{
+		return a < b ? -1 : (b < a ? 1 : 0);
+	}
+
+	//! Orders byte strings lexicographically, a shorter prefix goes first.
+	inline int32 dtoOrderBytes(const void* a, int32 aLength, const void* b, int32 bLength)
+	{
+		int32 length = std::min(aLength, bLength);
+		int32 result = length ? memcmp(a, b, length) : 0;
+		return result ? result : dtoOrder(aLength, bLength);
+	}
+
+	//! Orders doubles, NaN is ordered before all other numbers to keep the ordering total.
+	inline int32 dtoOrderDoubles(double a, double b)
+	{
+		if (a != a || b != b)
+		{
+			return (b != b) - (a != a);
+		}
+
+		return dtoOrder(a, b);
+	}
+
+	//! Converts an integral double that fits into 64 bits to an integer, so it is equal to an integer with the same value.
+	inline bool dtoIntegralNumber(double value, int64& integer)
+	{
+		if (value >= -9223372036854775808.0 && value < 9223372036854775808.0 && value == floor(value))
+		{
+			integer = static_cast<int64>(value);
+			return true;
+		}
+
+		return false;
+	}
+
+	//! Orders numbers that were split by dtoIntegralNumber, integers are compared exactly and everything else as doubles.
+	inline int32 dtoOrderNumbers(bool aIsInteger, int64 aInteger, double aNumber, bool bIsInteger, int64 bInteger, double bNumber)
+	{
+		if (aIsInteger && bIsInteger)
+		{
+			return dtoOrder(aInteger, bInteger);
+		}
+
+		return dtoOrderDoubles(aIsInteger ? static_cast<double>(aInteger) : aNumber, bIsInteger ? static_cast<double>(bInteger) : bNumber);
+	}
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Order_H__	*/
\ No newline at end of file
@@ -0,0 +1,1078 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Parallel.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <limits.h>
+#include <string.h>
+#include <algorithm>
+
+DTO_BEGIN
+
+// ** dtoJsonBinaryBound
+int32 dtoJsonBinaryBound(int64 length)
+{
+	// The worst case is a sequence of one-character values, where each two characters
+	// of a JSON text turn into a type byte, a decimal index key and an 8-byte value.
+	int64 bound = length * 16 + 64;
+	return length >= 0 && bound <= INT_MAX ? static_cast<int32>(bound) : -1;
+}
+
+// ** dtoBinaryJsonBound
+int32 dtoBinaryJsonBound(int64 length)
+{
+	// The worst case is a string of control characters where each byte is escaped
+	// with a six-character \u00XX sequence, all other values take less space.
+	int64 bound = length * 6 + 64;
+	return length >= 0 && bound <= INT_MAX ? static_cast<int32>(bound) : -1;
+}
+
+// -------------------------------------------------------- DtoThreadPool -------------------------------------------------------- //
+
+// ** DtoThreadPool::DtoThreadPool
+DtoThreadPool::DtoThreadPool(int32 workers)
+	: m_task(NULL)
+	, m_pending(0)
+	, m_batch(0)
+	, m_stop(false)
+{
+	if (workers <= 0)
+	{
+		workers = std::max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+	}
+
+	for (int32 i = 0; i < workers; i++)
+	{
+		m_workers.push_back(new Worker);
+	}
+
+	for (int32 i = 0; i < workers; i++)
+	{
+		m_workers[i]->thread = std::thread(&DtoThreadPool::work, this, i);
+	}
+}
+
+// ** DtoThreadPool::~DtoThreadPool
+DtoThreadPool::~DtoThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_started.notify_all();
+
+	// Other workers may still look into a queue of a stopped one, so release them after all threads exit
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->thread.join();
+	}
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		delete m_workers[i];
+	}
+}
+
+// ** DtoThreadPool::size
+int32 DtoThreadPool::size() const
+{
+	return static_cast<int32>(m_workers.size());
+}
+
+// ** DtoThreadPool::run
+void DtoThreadPool::run(int32 count, const Task& task)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// A batch state should be set before any task is queued, because a worker that is still
+	// looking for tasks of a previous batch may take a new one right away.
+	m_task    = &task;
+	m_pending = count;
+
+	// Distribute tasks between workers in contiguous ranges, so neighbouring tasks run on the same thread
+	int32 workers = size();
+
+	for (int32 i = 0; i < workers; i++)
+	{
+		Worker* worker = m_workers[i];
+		std::lock_guard<std::mutex> queueLock(worker->mutex);
+
+		for (int32 j = count * i / workers, n = count * (i + 1) / workers; j < n; j++)
+		{
+			worker->tasks.push_back(j);
+		}
+	}
+
+	m_batch++;
+	m_started.notify_all();
+
+	// Wait until all tasks are complete
+	m_finished.wait(lock, [this]() { return m_pending == 0; });
+	m_task = NULL;
+}
+
+// ** DtoThreadPool::work
+void DtoThreadPool::work(int32 worker)
+{
+	int64 batch = 0;
+
+	for (;;)
+	{
+		// Wait for a next batch of tasks
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_started.wait(lock, [this, batch]() { return m_stop || m_batch != batch; });
+
+			if (m_stop)
+			{
+				return;
+			}
+
+			batch = m_batch;
+		}
+
+		// Execute tasks until all queues are empty
+		int32 task;
+
+		while (take(worker, task))
+		{
+			(*m_task)(task, worker);
+
+			if (--m_pending == 0)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_finished.notify_all();
+			}
+		}
+	}
+}
+
+// ** DtoThreadPool::take
+bool DtoThreadPool::take(int32 worker, int32& task)
+{
+	// First try to take a task from the front of an own queue
+	{
+		Worker* own = m_workers[worker];
+		std::lock_guard<std::mutex> lock(own->mutex);
+
+		if (!own->tasks.empty())
+		{
+			task = own->tasks.front();
+			own->tasks.pop_front();
+			return true;
+		}
+	}
+
+	// Now steal a task from the back of another queue
+	int32 workers = size();
+
+	for (int32 i = 1; i < workers; i++)
+	{
+		Worker* victim = m_workers[(worker + i) % workers];
+		std::lock_guard<std::mutex> lock(victim->mutex);
+
+		if (!victim->tasks.empty())
+		{
+			task = victim->tasks.back();
+			victim->tasks.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ----------------------------------------------------- DtoJsonLinesReader ------------------------------------------------------ //
+
+// ** DtoJsonLinesReader::DtoJsonLinesReader
+DtoJsonLinesReader::DtoJsonLinesReader(DtoThreadPool& pool)
+	: m_pool(pool)
+	, m_chunkSize(1 << 20)
+{
+	for (int32 i = 0; i < pool.size(); i++)
+	{
+		m_arenas.push_back(new DtoArena);
+	}
+}
+
+// ** DtoJsonLinesReader::~DtoJsonLinesReader
+DtoJsonLinesReader::~DtoJsonLinesReader()
+{
+	for (size_t i = 0; i < m_arenas.size(); i++)
+	{
+		delete m_arenas[i];
+	}
+}
+
+// ** DtoJsonLinesReader::setChunkSize
+void DtoJsonLinesReader::setChunkSize(int32 value)
+{
+	assert(value > 0);
+	m_chunkSize = value;
+}
+
+// ** DtoJsonLinesReader::parseFile
+bool DtoJsonLinesReader::parseFile(cstring path)
+{
+	// An empty file can't be mapped but is still a valid stream without documents, any other file should be mapped
+	if (!m_file.open(path) && DtoMappedFile::size(path) != 0)
+	{
+		return false;
+	}
+
+	parse(m_file.data(), m_file.size());
+	return true;
+}
+
+// ** DtoJsonLinesReader::parse
+void DtoJsonLinesReader::parse(const byte* input, int64 length)
+{
+	// Release results of a previous run
+	for (size_t i = 0; i < m_arenas.size(); i++)
+	{
+		m_arenas[i]->clear();
+	}
+
+	m_chunks.clear();
+	m_documents.clear();
+	m_lines.clear();
+	m_errors.clear();
+
+	// Split an input into chunks at line boundaries
+	const byte* end = input + length;
+
+	for (const byte* ptr = input; ptr < end;)
+	{
+		const byte* split = ptr + std::min<int64>(m_chunkSize, end - ptr);
+
+		if (split < end)
+		{
+			const byte* newLine = reinterpret_cast<const byte*>(memchr(split, '\n', end - split));
+			split = newLine ? newLine + 1 : end;
+		}
+
+		Chunk chunk;
+		chunk.begin = ptr;
+		chunk.end   = split;
+		chunk.lines = 0;
+		m_chunks.push_back(chunk);
+
+		ptr = split;
+	}
+
+	// Parse all chunks in parallel
+	m_pool.run(static_cast<int32>(m_chunks.size()), [this](int32 task, int32 worker)
+	{
+		parseChunk(m_chunks[task], *m_arenas[worker]);
+	});
+
+	// Merge parsed documents in the input order
+	int32 line = 1;
+
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		const Chunk& chunk = m_chunks[i];
+
+		for (size_t j = 0; j < chunk.documents.size(); j++)
+		{
+			m_documents.push_back(chunk.documents[j]);
+			m_lines.push_back(line + chunk.lineIndex[j]);
+		}
+
+		for (size_t j = 0; j < chunk.errors.size(); j++)
+		{
+			m_errors.push_back(line + chunk.errors[j]);
+		}
+
+		line += chunk.lines;
+	}
+}
+
+// ** DtoJsonLinesReader::parseChunk
+void DtoJsonLinesReader::parseChunk(Chunk& chunk, DtoArena& arena)
+{
+	for (const byte* ptr = chunk.begin; ptr < chunk.end; chunk.lines++)
+	{
+		// Find the end of a line
+		const byte* newLine = reinterpret_cast<const byte*>(memchr(ptr, '\n', chunk.end - ptr));
+		const byte* end     = newLine ? newLine : chunk.end;
+		const byte* line    = ptr;
+		ptr = newLine ? newLine + 1 : chunk.end;
+
+		// Skip leading and trailing whitespace, so blank lines can be ignored
+		while (line < end && (*line == ' ' || *line == '\t' || *line == '\r'))
+		{
+			line++;
+		}
+		while (end > line && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+		{
+			end--;
+		}
+
+		if (line == end)
+		{
+			continue;
+		}
+
+		// A line that can't be converted within a 32-bit buffer is reported as malformed
+		int32 capacity = dtoJsonBinaryBound(end - line);
+
+		if (capacity < 0)
+		{
+			chunk.errors.push_back(chunk.lines);
+			continue;
+		}
+
+		// Parse a line directly to an arena
+		int32 length = static_cast<int32>(end - line);
+		byte* output = arena.reserve(capacity);
+
+		if (!dtoConvert<JsonDtoReader, BinaryDtoWriter>(line, length, output, capacity))
+		{
+			chunk.errors.push_back(chunk.lines);
+			continue;
+		}
+
+		Dto document(output, capacity);
+		arena.commit(document.length());
+		chunk.documents.push_back(Dto(output, document.length()));
+		chunk.lineIndex.push_back(chunk.lines);
+	}
+}
+
+// ** DtoJsonLinesReader::documentCount
+int32 DtoJsonLinesReader::documentCount() const
+{
+	return static_cast<int32>(m_documents.size());
+}
+
+// ** DtoJsonLinesReader::document
+const Dto& DtoJsonLinesReader::document(int32 index) const
+{
+	assert(index >= 0 && index < documentCount());
+	return m_documents[index];
+}
+
+// ** DtoJsonLinesReader::documentLine
+int32 DtoJsonLinesReader::documentLine(int32 index) const
+{
+	assert(index >= 0 && index < documentCount());
+	return m_lines[index];
+}
+
+// ** DtoJsonLinesReader::errorCount
+int32 DtoJsonLinesReader::errorCount() const
+{
+	return static_cast<int32>(m_errors.size());
+}
+
+// ** DtoJsonLinesReader::errorLine
+int32 DtoJsonLinesReader::errorLine(int32 index) const
+{
+	assert(index >= 0 && index < errorCount());
+	return m_errors[index];
+}
+
+// ----------------------------------------------------- DtoJsonLinesWriter ------------------------------------------------------ //
+
+// ** DtoJsonLinesWriter::DtoJsonLinesWriter
+DtoJsonLinesWriter::DtoJsonLinesWriter(DtoThreadPool& pool)
+	: m_pool(pool)
+	, m_chunkSize(4096)
+	, m_isAsciiOnly(false)
+{
+}
+
+// ** DtoJsonLinesWriter::setChunkSize
+void DtoJsonLinesWriter::setChunkSize(int32 value)
+{
+	assert(value > 0);
+	m_chunkSize = value;
+}
+
+// ** DtoJsonLinesWriter::setAsciiOnly
+void DtoJsonLinesWriter::setAsciiOnly(bool value)
+{
+	m_isAsciiOnly = value;
+}
+
+// ** DtoJsonLinesWriter::errorCount
+int32 DtoJsonLinesWriter::errorCount() const
+{
+	return static_cast<int32>(m_errors.size());
+}
+
+// ** DtoJsonLinesWriter::errorRecord
+int32 DtoJsonLinesWriter::errorRecord(int32 index) const
+{
+	assert(index >= 0 && index < errorCount());
+	return m_errors[index];
+}
+
+// ** DtoJsonLinesWriter::write
+void DtoJsonLinesWriter::write(const Dto* records, int32 count, std::vector<byte>& output)
+{
+	write(records, count, [&output](const byte* data, int32 length)
+	{
+		output.insert(output.end(), data, data + length);
+		return true;
+	});
+}
+
+// ** DtoJsonLinesWriter::writeFile
+bool DtoJsonLinesWriter::writeFile(cstring path, const Dto* records, int32 count)
+{
+	FILE* file = fopen(path, "wb");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool result = write(records, count, [file](const byte* data, int32 length)
+	{
+		return fwrite(data, 1, length, file) == static_cast<size_t>(length);
+	});
+
+	return fclose(file) == 0 && result;
+}
+
+// ** DtoJsonLinesWriter::write
+bool DtoJsonLinesWriter::write(const Dto* records, int32 count, const Output& output)
+{
+	// Records are processed in windows of a few chunks per worker, so a memory
+	// footprint does not depend on a total number of records.
+	int32 window = m_pool.size() * 4;
+	m_chunks.resize(window);
+
+	// Workers skip formatting after an output failure without taking a lock
+	std::atomic<bool> failed(false);
+	m_errors.clear();
+
+	for (int32 first = 0; first < count && !failed; first += window * m_chunkSize)
+	{
+		int32 chunkCount = std::min(window, (count - first + m_chunkSize - 1) / m_chunkSize);
+
+		for (int32 i = 0; i < chunkCount; i++)
+		{
+			Chunk& chunk = m_chunks[i];
+			chunk.begin  = first + i * m_chunkSize;
+			chunk.end    = std::min(count, chunk.begin + m_chunkSize);
+			chunk.ready  = false;
+			chunk.length = 0;
+			chunk.errors.clear();
+		}
+
+		// A worker that completes a chunk flushes it together with all following
+		// completed chunks once every preceding chunk is written.
+		std::mutex mutex;
+		int32 next = 0;
+
+		m_pool.run(chunkCount, [&](int32 task, int32)
+		{
+			if (!failed)
+			{
+				formatChunk(m_chunks[task], records);
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			m_chunks[task].ready = true;
+
+			for (; next < chunkCount && m_chunks[next].ready; next++)
+			{
+				const Chunk& completed = m_chunks[next];
+				m_errors.insert(m_errors.end(), completed.errors.begin(), completed.errors.end());
+
+				if (!failed && completed.length > 0 && !output(&completed.text[0], completed.length))
+				{
+					failed = true;
+				}
+			}
+		});
+	}
+
+	return !failed;
+}
+
+// ** DtoJsonLinesWriter::formatChunk
+void DtoJsonLinesWriter::formatChunk(Chunk& chunk, const Dto* records) const
+{
+	std::vector<byte>& text = chunk.text;
+	chunk.length = 0;
+
+	for (int32 i = chunk.begin; i < chunk.end; i++)
+	{
+		const Dto& record = records[i];
+
+		// A record should be a complete document that fits it's buffer and ends with a terminator
+		if (!record || record.length() < 5 || record.length() > record.capacity() || record.data()[record.length() - 1] != DtoEnd)
+		{
+			chunk.errors.push_back(i);
+			continue;
+		}
+
+		// Reserve a worst case space for a record, a buffer only grows so it is not cleared on each window
+		int32 capacity = dtoBinaryJsonBound(record.length());
+
+		if (capacity < 0)
+		{
+			chunk.errors.push_back(i);
+			continue;
+		}
+
+		if (static_cast<int32>(text.size()) < chunk.length + capacity)
+		{
+			text.resize(std::max(chunk.length + capacity, static_cast<int32>(text.size()) * 2));
+		}
+
+		// Now format a record in place
+		BinaryDtoReader reader(record.data(), record.length());
+		JsonDtoWriter writer(&text[chunk.length], capacity);
+		writer.setAsciiOnly(m_isAsciiOnly);
+
+		DtoEvent event;
+
+		do
+		{
+			event = reader.next();
+
+			if (event == DtoError)
+			{
+				break;
+			}
+
+			writer.consume(event);
+		} while (event.type != DtoStreamEnd);
+
+		if (event == DtoError)
+		{
+			chunk.errors.push_back(i);
+			continue;
+		}
+
+		// Replace a zero terminator with a line break
+		chunk.length += writer.length();
+		text[chunk.length - 1] = '\n';
+	}
+}
+
+// ----------------------------------------------------- DtoJsonArrayReader ------------------------------------------------------ //
+
+/*!
+ Parses a comma-separated list of array elements without enclosing brackets as a root sequence.
+ */
+class JsonDtoItemsReader : public JsonDtoReader
+{
+public:
+
+						//! Constructs a JsonDtoItemsReader instance.
+						JsonDtoItemsReader(const byte* input, int32 length)
+							: JsonDtoReader(input, length) {}
+
+	//! Parses a next event from an input stream.
+	virtual DtoEvent	next()
+	{
+		if (m_stack.empty())
+		{
+			m_stack.push(static_cast<EventParser>(&JsonDtoItemsReader::parseItems));
+		}
+
+		return JsonDtoReader::next();
+	}
+
+private:
+
+	//! A root event parser.
+	DtoEvent			parseItems()
+	{
+		m_input.nextNonSpace();
+		m_stack.push(static_cast<EventParser>(&JsonDtoItemsReader::expectItemsEnd));
+		m_index.push(0);
+		if (!m_input.check(DtoTokenInput::End))
+		{
+			m_stack.push(&JsonDtoItemsReader::parseItem);
+		}
+		return DtoStreamStart;
+	}
+
+	//! Expects to reach the end of an input after the last element.
+	DtoEvent			expectItemsEnd()
+	{
+		if (m_input.expect(DtoTokenInput::End, false))
+		{
+			m_index.pop();
+			return DtoStreamEnd;
+		}
+
+		return DtoError;
+	}
+};
+
+//! Returns true if a character at specified position is escaped by a preceding backslash.
+static bool isEscapedCharacter(const byte* ptr)
+{
+	// Backslashes are only valid inside strings, so an escape state does not depend on a string state
+	// of a valid JSON text. An array body is always preceded by a bracket which stops the scan.
+	int32 count = 0;
+
+	while (ptr[-count - 1] == '\\')
+	{
+		count++;
+	}
+
+	return count % 2 == 1;
+}
+
+//! Returns a total length of decimal index keys for a specified range of indices.
+static int64 indexKeysLength(int64 first, int64 count)
+{
+	int64 result = 0;
+	int64 end    = first + count;
+
+	for (int64 upper = 10, digits = 1; first < end; upper *= 10, digits++)
+	{
+		if (first >= upper)
+		{
+			continue;
+		}
+
+		int64 last = std::min(end, upper);
+		result += (last - first) * digits;
+		first = last;
+	}
+
+	return result;
+}
+
+// ** DtoJsonArrayReader::DtoJsonArrayReader
+DtoJsonArrayReader::DtoJsonArrayReader(DtoThreadPool& pool)
+	: m_pool(pool)
+	, m_chunkSize(1 << 20)
+{
+	for (int32 i = 0; i < pool.size(); i++)
+	{
+		m_arenas.push_back(new DtoArena);
+	}
+}
+
+// ** DtoJsonArrayReader::~DtoJsonArrayReader
+DtoJsonArrayReader::~DtoJsonArrayReader()
+{
+	for (size_t i = 0; i < m_arenas.size(); i++)
+	{
+		delete m_arenas[i];
+	}
+}
+
+// ** DtoJsonArrayReader::setChunkSize
+void DtoJsonArrayReader::setChunkSize(int32 value)
+{
+	assert(value > 0);
+	m_chunkSize = value;
+}
+
+// ** DtoJsonArrayReader::document
+const Dto& DtoJsonArrayReader::document() const
+{
+	return m_document;
+}
+
+// ** DtoJsonArrayReader::parseFile
+bool DtoJsonArrayReader::parseFile(cstring path)
+{
+	if (!m_file.open(path))
+	{
+		return false;
+	}
+
+	return parse(m_file.data(), m_file.size());
+}
+
+// ** DtoJsonArrayReader::parse
+bool DtoJsonArrayReader::parse(const byte* input, int64 length)
+{
+	// Release results of a previous run
+	for (size_t i = 0; i < m_arenas.size(); i++)
+	{
+		m_arenas[i]->clear();
+	}
+
+	m_segments.clear();
+	m_pieces.clear();
+	m_document = Dto();
+
+	// Only a top-level array can be split into pieces
+	const byte* begin = input;
+	const byte* end   = input + length;
+
+	while (begin < end && isspace(*begin))
+	{
+		begin++;
+	}
+	while (end > begin && isspace(end[-1]))
+	{
+		end--;
+	}
+
+	if (end - begin < 2 || *begin != '[' || end[-1] != ']')
+	{
+		return parseSerial(input, length);
+	}
+
+	begin++;
+	end--;
+
+	// Split an array body into segments of a fixed size and scan them in parallel
+	for (const byte* ptr = begin; ptr < end; ptr += std::min<int64>(m_chunkSize, end - ptr))
+	{
+		Segment segment;
+		segment.begin = ptr;
+		segment.end   = ptr + std::min<int64>(m_chunkSize, end - ptr);
+		m_segments.push_back(segment);
+	}
+
+	int32 segmentCount = static_cast<int32>(m_segments.size());
+
+	m_pool.run(segmentCount, [this](int32 task, int32)
+	{
+		scanSegment(m_segments[task]);
+	});
+
+	// Now resolve an actual string state and nesting depth at the start of each segment
+	bool  inString = false;
+	int64 depth    = 0;
+
+	for (int32 i = 0; i < segmentCount; i++)
+	{
+		Segment& segment = m_segments[i];
+		segment.inString = inString;
+		segment.depth    = depth;
+		depth   += inString ? segment.depthIn : segment.depthOut;
+		inString = inString != segment.quoted;
+	}
+
+	// An unbalanced input can't be split, so let the serial parser report an error
+	if (inString || depth != 0)
+	{
+		return parseSerial(input, length);
+	}
+
+	// Find a first top-level comma inside each segment, the first segment always starts a piece
+	m_pool.run(segmentCount - 1, [this](int32 task, int32)
+	{
+		splitSegment(m_segments[task + 1]);
+	});
+
+	Piece piece;
+	piece.begin = begin;
+
+	for (int32 i = 1; i < segmentCount; i++)
+	{
+		if (m_segments[i].split)
+		{
+			piece.end = m_segments[i].split;
+			m_pieces.push_back(piece);
+			piece.begin = piece.end + 1;
+		}
+	}
+
+	piece.end = end;
+	m_pieces.push_back(piece);
+
+	// Parse all pieces in parallel
+	int32 pieceCount = static_cast<int32>(m_pieces.size());
+	std::atomic<bool> failed(false);
+
+	m_pool.run(pieceCount, [this, &failed](int32 task, int32 worker)
+	{
+		if (!failed && !parsePiece(m_pieces[task], *m_arenas[worker]))
+		{
+			failed = true;
+		}
+	});
+
+	if (failed)
+	{
+		return false;
+	}
+
+	// Calculate piece offsets inside a resulting document, keys are replaced by indices inside a whole array
+	int64 size  = 4;
+	int32 index = 0;
+
+	for (int32 i = 0; i < pieceCount; i++)
+	{
+		Piece& piece = m_pieces[i];
+
+		// Only an empty array may contain an empty piece
+		if (piece.count == 0 && pieceCount > 1)
+		{
+			return false;
+		}
+
+		piece.first  = index;
+		piece.offset = size;
+		size  += piece.length - indexKeysLength(0, piece.count) + indexKeysLength(index, piece.count);
+		index += piece.count;
+	}
+
+	size += 1;
+
+	if (size > INT32_MAX)
+	{
+		return false;
+	}
+
+	// Finally stitch pieces in parallel
+	m_output.resize(size);
+	byte* output = &m_output[0];
+
+	m_pool.run(pieceCount, [this, output](int32 task, int32)
+	{
+		stitchPiece(m_pieces[task], output);
+	});
+
+	*reinterpret_cast<int32*>(output) = static_cast<int32>(size);
+	output[size - 1] = DtoEnd;
+
+	m_document = Dto(output, static_cast<int32>(size));
+	return true;
+}
+
+// ** DtoJsonArrayReader::parseSerial
+bool DtoJsonArrayReader::parseSerial(const byte* input, int64 length)
+{
+	if (length > INT32_MAX)
+	{
+		return false;
+	}
+
+	int32 capacity = static_cast<int32>(std::min<int64>(static_cast<int64>(length) * 16 + 64, INT32_MAX));
+	m_output.resize(capacity);
+
+	if (!dtoConvert<JsonDtoReader, BinaryDtoWriter>(input, static_cast<int32>(length), &m_output[0], capacity))
+	{
+		return false;
+	}
+
+	m_document = Dto(&m_output[0], capacity);
+	return true;
+}
+
+// ** DtoJsonArrayReader::scanSegment
+void DtoJsonArrayReader::scanSegment(Segment& segment)
+{
+	// A segment is scanned for both possible starting states at once: a character that is
+	// outside of a string for one state is inside of a string for the other one.
+	bool  escaped  = isEscapedCharacter(segment.begin);
+	bool  quoted   = false;
+	int64 depth[2] = { 0, 0 };
+
+	for (const byte* ptr = segment.begin; ptr < segment.end; ptr++)
+	{
+		if (escaped)
+		{
+			escaped = false;
+			continue;
+		}
+
+		switch (*ptr)
+		{
+		case '\\':	escaped = true;
+					break;
+		case '"':	quoted = !quoted;
+					break;
+		case '[':
+		case '{':	depth[quoted]++;
+					break;
+		case ']':
+		case '}':	depth[quoted]--;
+					break;
+		}
+	}
+
+	segment.quoted   = quoted;
+	segment.depthOut = depth[0];
+	segment.depthIn  = depth[1];
+}
+
+// ** DtoJsonArrayReader::splitSegment
+void DtoJsonArrayReader::splitSegment(Segment& segment)
+{
+	bool  escaped  = isEscapedCharacter(segment.begin);
+	bool  inString = segment.inString;
+	int64 depth    = segment.depth;
+
+	segment.split = NULL;
+
+	for (const byte* ptr = segment.begin; ptr < segment.end; ptr++)
+	{
+		if (escaped)
+		{
+			escaped = false;
+			continue;
+		}
+
+		switch (*ptr)
+		{
+		case '\\':	escaped = true;
+					break;
+		case '"':	inString = !inString;
+					break;
+		}
+
+		if (inString)
+		{
+			continue;
+		}
+
+		switch (*ptr)
+		{
+		case '[':
+		case '{':	depth++;
+					break;
+		case ']':
+		case '}':	depth--;
+					break;
+		case ',':	if (depth == 0)
+					{
+						segment.split = ptr;
+						return;
+					}
+					break;
+		}
+	}
+}
+
+// ** DtoJsonArrayReader::parsePiece
+bool DtoJsonArrayReader::parsePiece(Piece& piece, DtoArena& arena)
+{
+	int32 capacity = dtoJsonBinaryBound(piece.end - piece.begin);
+
+	if (capacity < 0)
+	{
+		return false;
+	}
+
+	int32 length = static_cast<int32>(piece.end - piece.begin);
+	byte* output = arena.reserve(capacity);
+
+	JsonDtoItemsReader reader(piece.begin, length);
+	BinaryDtoWriter writer(output, capacity);
+
+	// Convert a piece and count top-level elements
+	int32 depth = 0;
+	DtoEvent event;
+
+	piece.count = 0;
+
+	do
+	{
+		event = reader.next();
+
+		switch (event.type)
+		{
+		case DtoError:
+			return false;
+
+		case DtoEntry:
+			piece.count += depth == 1;
+			break;
+
+		case DtoSequenceStart:
+		case DtoKeyValueStart:
+			piece.count += depth == 1;
+			depth++;
+			break;
+
+		case DtoStreamStart:
+			depth++;
+			break;
+
+		default:
+			depth--;
+		}
+
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	Dto document(output, capacity);
+	arena.commit(document.length());
+
+	// Skip a length prefix and a terminator of a parsed piece
+	piece.output = output + 4;
+	piece.length = document.length() - 5;
+
+	return true;
+}
+
+// ** DtoJsonArrayReader::stitchPiece
+void DtoJsonArrayReader::stitchPiece(const Piece& piece, byte* output)
+{
+	const byte* entry = piece.output;
+	const byte* end   = piece.output + piece.length;
+	byte*       ptr   = output + piece.offset;
+
+	for (int32 i = 0; i < piece.count; i++)
+	{
+		DtoByteBufferInput input(entry, static_cast<int32>(end - entry));
+		DtoStringView key;
+		DtoValue value;
+
+		// Calculate a total entry size, nested DTO body is not consumed by a decoder
+		int32 size = BinaryDtoReader::decode(input, key, value);
+
+		if (value.type == DtoKeyValue || value.type == DtoSequence)
+		{
+			size += value.binary.length;
+		}
+
+		// Write an entry type and a new key followed by a value
+		char index[12];
+		int32 length = snprintf(index, sizeof(index), "%d", piece.first + i);
+
+		*ptr++ = *entry;
+		memcpy(ptr, index, length + 1);
+		ptr += length + 1;
+
+		int32 header = key.length + 2;
+		memcpy(ptr, entry + header, size - header);
+		ptr += size - header;
+
+		entry += size;
+	}
+}
+
+DTO_END
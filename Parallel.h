@@ -0,0 +1,324 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Parallel_H__
+#define __Dto_Parallel_H__
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+DTO_BEGIN
+
+	/*!
+	 A fixed-size pool of worker threads that runs batches of indexed tasks.
+	 Each worker owns a queue of task indices and steals from other queues once its own one is empty.
+	 */
+	class DtoThreadPool
+	{
+	public:
+
+		//! A task function receives a task index and an index of a worker that executes it.
+		typedef std::function<void(int32 task, int32 worker)> Task;
+
+								//! Constructs a thread pool with specified number of workers (zero means a number of hardware threads).
+								DtoThreadPool(int32 workers = 0);
+
+								~DtoThreadPool();
+
+		//! Returns a total number of worker threads.
+		int32					size() const;
+
+		//! Runs a specified number of tasks and blocks until all of them are complete.
+		//! A pool runs one batch at a time, so this must not be called concurrently from several threads or from inside a task.
+		void					run(int32 count, const Task& task);
+
+	private:
+
+								//! Thread pools are not copyable.
+								DtoThreadPool(const DtoThreadPool&);
+		DtoThreadPool&			operator = (const DtoThreadPool&);
+
+		//! A worker thread entry point.
+		void					work(int32 worker);
+
+		//! Takes a next task index from a worker queue or steals it from other queues.
+		bool					take(int32 worker, int32& task);
+
+	private:
+
+		//! A worker thread with it's own task queue.
+		struct Worker
+		{
+			std::thread			thread;	//!< A worker thread.
+			std::mutex			mutex;	//!< A mutex that guards a task queue.
+			std::deque<int32>	tasks;	//!< A queue of task indices.
+		};
+
+		std::vector<Worker*>	m_workers;		//!< All worker threads.
+		std::mutex				m_mutex;		//!< A mutex that guards a batch state.
+		std::condition_variable	m_started;		//!< Signaled when a new batch is started or a pool is stopped.
+		std::condition_variable	m_finished;		//!< Signaled when the last task of a batch is complete.
+		const Task*				m_task;			//!< A task function of an active batch.
+		std::atomic<int32>		m_pending;		//!< A total number of unfinished tasks in an active batch.
+		int64					m_batch;		//!< An active batch counter.
+		bool					m_stop;			//!< Indicates that worker threads should exit.
+	};
+
+	/*!
+	 Parses newline-delimited JSON on a thread pool. An input is split into chunks at line
+	 boundaries, each chunk is parsed by a single task into an arena owned by a worker thread
+	 and parsed documents are returned in the input order.
+	 */
+	class DtoJsonLinesReader
+	{
+	public:
+
+								//! Constructs a DtoJsonLinesReader instance that runs on a specified thread pool.
+								DtoJsonLinesReader(DtoThreadPool& pool);
+
+								~DtoJsonLinesReader();
+
+		//! Sets a preferred chunk size in bytes.
+		void					setChunkSize(int32 value);
+
+		//! Maps a file to memory and parses it, returns false if a file does not exist or a non-empty file could not be mapped.
+		bool					parseFile(cstring path);
+
+		//! Parses an input buffer, all parsed documents are valid until a next parse call.
+		void					parse(const byte* input, int64 length);
+
+		//! Returns a total number of successfully parsed documents.
+		int32					documentCount() const;
+
+		//! Returns a parsed document at specified index.
+		const Dto&				document(int32 index) const;
+
+		//! Returns a line number (starting from 1) of a document at specified index.
+		int32					documentLine(int32 index) const;
+
+		//! Returns a total number of lines that failed to parse.
+		int32					errorCount() const;
+
+		//! Returns a line number (starting from 1) of an error at specified index.
+		int32					errorLine(int32 index) const;
+
+	private:
+
+								//! Readers are not copyable.
+								DtoJsonLinesReader(const DtoJsonLinesReader&);
+		DtoJsonLinesReader&		operator = (const DtoJsonLinesReader&);
+
+		//! A piece of an input that is parsed by a single task.
+		struct Chunk
+		{
+			const byte*			begin;		//!< A first byte of a chunk.
+			const byte*			end;		//!< A byte past the end of a chunk.
+			int32				lines;		//!< A total number of lines inside a chunk.
+			std::vector<Dto>	documents;	//!< Parsed documents.
+			std::vector<int32>	lineIndex;	//!< Line indices of parsed documents relative to a chunk start.
+			std::vector<int32>	errors;		//!< Line indices of errors relative to a chunk start.
+		};
+
+		//! Parses all lines inside a chunk to a specified arena.
+		static void				parseChunk(Chunk& chunk, DtoArena& arena);
+
+	private:
+
+		DtoThreadPool&			m_pool;			//!< A thread pool that runs parsing tasks.
+		int32					m_chunkSize;	//!< A preferred chunk size.
+		DtoMappedFile			m_file;			//!< A mapped input file.
+		std::vector<DtoArena*>	m_arenas;		//!< Per-worker output arenas.
+		std::vector<Chunk>		m_chunks;		//!< Input chunks.
+		std::vector<Dto>		m_documents;	//!< All parsed documents in the input order.
+		std::vector<int32>		m_lines;		//!< Line numbers of parsed documents.
+		std::vector<int32>		m_errors;		//!< Line numbers of lines that failed to parse.
+	};
+
+	/*!
+	 Formats a batch of DTO records as newline-delimited JSON on a thread pool. Records are split
+	 into chunks, each chunk is formatted by a single task into it's own buffer and completed
+	 buffers are passed to an output strictly in the record order as soon as all preceding ones are done.
+	 Malformed records are left out of an output and their indices are reported after a write call.
+	 */
+	class DtoJsonLinesWriter
+	{
+	public:
+
+		//! An output function receives completed pieces of text in the record order and returns false to stop writing.
+		typedef std::function<bool(const byte* data, int32 length)> Output;
+
+								//! Constructs a DtoJsonLinesWriter instance that runs on a specified thread pool.
+								DtoJsonLinesWriter(DtoThreadPool& pool);
+
+		//! Sets a preferred number of records formatted by a single task.
+		void					setChunkSize(int32 value);
+
+		//! Enables or disables escaping of non-ASCII characters inside strings and keys.
+		void					setAsciiOnly(bool value);
+
+		//! Formats records and appends a resulting text to an output buffer.
+		void					write(const Dto* records, int32 count, std::vector<byte>& output);
+
+		//! Formats records and passes completed chunks to an output function, returns false if an output failed.
+		bool					write(const Dto* records, int32 count, const Output& output);
+
+		//! Formats records and writes them to a file, returns false if a file could not be written.
+		bool					writeFile(cstring path, const Dto* records, int32 count);
+
+		//! Returns a total number of records that were left out of a last write because they are malformed.
+		int32					errorCount() const;
+
+		//! Returns an index of a malformed record at specified index.
+		int32					errorRecord(int32 index) const;
+
+	private:
+
+								//! Writers are not copyable.
+								DtoJsonLinesWriter(const DtoJsonLinesWriter&);
+		DtoJsonLinesWriter&		operator = (const DtoJsonLinesWriter&);
+
+		//! A range of records that is formatted by a single task.
+		struct Chunk
+		{
+			int32				begin;		//!< A first record index.
+			int32				end;		//!< A record index past the end of a chunk.
+			bool				ready;		//!< Indicates that a chunk is formatted.
+			int32				length;		//!< A formatted text length.
+			std::vector<byte>	text;		//!< A formatted text buffer.
+			std::vector<int32>	errors;		//!< Indices of records that failed to format.
+		};
+
+		//! Formats all records of a chunk.
+		void					formatChunk(Chunk& chunk, const Dto* records) const;
+
+	private:
+
+		DtoThreadPool&			m_pool;			//!< A thread pool that runs formatting tasks.
+		int32					m_chunkSize;	//!< A preferred number of records per chunk.
+		bool					m_isAsciiOnly;	//!< Indicates that non-ASCII characters should be escaped.
+		std::vector<Chunk>		m_chunks;		//!< Chunk buffers that are reused between windows.
+		std::vector<int32>		m_errors;		//!< Indices of records that failed to format.
+	};
+
+	/*!
+	 Parses a single JSON document that is a huge top-level array on a thread pool. An array is split into
+	 pieces at element boundaries that are speculatively found by a quote and escape pre-pass, pieces are
+	 parsed concurrently and then stitched into a single binary sequence with corrected lengths and index keys.
+	 Documents of other shapes are parsed serially.
+	 */
+	class DtoJsonArrayReader
+	{
+	public:
+
+								//! Constructs a DtoJsonArrayReader instance that runs on a specified thread pool.
+								DtoJsonArrayReader(DtoThreadPool& pool);
+
+								~DtoJsonArrayReader();
+
+		//! Sets a preferred piece size in bytes.
+		void					setChunkSize(int32 value);
+
+		//! Maps a file to memory and parses it, returns false if a file could not be opened or parsed.
+		bool					parseFile(cstring path);
+
+		//! Parses an input buffer, returns false if an input is not a valid JSON document.
+		bool					parse(const byte* input, int64 length);
+
+		//! Returns a parsed document that is valid until a next parse call.
+		const Dto&				document() const;
+
+	private:
+
+								//! Readers are not copyable.
+								DtoJsonArrayReader(const DtoJsonArrayReader&);
+		DtoJsonArrayReader&		operator = (const DtoJsonArrayReader&);
+
+		//! A result of a pre-pass over a single segment of an array body.
+		struct Segment
+		{
+			const byte*			begin;		//!< A first byte of a segment.
+			const byte*			end;		//!< A byte past the end of a segment.
+			bool				quoted;		//!< Indicates that a segment ends inside a string if it starts outside of one.
+			int64				depthOut;	//!< A nesting depth change if a segment starts outside of a string.
+			int64				depthIn;	//!< A nesting depth change if a segment starts inside a string.
+			bool				inString;	//!< Indicates that a segment starts inside a string.
+			int64				depth;		//!< A nesting depth at the start of a segment.
+			const byte*			split;		//!< A first top-level comma inside a segment or NULL.
+		};
+
+		//! A piece of an array body that contains a whole number of elements.
+		struct Piece
+		{
+			const byte*			begin;		//!< A first byte of a piece.
+			const byte*			end;		//!< A byte past the end of a piece.
+			const byte*			output;		//!< A parsed piece body without a length prefix and a terminator.
+			int32				length;		//!< A parsed piece body length.
+			int32				count;		//!< A total number of elements inside a piece.
+			int32				first;		//!< An index of a first element inside a whole array.
+			int64				offset;		//!< An offset of a stitched piece inside a resulting document.
+		};
+
+		//! Scans a segment and calculates it's string and nesting state changes for both starting states.
+		static void				scanSegment(Segment& segment);
+
+		//! Finds a first top-level comma inside a segment with known starting state.
+		static void				splitSegment(Segment& segment);
+
+		//! Parses a piece of an array body to a specified arena.
+		static bool				parsePiece(Piece& piece, DtoArena& arena);
+
+		//! Writes piece elements to an output with keys that are replaced by indices inside a whole array.
+		static void				stitchPiece(const Piece& piece, byte* output);
+
+		//! Parses a whole input on a calling thread.
+		bool					parseSerial(const byte* input, int64 length);
+
+	private:
+
+		DtoThreadPool&			m_pool;			//!< A thread pool that runs parsing tasks.
+		int32					m_chunkSize;	//!< A preferred piece size.
+		DtoMappedFile			m_file;			//!< A mapped input file.
+		std::vector<DtoArena*>	m_arenas;		//!< Per-worker piece arenas.
+		std::vector<Segment>	m_segments;		//!< Pre-pass segments.
+		std::vector<Piece>		m_pieces;		//!< Array pieces.
+		std::vector<byte>		m_output;		//!< A resulting document buffer.
+		Dto						m_document;		//!< A parsed document.
+	};
+
+	//! Returns an upper bound of a binary DTO size produced from a JSON text of specified length, or -1 if a bound does not fit a 32-bit buffer size.
+	int32 dtoJsonBinaryBound(int64 length);
+
+	//! Returns an upper bound of a compact JSON text size produced from a binary DTO of specified length, or -1 if a bound does not fit a 32-bit buffer size.
+	int32 dtoBinaryJsonBound(int64 length);
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Parallel_H__	*/
@@ -0,0 +1,739 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Storage.h"
+
+#include <assert.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+
+// A crc32 instruction is selected at runtime on x86-64, so builds without -msse4.2 still use it where available
+#if defined(_M_X64) || defined(__x86_64__)
+	#define DTO_CRC32C_DISPATCH
+	#include <nmmintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define DTO_TARGET_SSE42
+	#else
+		#define DTO_TARGET_SSE42 __attribute__((target("sse4.2")))
+	#endif	//	#if defined(_MSC_VER)
+#endif	//	#if defined(_M_X64) || defined(__x86_64__)
+
+#ifdef _WINDOWS
+	#include <fcntl.h>
+	#include <io.h>
+	#include <share.h>
+	#include <sys/stat.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif	//	#ifdef _WINDOWS
+
+DTO_BEGIN
+
+// ** dtoTruncateFile
+static bool dtoTruncateFile(cstring path, int64 size)
+{
+#ifdef _WINDOWS
+	int descriptor;
+
+	if (_sopen_s(&descriptor, path, _O_RDWR | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE) != 0)
+	{
+		return false;
+	}
+
+	bool result = _chsize_s(descriptor, size) == 0;
+	_close(descriptor);
+
+	return result;
+#else
+	return truncate(path, size) == 0;
+#endif	//	#ifdef _WINDOWS
+}
+
+// ** dtoOpenForAppend
+static int dtoOpenForAppend(cstring path)
+{
+#ifdef _WINDOWS
+	int descriptor;
+
+	if (_sopen_s(&descriptor, path, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE) != 0)
+	{
+		return -1;
+	}
+
+	return descriptor;
+#else
+	return ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif	//	#ifdef _WINDOWS
+}
+
+// ** dtoWriteFile
+static bool dtoWriteFile(int descriptor, const byte* data, size_t length)
+{
+	while (length > 0)
+	{
+	#ifdef _WINDOWS
+		int written = _write(descriptor, data, static_cast<unsigned int>(std::min<size_t>(length, 1 << 30)));
+	#else
+		ssize_t written = ::write(descriptor, data, length);
+	#endif	//	#ifdef _WINDOWS
+
+		if (written <= 0)
+		{
+			return false;
+		}
+
+		data   += written;
+		length -= written;
+	}
+
+	return true;
+}
+
+// ** dtoSyncFile
+static bool dtoSyncFile(int descriptor)
+{
+#if defined(_WINDOWS)
+	return _commit(descriptor) == 0;
+#elif defined(__APPLE__)
+	return fsync(descriptor) == 0;
+#else
+	// File metadata other than a size is not needed to read records back
+	return fdatasync(descriptor) == 0;
+#endif	//	#if defined(_WINDOWS)
+}
+
+// ** dtoCloseFile
+static void dtoCloseFile(int descriptor)
+{
+#ifdef _WINDOWS
+	_close(descriptor);
+#else
+	::close(descriptor);
+#endif	//	#ifdef _WINDOWS
+}
+
+// ** dtoCrc32cTables
+static const uint32 (*dtoCrc32cTables())[256]
+{
+	//! Slicing-by-8 lookup tables for a reflected Castagnoli polynomial.
+	struct Tables
+	{
+		uint32 values[8][256];
+
+		Tables()
+		{
+			for (uint32 i = 0; i < 256; i++)
+			{
+				uint32 crc = i;
+
+				for (int32 j = 0; j < 8; j++)
+				{
+					crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+				}
+
+				values[0][i] = crc;
+			}
+
+			for (int32 i = 0; i < 256; i++)
+			{
+				for (int32 j = 1; j < 8; j++)
+				{
+					values[j][i] = (values[j - 1][i] >> 8) ^ values[0][values[j - 1][i] & 0xFF];
+				}
+			}
+		}
+	};
+
+	static const Tables tables;
+	return tables.values;
+}
+
+#if defined(DTO_CRC32C_DISPATCH)
+
+// ** dtoHasCrc32cInstruction
+static bool dtoHasCrc32cInstruction()
+{
+#if defined(DTO_SSE42)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 20)) != 0;
+#else
+	return __builtin_cpu_supports("sse4.2") != 0;
+#endif	//	#if defined(DTO_SSE42)
+}
+
+// ** dtoCrc32cHardware
+DTO_TARGET_SSE42 static uint32 dtoCrc32cHardware(const byte* bytes, int64 length, uint32 crc)
+{
+	uint64 value = crc;
+
+	for (; length >= 8; bytes += 8, length -= 8)
+	{
+		uint64 chunk;
+		memcpy(&chunk, bytes, sizeof(chunk));
+		value = _mm_crc32_u64(value, chunk);
+	}
+
+	crc = static_cast<uint32>(value);
+
+	for (; length > 0; bytes++, length--)
+	{
+		crc = _mm_crc32_u8(crc, *bytes);
+	}
+
+	return crc;
+}
+
+#endif	//	#if defined(DTO_CRC32C_DISPATCH)
+
+// ** dtoCrc32cSoftware
+static uint32 dtoCrc32cSoftware(const byte* bytes, int64 length, uint32 crc)
+{
+	const uint32 (*tables)[256] = dtoCrc32cTables();
+
+	for (; length >= 8; bytes += 8, length -= 8)
+	{
+		uint32 low, high;
+		memcpy(&low, bytes, sizeof(low));
+		memcpy(&high, bytes + 4, sizeof(high));
+		low ^= crc;
+
+		crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+			^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+	}
+
+	for (; length > 0; bytes++, length--)
+	{
+		crc = tables[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc;
+}
+
+// ** dtoCrc32c
+uint32 dtoCrc32c(const void* data, int64 length, uint32 crc)
+{
+	const byte* bytes = reinterpret_cast<const byte*>(data);
+
+#if defined(DTO_CRC32C_DISPATCH)
+	// CPU features are queried once on a first call
+	static const bool hasInstruction = dtoHasCrc32cInstruction();
+
+	if (hasInstruction)
+	{
+		return ~dtoCrc32cHardware(bytes, length, ~crc);
+	}
+#endif	//	#if defined(DTO_CRC32C_DISPATCH)
+
+	return ~dtoCrc32cSoftware(bytes, length, ~crc);
+}
+
+// ---------------------------------------------------------- DtoStore ---------------------------------------------------------- //
+
+// ** DtoStore::DtoStore
+DtoStore::DtoStore()
+	: m_mappedCount(0)
+	, m_data(NULL)
+	, m_index(NULL)
+	, m_size(0)
+{
+}
+
+// ** DtoStore::~DtoStore
+DtoStore::~DtoStore()
+{
+	close();
+}
+
+// ** DtoStore::operator bool
+DtoStore::operator bool() const
+{
+	return m_data != NULL;
+}
+
+// ** DtoStore::open
+bool DtoStore::open(cstring path)
+{
+	close();
+
+	std::string indexPath = std::string(path) + ".idx";
+
+	// Create an empty data file if it does not exist
+	FILE* file = fopen(path, "ab");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fclose(file);
+
+	// An empty file can't be mapped, so it's treated as a store without records, but any other mapping failure fails to open
+	// a store instead of scanning zero bytes and rewriting an index of existing records
+	if (!m_mapped.open(path) && DtoMappedFile::size(path) != 0)
+	{
+		return false;
+	}
+
+	bool isIndexValid = readIndex(indexPath.c_str());
+	size_t indexed = m_offsets.size();
+	int64 length = scan();
+
+	// Drop a torn record left by an interrupted append, so new records follow the last complete one
+	if (length < m_mapped.size())
+	{
+		m_mapped.close();
+
+		if (!dtoTruncateFile(path, length) || (length > 0 && !m_mapped.open(path)))
+		{
+			close();
+			return false;
+		}
+	}
+
+	m_mappedCount = m_offsets.size();
+	m_size		  = length;
+	m_data		  = fopen(path, "ab");
+	m_index		  = fopen(indexPath.c_str(), isIndexValid ? "ab" : "wb");
+
+	if (m_data == NULL || m_index == NULL)
+	{
+		close();
+		return false;
+	}
+
+	// Rewrite a damaged index or append offsets of records that were missing from it
+	size_t first = isIndexValid ? indexed : 0;
+
+	if (m_offsets.size() > first && fwrite(&m_offsets[first], sizeof(int64), m_offsets.size() - first, m_index) != m_offsets.size() - first)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+// ** DtoStore::close
+void DtoStore::close()
+{
+	if (m_data)
+	{
+		fclose(m_data);
+	}
+	if (m_index)
+	{
+		fclose(m_index);
+	}
+
+	m_mapped.close();
+	m_offsets.clear();
+	m_appended.clear();
+	m_arena.clear();
+
+	m_mappedCount = 0;
+	m_data		  = NULL;
+	m_index		  = NULL;
+	m_size		  = 0;
+}
+
+// ** DtoStore::append
+int64 DtoStore::append(const Dto& record)
+{
+	assert(m_data != NULL);
+
+	int32 length = record.length();
+
+	if (length < 5)
+	{
+		return -1;
+	}
+
+	int64 offset = m_size;
+
+	if (fwrite(record.data(), 1, length, m_data) != static_cast<size_t>(length) || fwrite(&offset, sizeof(int64), 1, m_index) != 1)
+	{
+		return -1;
+	}
+
+	// Keep a copy of a record, so it can be returned without mapping a file again
+	byte* copy = m_arena.reserve(length);
+	memcpy(copy, record.data(), length);
+	m_arena.commit(length);
+
+	m_appended.push_back(copy);
+	m_offsets.push_back(offset);
+	m_size += length;
+
+	return static_cast<int64>(m_offsets.size()) - 1;
+}
+
+// ** DtoStore::flush
+bool DtoStore::flush()
+{
+	assert(m_data != NULL);
+
+	// Data is flushed first, so an index never references records that were not written
+	bool result = fflush(m_data) == 0;
+	return fflush(m_index) == 0 && result;
+}
+
+// ** DtoStore::count
+int64 DtoStore::count() const
+{
+	return static_cast<int64>(m_offsets.size());
+}
+
+// ** DtoStore::record
+Dto DtoStore::record(int64 index) const
+{
+	assert(index >= 0 && index < count());
+
+	const byte* data = index < m_mappedCount ? m_mapped.data() + m_offsets[index] : m_appended[index - m_mappedCount];
+	int32 length;
+	memcpy(&length, data, sizeof(int32));
+
+	return Dto(data, length);
+}
+
+// ** DtoStore::offset
+int64 DtoStore::offset(int64 index) const
+{
+	assert(index >= 0 && index < count());
+	return m_offsets[index];
+}
+
+// ** DtoStore::size
+int64 DtoStore::size() const
+{
+	return m_size;
+}
+
+// ** DtoStore::readIndex
+bool DtoStore::readIndex(cstring path)
+{
+	FILE* file = fopen(path, "rb");
+
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	int64	buffer[4096];
+	size_t	read;
+	bool	isValid = true;
+
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		// A partially written offset may only be the last one
+		isValid = isValid && read % sizeof(int64) == 0;
+		m_offsets.insert(m_offsets.end(), buffer, buffer + read / sizeof(int64));
+	}
+
+	fclose(file);
+
+	// Offsets are written after records, so only trailing entries may point past the end of data.
+	// Only the last entry is checked, so the whole data file is never touched.
+	while (!m_offsets.empty())
+	{
+		size_t last = m_offsets.size() - 1;
+
+		if (recordLength(m_offsets[last]) > 0 && (last == 0 || m_offsets[last] > m_offsets[last - 1]))
+		{
+			break;
+		}
+
+		m_offsets.pop_back();
+		isValid = false;
+	}
+
+	return isValid;
+}
+
+// ** DtoStore::scan
+int64 DtoStore::scan()
+{
+	int64 offset = m_offsets.empty() ? 0 : m_offsets.back() + recordLength(m_offsets.back());
+
+	// Records are stored back to back, so each length prefix points to the next record
+	for (int32 length; (length = recordLength(offset)) > 0; offset += length)
+	{
+		m_offsets.push_back(offset);
+	}
+
+	return offset;
+}
+
+// ** DtoStore::recordLength
+int32 DtoStore::recordLength(int64 offset) const
+{
+	int64 size = m_mapped.size();
+
+	if (offset < 0 || size - offset < static_cast<int64>(sizeof(int32)))
+	{
+		return 0;
+	}
+
+	int32 length;
+	memcpy(&length, m_mapped.data() + offset, sizeof(int32));
+
+	// A complete document ends with a zero terminator
+	if (length < 5 || length > size - offset || m_mapped.data()[offset + length - 1] != 0)
+	{
+		return 0;
+	}
+
+	return length;
+}
+
+// -------------------------------------------------------- DtoRecordLog -------------------------------------------------------- //
+
+//! A size of a record frame header with a length and a checksum.
+enum { DtoRecordHeaderSize = 8 };
+
+// ** DtoRecordLog::DtoRecordLog
+DtoRecordLog::DtoRecordLog()
+	: m_file(-1)
+	, m_queued(0)
+	, m_committed(0)
+	, m_isCommitting(false)
+	, m_hasFailed(false)
+{
+}
+
+// ** DtoRecordLog::~DtoRecordLog
+DtoRecordLog::~DtoRecordLog()
+{
+	close();
+}
+
+// ** DtoRecordLog::operator bool
+DtoRecordLog::operator bool() const
+{
+	return m_file >= 0;
+}
+
+// ** DtoRecordLog::open
+bool DtoRecordLog::open(cstring path)
+{
+	close();
+
+	// Read a log to the first torn record and cut it off, so new records are not appended after a garbage
+	{
+		DtoRecordLogReader reader;
+		Dto record;
+
+		if (reader.open(path))
+		{
+			while (reader.next(record))
+			{
+			}
+		}
+		else if (DtoMappedFile::size(path) >= 0)
+		{
+			// An existing log that can't be read may end with a torn record, so nothing is appended after it
+			return false;
+		}
+
+		if (reader.isTorn() && !dtoTruncateFile(path, reader.offset()))
+		{
+			return false;
+		}
+	}
+
+	m_file		= dtoOpenForAppend(path);
+	m_queued	= 0;
+	m_committed = 0;
+	m_hasFailed = false;
+
+	return m_file >= 0;
+}
+
+// ** DtoRecordLog::close
+void DtoRecordLog::close()
+{
+	if (m_file < 0)
+	{
+		return;
+	}
+
+	commit(m_queued);
+	dtoCloseFile(m_file);
+
+	m_file = -1;
+	m_queue.clear();
+}
+
+// ** DtoRecordLog::write
+int64 DtoRecordLog::write(const Dto& record)
+{
+	assert(m_file >= 0);
+
+	uint32 length = record.length();
+
+	if (length < 5)
+	{
+		return -1;
+	}
+
+	// A checksum covers a length, so a corrupted length is detected as well
+	uint32 crc = dtoCrc32c(record.data(), length, dtoCrc32c(&length, sizeof(length)));
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	size_t offset = m_queue.size();
+	m_queue.resize(offset + DtoRecordHeaderSize + length);
+	memcpy(&m_queue[offset], &length, sizeof(length));
+	memcpy(&m_queue[offset + 4], &crc, sizeof(crc));
+	memcpy(&m_queue[offset + DtoRecordHeaderSize], record.data(), length);
+
+	return ++m_queued;
+}
+
+// ** DtoRecordLog::commit
+bool DtoRecordLog::commit(int64 sequence)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	assert(sequence <= m_queued);
+
+	while (m_committed < sequence && !m_hasFailed)
+	{
+		if (m_isCommitting)
+		{
+			m_done.wait(lock);
+			continue;
+		}
+
+		// Become a leader and write everything queued so far, records queued meanwhile go to a next batch
+		int64 last = m_queued;
+		m_batch.swap(m_queue);
+		m_isCommitting = true;
+		lock.unlock();
+
+		bool result = dtoWriteFile(m_file, m_batch.data(), m_batch.size()) && dtoSyncFile(m_file);
+		m_batch.clear();
+
+		lock.lock();
+		m_isCommitting = false;
+		m_hasFailed	   = !result;
+		m_committed	   = result ? last : m_committed;
+		m_done.notify_all();
+	}
+
+	return m_committed >= sequence;
+}
+
+// ** DtoRecordLog::append
+bool DtoRecordLog::append(const Dto& record)
+{
+	int64 sequence = write(record);
+	return sequence > 0 && commit(sequence);
+}
+
+// ** DtoRecordLog::committed
+int64 DtoRecordLog::committed() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_committed;
+}
+
+// ----------------------------------------------------- DtoRecordLogReader ----------------------------------------------------- //
+
+// ** DtoRecordLogReader::DtoRecordLogReader
+DtoRecordLogReader::DtoRecordLogReader()
+	: m_offset(0)
+	, m_isTorn(false)
+{
+}
+
+// ** DtoRecordLogReader::open
+bool DtoRecordLogReader::open(cstring path)
+{
+	m_offset = 0;
+	m_isTorn = false;
+
+	if (m_file.open(path))
+	{
+		return true;
+	}
+
+	// An empty log can't be mapped but is still a valid one, a non-empty log that failed to map is not
+	return DtoMappedFile::size(path) == 0;
+}
+
+// ** DtoRecordLogReader::next
+bool DtoRecordLogReader::next(Dto& record)
+{
+	int64 available = m_file.size() - m_offset;
+
+	if (m_isTorn || available == 0)
+	{
+		return false;
+	}
+
+	const byte* frame = m_file.data() + m_offset;
+	uint32 length = 0, crc = 0;
+
+	if (available >= DtoRecordHeaderSize)
+	{
+		memcpy(&length, frame, sizeof(length));
+		memcpy(&crc, frame + 4, sizeof(crc));
+	}
+
+	// A length is checked before a checksum, so a garbage length never makes a reader run past the end of a file
+	if (length < 5 || length > available - DtoRecordHeaderSize || dtoCrc32c(frame + DtoRecordHeaderSize, length, dtoCrc32c(&length, sizeof(length))) != crc)
+	{
+		m_isTorn = true;
+		return false;
+	}
+
+	record    = Dto(frame + DtoRecordHeaderSize, length);
+	m_offset += DtoRecordHeaderSize + length;
+
+	return true;
+}
+
+// ** DtoRecordLogReader::offset
+int64 DtoRecordLogReader::offset() const
+{
+	return m_offset;
+}
+
+// ** DtoRecordLogReader::isTorn
+bool DtoRecordLogReader::isTorn() const
+{
+	return m_isTorn;
+}
+
+DTO_END
\ No newline at end of file
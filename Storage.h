@@ -0,0 +1,204 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Storage_H__
+#define __Dto_Storage_H__
+
+#include <stdio.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+DTO_BEGIN
+
+	/*!
+	 An append-only store of binary DTOs kept in a data file with records stored back to back and an index
+	 file with a 64-bit offset of each record.
+
+	 Opening a store maps a data file to memory and reads an index, so an open time depends on a number of
+	 records rather than on a data size and records are returned as views of a mapped file without any
+	 parsing or copying. An index is checked against a data file on open: index entries past the end of data
+	 are dropped, records that are missing from an index are indexed again and a torn record at the end of a
+	 data file is truncated. Any file with BSON documents stored back to back can be opened as a store.
+
+	 Records appended after a store was opened are also kept in memory, so all returned views stay valid
+	 until a store is closed.
+	 */
+	class DtoStore
+	{
+	public:
+
+								//! Constructs a closed DtoStore instance.
+								DtoStore();
+
+								~DtoStore();
+
+								//! Returns true if a store is open.
+								operator bool() const;
+
+		//! Opens a store at specified data file path, creates an empty one if it does not exist, returns false on failure.
+		bool					open(cstring path);
+
+		//! Flushes and closes store files.
+		void					close();
+
+		//! Appends a record and returns it's index or -1 if a record could not be written.
+		int64					append(const Dto& record);
+
+		//! Flushes appended records and their offsets to a file system.
+		bool					flush();
+
+		//! Returns a total number of records.
+		int64					count() const;
+
+		//! Returns a record at specified index.
+		Dto						record(int64 index) const;
+
+		//! Returns a data file offset of a record at specified index.
+		int64					offset(int64 index) const;
+
+		//! Returns a data file size in bytes.
+		int64					size() const;
+
+	private:
+
+		//! Reads an index file and checks it against a mapped data file, returns false if an index should be rewritten.
+		bool					readIndex(cstring path);
+
+		//! Indexes records of a mapped data file that follow the last indexed one and returns a length of valid data.
+		int64					scan();
+
+		//! Returns a length of a record that starts at specified offset of a mapped file or 0 if a record is torn.
+		int32					recordLength(int64 offset) const;
+
+	private:
+
+								//! Stores are not copyable.
+								DtoStore(const DtoStore&);
+		DtoStore&				operator = (const DtoStore&);
+
+	private:
+
+		DtoMappedFile			m_mapped;	//!< A data file contents at the moment a store was opened.
+		int64					m_mappedCount;	//!< A total number of records inside a mapped file.
+		std::vector<int64>		m_offsets;	//!< Data file offsets of all records.
+		std::vector<const byte*>	m_appended;	//!< Pointers to records appended after a store was opened.
+		DtoArena				m_arena;	//!< Copies of appended records.
+		FILE*					m_data;		//!< A data file opened for appending.
+		FILE*					m_index;	//!< An index file opened for appending.
+		int64					m_size;		//!< A total data file size.
+	};
+
+	//! Computes a CRC-32C (Castagnoli) checksum, a previous checksum may be passed to continue it over a next chunk of data.
+	uint32 dtoCrc32c(const void* data, int64 length, uint32 crc = 0);
+
+	/*!
+	 An append-only log of binary DTOs. Each record is framed with a 32-bit length and a CRC-32C of a length
+	 and a record, so a record that was torn by a crash is detected on recovery.
+
+	 Records may be written from many threads. A written record is queued and a thread that commits it
+	 either becomes a leader that writes all queued records with a single write and sync or waits for a
+	 commit that is already in progress, so concurrent appends share a single sync.
+	 */
+	class DtoRecordLog
+	{
+	public:
+
+								//! Constructs a closed DtoRecordLog instance.
+								DtoRecordLog();
+
+								~DtoRecordLog();
+
+								//! Returns true if a log is open.
+								operator bool() const;
+
+		//! Opens a log for appending and creates it if it does not exist, a torn record left by a crash is truncated. Returns false on failure.
+		bool					open(cstring path);
+
+		//! Commits all queued records and closes a log.
+		void					close();
+
+		//! Queues a record and returns it's sequence number or -1 if a record is malformed, a record is durable once it's committed.
+		int64					write(const Dto& record);
+
+		//! Blocks until all records up to a specified sequence number are written and synced, returns false if a log failed.
+		bool					commit(int64 sequence);
+
+		//! Queues and commits a single record, returns false if a record was not committed.
+		bool					append(const Dto& record);
+
+		//! Returns a sequence number of the last committed record.
+		int64					committed() const;
+
+	private:
+
+								//! Logs are not copyable.
+								DtoRecordLog(const DtoRecordLog&);
+		DtoRecordLog&			operator = (const DtoRecordLog&);
+
+	private:
+
+		int						m_file;			//!< A log file descriptor.
+		mutable std::mutex		m_mutex;		//!< A mutex that guards a queue and a commit state.
+		std::condition_variable	m_done;			//!< Signaled when a commit is finished.
+		std::vector<byte>		m_queue;		//!< Framed records that were not written yet.
+		std::vector<byte>		m_batch;		//!< Framed records that are written by a current leader.
+		int64					m_queued;		//!< A sequence number of the last queued record.
+		int64					m_committed;	//!< A sequence number of the last committed record.
+		bool					m_isCommitting;	//!< Indicates that a leader is writing a batch.
+		bool					m_hasFailed;	//!< Indicates that a write or a sync has failed.
+	};
+
+	//! Reads records of a DtoRecordLog file mapped to memory and stops at the first torn or corrupted record.
+	class DtoRecordLogReader
+	{
+	public:
+
+								//! Constructs a DtoRecordLogReader instance.
+								DtoRecordLogReader();
+
+		//! Maps a log file, returns false if a file does not exist or a non-empty file can't be mapped.
+		bool					open(cstring path);
+
+		//! Reads a next record, returns false at the end of a log or at a torn or corrupted record.
+		bool					next(Dto& record);
+
+		//! Returns a length of a log prefix that holds all records read so far.
+		int64					offset() const;
+
+		//! Returns true if reading has stopped at a torn or corrupted record rather than at the end of a log.
+		bool					isTorn() const;
+
+	private:
+
+		DtoMappedFile			m_file;		//!< A mapped log file.
+		int64					m_offset;	//!< An offset of a next record.
+		bool					m_isTorn;	//!< Indicates that a torn record was found.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Storage_H__	*/
\ No newline at end of file
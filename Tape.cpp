@@ -0,0 +1,592 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Dto.h"
+#include "Tape.h"
+
+#include <assert.h>
+#include <string.h>
+
+DTO_BEGIN
+
+//! Packs an entry header word.
+static uint64 packHeader(DtoValueType type, uint32 keyOffset, int32 keyLength)
+{
+	assert(keyLength < (1 << 24));
+	return (static_cast<uint64>(type) << 56) | (static_cast<uint64>(keyLength) << 32) | keyOffset;
+}
+
+//! Packs a payload word of two 32-bit halves.
+static uint64 packPayload(uint32 high, uint32 low)
+{
+	return (static_cast<uint64>(high) << 32) | low;
+}
+
+//! Returns a high half of a payload word.
+static uint32 highPart(uint64 value)
+{
+	return static_cast<uint32>(value >> 32);
+}
+
+//! Returns a low half of a payload word.
+static uint32 lowPart(uint64 value)
+{
+	return static_cast<uint32>(value);
+}
+
+// ---------------------------------------------------------- DtoTape ---------------------------------------------------------- //
+
+// ** DtoTape::DtoTape
+DtoTape::DtoTape()
+{
+}
+
+// ** DtoTape::clear
+void DtoTape::clear()
+{
+	m_tape.clear();
+	m_children.clear();
+	m_strings.clear();
+	m_pending.clear();
+	m_stack.clear();
+}
+
+// ** DtoTape::size
+int32 DtoTape::size() const
+{
+	return static_cast<int32>(m_tape.size() / 2);
+}
+
+// ** DtoTape::root
+DtoTapeNode DtoTape::root() const
+{
+	if (m_tape.empty() || !m_stack.empty())
+	{
+		return DtoTapeNode();
+	}
+
+	return DtoTapeNode(this, 0);
+}
+
+// ** DtoTape::read
+bool DtoTape::read(DtoReader& reader)
+{
+	clear();
+
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+
+		if (event == DtoError)
+		{
+			return false;
+		}
+
+		consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return true;
+}
+
+// ** DtoTape::consume
+int32 DtoTape::consume(const DtoEvent& event)
+{
+	int32 size = static_cast<int32>(m_tape.size());
+
+	switch (event.type)
+	{
+	case DtoStreamStart:
+	case DtoKeyValueStart:
+	case DtoSequenceStart:
+		{
+			// A container payload is written when it's closed
+			// A stream start event has no key
+			DtoStringView key;
+			key.value  = "";
+			key.length = 0;
+
+			Container container;
+			container.index = push(event.type == DtoSequenceStart ? DtoSequence : DtoKeyValue, event.type == DtoStreamStart ? key : event.key, 0);
+
+			if (event.type != DtoStreamStart)
+			{
+				addChild(container.index);
+			}
+
+			container.children = static_cast<int32>(m_pending.size());
+
+			m_stack.push_back(container);
+		}
+		break;
+
+	case DtoStreamEnd:
+	case DtoKeyValueEnd:
+	case DtoSequenceEnd:
+		{
+			assert(!m_stack.empty());
+			Container container = m_stack.back();
+			m_stack.pop_back();
+
+			// Move children from a pending list to a child table
+			int32 table = static_cast<int32>(m_children.size());
+			int32 count = static_cast<int32>(m_pending.size()) - container.children;
+
+			m_children.push_back(count);
+			m_children.insert(m_children.end(), m_pending.begin() + container.children, m_pending.end());
+			m_pending.resize(container.children);
+
+			m_tape[container.index * 2 + 1] = packPayload(size / 2, table);
+		}
+		break;
+
+	case DtoEntry:
+		{
+			const DtoValue& value = event.data;
+			uint64 payload = 0;
+
+			switch (value.type)
+			{
+			case DtoBool:
+				payload = value.boolean ? 1 : 0;
+				break;
+
+			case DtoInt32:
+				payload = static_cast<uint32>(value.int32);
+				break;
+
+			case DtoDate:
+			case DtoInt64:
+				payload = static_cast<uint64>(value.int64);
+				break;
+
+			case DtoTimestamp:
+				payload = value.uint64;
+				break;
+
+			case DtoDouble:
+				memcpy(&payload, &value.number, sizeof(payload));
+				break;
+
+			case DtoString:
+				payload = packPayload(value.string.length, store(value.string.value, value.string.length));
+				store("", 1);
+				break;
+
+			case DtoBinary:
+				payload = packPayload(value.binary.length, store(&value.binary.subtype, 1));
+				store(value.binary.data, value.binary.length);
+				break;
+
+			case DtoUUID:
+				payload = store(value.uuid.value, 16);
+				break;
+
+			case DtoRegEx:
+				payload = packPayload(value.regex.value.length, store(value.regex.value.value, value.regex.value.length));
+				store("", 1);
+				store(value.regex.options.value, value.regex.options.length);
+				store("", 1);
+				break;
+
+			case DtoNull:
+				break;
+
+			default:
+				assert(0);
+			}
+
+			int32 index = push(value.type, event.key, 0);
+			m_tape[index * 2 + 1] = payload;
+			addChild(index);
+		}
+		break;
+
+	default:
+		assert(0);
+	}
+
+	return static_cast<int32>(m_tape.size()) - size;
+}
+
+// ** DtoTape::push
+int32 DtoTape::push(DtoValueType type, const DtoStringView& key, uint64 payload)
+{
+	uint32 keyOffset = key.length ? store(key.value, key.length) : 0;
+	int32  index     = size();
+
+	m_tape.push_back(packHeader(type, keyOffset, key.length));
+	m_tape.push_back(payload);
+
+	return index;
+}
+
+// ** DtoTape::addChild
+void DtoTape::addChild(int32 index)
+{
+	assert(!m_stack.empty());
+	m_pending.push_back(index);
+}
+
+// ** DtoTape::store
+uint32 DtoTape::store(const void* data, int32 length)
+{
+	size_t offset = m_strings.size();
+	assert(offset + length <= 0xFFFFFFFF);
+
+	m_strings.insert(m_strings.end(), reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + length);
+	return static_cast<uint32>(offset);
+}
+
+// ** DtoTape::write
+void DtoTape::write(DtoWriter& writer) const
+{
+	DtoTapeNode node = root();
+
+	if (!node)
+	{
+		return;
+	}
+
+	writer.consume(DtoStreamStart);
+
+	for (int32 i = 0, n = node.entryCount(); i < n; i++)
+	{
+		write(writer, node.entry(i).m_index);
+	}
+
+	writer.consume(DtoStreamEnd);
+}
+
+// ** DtoTape::write
+void DtoTape::write(DtoWriter& writer, int32 index) const
+{
+	DtoTapeNode node(this, index);
+
+	switch (node.type())
+	{
+	case DtoKeyValue:
+	case DtoSequence:
+		{
+			bool isSequence = node.type() == DtoSequence;
+			writer.consume(DtoEvent(isSequence ? DtoSequenceStart : DtoKeyValueStart, node.key()));
+
+			for (int32 i = 0, n = node.entryCount(); i < n; i++)
+			{
+				write(writer, node.entry(i).m_index);
+			}
+
+			writer.consume(isSequence ? DtoSequenceEnd : DtoKeyValueEnd);
+		}
+		break;
+
+	default:
+		writer.consume(DtoEvent(node.key(), node.value()));
+	}
+}
+
+// -------------------------------------------------------- DtoTapeNode -------------------------------------------------------- //
+
+// ** DtoTapeNode::DtoTapeNode
+DtoTapeNode::DtoTapeNode()
+	: m_tape(NULL)
+	, m_index(0)
+{
+}
+
+// ** DtoTapeNode::DtoTapeNode
+DtoTapeNode::DtoTapeNode(const DtoTape* tape, int32 index)
+	: m_tape(tape)
+	, m_index(index)
+{
+}
+
+// ** DtoTapeNode::operator bool
+DtoTapeNode::operator bool() const
+{
+	return m_tape != NULL;
+}
+
+// ** DtoTapeNode::operator ==
+bool DtoTapeNode::operator == (DtoValueType type) const
+{
+	return this->type() == type;
+}
+
+// ** DtoTapeNode::operator !=
+bool DtoTapeNode::operator != (DtoValueType type) const
+{
+	return this->type() != type;
+}
+
+// ** DtoTapeNode::type
+DtoValueType DtoTapeNode::type() const
+{
+	if (m_tape == NULL)
+	{
+		return DtoEnd;
+	}
+
+	return static_cast<DtoValueType>(m_tape->m_tape[m_index * 2] >> 56);
+}
+
+// ** DtoTapeNode::key
+DtoStringView DtoTapeNode::key() const
+{
+	assert(m_tape);
+
+	uint64 header = m_tape->m_tape[m_index * 2];
+	DtoStringView result;
+	result.length = static_cast<int32>((header >> 32) & 0xFFFFFF);
+	result.value  = result.length ? &m_tape->m_strings[lowPart(header)] : "";
+
+	return result;
+}
+
+// ** DtoTapeNode::value
+DtoValue DtoTapeNode::value() const
+{
+	assert(m_tape);
+
+	uint64 payload = m_tape->m_tape[m_index * 2 + 1];
+	const char* strings = m_tape->m_strings.empty() ? NULL : &m_tape->m_strings[0];
+
+	DtoValue result;
+	memset(&result, 0, sizeof(result));
+	result.type = type();
+
+	switch (result.type)
+	{
+	case DtoBool:
+		result.boolean = payload != 0;
+		break;
+
+	case DtoInt32:
+		result.int32 = static_cast<int32>(lowPart(payload));
+		break;
+
+	case DtoDate:
+	case DtoInt64:
+		result.int64 = static_cast<int64>(payload);
+		break;
+
+	case DtoTimestamp:
+		result.uint64 = payload;
+		break;
+
+	case DtoDouble:
+		memcpy(&result.number, &payload, sizeof(payload));
+		break;
+
+	case DtoString:
+		result.string.value  = strings + lowPart(payload);
+		result.string.length = highPart(payload);
+		break;
+
+	case DtoBinary:
+		result.binary.subtype = strings[lowPart(payload)];
+		result.binary.data    = reinterpret_cast<const byte*>(strings + lowPart(payload) + 1);
+		result.binary.length  = highPart(payload);
+		break;
+
+	case DtoUUID:
+		memcpy(result.uuid.value, strings + lowPart(payload), 16);
+		break;
+
+	case DtoRegEx:
+		result.regex.value.value    = strings + lowPart(payload);
+		result.regex.value.length   = highPart(payload);
+		result.regex.options        = DtoStringView::construct(result.regex.value.value + result.regex.value.length + 1);
+		break;
+
+	default:
+		break;
+	}
+
+	return result;
+}
+
+// ** DtoTapeNode::toBool
+bool DtoTapeNode::toBool() const
+{
+	assert(type() == DtoBool);
+	return value().boolean;
+}
+
+// ** DtoTapeNode::toString
+DtoStringView DtoTapeNode::toString() const
+{
+	assert(type() == DtoString);
+	return value().string;
+}
+
+// ** DtoTapeNode::toInt32
+int32 DtoTapeNode::toInt32() const
+{
+	DtoValue value = this->value();
+
+	switch (value.type)
+	{
+	case DtoInt32:
+		return value.int32;
+	case DtoDouble:
+		return static_cast<int32>(value.number);
+	default:
+		break;
+	}
+
+	assert(value.type == DtoInt32);
+	return value.int32;
+}
+
+// ** DtoTapeNode::toInt64
+int64 DtoTapeNode::toInt64() const
+{
+	DtoValue value = this->value();
+
+	switch (value.type)
+	{
+	case DtoInt32:
+		return value.int32;
+	case DtoDouble:
+		return static_cast<int64>(value.number);
+	default:
+		break;
+	}
+
+	assert(value.type == DtoInt64 || value.type == DtoDate);
+	return value.int64;
+}
+
+// ** DtoTapeNode::toDouble
+double DtoTapeNode::toDouble() const
+{
+	assert(type() == DtoDouble);
+	return value().number;
+}
+
+// ** DtoTapeNode::entryCount
+int32 DtoTapeNode::entryCount() const
+{
+	if (type() != DtoKeyValue && type() != DtoSequence)
+	{
+		return 0;
+	}
+
+	return m_tape->m_children[lowPart(m_tape->m_tape[m_index * 2 + 1])];
+}
+
+// ** DtoTapeNode::entry
+DtoTapeNode DtoTapeNode::entry(int32 index) const
+{
+	if (index < 0 || index >= entryCount())
+	{
+		return DtoTapeNode();
+	}
+
+	int32 table = lowPart(m_tape->m_tape[m_index * 2 + 1]);
+	return DtoTapeNode(m_tape, m_tape->m_children[table + 1 + index]);
+}
+
+// ** DtoTapeNode::find
+DtoTapeNode DtoTapeNode::find(cstring key) const
+{
+	assert(key);
+	return find(DtoStringView::construct(key));
+}
+
+// ** DtoTapeNode::find
+DtoTapeNode DtoTapeNode::find(const DtoStringView& key) const
+{
+	assert(key);
+
+	// Items of a sequence are accessed by index directly
+	if (type() == DtoSequence)
+	{
+		int32 index = 0;
+
+		for (int32 i = 0; i < key.length; i++)
+		{
+			// Nine digits always fit an int32, longer keys can't address an entry anyway
+			if (key.value[i] < '0' || key.value[i] > '9' || i >= 9)
+			{
+				return DtoTapeNode();
+			}
+
+			index = index * 10 + key.value[i] - '0';
+		}
+
+		return entry(index);
+	}
+
+	for (int32 i = 0, n = entryCount(); i < n; i++)
+	{
+		DtoTapeNode node = entry(i);
+
+		if (node.key() == key)
+		{
+			return node;
+		}
+	}
+
+	return DtoTapeNode();
+}
+
+// ** DtoTapeNode::findDescendant
+DtoTapeNode DtoTapeNode::findDescendant(cstring key) const
+{
+	DtoTapeNode node = *this;
+
+	while (*key)
+	{
+		if (*key == '.')
+		{
+			key++;
+			continue;
+		}
+
+		DtoStringView nextKey;
+		nextKey.value = key;
+
+		while (*key && *key != '.')
+		{
+			key++;
+		}
+		nextKey.length = key - nextKey.value;
+
+		node = node.find(nextKey);
+
+		if (!node)
+		{
+			return DtoTapeNode();
+		}
+	}
+
+	return node;
+}
+
+DTO_END
@@ -0,0 +1,170 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#ifndef __Dto_Tape_H__
+#define __Dto_Tape_H__
+
+#include <vector>
+
+DTO_BEGIN
+
+	class DtoTape;
+
+	//! A reference to a single entry stored on a tape.
+	class DtoTapeNode
+	{
+	friend class DtoTape;
+	public:
+
+								//! Constructs an invalid node.
+								DtoTapeNode();
+
+								//! Returns true if this node points to a valid entry.
+								operator bool() const;
+
+		//! Returns true if an entry value type matches a specified one.
+		bool					operator == (DtoValueType type) const;
+
+		//! Returns true if an entry value type does not match a specified one.
+		bool					operator != (DtoValueType type) const;
+
+		//! Returns an entry value type.
+		DtoValueType			type() const;
+
+		//! Returns an entry key.
+		DtoStringView			key() const;
+
+		//! Returns an entry value, a nested object or array is returned as a DtoKeyValue or DtoSequence without any data.
+		DtoValue				value() const;
+
+		//! Returns boolean entry value.
+		bool					toBool() const;
+
+		//! Returns string entry value.
+		DtoStringView			toString() const;
+
+		//! Returns integer entry value.
+		int32					toInt32() const;
+
+		//! Returns 64-bit integer entry value.
+		int64					toInt64() const;
+
+		//! Returns double entry value.
+		double					toDouble() const;
+
+		//! Returns a total number of child entries of an object or array.
+		int32					entryCount() const;
+
+		//! Returns a child entry at specified index.
+		DtoTapeNode				entry(int32 index) const;
+
+		//! Searches for a child entry with specified key.
+		DtoTapeNode				find(cstring key) const;
+
+		//! Searches for a child entry with specified key.
+		DtoTapeNode				find(const DtoStringView& key) const;
+
+		//! Searches for an entry with specified key, including nested objects.
+		DtoTapeNode				findDescendant(cstring key) const;
+
+	private:
+
+								//! Constructs a DtoTapeNode instance.
+								DtoTapeNode(const DtoTape* tape, int32 index);
+
+	private:
+
+		const DtoTape*			m_tape;		//!< A parent tape.
+		int32					m_index;	//!< An entry index.
+	};
+
+	/*!
+	 A flat random-access representation of a parsed document that can be filled by any reader.
+	 Each entry is a pair of 64-bit words: a header with a value type and a key location and
+	 a payload with either an immediate value, a location of string data or, for objects and
+	 arrays, an index just past the last descendant and a location of a child index table.
+	 So skipping a subtree and accessing an item by index take a constant time. All strings
+	 are copied to an arena, and a tape keeps it's memory when cleared for a next document.
+	 */
+	class DtoTape : public DtoWriter
+	{
+	friend class DtoTapeNode;
+	public:
+
+								//! Constructs an empty tape.
+								DtoTape();
+
+		//! Consumes an event and appends it to a tape.
+		virtual int32			consume(const DtoEvent& event);
+
+		//! Reads all events from a reader to an empty tape, returns false if a reader failed.
+		bool					read(DtoReader& reader);
+
+		//! Emits a tape content as a sequence of events to a writer.
+		void					write(DtoWriter& writer) const;
+
+		//! Removes all entries without releasing memory.
+		void					clear();
+
+		//! Returns a total number of entries.
+		int32					size() const;
+
+		//! Returns a root entry.
+		DtoTapeNode				root() const;
+
+	private:
+
+		//! Appends an entry and returns it's index.
+		int32					push(DtoValueType type, const DtoStringView& key, uint64 payload);
+
+		//! Appends an entry to a child list of a topmost container.
+		void					addChild(int32 index);
+
+		//! Copies bytes to a string arena and returns an arena offset.
+		uint32					store(const void* data, int32 length);
+
+		//! Emits events for a single entry and all it's descendants.
+		void					write(DtoWriter& writer, int32 index) const;
+
+	private:
+
+		//! An open container info.
+		struct Container
+		{
+			int32				index;		//!< A container entry index.
+			int32				children;	//!< A first child position inside a pending list.
+		};
+
+		std::vector<uint64>		m_tape;		//!< Entry words.
+		std::vector<int32>		m_children;	//!< Container child tables, each is a child count followed by child indices.
+		std::vector<char>		m_strings;	//!< A string arena.
+		std::vector<int32>		m_pending;	//!< Children of open containers.
+		std::vector<Container>	m_stack;	//!< Open containers.
+	};
+
+DTO_END
+
+#endif	/*	#ifndef __Dto_Tape_H__	*/
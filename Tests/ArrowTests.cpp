@@ -0,0 +1,187 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+//! Reads a little-endian 32-bit integer from a byte array.
+static int32 readInt32(const std::vector<byte>& bytes, size_t offset)
+{
+	int32 value;
+	memcpy(&value, &bytes[offset], sizeof(value));
+	return value;
+}
+
+TEST(Arrow, PivotsRecordsToColumns)
+{
+	cstring records[] = {
+		  "{\"id\":1,\"name\":\"alpha\",\"ok\":true,\"pos\":{\"x\":1,\"y\":2}}"
+		, "{\"id\":2,\"ok\":false,\"extra\":\"late\"}"
+		, "{\"id\":3,\"name\":\"\",\"pos\":{\"x\":3}}"
+	};
+
+	DtoArrowTable table;
+	byte buffer[256];
+
+	for (int32 i = 0; i < 3; i++)
+	{
+		EXPECT_TRUE(table.append(dtoParse<JsonDtoReader>(records[i], buffer, sizeof(buffer))));
+	}
+
+	ASSERT_EQ(table.rowCount(), 3);
+	ASSERT_EQ(table.columnCount(), 6);
+
+	// Nested keys are flattened and columns are created in the order keys are seen
+	EXPECT_EQ(table.findColumn("pos.y"), 4);
+	EXPECT_EQ(table.findColumn("extra"), 5);
+	EXPECT_EQ(table.findColumn("pos"), -1);
+
+	const DtoColumn& id = table.column(table.findColumn("id"));
+	EXPECT_EQ(id.type, DtoColumnDouble);
+	EXPECT_EQ(id.nullCount, 0);
+	EXPECT_EQ(reinterpret_cast<const double*>(id.values.data())[2], 3.0);
+
+	// A late column is backfilled with nulls
+	const DtoColumn& extra = table.column(table.findColumn("extra"));
+	EXPECT_EQ(extra.length, 3);
+	EXPECT_EQ(extra.nullCount, 2);
+	EXPECT_FALSE(extra.isValid(0));
+	EXPECT_TRUE(extra.isValid(1));
+	EXPECT_FALSE(extra.isValid(2));
+
+	// String offsets are shared by nulls and empty strings
+	const DtoColumn& name = table.column(table.findColumn("name"));
+	EXPECT_EQ(name.type, DtoColumnString);
+	ASSERT_EQ(name.offsets.size(), 4);
+	EXPECT_EQ(name.offsets[1], 5);
+	EXPECT_EQ(name.offsets[2], 5);
+	EXPECT_EQ(name.offsets[3], 5);
+	EXPECT_FALSE(name.isValid(1));
+	EXPECT_TRUE(name.isValid(2));
+
+	const DtoColumn& ok = table.column(table.findColumn("ok"));
+	EXPECT_EQ(ok.type, DtoColumnBool);
+	EXPECT_EQ(ok.values[0], 0x1);
+	EXPECT_EQ(ok.validity[0], 0x3);
+}
+
+TEST(Arrow, WidensNumericColumns)
+{
+	DtoArrowTable table;
+	byte buffer[256];
+
+	DtoEncoder(buffer, sizeof(buffer)) << "a" << 1 << "b" << DtoEncoder::null << DtoEncoder::end;
+	EXPECT_TRUE(table.append(DtoType(buffer, sizeof(buffer))));
+	EXPECT_EQ(table.column(0).type, DtoColumnInt32);
+	EXPECT_EQ(table.column(1).type, DtoColumnNull);
+
+	DtoEncoder(buffer, sizeof(buffer)) << "a" << 5000000000LL << "b" << 7 << DtoEncoder::end;
+	EXPECT_TRUE(table.append(DtoType(buffer, sizeof(buffer))));
+	EXPECT_EQ(table.column(0).type, DtoColumnInt64);
+	EXPECT_EQ(table.column(1).type, DtoColumnInt32);
+
+	DtoEncoder(buffer, sizeof(buffer)) << "a" << 0.5 << DtoEncoder::end;
+	EXPECT_TRUE(table.append(DtoType(buffer, sizeof(buffer))));
+
+	const DtoColumn& a = table.column(0);
+	ASSERT_EQ(a.type, DtoColumnDouble);
+	EXPECT_EQ(reinterpret_cast<const double*>(a.values.data())[0], 1.0);
+	EXPECT_EQ(reinterpret_cast<const double*>(a.values.data())[1], 5000000000.0);
+	EXPECT_EQ(reinterpret_cast<const double*>(a.values.data())[2], 0.5);
+
+	const DtoColumn& b = table.column(1);
+	EXPECT_EQ(b.nullCount, 2);
+	EXPECT_EQ(b.values.size(), 3 * sizeof(int32));
+	EXPECT_EQ(reinterpret_cast<const int32*>(b.values.data())[1], 7);
+}
+
+TEST(Arrow, RejectsMismatchedRecords)
+{
+	DtoArrowTable table;
+	byte buffer[256];
+
+	EXPECT_TRUE(table.append(dtoParse<JsonDtoReader>("{\"a\":1}", buffer, sizeof(buffer))));
+	EXPECT_FALSE(table.append(dtoParse<JsonDtoReader>("{\"b\":true,\"a\":\"text\"}", buffer, sizeof(buffer))));
+	EXPECT_FALSE(table.append(dtoParse<JsonDtoReader>("{\"c\":[1,2]}", buffer, sizeof(buffer))));
+
+	// A rejected record leaves no partial row and no new columns
+	EXPECT_EQ(table.rowCount(), 1);
+	EXPECT_EQ(table.columnCount(), 1);
+	EXPECT_EQ(table.column(0).length, 1);
+
+	EXPECT_TRUE(table.append(dtoParse<JsonDtoReader>("{\"b\":false,\"a\":2}", buffer, sizeof(buffer))));
+	EXPECT_EQ(table.columnCount(), 2);
+	EXPECT_EQ(table.column(1).length, 2);
+}
+
+TEST(Arrow, AppendsSequenceItems)
+{
+	DtoArrowTable table;
+	byte buffer[256];
+
+	DtoType items = dtoParse<JsonDtoReader>("[{\"a\":1},{\"a\":2,\"b\":\"x\"},3,{\"b\":\"y\"}]", buffer, sizeof(buffer));
+	EXPECT_FALSE(table.appendItems(items));
+
+	EXPECT_EQ(table.rowCount(), 3);
+	EXPECT_EQ(table.column(table.findColumn("a")).nullCount, 1);
+	EXPECT_EQ(table.column(table.findColumn("b")).nullCount, 1);
+}
+
+TEST(Arrow, WritesIpcFile)
+{
+	byte stream[512];
+	int32 length = 0;
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		DtoEncoder encoder(stream + length, sizeof(stream) - length);
+		encoder << "index" << i << "label" << (i % 2 ? "odd" : "even") << DtoEncoder::end;
+		length += encoder.length();
+	}
+
+	DtoArrowTable table;
+	EXPECT_TRUE(table.appendStream(stream, length));
+	EXPECT_EQ(table.rowCount(), 4);
+
+	std::vector<byte> file;
+	table.write(file);
+
+	// A file starts with a padded magic string followed by a schema message and ends with a footer
+	ASSERT_GT(file.size(), 32);
+	EXPECT_EQ(memcmp(&file[0], "ARROW1\0\0", 8), 0);
+	EXPECT_EQ(readInt32(file, 8), -1);
+	EXPECT_EQ((readInt32(file, 12) + 8) % 8, 0);
+	EXPECT_EQ(memcmp(&file[file.size() - 6], "ARROW1", 6), 0);
+
+	int32 footerLength = readInt32(file, file.size() - 10);
+	ASSERT_LT(footerLength, static_cast<int32>(file.size()));
+
+	// A footer is preceded by an end of stream marker
+	size_t footer = file.size() - 10 - footerLength;
+	EXPECT_EQ(readInt32(file, footer - 8), -1);
+	EXPECT_EQ(readInt32(file, footer - 4), 0);
+}
\ No newline at end of file
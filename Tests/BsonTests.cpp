@@ -204,6 +204,121 @@ TEST(Bson, ToYaml)
 	EXPECT_STREQ(reinterpret_cast<cstring>(yaml), kYaml);
 }
 
+TEST(Bson, PackedArrays)
+{
+	const int32  integers[] = { 1, -2, 300000 };
+	const int64  large[]    = { 1LL << 40 };
+	const double numbers[]  = { 0.5, -1.25 };
+	const bool   flags[]    = { true, false, true };
+
+	byte document[1024];
+	DtoEncoder(document, sizeof(document))
+		<< "integers" << DtoPackedArray::construct(integers, 3)
+		<< "large" << DtoPackedArray::construct(large, 1)
+		<< "numbers" << DtoPackedArray::construct(numbers, 2)
+		<< "flags" << DtoPackedArray::construct(flags, 3)
+		<< "empty" << DtoPackedArray::construct(numbers, 0)
+		<< DtoEncoder::end;
+	::Dto::Dto dto(document, sizeof(document));
+
+	DtoIter i = dto.find("numbers");
+	ASSERT_TRUE(i.isPackedArray());
+
+	DtoPackedArray array = i.toPackedArray();
+	EXPECT_EQ(array.type, DtoPackedDouble);
+	ASSERT_EQ(array.count, 2);
+	EXPECT_EQ(memcmp(array.data, numbers, sizeof(numbers)), 0);
+
+	// Elements are not aligned inside a document, so they are copied out instead of being accessed through a cast pointer
+	double second;
+	memcpy(&second, static_cast<const byte*>(array.data) + sizeof(double), sizeof(double));
+	EXPECT_EQ(second, -1.25);
+
+	EXPECT_EQ(dto.find("integers").toPackedArray().count, 3);
+	EXPECT_EQ(dto.find("empty").toPackedArray().count, 0);
+
+	// A JSON writer renders packed arrays as regular ones
+	byte json[256];
+	ASSERT_TRUE((dtoConvert<BinaryDtoReader, JsonDtoWriter>(document, sizeof(document), json, sizeof(json))));
+	EXPECT_STREQ(reinterpret_cast<cstring>(json), "{\"integers\":[1,-2,300000],\"large\":[1099511627776],\"numbers\":[0.5,-1.25],\"flags\":[true,false,true],\"empty\":[]}");
+}
+
+TEST(Bson, PackedArrayIsSmallerThanSequence)
+{
+	double numbers[100];
+	byte packed[2048], sequence[2048];
+
+	DtoEncoder encoder(sequence, sizeof(sequence));
+	encoder << "values" << DtoEncoder::sequence;
+
+	for (int32 i = 0; i < 100; i++)
+	{
+		numbers[i] = i * 0.5;
+		encoder << numbers[i];
+	}
+
+	encoder << DtoEncoder::end << DtoEncoder::end;
+	DtoEncoder(packed, sizeof(packed)) << "values" << DtoPackedArray::construct(numbers, 100) << DtoEncoder::end;
+
+	// Each sequence item adds a type byte and a decimal key with a zero terminator, node headers have the same size
+	EXPECT_EQ(::Dto::Dto(sequence, sizeof(sequence)).length() - ::Dto::Dto(packed, sizeof(packed)).length(), 10 * 3 + 90 * 4);
+}
+
+TEST(Bson, ExtractsNumericSequences)
+{
+	static byte document[16000];
+	DtoEncoder encoder(document, sizeof(document));
+
+	// Enough items to cover one, two and three digit index keys
+	encoder << "numbers" << DtoEncoder::sequence;
+	for (int32 i = 0; i < 150; i++)
+	{
+		encoder << i * 0.25;
+	}
+	encoder << DtoEncoder::end;
+
+	encoder << "integers" << DtoEncoder::sequence << 1 << -2 << 3 << DtoEncoder::end;
+	encoder << "mixed" << DtoEncoder::sequence << 1 << (1LL << 40) << DtoEncoder::end;
+	encoder << "strings" << DtoEncoder::sequence << 1.0 << "two" << DtoEncoder::end;
+	encoder << "empty" << DtoEncoder::sequence << DtoEncoder::end;
+	encoder << DtoEncoder::end;
+	::Dto::Dto dto(document, sizeof(document));
+
+	double numbers[150];
+	ASSERT_EQ(dto.find("numbers").extractDoubles(numbers, 150), 150);
+	for (int32 i = 0; i < 150; i++)
+	{
+		EXPECT_EQ(numbers[i], i * 0.25);
+	}
+	EXPECT_EQ(dto.find("numbers").extractDoubles(numbers, 149), -1);
+
+	int64 integers[4];
+	ASSERT_EQ(dto.find("integers").extractInt64s(integers, 4), 3);
+	EXPECT_EQ(integers[1], -2);
+
+	// Items of different sizes are read one by one
+	ASSERT_EQ(dto.find("mixed").extractInt64s(integers, 4), 2);
+	EXPECT_EQ(integers[1], 1LL << 40);
+
+	EXPECT_EQ(dto.find("strings").extractDoubles(numbers, 150), -1);
+	EXPECT_EQ(dto.find("integers").extractDoubles(numbers, 150), -1);
+	EXPECT_EQ(dto.find("empty").extractDoubles(numbers, 150), 0);
+}
+
+TEST(Bson, ExtractsPackedArrays)
+{
+	const int32 integers[] = { 7, -8, 9 };
+	byte document[256];
+	DtoEncoder(document, sizeof(document)) << "integers" << DtoPackedArray::construct(integers, 3) << DtoEncoder::end;
+	::Dto::Dto dto(document, sizeof(document));
+
+	int64 output[3];
+	double numbers[3];
+	ASSERT_EQ(dto.find("integers").extractInt64s(output, 3), 3);
+	EXPECT_EQ(output[1], -8);
+	EXPECT_EQ(dto.find("integers").extractDoubles(numbers, 3), -1);
+}
+
 /*TEST(Bson, FromYaml)
 {
 	byte document[16000], duplicate[16000];
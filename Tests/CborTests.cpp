@@ -0,0 +1,171 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+static byte document[16536];
+typedef ::Dto::Dto DtoType;
+
+//! Converts a binary DTO to a CBOR data item and returns a total number of written bytes.
+static int32 toCbor(const DtoType& dto, byte* output, int32 capacity)
+{
+	BinaryDtoReader reader(dto.data(), dto.length());
+	CborDtoWriter writer(output, capacity);
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return writer.length();
+}
+
+TEST(Cbor, ReadsDefiniteAndIndefiniteNodes)
+{
+	const byte definite[]   = { 0xA2, 0x61, 'a', 0x01, 0x61, 'b', 0x82, 0x02, 0x03 };
+	const byte indefinite[] = { 0xBF, 0x61, 'a', 0x01, 0x61, 'b', 0x9F, 0x02, 0x03, 0xFF, 0xFF };
+
+	byte decoded[256];
+	ASSERT_TRUE((dtoConvert<CborDtoReader, BinaryDtoWriter>(definite, sizeof(definite), document, sizeof(document))));
+	ASSERT_TRUE((dtoConvert<CborDtoReader, BinaryDtoWriter>(indefinite, sizeof(indefinite), decoded, sizeof(decoded))));
+
+	DtoType dto(document, sizeof(document));
+	EXPECT_EQ(dto.find("a").toInt32(), 1);
+	EXPECT_EQ(dto.findDescendant("b.1").toInt32(), 3);
+	ASSERT_EQ(DtoType(decoded, sizeof(decoded)).length(), dto.length());
+	EXPECT_EQ(memcmp(decoded, document, dto.length()), 0);
+}
+
+TEST(Cbor, WritesIndefiniteLengthNodes)
+{
+	DtoEncoder(document, sizeof(document))
+		<< "a" << DtoEncoder::sequence << 1 << -1 << 500 << DtoEncoder::end
+		<< "b" << DtoEncoder::null
+		<< DtoEncoder::end;
+	DtoType dto(document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte cbor[64];
+	int32 length = toCbor(dto, cbor, sizeof(cbor));
+
+	const byte expected[] = { 0xBF, 0x61, 'a', 0x9F, 0x01, 0x20, 0x19, 0x01, 0xF4, 0xFF, 0x61, 'b', 0xF6, 0xFF };
+	ASSERT_EQ(length, sizeof(expected));
+	EXPECT_EQ(memcmp(cbor, expected, length), 0);
+}
+
+TEST(Cbor, ReadsTagsFloatsAndChunkedStrings)
+{
+	const byte input[] =
+	{
+		  0xA5
+		, 0x61, 'h', 0xF9, 0x3C, 0x00
+		, 0x61, 'd', 0xC1, 0x1A, 0x5A, 0x4F, 0xD4, 0x00
+		, 0x61, 's', 0x7F, 0x62, 'a', 'b', 0x61, 'c', 0xFF
+		, 0x7F, 0x61, 'k', 0x61, 'y', 0xFF, 0xF5
+		, 0x61, 'u', 0xD8, 0x20, 0x63, 'u', 'r', 'l'
+	};
+
+	ASSERT_TRUE((dtoConvert<CborDtoReader, BinaryDtoWriter>(input, sizeof(input), document, sizeof(document))));
+	DtoType dto(document, sizeof(document));
+	EXPECT_EQ(dto.find("h").toDouble(), 1.0);
+	EXPECT_EQ(dto.find("d").type(), DtoDate);
+	EXPECT_TRUE(dto.find("s").toString() == DtoStringView::construct("abc"));
+	EXPECT_TRUE(dto.find("ky").toBool());
+	EXPECT_TRUE(dto.find("u").toString() == DtoStringView::construct("url"));
+}
+
+TEST(Cbor, LeavesOutOfRangeEpochTimesUntagged)
+{
+	const byte input[] =
+	{
+		  0xA4
+		, 0x61, 'i', 0xC1, 0x1B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+		, 0x61, 'n', 0xC1, 0xFB, 0x7F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		, 0x61, 'f', 0xC1, 0xFB, 0x7F, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		, 0x61, 'd', 0xC1, 0x3A, 0x00, 0x00, 0x00, 0x01
+	};
+
+	// Times that would overflow 64-bit milliseconds keep their original type
+	ASSERT_TRUE((dtoConvert<CborDtoReader, BinaryDtoWriter>(input, sizeof(input), document, sizeof(document))));
+	DtoType dto(document, sizeof(document));
+	EXPECT_EQ(dto.find("i").type(), DtoInt64);
+	EXPECT_EQ(dto.find("n").type(), DtoDouble);
+	EXPECT_EQ(dto.find("f").type(), DtoDouble);
+	EXPECT_EQ(dto.find("d").type(), DtoDate);
+	EXPECT_EQ(dto.find("d").value().int64, -2000);
+}
+
+TEST(Cbor, RoundTripsValues)
+{
+	std::string text(300, 'z');
+	DtoBinaryBlob blob;
+	blob.data = reinterpret_cast<const byte*>("blob");
+	blob.length = 4;
+	blob.subtype = 0;
+
+	DtoEncoder(document, sizeof(document))
+		<< "single" << 2.5
+		<< "double" << 0.1
+		<< "int32" << -70000
+		<< "int64" << static_cast<int64>(-1) * 1234567890123LL
+		<< "stamp" << static_cast<uint64>(0xFFFFFFFFFFFFFFF0ULL)
+		<< "text" << text.c_str()
+		<< "empty" << ""
+		<< "blob" << blob
+		<< "uuid" << DtoUuid::null()
+		<< "regex" << DtoRegularExpression::construct("a+")
+		<< "nothing" << DtoEncoder::null
+		<< "nested" << DtoEncoder::keyValue << "flag" << false << "items" << DtoEncoder::sequence << 1 << 2 << DtoEncoder::end << DtoEncoder::end
+		<< DtoEncoder::end;
+	DtoType dto(document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte cbor[1024];
+	int32 length = toCbor(dto, cbor, sizeof(cbor));
+
+	// Decoding a CBOR data item back should produce exactly the same binary DTO
+	byte decoded[2048];
+	ASSERT_TRUE((dtoConvert<CborDtoReader, BinaryDtoWriter>(cbor, length, decoded, sizeof(decoded))));
+	ASSERT_EQ(DtoType(decoded, sizeof(decoded)).length(), dto.length());
+	EXPECT_EQ(memcmp(decoded, document, dto.length()), 0);
+}
+
+TEST(Cbor, WontReadTruncatedInput)
+{
+	DtoType dto = dtoParse<JsonDtoReader>("{\"a\":\"hello\",\"b\":[1,2,3],\"c\":{\"d\":0.1}}", document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte cbor[64];
+	int32 length = toCbor(dto, cbor, sizeof(cbor));
+
+	byte decoded[256];
+	for (int32 i = 0; i < length; i++)
+	{
+		EXPECT_FALSE((dtoConvert<CborDtoReader, BinaryDtoWriter>(cbor, i, decoded, sizeof(decoded))));
+	}
+}
\ No newline at end of file
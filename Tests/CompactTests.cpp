@@ -0,0 +1,120 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+static byte document[16536];
+typedef ::Dto::Dto DtoType;
+
+//! Converts a binary DTO to a compact layout and returns a total number of written bytes.
+static int32 toCompact(const DtoType& dto, byte* output, int32 capacity)
+{
+	BinaryDtoReader reader(dto.data(), dto.length());
+	CompactDtoWriter writer(output, capacity);
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return writer.length();
+}
+
+TEST(Compact, PacksSmallValuesIntoTags)
+{
+	DtoType dto = dtoParse<JsonDtoReader>("{\"a\":1,\"b\":[true,\"x\"]}", document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte compact[64];
+	int32 length = toCompact(dto, compact, sizeof(compact));
+
+	const byte expected[] = { 0x01, 0x41, 0x01, 'a', 0x02, 0x01, 'b', 0x05, 0x81, 'x', 0x00, 0x00 };
+	ASSERT_EQ(length, sizeof(expected));
+	EXPECT_EQ(memcmp(compact, expected, length), 0);
+}
+
+TEST(Compact, RoundTripsAllValueTypes)
+{
+	std::string text(300, 'z');
+	DtoBinaryBlob blob;
+	blob.data = reinterpret_cast<const byte*>("blob");
+	blob.length = 4;
+	blob.subtype = 0;
+
+	DtoEncoder(document, sizeof(document))
+		<< "double" << 2.5
+		<< "integral" << -70000.0
+		<< "int32" << -5
+		<< "int64" << static_cast<int64>(-1) * 1234567890123LL
+		<< "stamp" << static_cast<uint64>(1500000000000ULL)
+		<< "text" << text.c_str()
+		<< "empty" << ""
+		<< "blob" << blob
+		<< "uuid" << DtoUuid::null()
+		<< "regex" << DtoRegularExpression::construct("a+", "i")
+		<< "nothing" << DtoEncoder::null
+		<< "nested" << DtoEncoder::sequence << 1 << 2 << DtoEncoder::end
+		<< DtoEncoder::end;
+	DtoType dto(document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte compact[1024];
+	int32 length = toCompact(dto, compact, sizeof(compact));
+
+	// Decoding a compact layout back should produce exactly the same binary DTO
+	byte decoded[2048];
+	ASSERT_TRUE((dtoConvert<CompactDtoReader, BinaryDtoWriter>(compact, length, decoded, sizeof(decoded))));
+	ASSERT_EQ(DtoType(decoded, sizeof(decoded)).length(), dto.length());
+	EXPECT_EQ(memcmp(decoded, document, dto.length()), 0);
+}
+
+TEST(Compact, IsSmallerThanBinaryLayout)
+{
+	cstring json = "{\"id\":1842,\"user\":{\"name\":\"alice\",\"active\":true},\"score\":17.25,\"tags\":[\"a\",\"b\",\"c\"],\"pos\":[0,12,-3,40000]}";
+	DtoType dto = dtoParse<JsonDtoReader>(json, document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte compact[256];
+	int32 length = toCompact(dto, compact, sizeof(compact));
+	EXPECT_LT(length * 2, dto.length());
+}
+
+TEST(Compact, WontReadTruncatedInput)
+{
+	DtoType dto = dtoParse<JsonDtoReader>("{\"a\":\"hello\",\"b\":[1,2,3]}", document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte compact[64];
+	int32 length = toCompact(dto, compact, sizeof(compact));
+
+	byte decoded[256];
+	for (int32 i = 0; i < length; i++)
+	{
+		EXPECT_FALSE((dtoConvert<CompactDtoReader, BinaryDtoWriter>(compact, i, decoded, sizeof(decoded))));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,209 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+#include <limits>
+
+typedef ::Dto::Dto DtoType;
+
+//! Collects all sequence item values.
+static std::vector<DtoValue> collectItems(const DtoType& dto)
+{
+	std::vector<DtoValue> values;
+	DtoIter i = dto.find("items").toDto().iter();
+
+	while (i.next())
+	{
+		values.push_back(i.value());
+	}
+
+	return values;
+}
+
+TEST(Compare, OrdersValuesAcrossTypes)
+{
+	byte buffer[1024];
+	DtoBinaryBlob a = { reinterpret_cast<const byte*>("a"), 0, 1 };
+	DtoBinaryBlob b = { reinterpret_cast<const byte*>("b"), 0, 1 };
+
+	DtoEncoder(buffer, sizeof(buffer)) << "items" << DtoEncoder::sequence
+		<< DtoEncoder::null << std::numeric_limits<double>::quiet_NaN() << -1.5 << 1 << 2.5 << static_cast<int64>(3)
+		<< "" << "a" << "ab" << "b"
+		<< false << true
+		<< static_cast<uint64>(1) << static_cast<uint64>(2)
+		<< a << b
+		<< DtoUuid::null()
+		<< DtoRegularExpression::construct("a+")
+		<< DtoEncoder::keyValue << DtoEncoder::end
+		<< DtoEncoder::keyValue << "a" << 1 << DtoEncoder::end
+		<< DtoEncoder::keyValue << "a" << 2 << DtoEncoder::end
+		<< DtoEncoder::keyValue << "b" << 0 << DtoEncoder::end
+		<< DtoEncoder::sequence << DtoEncoder::end
+		<< DtoEncoder::sequence << 1 << DtoEncoder::end
+		<< DtoEncoder::sequence << 1 << 2 << DtoEncoder::end
+		<< DtoEncoder::sequence << 2 << DtoEncoder::end
+		<< DtoEncoder::end << DtoEncoder::end;
+
+	std::vector<DtoValue> values = collectItems(DtoType(buffer, sizeof(buffer)));
+	ASSERT_EQ(values.size(), 26);
+
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		for (size_t j = 0; j < values.size(); j++)
+		{
+			int32 expected = i < j ? -1 : (i > j ? 1 : 0);
+			int32 actual   = dtoCompare(values[i], values[j]);
+			EXPECT_EQ((actual > 0) - (actual < 0), expected) << i << " vs " << j;
+
+			// Scalars are ordered exactly like index keys
+			DtoIndexKey x = DtoIndexKey::construct(values[i]);
+			DtoIndexKey y = DtoIndexKey::construct(values[j]);
+
+			if (x && y)
+			{
+				EXPECT_EQ((x.compare(y) > 0) - (x.compare(y) < 0), expected) << i << " vs " << j;
+			}
+		}
+	}
+}
+
+TEST(Compare, ComparesNumbersByValue)
+{
+	byte buffer[256];
+	DtoEncoder(buffer, sizeof(buffer)) << "items" << DtoEncoder::sequence
+		<< 2 << 2.0 << static_cast<int64>(2) << 2.5 << static_cast<int64>(9007199254740993LL) << 9007199254740992.0
+		<< DtoEncoder::end << DtoEncoder::end;
+
+	std::vector<DtoValue> values = collectItems(DtoType(buffer, sizeof(buffer)));
+	ASSERT_EQ(values.size(), 6);
+
+	EXPECT_EQ(dtoCompare(values[0], values[1]), 0);
+	EXPECT_EQ(dtoCompare(values[1], values[2]), 0);
+	EXPECT_LT(dtoCompare(values[1], values[3]), 0);
+	EXPECT_GT(dtoCompare(values[3], values[0]), 0);
+	EXPECT_GT(dtoCompare(values[4], values[5]), 0);
+}
+
+TEST(Compare, EqualsDocuments)
+{
+	byte a[256], b[256], c[256], d[256];
+	DtoEncoder(a, sizeof(a)) << "id" << 1 << "user" << DtoEncoder::keyValue << "name" << "x" << "tags" << DtoEncoder::sequence << 1 << 2 << DtoEncoder::end << DtoEncoder::end << DtoEncoder::end;
+	DtoEncoder(b, sizeof(b)) << "id" << 1.0 << "user" << DtoEncoder::keyValue << "name" << "x" << "tags" << DtoEncoder::sequence << static_cast<int64>(1) << 2 << DtoEncoder::end << DtoEncoder::end << DtoEncoder::end;
+	DtoEncoder(c, sizeof(c)) << "id" << 1 << "user" << DtoEncoder::keyValue << "name" << "x" << "tags" << DtoEncoder::sequence << 1 << 3 << DtoEncoder::end << DtoEncoder::end << DtoEncoder::end;
+	DtoEncoder(d, sizeof(d)) << "user" << DtoEncoder::keyValue << "name" << "x" << "tags" << DtoEncoder::sequence << 1 << 2 << DtoEncoder::end << DtoEncoder::end << "id" << 1 << DtoEncoder::end;
+
+	DtoType first(a, sizeof(a)), second(b, sizeof(b)), third(c, sizeof(c)), fourth(d, sizeof(d));
+
+	EXPECT_TRUE(dtoEquals(first, first));
+	EXPECT_TRUE(dtoEquals(first, second));
+	EXPECT_FALSE(dtoEquals(first, third));
+	EXPECT_LT(dtoCompare(first, third), 0);
+
+	// Entries are compared in order
+	EXPECT_FALSE(dtoEquals(first, fourth));
+	EXPECT_EQ(dtoHash(first, DtoHashCanonical), dtoHash(fourth, DtoHashCanonical));
+
+	EXPECT_TRUE(dtoEquals(DtoType(), DtoType()));
+	EXPECT_LT(dtoCompare(DtoType(), first), 0);
+}
+
+TEST(Compare, SortsDocumentsByFields)
+{
+	cstring records[] =
+	{
+		  "{\"id\":0,\"group\":\"b\",\"score\":10}"
+		, "{\"id\":1,\"group\":\"a\",\"score\":5}"
+		, "{\"id\":2,\"score\":7}"
+		, "{\"id\":3,\"group\":\"a\",\"score\":8.5}"
+		, "{\"id\":4,\"group\":\"b\",\"score\":10}"
+		, "{\"id\":5,\"group\":\"a\",\"score\":5}"
+	};
+
+	int32 expected[] = { 2, 3, 1, 5, 0, 4 };
+
+	std::vector<byte> buffer(6 * 128);
+	std::vector<DtoType> documents;
+
+	for (int32 i = 0; i < 6; i++)
+	{
+		documents.push_back(dtoParse<JsonDtoReader>(records[i], &buffer[i * 128], 128));
+	}
+
+	DtoThreadPool pool(2);
+	DtoComparator comparator;
+	comparator.by("group").by("score", DtoDescending);
+	comparator.sort(&documents[0], 6, &pool);
+
+	for (int32 i = 0; i < 6; i++)
+	{
+		EXPECT_EQ(documents[i].find("id").toInt32(), expected[i]);
+	}
+
+	// Extracted values follow sorted documents
+	EXPECT_EQ(comparator.compare(2, 3), 0);
+	EXPECT_LT(comparator.compare(1, 2), 0);
+	EXPECT_TRUE(comparator(0, 5));
+}
+
+TEST(Compare, SortAgreesWithCompare)
+{
+	int32 count = 2000;
+	int32 stride = 64;
+	std::vector<byte> buffer(count * stride);
+	std::vector<DtoType> documents;
+
+	// Values of mixed kinds with many ties and long strings sharing a prefix
+	for (int32 i = 0; i < count; i++)
+	{
+		byte* data = &buffer[i * stride];
+		DtoEncoder encoder(data, stride);
+		int32 kind = i * 7 % 6;
+		encoder << "value";
+
+		switch (kind)
+		{
+		case 0:	encoder << (i % 13) - 6; break;
+		case 1:	encoder << ((i % 11) - 5) * 0.5; break;
+		case 2:	encoder << static_cast<int64>(9007199254740992LL + i % 5); break;
+		case 3:	encoder << (i % 2 ? "prefix-long-a" : "prefix-long"); break;
+		case 4:	encoder << (i % 3 ? "ab" : "a"); break;
+		case 5:	encoder << (i % 2 == 0); break;
+		}
+
+		encoder << "id" << i << DtoEncoder::end;
+		documents.push_back(DtoType(data, stride));
+	}
+
+	DtoComparator comparator;
+	comparator.by("value", DtoDescending).by("id");
+	comparator.sort(&documents[0], count);
+
+	for (int32 i = 0; i + 1 < count; i++)
+	{
+		ASSERT_LT(comparator.compare(i, i + 1), 0) << i;
+	}
+}
\ No newline at end of file
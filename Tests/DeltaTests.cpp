@@ -0,0 +1,156 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+//! Encodes a synthetic sensor sample, most entries do not change between samples.
+static DtoType encodeSample(byte* buffer, int32 capacity, int32 index)
+{
+	DtoEncoder encoder(buffer, capacity);
+	encoder << "sensor" << "thermo-01" << "seq" << index << "ts" << static_cast<int64>(1500000000000LL + index * 1000LL);
+	encoder << "readings" << DtoEncoder::keyValue << "temperature" << 20.0 + (index / 5) * 0.5 << "humidity" << 40 << "pressure" << 1013.25 << DtoEncoder::end;
+
+	if (index % 10 == 7)
+	{
+		encoder << "alarm" << "overheat";
+	}
+
+	encoder << "history" << DtoEncoder::sequence;
+
+	for (int32 i = 0; i <= index % 3; i++)
+	{
+		encoder << i;
+	}
+
+	encoder << DtoEncoder::end << "status" << (index % 4 ? "ok" : "warm") << DtoEncoder::end;
+
+	return DtoType(buffer, capacity);
+}
+
+TEST(Delta, RoundTripsSensorStream)
+{
+	DtoDeltaEncoder encoder;
+	std::vector<byte> stream;
+	std::vector<byte> samples(50 * 256);
+	int64 total = 0;
+
+	for (int32 i = 0; i < 50; i++)
+	{
+		DtoType sample = encodeSample(&samples[i * 256], 256, i);
+		encoder.encode(sample, stream);
+		total += sample.length();
+	}
+
+	EXPECT_LT(static_cast<int64>(stream.size()) * 3, total);
+
+	DtoDeltaDecoder decoder;
+	DtoByteBufferInput input(&stream[0], static_cast<int32>(stream.size()));
+	std::vector<byte> output;
+
+	for (int32 i = 0; i < 50; i++)
+	{
+		DtoType expected(&samples[i * 256], 256);
+		DtoType decoded = decoder.decode(input, output);
+
+		ASSERT_TRUE(decoded);
+		ASSERT_EQ(decoded.length(), expected.length());
+		EXPECT_EQ(memcmp(decoded.data(), expected.data(), expected.length()), 0);
+	}
+
+	EXPECT_EQ(input.available(), 0);
+}
+
+TEST(Delta, UnchangedDocumentTakesASingleCopy)
+{
+	byte buffer[256];
+	DtoType sample = encodeSample(buffer, sizeof(buffer), 1);
+
+	DtoDeltaEncoder encoder;
+	std::vector<byte> first, second, keyFrame;
+	encoder.encode(sample, first);
+	encoder.encode(sample, second);
+
+	// A copy of all tokens followed by an end of frame
+	EXPECT_EQ(second.size(), 2);
+
+	// A reset encoder writes a key frame again
+	encoder.reset();
+	encoder.encode(sample, keyFrame);
+	EXPECT_TRUE(first == keyFrame);
+}
+
+TEST(Delta, RejectsMalformedFrames)
+{
+	byte buffer[256];
+	DtoType sample = encodeSample(buffer, sizeof(buffer), 1);
+
+	DtoDeltaEncoder encoder;
+	std::vector<byte> frame, output;
+	encoder.encode(sample, frame);
+
+	// A truncated key frame
+	DtoDeltaDecoder decoder;
+	DtoByteBufferInput truncated(&frame[0], static_cast<int32>(frame.size()) - 1);
+	EXPECT_FALSE(decoder.decode(truncated, output));
+
+	// Copy tokens without a previous document
+	byte copy[] = { 4 << 2, 0 << 2 | 3 };
+	DtoByteBufferInput input(copy, sizeof(copy));
+	EXPECT_FALSE(decoder.decode(input, output));
+
+	// A decoder keeps it's state after an error
+	DtoByteBufferInput valid(&frame[0], static_cast<int32>(frame.size()));
+	EXPECT_TRUE(decoder.decode(valid, output));
+}
+
+TEST(Delta, RejectsValuesLongerThanTokens)
+{
+	// Insert a 9 byte string token that declares a 1000 byte value
+	byte frame[] = { 9 << 2 | 2, DtoString, 'a', 0, 0xe8, 0x03, 0, 0, 'x', 0, 0 << 2 | 3 };
+
+	DtoDeltaDecoder decoder;
+	std::vector<byte> output;
+	DtoByteBufferInput input(frame, sizeof(frame));
+	EXPECT_FALSE(decoder.decode(input, output));
+
+	// A binary value that is longer than a token and a regular expression without an options terminator
+	byte binary[] = { 9 << 2 | 2, DtoBinary, 'b', 0, 0x10, 0, 0, 0, 0, 1, 0 << 2 | 3 };
+	DtoByteBufferInput binaryInput(binary, sizeof(binary));
+	EXPECT_FALSE(decoder.decode(binaryInput, output));
+
+	byte regex[] = { 6 << 2 | 2, DtoRegEx, 'r', 0, '.', 0, 'i', 0 << 2 | 3 };
+	DtoByteBufferInput regexInput(regex, sizeof(regex));
+	EXPECT_FALSE(decoder.decode(regexInput, output));
+
+	// A well formed string token is still accepted
+	byte valid[] = { 9 << 2 | 2, DtoString, 'a', 0, 2, 0, 0, 0, 'x', 0, 0 << 2 | 3 };
+	DtoByteBufferInput validInput(valid, sizeof(valid));
+	DtoType decoded = decoder.decode(validInput, output);
+	ASSERT_TRUE(decoded);
+	EXPECT_TRUE(decoded.find("a").toString() == DtoStringView::construct("x"));
+}
\ No newline at end of file
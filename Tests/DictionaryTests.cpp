@@ -0,0 +1,158 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+//! Parses a JSON string to a binary DTO with keys encoded through a dictionary and returns a DTO length.
+static int32 writeJson(cstring json, byte* output, int32 capacity, const DtoKeyDictionary* dictionary)
+{
+	JsonDtoReader reader(reinterpret_cast<const byte*>(json), static_cast<int32>(strlen(json)));
+	BinaryDtoWriter writer(output, capacity, dictionary);
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return DtoType(output, capacity).length();
+}
+
+//! Formats a binary DTO with encoded keys as a JSON string.
+static cstring formatJson(const byte* input, int32 length, byte* output, int32 capacity, const DtoKeyDictionary* dictionary)
+{
+	BinaryDtoReader reader(input, length, dictionary);
+	JsonDtoWriter writer(output, capacity);
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return reinterpret_cast<cstring>(output);
+}
+
+TEST(Dictionary, EncodesKnownKeys)
+{
+	DtoKeyDictionary dictionary;
+	dictionary.add(DtoStringView::construct("temperature"));
+	dictionary.add(DtoStringView::construct("position"));
+
+	cstring json = "{\"temperature\":21.5,\"position\":{\"temperature\":1,\"x\":2},\"other\":true}";
+	byte plain[256], encoded[256], text[256];
+	int32 plainLength   = writeJson(json, plain, sizeof(plain), NULL);
+	int32 encodedLength = writeJson(json, encoded, sizeof(encoded), &dictionary);
+
+	// Each of three known keys is replaced with a two-byte id
+	EXPECT_EQ(plainLength - encodedLength, 9 + 6 + 9);
+
+	DtoType dto(encoded, sizeof(encoded), &dictionary);
+	EXPECT_EQ(dto.find("temperature").toDouble(), 21.5);
+	EXPECT_EQ(dto.findDescendant("position.x").toDouble(), 2.0);
+	EXPECT_TRUE(dto.find("other").toBool());
+
+	// Resolved keys point to a dictionary storage
+	EXPECT_EQ(dto.find("position").key().value, dictionary.key(1).value);
+
+	EXPECT_STREQ(formatJson(encoded, encodedLength, text, sizeof(text), &dictionary), json);
+}
+
+TEST(Dictionary, LearnsKeysFromPreviousMessages)
+{
+	DtoKeyDictionary writerDictionary, readerDictionary;
+	cstring messages[] =
+	{
+		  "{\"id\":1,\"name\":\"a\",\"tags\":[\"x\"]}"
+		, "{\"id\":2,\"name\":\"b\",\"tags\":[\"y\"],\"extra\":{\"name\":\"c\"}}"
+		, "{\"id\":3,\"extra\":{\"name\":\"d\"}}"
+	};
+
+	for (int32 i = 0; i < 3; i++)
+	{
+		byte plain[256], encoded[256], text[256];
+		int32 plainLength   = writeJson(messages[i], plain, sizeof(plain), NULL);
+		int32 encodedLength = writeJson(messages[i], encoded, sizeof(encoded), &writerDictionary);
+
+		if (i == 0)
+		{
+			EXPECT_EQ(encodedLength, plainLength);
+		}
+		else
+		{
+			EXPECT_LT(encodedLength, plainLength);
+		}
+
+		EXPECT_STREQ(formatJson(encoded, encodedLength, text, sizeof(text), &readerDictionary), messages[i]);
+
+		// Both sides learn keys after each message
+		writerDictionary.learn(DtoType(encoded, sizeof(encoded)));
+		readerDictionary.learn(DtoType(encoded, sizeof(encoded)));
+	}
+
+	// Sequence item keys are not learned
+	ASSERT_EQ(writerDictionary.size(), 4);
+	ASSERT_EQ(readerDictionary.size(), 4);
+
+	for (int32 i = 0; i < writerDictionary.size(); i++)
+	{
+		EXPECT_TRUE(writerDictionary.key(i) == readerDictionary.key(i));
+	}
+
+	EXPECT_TRUE(writerDictionary.key(3) == DtoStringView::construct("extra"));
+}
+
+TEST(Dictionary, EncodesLargeIds)
+{
+	DtoKeyDictionary dictionary;
+	char key[16];
+
+	for (int32 i = 0; i < 1000; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		ASSERT_EQ(dictionary.add(DtoStringView::construct(key)), i);
+	}
+
+	for (int32 i = 0; i < 1000; i++)
+	{
+		byte encoded[DtoKeyDictionary::MaxEncodedLength];
+		DtoStringView view;
+		view.value  = reinterpret_cast<cstring>(encoded);
+		view.length = DtoKeyDictionary::encode(i, encoded);
+
+		EXPECT_EQ(view.length, i < 255 ? 2 : 3);
+		EXPECT_TRUE(memchr(encoded, 0, view.length) == NULL);
+		ASSERT_TRUE(dictionary.resolve(view));
+
+		snprintf(key, sizeof(key), "key%d", i);
+		EXPECT_TRUE(view == DtoStringView::construct(key));
+		EXPECT_EQ(dictionary.find(view), i);
+	}
+}
\ No newline at end of file
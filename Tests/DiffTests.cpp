@@ -0,0 +1,109 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+//! Returns true if two documents have the same binary layout.
+static bool equalLayouts(const DtoType& a, const DtoType& b)
+{
+	return a.length() == b.length() && memcmp(a.data(), b.data(), a.length()) == 0;
+}
+
+TEST(Diff, EqualDocumentsProduceAnEmptyPatch)
+{
+	byte a[256], b[256];
+	DtoType first  = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"x\"},\"tags\":[1,2]}", a, sizeof(a));
+	DtoType second = dtoParse<JsonDtoReader>("{\"tags\":[1,2],\"user\":{\"name\":\"x\"},\"id\":1}", b, sizeof(b));
+
+	std::vector<byte> patch, result;
+	EXPECT_EQ(dtoDiff(first, first, patch).length(), 5);
+	EXPECT_EQ(dtoDiff(first, second, patch).length(), 5);
+
+	DtoType applied = dtoApplyPatch(first, dtoDiff(first, first, patch), result);
+	EXPECT_TRUE(equalLayouts(applied, first));
+}
+
+TEST(Diff, PatchesNestedEntries)
+{
+	byte a[256], b[256];
+	DtoType first  = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"x\",\"address\":{\"city\":\"a\",\"zip\":10}},\"tags\":[1,2,3],\"note\":\"a long unchanged string value\"}", a, sizeof(a));
+	DtoType second = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"x\",\"address\":{\"city\":\"b\",\"zip\":10}},\"tags\":[1,5,3,4],\"note\":\"a long unchanged string value\"}", b, sizeof(b));
+
+	std::vector<byte> patch, result;
+	DtoType diff = dtoDiff(first, second, patch);
+	EXPECT_LT(diff.length(), second.length() / 2);
+
+	DtoIter city = diff.find(DtoFieldPath("user.address.city"));
+	ASSERT_TRUE(city);
+	EXPECT_TRUE(city.toString() == DtoStringView::construct("b"));
+	EXPECT_FALSE(diff.find("id"));
+	EXPECT_FALSE(diff.find("note"));
+
+	EXPECT_TRUE(equalLayouts(dtoApplyPatch(first, diff, result), second));
+}
+
+TEST(Diff, SetsUnsetsAndReplacesEntries)
+{
+	byte a[256], b[256];
+	DtoEncoder(a, sizeof(a)) << "id" << 1 << "name" << "x" << "user" << DtoEncoder::keyValue << "age" << 30 << DtoEncoder::end << "tags" << DtoEncoder::sequence << 1 << 2 << DtoEncoder::end << DtoEncoder::end;
+	DtoEncoder(b, sizeof(b)) << "id" << 2.5 << "user" << "guest" << "tags" << DtoEncoder::sequence << 1 << DtoEncoder::end << "flag" << DtoEncoder::null << "items" << DtoEncoder::sequence << true << DtoEncoder::end << DtoEncoder::end;
+	DtoType first(a, sizeof(a));
+	DtoType second(b, sizeof(b));
+
+	std::vector<byte> patch, result;
+	DtoType diff = dtoDiff(first, second, patch);
+
+	EXPECT_EQ(diff.find("name").type(), DtoNull);
+	EXPECT_EQ(diff.find("id").type(), DtoDouble);
+	EXPECT_EQ(diff.find("flag").type(), DtoSequence);
+	EXPECT_EQ(diff.find("items").type(), DtoSequence);
+
+	EXPECT_TRUE(equalLayouts(dtoApplyPatch(first, diff, result), second));
+
+	// A reverse patch restores a source document, but re-added entries are appended to the end
+	DtoType restored = dtoApplyPatch(second, dtoDiff(second, first, patch), result);
+	EXPECT_FALSE(equalLayouts(restored, first));
+	EXPECT_EQ(dtoHash(restored, DtoHashCanonical), dtoHash(first, DtoHashCanonical));
+}
+
+TEST(Diff, RejectsMismatchedBase)
+{
+	byte a[256], b[256], c[256];
+	DtoType first  = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"x\"}}", a, sizeof(a));
+	DtoType second = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"y\"}}", b, sizeof(b));
+	DtoType other  = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":7}", c, sizeof(c));
+
+	std::vector<byte> patch, result;
+	DtoType diff = dtoDiff(first, second, patch);
+
+	EXPECT_FALSE(dtoApplyPatch(other, diff, result));
+	EXPECT_FALSE(dtoApplyPatch(DtoType(), diff, result));
+
+	// A patch from an empty document sets all entries
+	EXPECT_TRUE(equalLayouts(dtoApplyPatch(DtoType(), dtoDiff(DtoType(), second, patch), result), second));
+}
\ No newline at end of file
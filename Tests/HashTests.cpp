@@ -0,0 +1,86 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+TEST(Hash, MatchesReferenceVectors)
+{
+	EXPECT_EQ(dtoHashBytes("", 0), 0xEF46DB3751D8E999ULL);
+	EXPECT_EQ(dtoHashBytes("a", 1), 0xD24EC4F1A98C6E5BULL);
+	EXPECT_EQ(dtoHashBytes("abc", 3), 0x44BC2CF5AD770999ULL);
+	EXPECT_EQ(dtoHashBytes("Nobody inspects the spammish repetition", 39), 0xFBCEA83C8A378BF1ULL);
+	EXPECT_NE(dtoHashBytes("abc", 3, 1), dtoHashBytes("abc", 3));
+}
+
+TEST(Hash, LayoutDependsOnEntryOrder)
+{
+	byte a[256], b[256], c[256];
+	DtoType first  = dtoParse<JsonDtoReader>("{\"id\":1,\"name\":\"x\"}", a, sizeof(a));
+	DtoType second = dtoParse<JsonDtoReader>("{\"id\":1,\"name\":\"x\"}", b, sizeof(b));
+	DtoType third  = dtoParse<JsonDtoReader>("{\"name\":\"x\",\"id\":1}", c, sizeof(c));
+
+	EXPECT_EQ(dtoHash(first), dtoHash(second));
+	EXPECT_EQ(dtoHash(first), dtoHashBytes(first.data(), first.length()));
+	EXPECT_NE(dtoHash(first), dtoHash(third));
+	EXPECT_NE(dtoHash(first), dtoHash(first, DtoHashLayout, 7));
+}
+
+TEST(Hash, CanonicalIgnoresKeyOrder)
+{
+	byte a[256], b[256], c[256], d[256];
+	DtoType first  = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"x\",\"age\":30},\"tags\":[1,2]}", a, sizeof(a));
+	DtoType second = dtoParse<JsonDtoReader>("{\"tags\":[1,2],\"user\":{\"age\":30,\"name\":\"x\"},\"id\":1}", b, sizeof(b));
+	DtoType swapped = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"x\",\"age\":30},\"tags\":[2,1]}", c, sizeof(c));
+	DtoType changed = dtoParse<JsonDtoReader>("{\"id\":1,\"user\":{\"name\":\"y\",\"age\":30},\"tags\":[1,2]}", d, sizeof(d));
+
+	EXPECT_EQ(dtoHash(first, DtoHashCanonical), dtoHash(second, DtoHashCanonical));
+	EXPECT_NE(dtoHash(first, DtoHashCanonical), dtoHash(swapped, DtoHashCanonical));
+	EXPECT_NE(dtoHash(first, DtoHashCanonical), dtoHash(changed, DtoHashCanonical));
+	EXPECT_NE(dtoHash(first), dtoHash(second));
+}
+
+TEST(Hash, CanonicalDistinguishesStructure)
+{
+	byte a[256], b[256], c[256], d[256];
+	DtoType flat    = dtoParse<JsonDtoReader>("{\"a\":1,\"b\":2}", a, sizeof(a));
+	DtoType nested  = dtoParse<JsonDtoReader>("{\"a\":{\"b\":2}}", b, sizeof(b));
+	DtoType doubled = dtoParse<JsonDtoReader>("{\"a\":1,\"a\":1,\"b\":2}", c, sizeof(c));
+	DtoType items   = dtoParse<JsonDtoReader>("{\"a\":[2]}", d, sizeof(d));
+
+	uint64 hashes[] = { dtoHash(flat, DtoHashCanonical), dtoHash(nested, DtoHashCanonical), dtoHash(doubled, DtoHashCanonical), dtoHash(items, DtoHashCanonical) };
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		for (int32 j = i + 1; j < 4; j++)
+		{
+			EXPECT_NE(hashes[i], hashes[j]);
+		}
+	}
+
+	EXPECT_EQ(dtoHash(DtoType(), DtoHashCanonical), dtoHash(DtoType()));
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+//! Parses JSON records into a single buffer.
+static std::vector<DtoType> parseRecords(cstring* records, int32 count, std::vector<byte>& buffer)
+{
+	std::vector<DtoType> documents;
+	buffer.resize(count * 128);
+
+	for (int32 i = 0; i < count; i++)
+	{
+		documents.push_back(dtoParse<JsonDtoReader>(records[i], &buffer[i * 128], 128));
+	}
+
+	return documents;
+}
+
+TEST(FieldPath, FindsNestedEntries)
+{
+	byte buffer[256];
+	DtoType dto = dtoParse<JsonDtoReader>("{\"user\":{\"id\":7,\"tags\":[\"a\",\"b\"]},\"name\":\"x\"}", buffer, sizeof(buffer));
+
+	DtoFieldPath path("user..id");
+	ASSERT_EQ(path.size(), 2);
+	EXPECT_TRUE(path.key(1) == DtoStringView::construct("id"));
+
+	EXPECT_EQ(dto.find(path).toDouble(), 7.0);
+	EXPECT_TRUE(dto.find(DtoFieldPath("user.tags.1")).toString() == DtoStringView::construct("b"));
+	EXPECT_FALSE(dto.find(DtoFieldPath("user.missing")));
+	EXPECT_FALSE(dto.find(DtoFieldPath("name.id")));
+	EXPECT_FALSE(dto.find(DtoFieldPath("")));
+}
+
+TEST(FieldIndex, FindsEqualValues)
+{
+	cstring records[] = {
+		  "{\"user\":{\"id\":5}}"
+		, "{\"user\":{\"id\":\"5\"}}"
+		, "{\"user\":{}}"
+		, "{\"user\":{\"id\":5.5}}"
+		, "{\"user\":{\"id\":5}}"
+		, "{\"user\":{\"id\":[5]}}"
+	};
+
+	std::vector<byte> buffer;
+	std::vector<DtoType> documents = parseRecords(records, 6, buffer);
+
+	DtoFieldIndex index("user.id", DtoHashIndex);
+	index.build(&documents[0], documents.size());
+
+	// Documents without a scalar value are not indexed
+	EXPECT_EQ(index.size(), 4);
+
+	std::vector<int64> locations;
+	EXPECT_EQ(index.find(5, locations), 2);
+	ASSERT_EQ(locations.size(), 2);
+	EXPECT_EQ(locations[0], 0);
+	EXPECT_EQ(locations[1], 4);
+
+	// Keys of different types never match
+	locations.clear();
+	EXPECT_EQ(index.find("5", locations), 1);
+	EXPECT_EQ(locations[0], 1);
+
+	EXPECT_EQ(index.find(5.5, locations), 1);
+	EXPECT_EQ(index.find(6, locations), 0);
+	EXPECT_EQ(index.range(0, 10, locations), -1);
+}
+
+TEST(FieldIndex, QueriesRangesInParallel)
+{
+	std::vector<byte> buffer(10000 * 32);
+	std::vector<DtoType> documents;
+
+	for (int32 i = 0; i < 10000; i++)
+	{
+		DtoEncoder(&buffer[i * 32], 32) << "value" << (i * 7919) % 10000 << DtoEncoder::end;
+		documents.push_back(DtoType(&buffer[i * 32], 32));
+	}
+
+	DtoThreadPool pool(4);
+	DtoFieldIndex index("value", DtoSortedIndex);
+	index.build(&documents[0], documents.size(), &pool);
+	ASSERT_EQ(index.size(), 10000);
+
+	std::vector<int64> locations;
+	EXPECT_EQ(index.range(100, 199.5, locations), 100);
+
+	// A range is returned in an ascending key order
+	for (size_t i = 0; i < locations.size(); i++)
+	{
+		EXPECT_EQ(documents[locations[i]].find("value").toInt32(), 100 + static_cast<int32>(i));
+	}
+
+	locations.clear();
+	EXPECT_EQ(index.find(4242, locations), 1);
+	EXPECT_EQ(documents[locations[0]].find("value").toInt32(), 4242);
+}
+
+TEST(FieldIndex, LocatesSequenceItems)
+{
+	byte buffer[512];
+	DtoType sequence = dtoParse<JsonDtoReader>("[{\"k\":\"b\"},{\"k\":\"a\"},1,{\"k\":\"c\"},{\"k\":\"a\"}]", buffer, sizeof(buffer));
+
+	DtoFieldIndex index("k", DtoSortedIndex);
+	index.build(sequence);
+
+	std::vector<int64> locations;
+	ASSERT_EQ(index.find("a", locations), 2);
+
+	// Item offsets point directly to item documents
+	DtoType item(sequence.data() + locations[1], sequence.length() - static_cast<int32>(locations[1]));
+	EXPECT_TRUE(item.find("k").toString() == DtoStringView::construct("a"));
+	EXPECT_GT(locations[1], locations[0]);
+
+	locations.clear();
+	EXPECT_EQ(index.range("b", "z", locations), 2);
+}
\ No newline at end of file
@@ -283,4 +283,311 @@ TEST(Json, ParsesRootEmptyArray)
 	cstring json = "[]";
 	DtoType dto = dtoParse<JsonDtoReader>(json, document, sizeof(document));
 	ASSERT_TRUE(dto);
+}
+
+//! Formats a DTO as a compact JSON string.
+static cstring formatJson(const byte* input, byte* output, int32 capacity, bool asciiOnly = false)
+{
+	BinaryDtoReader reader(input, capacity);
+	JsonDtoWriter writer(output, capacity);
+	writer.setAsciiOnly(asciiOnly);
+
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return reinterpret_cast<cstring>(output);
+}
+
+TEST(Json, EscapesQuotesAndBackslashes)
+{
+	byte encoded[256], json[256];
+	DtoEncoder(encoded, sizeof(encoded)) << "a\"b" << "say \"hi\" \\o/" << DtoEncoder::end;
+	EXPECT_STREQ(formatJson(encoded, json, sizeof(json)), "{\"a\\\"b\":\"say \\\"hi\\\" \\\\o/\"}");
+}
+
+TEST(Json, EscapesControlCharacters)
+{
+	byte encoded[256], json[256];
+	DtoEncoder(encoded, sizeof(encoded)) << "a" << "\b\f\n\r\t\x01" << DtoEncoder::end;
+	EXPECT_STREQ(formatJson(encoded, json, sizeof(json)), "{\"a\":\"\\b\\f\\n\\r\\t\\u0001\"}");
+}
+
+TEST(Json, EscapesLongStrings)
+{
+	byte encoded[512], json[512];
+	cstring value = "0123456789abcdefghijklmnopqrstuvwxyz\"0123456789abcdefghijklmnopqrstuvwxyz\n";
+	DtoEncoder(encoded, sizeof(encoded)) << "a" << value << DtoEncoder::end;
+	EXPECT_STREQ(formatJson(encoded, json, sizeof(json)), "{\"a\":\"0123456789abcdefghijklmnopqrstuvwxyz\\\"0123456789abcdefghijklmnopqrstuvwxyz\\n\"}");
+}
+
+TEST(Json, KeepsNonAsciiCharacters)
+{
+	byte encoded[256], json[256];
+	DtoEncoder(encoded, sizeof(encoded)) << "a" << "\xc3\xa9t\xc3\xa9" << DtoEncoder::end;
+	EXPECT_STREQ(formatJson(encoded, json, sizeof(json)), "{\"a\":\"\xc3\xa9t\xc3\xa9\"}");
+}
+
+TEST(Json, EscapesNonAsciiCharacters)
+{
+	byte encoded[256], json[256];
+	DtoEncoder(encoded, sizeof(encoded)) << "a" << "\xc3\xa9t\xe2\x82\xac \xf0\x9f\x98\x80" << DtoEncoder::end;
+	EXPECT_STREQ(formatJson(encoded, json, sizeof(json), true), "{\"a\":\"\\u00e9t\\u20ac \\ud83d\\ude00\"}");
+}
+
+TEST(Json, ParsesEscapedQuotes)
+{
+	cstring json = "{\"a\":\"say \\\"hi\\\"\",\"b\":1}";
+	DtoType dto = dtoParse<JsonDtoReader>(json, document, sizeof(document));
+	ASSERT_TRUE(dto);
+	EXPECT_EQ(dto.entryCount(), 2);
+
+	DtoIter i = dto.find("a");
+	ASSERT_TRUE(i);
+	EXPECT_TRUE(i.toString() == DtoStringView::construct("say \"hi\""));
+}
+
+TEST(Json, RoundTripsEscapedStrings)
+{
+	cstring json = "{\"a\":\"line1\\nline2 \\\"q\\\" \\u00e9\",\"line\\tkey\":\"\\ud83d\\ude00\"}";
+	DtoType dto = dtoParse<JsonDtoReader>(json, document, sizeof(document));
+	ASSERT_TRUE(dto);
+	EXPECT_TRUE(dto.find("a").toString() == DtoStringView::construct("line1\nline2 \"q\" \xc3\xa9"));
+	EXPECT_TRUE(dto.find("line\tkey").toString() == DtoStringView::construct("\xf0\x9f\x98\x80"));
+
+	byte output[256];
+	EXPECT_STREQ(formatJson(document, output, sizeof(output)), "{\"a\":\"line1\\nline2 \\\"q\\\" \xc3\xa9\",\"line\\tkey\":\"\xf0\x9f\x98\x80\"}");
+	EXPECT_STREQ(formatJson(document, output, sizeof(output), true), "{\"a\":\"line1\\nline2 \\\"q\\\" \\u00e9\",\"line\\tkey\":\"\\ud83d\\ude00\"}");
+}
+
+static cstring kStreamJson = "{\"a\": 1, \"b\": -25.5, \"c\": \"hello \\\"world\\\"\", \"d\": true, \"e\": false, \"sequence\": [1, 2, [3, 4], {\"x\": \"y\"}], \"mapping\": {\"one\": {}, \"two\": []}}";
+
+//! Feeds a JSON string to a streaming reader in chunks of specified size.
+static bool parseInChunks(cstring json, int32 chunkSize, byte* output, int32 capacity)
+{
+	BinaryDtoWriter writer(output, capacity);
+	JsonDtoStreamReader reader(writer);
+	int32 length = static_cast<int32>(strlen(json));
+
+	for (int32 i = 0; i < length; i += chunkSize)
+	{
+		// Copy each chunk to a temporary buffer, so the reader can not rely on previous chunks
+		byte chunk[256];
+		int32 size = std::min(chunkSize, length - i);
+		memcpy(chunk, json + i, size);
+		memset(chunk + size, '#', sizeof(chunk) - size);
+
+		if (!reader.feed(chunk, size))
+		{
+			return false;
+		}
+	}
+
+	return reader.finish();
+}
+
+TEST(JsonStream, ParsesWholeInput)
+{
+	byte expected[1024], actual[1024];
+	ASSERT_TRUE(dtoParse<JsonDtoReader>(kStreamJson, expected, sizeof(expected)));
+	ASSERT_TRUE(parseInChunks(kStreamJson, static_cast<int32>(strlen(kStreamJson)), actual, sizeof(actual)));
+
+	DtoType dto(actual, sizeof(actual));
+	EXPECT_EQ(dto.length(), DtoType(expected, sizeof(expected)).length());
+	EXPECT_EQ(memcmp(expected, actual, dto.length()), 0);
+	EXPECT_TRUE(dto.find("c").toString() == DtoStringView::construct("hello \"world\""));
+	EXPECT_EQ(dto.findDescendant("sequence.2.1").toInt32(), 4);
+}
+
+TEST(JsonStream, ParsesArbitraryChunks)
+{
+	byte expected[1024], actual[1024];
+	ASSERT_TRUE(dtoParse<JsonDtoReader>(kStreamJson, expected, sizeof(expected)));
+	int32 length = DtoType(expected, sizeof(expected)).length();
+
+	for (int32 chunkSize = 1; chunkSize < 20; chunkSize++)
+	{
+		memset(actual, 0, sizeof(actual));
+		ASSERT_TRUE(parseInChunks(kStreamJson, chunkSize, actual, sizeof(actual)));
+		EXPECT_EQ(memcmp(expected, actual, length), 0) << "chunk size " << chunkSize;
+	}
+}
+
+TEST(JsonStream, ParsesRootSequence)
+{
+	byte actual[256];
+	ASSERT_TRUE(parseInChunks("[1, \"two\", true]", 3, actual, sizeof(actual)));
+
+	DtoType dto(actual, sizeof(actual));
+	EXPECT_EQ(dto.entryCount(), 3);
+	EXPECT_TRUE(dto.find("1").toString() == "two");
+}
+
+//! A writer that records keys of consumed entries to observe when a streaming reader emits them.
+class RecordingDtoWriter : public DtoWriter
+{
+public:
+
+	virtual int32 consume(const DtoEvent& event)
+	{
+		events++;
+
+		if (event.type == DtoEntry)
+		{
+			keys.push_back(std::string(event.key.value, event.key.length));
+		}
+		return 0;
+	}
+
+	int32					 events = 0;
+	std::vector<std::string> keys;
+};
+
+TEST(JsonStream, EmitsEventsBeforeInputEnds)
+{
+	RecordingDtoWriter recorder;
+	JsonDtoStreamReader reader(recorder);
+
+	cstring first = "{\"a\": \"complete\", \"b\": \"incompl";
+	ASSERT_TRUE(reader.feed(reinterpret_cast<const byte*>(first), static_cast<int32>(strlen(first))));
+	EXPECT_FALSE(reader.complete());
+
+	// A stream start and a complete entry are already emitted, a partial entry is not
+	EXPECT_EQ(recorder.events, 2);
+	ASSERT_EQ(recorder.keys.size(), 1u);
+	EXPECT_EQ(recorder.keys[0], "a");
+
+	cstring second = "ete\"}";
+	ASSERT_TRUE(reader.feed(reinterpret_cast<const byte*>(second), static_cast<int32>(strlen(second))));
+	EXPECT_TRUE(reader.complete());
+	EXPECT_EQ(recorder.events, 4);
+	ASSERT_EQ(recorder.keys.size(), 2u);
+	EXPECT_EQ(recorder.keys[1], "b");
+}
+
+TEST(JsonStream, ParsesNullSplitAcrossChunks)
+{
+	cstring json = "{\"a\": null, \"b\": [null, 1]}";
+	byte actual[256];
+
+	for (int32 chunkSize = 1; chunkSize < 8; chunkSize++)
+	{
+		ASSERT_TRUE(parseInChunks(json, chunkSize, actual, sizeof(actual))) << "chunk size " << chunkSize;
+
+		DtoType dto(actual, sizeof(actual));
+		EXPECT_EQ(dto.find("a").type(), DtoNull);
+		EXPECT_EQ(dto.findDescendant("b.0").type(), DtoNull);
+		EXPECT_EQ(dto.findDescendant("b.1").toInt32(), 1);
+	}
+
+	EXPECT_FALSE(parseInChunks("{\"a\": nul}", 3, actual, sizeof(actual)));
+}
+
+TEST(JsonStream, FailsOnTruncatedInput)
+{
+	byte actual[256];
+	EXPECT_FALSE(parseInChunks("{\"a\": [1, 2", 4, actual, sizeof(actual)));
+}
+
+TEST(JsonStream, FailsOnMalformedInput)
+{
+	byte actual[256];
+	EXPECT_FALSE(parseInChunks("{\"a\" 1}", 2, actual, sizeof(actual)));
+	EXPECT_FALSE(parseInChunks("{\"a\": tru}", 2, actual, sizeof(actual)));
+	EXPECT_FALSE(parseInChunks("{\"a\": [1}", 2, actual, sizeof(actual)));
+}
+
+static cstring kLazyJson =
+	"{\n"
+	"  \"id\": 42,\n"
+	"  \"skip\": {\"a\": [1, {\"b\": \"}]\\\"\"}], \"c\": \"{[\"},\n"
+	"  \"name\": \"lazy \\\"view\\\"\",\n"
+	"  \"active\": false,\n"
+	"  \"missing\": null,\n"
+	"  \"items\": [10, -2.5e1, {\"deep\": true}, []]\n"
+	"}";
+
+TEST(JsonView, FindsTopLevelEntries)
+{
+	JsonDtoView view(reinterpret_cast<const byte*>(kLazyJson), static_cast<int32>(strlen(kLazyJson)));
+
+	ASSERT_TRUE(view);
+	EXPECT_EQ(view.entryCount(), 6);
+	EXPECT_EQ(view.find("id").toInt32(), 42);
+	EXPECT_TRUE(view.find("name").toString() == "lazy \\\"view\\\"");
+	EXPECT_FALSE(view.find("active").toBool());
+	EXPECT_TRUE(view.find("missing") == DtoNull);
+	EXPECT_TRUE(view.find("skip") == DtoKeyValue);
+	EXPECT_FALSE(view.find("unknown"));
+}
+
+TEST(JsonView, FindsDescendants)
+{
+	JsonDtoView view(reinterpret_cast<const byte*>(kLazyJson), static_cast<int32>(strlen(kLazyJson)));
+
+	EXPECT_TRUE(view.findDescendant("skip.a.1.b").toString() == "}]\\\"");
+	EXPECT_TRUE(view.findDescendant("skip.c").toString() == "{[");
+	EXPECT_EQ(view.findDescendant("items.1").toDouble(), -25.0);
+	EXPECT_TRUE(view.findDescendant("items.2.deep").toBool());
+	EXPECT_EQ(view.findDescendant("items.3").toDto().entryCount(), 0);
+	EXPECT_FALSE(view.findDescendant("items.4"));
+	EXPECT_FALSE(view.findDescendant("id.x"));
+}
+
+TEST(JsonView, FindsEscapedKeys)
+{
+	cstring input = "{\"a\\\"b\": 1, \"\\u0061\": 2, \"c\\\\\": 3}";
+	JsonDtoView view(reinterpret_cast<const byte*>(input), static_cast<int32>(strlen(input)));
+
+	// Keys are matched by their decoded text, just like in a parsed document
+	EXPECT_EQ(view.find("a\"b").toInt32(), 1);
+	EXPECT_EQ(view.find("a").toInt32(), 2);
+	EXPECT_EQ(view.find("c\\").toInt32(), 3);
+	EXPECT_EQ(view.findDescendant("a").toInt32(), 2);
+	EXPECT_FALSE(view.find("\\u0061"));
+}
+
+TEST(JsonView, IteratesOverArrayItems)
+{
+	cstring input = "  [1, \"two\", [3], {\"four\": 4}] trailing";
+	JsonDtoView view(reinterpret_cast<const byte*>(input), static_cast<int32>(strlen(input)));
+
+	DtoValueType types[] = { DtoDouble, DtoString, DtoSequence, DtoKeyValue };
+	JsonDtoIter iter = view.iter();
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		ASSERT_TRUE(iter.next());
+		EXPECT_EQ(iter.type(), types[i]);
+		EXPECT_EQ(atoi(std::string(iter.key().value, iter.key().length).c_str()), i);
+	}
+
+	EXPECT_FALSE(iter.next());
+}
+
+TEST(JsonView, StopsOnMalformedInput)
+{
+	cstring input = "{\"a\": 1, \"b\": [1, 2, \"c\": 3}";
+	JsonDtoView view(reinterpret_cast<const byte*>(input), static_cast<int32>(strlen(input)));
+
+	EXPECT_EQ(view.find("a").toInt32(), 1);
+	EXPECT_FALSE(view.find("c"));
+	EXPECT_FALSE(JsonDtoView(reinterpret_cast<const byte*>("42"), 2));
+}
+
+TEST(JsonView, ParsesLongNumbers)
+{
+	cstring input = "{\"a\": 1.25e2, \"b\": 123456789012345678901234567890123456789, \"c\": 7}";
+	JsonDtoView view(reinterpret_cast<const byte*>(input), static_cast<int32>(strlen(input)));
+
+	EXPECT_EQ(view.find("a").toDouble(), 125.0);
+	EXPECT_DOUBLE_EQ(view.find("b").toDouble(), 1.23456789012345678901234567890123456789e38);
+
+	// Fields that follow a long number are still reachable
+	ASSERT_TRUE(view.find("c"));
+	EXPECT_EQ(view.find("c").toDouble(), 7.0);
 }
\ No newline at end of file
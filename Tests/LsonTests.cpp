@@ -0,0 +1,147 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+static byte document[16536];
+typedef ::Dto::Dto DtoType;
+
+TEST(Lson, WontParseEmptyString)
+{
+	cstring lson = "";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_FALSE(dto);
+}
+
+TEST(Lson, ParsesReturnedTable)
+{
+	cstring lson =	"-- window settings\n"
+					"return {\n"
+					"\ttitle = \"Game\", width = 800; height = 600,\n"
+					"\tfullscreen = false,\n"
+					"\t[\"log level\"] = 'debug',\n"
+					"\tgamma = -1.5, --[[ a block\n"
+					"\tcomment ]] shader = nil,\n"
+					"}\n";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_TRUE(dto);
+	EXPECT_EQ(dto.entryCount(), 7);
+
+	EXPECT_TRUE(dto.find("title").toString() == "Game");
+	EXPECT_EQ(dto.find("height").toInt32(), 600);
+	EXPECT_FALSE(dto.find("fullscreen").toBool());
+	EXPECT_TRUE(dto.find("log level").toString() == "debug");
+	EXPECT_EQ(dto.find("gamma").toDouble(), -1.5);
+	EXPECT_EQ(dto.find("shader").type(), DtoNull);
+}
+
+TEST(Lson, ParsesPositionalTablesAsSequences)
+{
+	cstring lson = "{ levels = { \"intro\", \"forest\", { name = \"boss\", hp = 100 } }, empty = {} }";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	DtoIter levels = dto.find("levels");
+	ASSERT_TRUE(levels);
+	EXPECT_EQ(levels.type(), DtoSequence);
+	EXPECT_TRUE(dto.findDescendant("levels.1").toString() == "forest");
+	EXPECT_EQ(dto.findDescendant("levels.2.hp").toInt32(), 100);
+	EXPECT_EQ(dto.find("empty").type(), DtoKeyValue);
+}
+
+TEST(Lson, ParsesGlobalAssignments)
+{
+	cstring lson =	"width = 1024\n"
+					"height = 768\n"
+					"modes = { 1, 2, 3 }\n";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_TRUE(dto);
+	EXPECT_EQ(dto.entryCount(), 3);
+	EXPECT_EQ(dto.find("width").toInt32(), 1024);
+	EXPECT_EQ(dto.findDescendant("modes.2").toInt32(), 3);
+}
+
+TEST(Lson, ParsesEscapedStrings)
+{
+	cstring lson = "{ a = 'it\\'s', [\"k\\n\"] = \"\\65\\x42\\u{43}\" }";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_TRUE(dto);
+	EXPECT_TRUE(dto.find("a").toString() == DtoStringView::construct("it's"));
+	EXPECT_TRUE(dto.find("k\n").toString() == DtoStringView::construct("ABC"));
+}
+
+TEST(Lson, WontParseMissingSeparators)
+{
+	cstring lson = "{ a = 1 b = 2 }";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_FALSE(dto);
+}
+
+TEST(Lson, WritesTableConstructor)
+{
+	cstring json = "{\"name\":\"hero\",\"end\":1,\"hit points\":[10,20],\"flags\":{\"alive\":true}}";
+	DtoType dto = dtoParse<JsonDtoReader>(json, document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte output[256];
+	ASSERT_TRUE((dtoConvert<BinaryDtoReader, LsonDtoWriter>(document, dto.length(), output, sizeof(output))));
+	EXPECT_STREQ(reinterpret_cast<cstring>(output), "{name=\"hero\",[\"end\"]=1,[\"hit points\"]={10,20},flags={alive=true}}");
+
+	// A written table should be readable back
+	byte binary[256];
+	DtoType parsed = dtoParse<LsonDtoReader>(reinterpret_cast<cstring>(output), binary, sizeof(binary));
+	ASSERT_TRUE(parsed);
+	EXPECT_EQ(parsed.findDescendant("hit points.1").toInt32(), 20);
+}
+
+TEST(Lson, WritesLuaEscapes)
+{
+	cstring json = "{\"k\":\"a\\u0001b\\n\\\"q\\\"\\u007f\",\"\\u00e9\":1}";
+	DtoType dto = dtoParse<JsonDtoReader>(json, document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte output[256];
+	ASSERT_TRUE((dtoConvert<BinaryDtoReader, LsonDtoWriter>(document, dto.length(), output, sizeof(output))));
+	EXPECT_STREQ(reinterpret_cast<cstring>(output), "{k=\"a\\001b\\n\\\"q\\\"\x7f\",[\"\xc3\xa9\"]=1}");
+
+	// Escapes are decoded back to the original bytes
+	byte binary[256];
+	DtoType parsed = dtoParse<LsonDtoReader>(reinterpret_cast<cstring>(output), binary, sizeof(binary));
+	ASSERT_TRUE(parsed);
+	EXPECT_TRUE(parsed.find("k").toString() == DtoStringView::construct("a\x01" "b\n\"q\"\x7f"));
+}
+
+TEST(Lson, ParsesExponentsAndHexNumbers)
+{
+	cstring lson = "{ a = 1.5e3, b = 2E-2, c = 0x10, d = -0XfF, e = 7 }";
+	DtoType dto = dtoParse<LsonDtoReader>(lson, document, sizeof(document));
+	ASSERT_TRUE(dto);
+	EXPECT_EQ(dto.find("a").toDouble(), 1500.0);
+	EXPECT_EQ(dto.find("b").toDouble(), 0.02);
+	EXPECT_EQ(dto.find("c").toInt32(), 16);
+	EXPECT_EQ(dto.find("d").toInt32(), -255);
+	EXPECT_EQ(dto.find("e").toInt32(), 7);
+}
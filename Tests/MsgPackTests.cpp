@@ -0,0 +1,179 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+static byte document[16536];
+typedef ::Dto::Dto DtoType;
+
+//! Converts a binary DTO to a MessagePack document and returns a total number of written bytes.
+static int32 toMsgPack(const DtoType& dto, byte* output, int32 capacity)
+{
+	BinaryDtoReader reader(dto.data(), dto.length());
+	MsgPackDtoWriter writer(output, capacity);
+	DtoEvent event;
+
+	do
+	{
+		event = reader.next();
+		writer.consume(event);
+	} while (event.type != DtoStreamEnd);
+
+	return writer.length();
+}
+
+TEST(MsgPack, ReadsMaps)
+{
+	const byte input[] = { 0x82, 0xA7, 'c', 'o', 'm', 'p', 'a', 'c', 't', 0xC3, 0xA6, 's', 'c', 'h', 'e', 'm', 'a', 0x00 };
+
+	ASSERT_TRUE((dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(input, sizeof(input), document, sizeof(document))));
+	DtoType dto(document, sizeof(document));
+	EXPECT_TRUE(dto.find("compact").toBool());
+	EXPECT_EQ(dto.find("schema").type(), DtoInt32);
+	EXPECT_EQ(dto.find("schema").toInt32(), 0);
+}
+
+TEST(MsgPack, ReadsIntegerKeysAndFloats)
+{
+	const byte input[] = { 0x83, 0xD0, 0x9C, 0xC0, 0x07, 0xCA, 0x3F, 0xC0, 0x00, 0x00, 0xA1, 'n', 0xD1, 0xFC, 0x18 };
+
+	ASSERT_TRUE((dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(input, sizeof(input), document, sizeof(document))));
+	DtoType dto(document, sizeof(document));
+	EXPECT_EQ(dto.find("-100").type(), DtoNull);
+	EXPECT_EQ(dto.find("7").toDouble(), 1.5);
+	EXPECT_EQ(dto.find("n").toInt32(), -1000);
+}
+
+TEST(MsgPack, WritesShortestHeaders)
+{
+	DtoEncoder(document, sizeof(document))
+		<< "a" << DtoEncoder::sequence << 1 << -1 << 300 << -200 << DtoEncoder::end
+		<< "b" << DtoEncoder::null
+		<< DtoEncoder::end;
+	DtoType dto(document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte msgpack[64];
+	int32 length = toMsgPack(dto, msgpack, sizeof(msgpack));
+
+	const byte expected[] = { 0x82, 0xA1, 'a', 0x94, 0x01, 0xFF, 0xCD, 0x01, 0x2C, 0xD1, 0xFF, 0x38, 0xA1, 'b', 0xC0 };
+	ASSERT_EQ(length, sizeof(expected));
+	EXPECT_EQ(memcmp(msgpack, expected, length), 0);
+}
+
+TEST(MsgPack, RoundTripsValues)
+{
+	std::string text(300, 'z');
+	DtoBinaryBlob blob;
+	blob.data = reinterpret_cast<const byte*>("blob");
+	blob.length = 4;
+	blob.subtype = 0;
+
+	DtoEncoder encoder(document, sizeof(document));
+	encoder
+		<< "double" << 2.5
+		<< "int32" << -70000
+		<< "int64" << static_cast<int64>(-1) * 1234567890123LL
+		<< "stamp" << static_cast<uint64>(0xFFFFFFFFFFFFFFF0ULL)
+		<< "text" << text.c_str()
+		<< "empty" << ""
+		<< "blob" << blob
+		<< "nothing" << DtoEncoder::null
+		<< "nested" << DtoEncoder::keyValue << "flag" << false << DtoEncoder::end
+		<< "items" << DtoEncoder::sequence;
+
+	// Enough items to require an array16 header
+	for (int32 i = 0; i < 20; i++)
+	{
+		encoder << i;
+	}
+
+	encoder << DtoEncoder::end << DtoEncoder::end;
+	DtoType dto(document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte msgpack[1024];
+	int32 length = toMsgPack(dto, msgpack, sizeof(msgpack));
+
+	// Decoding a MessagePack document back should produce exactly the same binary DTO
+	byte decoded[2048];
+	ASSERT_TRUE((dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(msgpack, length, decoded, sizeof(decoded))));
+	ASSERT_EQ(DtoType(decoded, sizeof(decoded)).length(), dto.length());
+	EXPECT_EQ(memcmp(decoded, document, dto.length()), 0);
+}
+
+TEST(MsgPack, RoundTripsTimestampExtensions)
+{
+	const byte input[] =
+	{
+		  0x83
+		, 0xA1, 'a', 0xD6, 0xFF, 0x5A, 0x4F, 0xD4, 0x00
+		, 0xA1, 'b', 0xD7, 0xFF, 0x77, 0x35, 0x94, 0x00, 0x5A, 0x4F, 0xD4, 0x00
+		, 0xA1, 'c', 0xC7, 0x0C, 0xFF, 0x1D, 0xCD, 0x65, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+	};
+
+	ASSERT_TRUE((dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(input, sizeof(input), document, sizeof(document))));
+	DtoType dto(document, sizeof(document));
+	EXPECT_EQ(dto.find("a").type(), DtoDate);
+
+	// Dates are stored as milliseconds, so each extension should be written back in the same form
+	byte msgpack[64];
+	int32 length = toMsgPack(dto, msgpack, sizeof(msgpack));
+	ASSERT_EQ(length, sizeof(input));
+	EXPECT_EQ(memcmp(msgpack, input, length), 0);
+}
+
+TEST(MsgPack, KeepsOutOfRangeTimestampsAsExtensions)
+{
+	const byte input[] =
+	{
+		  0x82
+		, 0xA1, 'a', 0xC7, 0x0C, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+		, 0xA1, 'b', 0xC7, 0x0C, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+
+	// Seconds that would overflow 64-bit milliseconds are not converted to dates
+	ASSERT_TRUE((dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(input, sizeof(input), document, sizeof(document))));
+	DtoType dto(document, sizeof(document));
+	EXPECT_EQ(dto.find("a").type(), DtoBinary);
+	EXPECT_EQ(dto.find("b").type(), DtoBinary);
+	EXPECT_EQ(dto.find("a").value().binary.length, 12);
+}
+
+TEST(MsgPack, WontReadTruncatedInput)
+{
+	DtoType dto = dtoParse<JsonDtoReader>("{\"a\":\"hello\",\"b\":[1,2,3],\"c\":{\"d\":0.5}}", document, sizeof(document));
+	ASSERT_TRUE(dto);
+
+	byte msgpack[64];
+	int32 length = toMsgPack(dto, msgpack, sizeof(msgpack));
+
+	byte decoded[256];
+	for (int32 i = 0; i < length; i++)
+	{
+		EXPECT_FALSE((dtoConvert<MsgPackDtoReader, BinaryDtoWriter>(msgpack, i, decoded, sizeof(decoded))));
+	}
+}
\ No newline at end of file
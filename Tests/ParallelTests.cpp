@@ -0,0 +1,352 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+#include <atomic>
+#include <string>
+
+typedef ::Dto::Dto DtoType;
+
+TEST(ThreadPool, RunsAllTasks)
+{
+	DtoThreadPool pool(4);
+	std::vector<int32> counters(1000, 0);
+
+	for (int32 batch = 0; batch < 10; batch++)
+	{
+		pool.run(static_cast<int32>(counters.size()), [&](int32 task, int32 worker)
+		{
+			EXPECT_GE(worker, 0);
+			EXPECT_LT(worker, pool.size());
+			counters[task]++;
+		});
+	}
+
+	for (size_t i = 0; i < counters.size(); i++)
+	{
+		EXPECT_EQ(counters[i], 10);
+	}
+}
+
+TEST(ThreadPool, StealsTasksFromBusyWorkers)
+{
+	DtoThreadPool pool(4);
+	std::atomic<int32> finished(0);
+	bool stolen = false;
+
+	// Tasks 0 and 1 are queued to the same worker, so task 0 can only see all other
+	// tasks finished if task 1 was stolen by another worker.
+	pool.run(8, [&](int32 task, int32 worker)
+	{
+		if (task == 0)
+		{
+			for (int32 i = 0; i < 1000 && finished < 7; i++)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			stolen = finished == 7;
+		}
+		else
+		{
+			finished++;
+		}
+	});
+
+	EXPECT_TRUE(stolen);
+}
+
+TEST(JsonLines, ParsesDocumentsInInputOrder)
+{
+	std::string input;
+
+	for (int32 i = 0; i < 500; i++)
+	{
+		input += "{\"index\": " + std::to_string(i) + ", \"name\": \"item\", \"tags\": [1, 2, 3]}\n";
+	}
+
+	DtoThreadPool pool(4);
+	DtoJsonLinesReader reader(pool);
+	reader.setChunkSize(256);
+	reader.parse(reinterpret_cast<const byte*>(input.c_str()), input.size());
+
+	ASSERT_EQ(reader.documentCount(), 500);
+	EXPECT_EQ(reader.errorCount(), 0);
+
+	for (int32 i = 0; i < reader.documentCount(); i++)
+	{
+		EXPECT_EQ(reader.document(i).find("index").toInt32(), i);
+		EXPECT_EQ(reader.document(i).findDescendant("tags.2").toInt32(), 3);
+		EXPECT_EQ(reader.documentLine(i), i + 1);
+	}
+}
+
+TEST(JsonLines, ReportsErrorsPerLine)
+{
+	cstring input =
+		"{\"a\": 1}\n"
+		"\n"
+		"{\"a\": }\r\n"
+		"{\"a\": 2}\r\n"
+		"   \n"
+		"[1, 2\n"
+		"{\"a\": 3}";
+
+	DtoThreadPool pool(2);
+	DtoJsonLinesReader reader(pool);
+	reader.setChunkSize(8);
+	reader.parse(reinterpret_cast<const byte*>(input), strlen(input));
+
+	ASSERT_EQ(reader.documentCount(), 3);
+	EXPECT_EQ(reader.documentLine(0), 1);
+	EXPECT_EQ(reader.documentLine(1), 4);
+	EXPECT_EQ(reader.documentLine(2), 7);
+	EXPECT_EQ(reader.document(2).find("a").toInt32(), 3);
+
+	ASSERT_EQ(reader.errorCount(), 2);
+	EXPECT_EQ(reader.errorLine(0), 3);
+	EXPECT_EQ(reader.errorLine(1), 6);
+}
+
+TEST(JsonLines, ParsesMappedFile)
+{
+	cstring path = "dto_json_lines_test.ndjson";
+	FILE* file = fopen(path, "wb");
+	ASSERT_TRUE(file != NULL);
+	fputs("{\"a\": \"first\"}\n{\"a\": \"second\"}\n", file);
+	fclose(file);
+
+	DtoThreadPool pool(2);
+	DtoJsonLinesReader reader(pool);
+	ASSERT_TRUE(reader.parseFile(path));
+	ASSERT_EQ(reader.documentCount(), 2);
+	EXPECT_TRUE(reader.document(1).find("a").toString() == "second");
+
+	EXPECT_FALSE(reader.parseFile("dto_json_lines_missing.ndjson"));
+	remove(path);
+}
+
+TEST(JsonLines, ParsesEmptyFile)
+{
+	cstring path = "dto_json_lines_empty.ndjson";
+	FILE* file = fopen(path, "wb");
+	ASSERT_TRUE(file != NULL);
+	fclose(file);
+
+	DtoThreadPool pool(2);
+	DtoJsonLinesReader reader(pool);
+	EXPECT_TRUE(reader.parseFile(path));
+	EXPECT_EQ(reader.documentCount(), 0);
+	EXPECT_EQ(reader.errorCount(), 0);
+	remove(path);
+
+	// A missing file is not an empty one
+	EXPECT_FALSE(reader.parseFile(path));
+}
+
+TEST(JsonLines, RejectsBoundsThatOverflow)
+{
+	EXPECT_EQ(dtoJsonBinaryBound(1024), 1024 * 16 + 64);
+	EXPECT_EQ(dtoJsonBinaryBound(200 * 1024 * 1024), -1);
+	EXPECT_EQ(dtoBinaryJsonBound(1024), 1024 * 6 + 64);
+	EXPECT_EQ(dtoBinaryJsonBound(1024 * 1024 * 1024), -1);
+}
+
+TEST(JsonLinesWriter, WritesRecordsInInputOrder)
+{
+	std::vector<byte> storage(1000 * 128);
+	std::vector<DtoType> records;
+
+	for (int32 i = 0; i < 1000; i++)
+	{
+		std::string json = "{\"index\": " + std::to_string(i) + ", \"name\": \"item\", \"tags\": [1, 2]}";
+		records.push_back(dtoParse<JsonDtoReader>(json.c_str(), &storage[i * 128], 128));
+	}
+
+	DtoThreadPool pool(4);
+	DtoJsonLinesWriter writer(pool);
+	writer.setChunkSize(7);
+
+	std::vector<byte> output;
+	writer.write(&records[0], static_cast<int32>(records.size()), output);
+
+	// Parse the output back and check that records are written in order, one per line
+	DtoJsonLinesReader reader(pool);
+	reader.parse(&output[0], output.size());
+
+	ASSERT_EQ(reader.documentCount(), 1000);
+	EXPECT_EQ(reader.errorCount(), 0);
+
+	for (int32 i = 0; i < reader.documentCount(); i++)
+	{
+		EXPECT_EQ(reader.document(i).find("index").toInt32(), i);
+		EXPECT_EQ(reader.documentLine(i), i + 1);
+	}
+
+	std::string text(output.begin(), output.end());
+	EXPECT_EQ(text.substr(0, text.find('\n') + 1), "{\"index\":0,\"name\":\"item\",\"tags\":[1,2]}\n");
+}
+
+TEST(JsonLinesWriter, StopsWhenOutputFails)
+{
+	byte storage[64];
+	DtoType record = dtoParse<JsonDtoReader>("{\"a\": 1}", storage, sizeof(storage));
+	std::vector<DtoType> records(100, record);
+
+	DtoThreadPool pool(2);
+	DtoJsonLinesWriter writer(pool);
+	writer.setChunkSize(3);
+
+	int32 calls = 0;
+	bool result = writer.write(&records[0], static_cast<int32>(records.size()), [&](const byte* data, int32 length)
+	{
+		EXPECT_EQ(std::string(reinterpret_cast<cstring>(data), length).substr(0, 7), "{\"a\":1}");
+		return ++calls < 2;
+	});
+
+	EXPECT_FALSE(result);
+	EXPECT_EQ(calls, 2);
+}
+
+TEST(JsonLinesWriter, ReportsMalformedRecords)
+{
+	byte storage[64], truncated[64], unterminated[64];
+	DtoType record = dtoParse<JsonDtoReader>("{\"a\": 1}", storage, sizeof(storage));
+
+	// A record which length exceeds it's buffer and a record without a terminator
+	memcpy(truncated, storage, record.length());
+	memcpy(unterminated, storage, record.length());
+	unterminated[record.length() - 1] = DtoInt32;
+
+	std::vector<DtoType> records(10, record);
+	records[3] = DtoType(truncated, record.length() - 1);
+	records[4] = DtoType();
+	records[8] = DtoType(unterminated, record.length());
+
+	DtoThreadPool pool(2);
+	DtoJsonLinesWriter writer(pool);
+	writer.setChunkSize(2);
+
+	std::vector<byte> output;
+	writer.write(&records[0], static_cast<int32>(records.size()), output);
+
+	ASSERT_EQ(writer.errorCount(), 3);
+	EXPECT_EQ(writer.errorRecord(0), 3);
+	EXPECT_EQ(writer.errorRecord(1), 4);
+	EXPECT_EQ(writer.errorRecord(2), 8);
+	EXPECT_EQ(std::count(output.begin(), output.end(), '\n'), 7);
+
+	// Errors are reset by a next write
+	writer.write(&record, 1, output);
+	EXPECT_EQ(writer.errorCount(), 0);
+}
+
+TEST(JsonLinesWriter, WritesFile)
+{
+	byte storage[64];
+	DtoType record = dtoParse<JsonDtoReader>("{\"a\": \"value\"}", storage, sizeof(storage));
+	std::vector<DtoType> records(3, record);
+
+	cstring path = "dto_json_lines_writer_test.ndjson";
+	DtoThreadPool pool(2);
+	DtoJsonLinesWriter writer(pool);
+	ASSERT_TRUE(writer.writeFile(path, &records[0], static_cast<int32>(records.size())));
+
+	DtoJsonLinesReader reader(pool);
+	ASSERT_TRUE(reader.parseFile(path));
+	EXPECT_EQ(reader.documentCount(), 3);
+	EXPECT_TRUE(reader.document(2).find("a").toString() == "value");
+	remove(path);
+}
+
+//! Parses a JSON text on a single thread for comparison with a parallel reader.
+static std::vector<byte> parseSerial(const std::string& input)
+{
+	std::vector<byte> output(dtoJsonBinaryBound(static_cast<int32>(input.size())));
+	bool result = dtoConvert<JsonDtoReader, BinaryDtoWriter>(reinterpret_cast<const byte*>(input.c_str()), static_cast<int32>(input.size()), &output[0], static_cast<int32>(output.size()));
+	EXPECT_TRUE(result);
+	output.resize(DtoType(&output[0], static_cast<int32>(output.size())).length());
+	return output;
+}
+
+TEST(JsonArray, MatchesSerialParser)
+{
+	// Strings contain symbols that would break a naive split at commas and brackets
+	std::string input = "  [\n";
+
+	for (int32 i = 0; i < 300; i++)
+	{
+		input += i ? ",\n" : "";
+		input += "{\"id\": " + std::to_string(i) + ", \"text\": \"a, b], {c} \\\"quoted,\\\" \\\\\", \"items\": [[1, 2], {\"x\": \"]\"}], \"ok\": true}";
+	}
+
+	input += "\n]\n";
+
+	std::vector<byte> expected = parseSerial(input);
+	DtoThreadPool pool(4);
+	DtoJsonArrayReader reader(pool);
+
+	for (int32 chunkSize = 7; chunkSize < 20000; chunkSize *= 3)
+	{
+		reader.setChunkSize(chunkSize);
+		ASSERT_TRUE(reader.parse(reinterpret_cast<const byte*>(input.c_str()), input.size()));
+		ASSERT_EQ(reader.document().length(), static_cast<int32>(expected.size()));
+		EXPECT_EQ(memcmp(reader.document().data(), &expected[0], expected.size()), 0);
+	}
+
+	EXPECT_EQ(reader.document().entryCount(), 300);
+	EXPECT_EQ(reader.document().findDescendant("299.id").toInt32(), 299);
+	EXPECT_TRUE(reader.document().findDescendant("150.items.1.x").toString() == "]");
+}
+
+TEST(JsonArray, ParsesOtherDocumentsSerially)
+{
+	DtoThreadPool pool(2);
+	DtoJsonArrayReader reader(pool);
+	reader.setChunkSize(4);
+
+	cstring object = "{\"a\": [1, 2, 3]}";
+	ASSERT_TRUE(reader.parse(reinterpret_cast<const byte*>(object), strlen(object)));
+	EXPECT_EQ(reader.document().findDescendant("a.2").toInt32(), 3);
+
+	cstring empty = "[ ]";
+	ASSERT_TRUE(reader.parse(reinterpret_cast<const byte*>(empty), strlen(empty)));
+	EXPECT_EQ(reader.document().entryCount(), 0);
+}
+
+TEST(JsonArray, RejectsMalformedArrays)
+{
+	DtoThreadPool pool(2);
+	DtoJsonArrayReader reader(pool);
+	reader.setChunkSize(4);
+
+	cstring inputs[] = { "[1, 2, ]", "[1, , 2]", "[1, \"2]", "[1, [2, 3]", "[1, {\"a\": }, 3]" };
+
+	for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+	{
+		EXPECT_FALSE(reader.parse(reinterpret_cast<const byte*>(inputs[i]), strlen(inputs[i]))) << inputs[i];
+	}
+}
@@ -0,0 +1,277 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+//! Encodes a record with a single integer field.
+static DtoType encodeRecord(byte* buffer, int32 capacity, int32 value)
+{
+	DtoEncoder(buffer, capacity) << "value" << value << "name" << "record" << DtoEncoder::end;
+	return DtoType(buffer, capacity);
+}
+
+TEST(Store, AppendsAndReopens)
+{
+	cstring path = "dto_store_test.bson";
+	remove(path);
+	remove("dto_store_test.bson.idx");
+
+	byte buffer[128];
+
+	{
+		DtoStore store;
+		ASSERT_TRUE(store.open(path));
+		EXPECT_EQ(store.count(), 0);
+
+		for (int32 i = 0; i < 3; i++)
+		{
+			EXPECT_EQ(store.append(encodeRecord(buffer, sizeof(buffer), i)), i);
+		}
+
+		// Appended records are readable before a store is reopened
+		EXPECT_EQ(store.record(1).find("value").toInt32(), 1);
+		EXPECT_EQ(store.offset(1), encodeRecord(buffer, sizeof(buffer), 0).length());
+	}
+
+	DtoStore store;
+	ASSERT_TRUE(store.open(path));
+	ASSERT_EQ(store.count(), 3);
+	EXPECT_EQ(store.size(), 3 * encodeRecord(buffer, sizeof(buffer), 0).length());
+
+	for (int32 i = 0; i < 3; i++)
+	{
+		EXPECT_EQ(store.record(i).find("value").toInt32(), i);
+	}
+
+	DtoType first = store.record(0);
+	EXPECT_EQ(store.append(encodeRecord(buffer, sizeof(buffer), 3)), 3);
+	EXPECT_EQ(store.record(3).find("value").toInt32(), 3);
+	EXPECT_TRUE(first.find("name").toString() == DtoStringView::construct("record"));
+
+	store.close();
+	remove(path);
+	remove("dto_store_test.bson.idx");
+}
+
+TEST(Store, RecoversFromTornWrites)
+{
+	cstring path = "dto_store_torn.bson";
+	remove(path);
+	remove("dto_store_torn.bson.idx");
+
+	byte buffer[128];
+	DtoType record = encodeRecord(buffer, sizeof(buffer), 7);
+
+	{
+		DtoStore store;
+		ASSERT_TRUE(store.open(path));
+		store.append(record);
+		store.append(record);
+	}
+
+	// Simulate a crash in the middle of a third append: a half of a record is written and an index is not updated
+	FILE* file = fopen(path, "ab");
+	ASSERT_TRUE(file != NULL);
+	fwrite(record.data(), 1, record.length() / 2, file);
+	fclose(file);
+
+	file = fopen("dto_store_torn.bson.idx", "ab");
+	ASSERT_TRUE(file != NULL);
+	fwrite("\x01\x02\x03", 1, 3, file);
+	fclose(file);
+
+	{
+		DtoStore store;
+		ASSERT_TRUE(store.open(path));
+		EXPECT_EQ(store.count(), 2);
+		EXPECT_EQ(store.size(), 2 * record.length());
+		EXPECT_EQ(store.append(record), 2);
+	}
+
+	// A lost index is rebuilt from a data file
+	remove("dto_store_torn.bson.idx");
+
+	DtoStore store;
+	ASSERT_TRUE(store.open(path));
+	ASSERT_EQ(store.count(), 3);
+	EXPECT_EQ(store.offset(2), 2 * record.length());
+	EXPECT_EQ(store.record(2).find("value").toInt32(), 7);
+
+	store.close();
+	remove(path);
+	remove("dto_store_torn.bson.idx");
+}
+
+TEST(Crc32c, MatchesCheckValue)
+{
+	cstring text = "123456789";
+	EXPECT_EQ(dtoCrc32c(text, 9), 0xE3069283);
+	EXPECT_EQ(dtoCrc32c(text + 4, 5, dtoCrc32c(text, 4)), 0xE3069283);
+	EXPECT_EQ(dtoCrc32c(text, 0), 0);
+
+	// Check a long input that takes a word-sized path
+	std::vector<byte> zeroes(32, 0);
+	EXPECT_EQ(dtoCrc32c(&zeroes[0], 32), 0x8A9136AA);
+}
+
+TEST(Crc32c, MatchesBitwiseReference)
+{
+	std::vector<byte> data(1000);
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<byte>(i * 131 + 7);
+	}
+
+	// A hardware and a table driven paths should both match a plain bitwise computation at any alignment
+	for (int32 offset = 0; offset < 8; offset++)
+	{
+		uint32 expected = 0xFFFFFFFF;
+
+		for (size_t i = offset; i < data.size(); i++)
+		{
+			expected ^= data[i];
+
+			for (int32 j = 0; j < 8; j++)
+			{
+				expected = (expected >> 1) ^ (0x82F63B78 & (0 - (expected & 1)));
+			}
+		}
+
+		EXPECT_EQ(dtoCrc32c(&data[offset], static_cast<int64>(data.size()) - offset), ~expected);
+	}
+}
+
+TEST(RecordLog, StopsAtTornRecord)
+{
+	cstring path = "dto_record_log.log";
+	remove(path);
+
+	byte buffer[128];
+
+	{
+		DtoRecordLog log;
+		ASSERT_TRUE(log.open(path));
+
+		for (int32 i = 0; i < 3; i++)
+		{
+			EXPECT_TRUE(log.append(encodeRecord(buffer, sizeof(buffer), i)));
+		}
+
+		EXPECT_EQ(log.committed(), 3);
+	}
+
+	// Corrupt a single byte of the last record
+	FILE* file = fopen(path, "r+b");
+	ASSERT_TRUE(file != NULL);
+	fseek(file, -3, SEEK_END);
+	fputc('x', file);
+	fclose(file);
+
+	DtoRecordLogReader reader;
+	DtoType record;
+	ASSERT_TRUE(reader.open(path));
+	EXPECT_TRUE(reader.next(record));
+	EXPECT_TRUE(reader.next(record));
+	EXPECT_EQ(record.find("value").toInt32(), 1);
+	EXPECT_FALSE(reader.next(record));
+	EXPECT_TRUE(reader.isTorn());
+
+	// Reopening a log cuts off a corrupted record
+	{
+		DtoRecordLog log;
+		ASSERT_TRUE(log.open(path));
+		EXPECT_TRUE(log.append(encodeRecord(buffer, sizeof(buffer), 5)));
+	}
+
+	DtoRecordLogReader recovered;
+	ASSERT_TRUE(recovered.open(path));
+
+	int32 count = 0;
+
+	while (recovered.next(record))
+	{
+		count++;
+	}
+
+	EXPECT_EQ(count, 3);
+	EXPECT_EQ(record.find("value").toInt32(), 5);
+	EXPECT_FALSE(recovered.isTorn());
+
+	remove(path);
+}
+
+TEST(RecordLog, CommitsConcurrentAppends)
+{
+	cstring path = "dto_record_log_concurrent.log";
+	remove(path);
+
+	DtoRecordLog log;
+	ASSERT_TRUE(log.open(path));
+
+	std::vector<std::thread> threads;
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		threads.push_back(std::thread([&log, i]()
+		{
+			byte buffer[128];
+
+			for (int32 j = 0; j < 50; j++)
+			{
+				log.append(encodeRecord(buffer, sizeof(buffer), i * 1000 + j));
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	EXPECT_EQ(log.committed(), 200);
+	log.close();
+
+	// Records of each thread are stored in the order they were appended
+	DtoRecordLogReader reader;
+	ASSERT_TRUE(reader.open(path));
+
+	DtoType record;
+	int32 next[4] = { 0, 0, 0, 0 };
+
+	while (reader.next(record))
+	{
+		int32 value = record.find("value").toInt32();
+		EXPECT_EQ(value % 1000, next[value / 1000]++);
+	}
+
+	EXPECT_FALSE(reader.isTorn());
+	EXPECT_EQ(next[0] + next[1] + next[2] + next[3], 200);
+
+	remove(path);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+/**************************************************************************
+
+The MIT License (MIT)
+
+Copyright (c) 2017 Dmitry Sovetov
+
+https://github.com/dmsovetov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+**************************************************************************/
+
+#include "Tests.h"
+
+typedef ::Dto::Dto DtoType;
+
+static cstring kTapeJson =
+	"{"
+	"  \"id\": 7,"
+	"  \"name\": \"tape\","
+	"  \"flags\": [true, false],"
+	"  \"nested\": {\"a\": [1, [2, 3], {\"b\": \"deep\"}], \"c\": 4},"
+	"  \"last\": 5"
+	"}";
+
+//! Reads a JSON text to a tape.
+static bool readJson(DtoTape& tape, cstring input)
+{
+	JsonDtoReader reader(reinterpret_cast<const byte*>(input), static_cast<int32>(strlen(input)));
+	return tape.read(reader);
+}
+
+TEST(Tape, NavigatesParsedDocument)
+{
+	DtoTape tape;
+	ASSERT_TRUE(readJson(tape, kTapeJson));
+
+	DtoTapeNode root = tape.root();
+	ASSERT_TRUE(root);
+	EXPECT_EQ(root.entryCount(), 5);
+	EXPECT_EQ(root.find("id").toInt32(), 7);
+	EXPECT_TRUE(root.find("name").toString() == "tape");
+	EXPECT_FALSE(root.find("flags").entry(1).toBool());
+	EXPECT_TRUE(root.findDescendant("nested.a.2.b").toString() == "deep");
+	EXPECT_EQ(root.findDescendant("nested.a.1.1").toInt32(), 3);
+	EXPECT_EQ(root.findDescendant("nested.c").toInt32(), 4);
+	EXPECT_FALSE(root.findDescendant("nested.a.3"));
+	EXPECT_FALSE(root.findDescendant("nested.x"));
+	EXPECT_FALSE(root.findDescendant("id.x"));
+	EXPECT_FALSE(root.find("flags").find("4294967297"));
+	EXPECT_FALSE(root.find("flags").find("000000000001"));
+
+	// Entries are accessed by index regardless of a size of preceding subtrees
+	EXPECT_TRUE(root.entry(3).key() == "nested");
+	EXPECT_EQ(root.entry(4).toInt32(), 5);
+	EXPECT_TRUE(root.entry(3) == DtoKeyValue);
+	EXPECT_TRUE(root.entry(2) == DtoSequence);
+	EXPECT_FALSE(root.entry(5));
+}
+
+TEST(Tape, RoundTripsBinaryDocument)
+{
+	byte document[512];
+	DtoEncoder(document, sizeof(document))
+		<< "int" << 1
+		<< "double" << 2.5
+		<< "string" << "hello"
+		<< "bool" << true
+		<< "timestamp" << static_cast<uint64>(1234)
+		<< "sequence" << DtoEncoder::sequence
+			<< 1 << "two" << DtoEncoder::keyValue << "three" << 3 << DtoEncoder::end << DtoEncoder::end
+		<< "empty" << DtoEncoder::keyValue << DtoEncoder::end
+		<< DtoEncoder::end;
+
+	DtoType input(document, sizeof(document));
+	BinaryDtoReader reader(input.data(), input.length());
+
+	DtoTape tape;
+	ASSERT_TRUE(tape.read(reader));
+	EXPECT_EQ(tape.root().findDescendant("sequence.2.three").toInt32(), 3);
+	EXPECT_EQ(tape.root().find("empty").entryCount(), 0);
+
+	byte output[512];
+	BinaryDtoWriter writer(output, sizeof(output));
+	tape.write(writer);
+
+	ASSERT_EQ(DtoType(output, sizeof(output)).length(), input.length());
+	EXPECT_EQ(memcmp(output, document, input.length()), 0);
+}
+
+TEST(Tape, IsReusedBetweenDocuments)
+{
+	DtoTape tape;
+	ASSERT_TRUE(readJson(tape, kTapeJson));
+	int32 size = tape.size();
+
+	ASSERT_TRUE(readJson(tape, "[10, 20, 30]"));
+	EXPECT_EQ(tape.size(), 4);
+	EXPECT_EQ(tape.root().entry(2).toInt32(), 30);
+
+	ASSERT_TRUE(readJson(tape, kTapeJson));
+	EXPECT_EQ(tape.size(), size);
+	EXPECT_TRUE(tape.root().findDescendant("nested.a.2.b").toString() == "deep");
+
+	EXPECT_FALSE(readJson(tape, "{\"a\": }"));
+	EXPECT_FALSE(tape.root());
+}
@@ -36,8 +36,8 @@ public:
 	{
 		Token token = input.next();
 		ASSERT_EQ(token, type);
-		EXPECT_EQ(token.line, line);
-		EXPECT_EQ(token.column, column);
+		EXPECT_EQ(token.line(), line);
+		EXPECT_EQ(token.column(), column);
 
 		if (text)
 		{
@@ -188,4 +188,59 @@ TEST_F(Tokenizer, IdentifierSeparators)
 	expect(input, DtoTokenInput::Colon, 1, 6);
 	expect(input, DtoTokenInput::Identifier, 1, 7, "world_2");
 	expect(input, DtoTokenInput::End, 1, 14);
+}
+
+TEST_F(Tokenizer, SkipsWhitespaceRuns)
+{
+	DtoTokenInput input("   \n\t\t  first\r\n   \r\n\n      second                 third  \r\n");
+
+	Token token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::Identifier);
+	EXPECT_EQ(token.text, "first");
+	EXPECT_EQ(token.line(), 2);
+	EXPECT_EQ(token.column(), 5);
+
+	token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::Identifier);
+	EXPECT_EQ(token.text, "second");
+	EXPECT_EQ(token.line(), 5);
+	EXPECT_EQ(token.column(), 7);
+
+	token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::Identifier);
+	EXPECT_EQ(token.text, "third");
+	EXPECT_EQ(token.line(), 5);
+	EXPECT_EQ(token.column(), 30);
+
+	token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::End);
+	EXPECT_EQ(token.line(), 6);
+	EXPECT_EQ(token.column(), 1);
+}
+
+TEST_F(Tokenizer, QuotedStringPositions)
+{
+	DtoTokenInput input("{\n  \"a long key to cross a vector width\": '',\n\t\"value\"\n}");
+
+	Token token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::BraceOpen);
+
+	token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::DoubleQuotedString);
+	EXPECT_EQ(token.text, "a long key to cross a vector width");
+	EXPECT_EQ(token.line(), 2);
+	EXPECT_EQ(token.column(), 3);
+
+	input.nextNonSpace();
+	token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::SingleQuotedString);
+	EXPECT_EQ(token.text.length, 0);
+	EXPECT_EQ(token.line(), 2);
+	EXPECT_EQ(token.column(), 41);
+
+	input.nextNonSpace();
+	token = input.nextNonSpace();
+	ASSERT_EQ(token, DtoTokenInput::DoubleQuotedString);
+	EXPECT_EQ(token.line(), 3);
+	EXPECT_EQ(token.column(), 2);
 }
\ No newline at end of file
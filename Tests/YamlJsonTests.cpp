@@ -29,7 +29,7 @@ SOFTWARE.
 static byte document[16536];
 typedef ::Dto::Dto DtoType;
 
-/*TEST(Yaml, ParsesJsonEmptyObject)
+TEST(Yaml, ParsesJsonEmptyObject)
 {
 	cstring yaml = "{}";
 	DtoType dto = dtoParse<YamlDtoReader>(yaml, document, sizeof(document));
@@ -224,9 +224,9 @@ TEST(Yaml, ParsesJsonNestedComplexArrays)
 	EXPECT_EQ(i.type(), DtoSequence);
 }
 
-TEST(Yaml, WontParseJsonRootArray)
+TEST(Yaml, ParsesJsonRootEmptyArray)
 {
 	cstring yaml = "[]";
 	DtoType dto = dtoParse<YamlDtoReader>(yaml, document, sizeof(document));
-	ASSERT_FALSE(dto);
-}*/
\ No newline at end of file
+	ASSERT_TRUE(dto);
+}
\ No newline at end of file
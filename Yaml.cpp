@@ -28,10 +28,15 @@ SOFTWARE.
 #include "Yaml.h"
 
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <cctype>
 
 DTO_BEGIN
 
+extern DtoErrorHandler g_errorHandler;
+
 // -------------------------------------------------------- YamlDtoWriter -------------------------------------------------------- //
 
 // ** YamlDtoWriter::YamlDtoWriter
@@ -113,9 +118,72 @@ DtoTextOutput& YamlDtoWriter::key(const DtoStringView& value)
 
 // -------------------------------------------------------- YamlDtoReader -------------------------------------------------------- //
 
+//! Returns true if a string view exactly matches any of specified words.
+static bool isOneOf(const DtoStringView& text, cstring a, cstring b, cstring c)
+{
+	return text == DtoStringView::construct(a) || text == DtoStringView::construct(b) || text == DtoStringView::construct(c);
+}
+
+//! Returns true if a plain scalar is a decimal number.
+static bool isNumber(const DtoStringView& text)
+{
+	cstring ptr = text.value;
+	cstring end = text.value + text.length;
+	int32 digits = 0;
+
+	if (ptr < end && (*ptr == '-' || *ptr == '+'))
+	{
+		ptr++;
+	}
+
+	for (; ptr < end && isdigit(*ptr); ptr++)
+	{
+		digits++;
+	}
+
+	if (ptr < end && *ptr == '.')
+	{
+		for (ptr++; ptr < end && isdigit(*ptr); ptr++)
+		{
+			digits++;
+		}
+	}
+
+	if (!digits)
+	{
+		return false;
+	}
+
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+	{
+		ptr++;
+
+		if (ptr < end && (*ptr == '-' || *ptr == '+'))
+		{
+			ptr++;
+		}
+
+		if (ptr == end || !isdigit(*ptr))
+		{
+			return false;
+		}
+
+		while (ptr < end && isdigit(*ptr))
+		{
+			ptr++;
+		}
+	}
+
+	return ptr == end;
+}
+
 // ** YamlDtoReader::YamlDtoReader
 YamlDtoReader::YamlDtoReader(const byte* input, int32 length)
 	: m_input(input, length)
+	, m_lineStart(input)
+	, m_indentation(0)
+	, m_isStarted(false)
+	, m_hasTabIndentation(false)
 {
 
 }
@@ -129,18 +197,30 @@ int32 YamlDtoReader::consumed() const
 // ** YamlDtoReader::next
 DtoEvent YamlDtoReader::next()
 {
-	// A node stack is empty, this means that we have just started JSON parsing 
-	if (m_stack.empty())
+	DtoEvent event;
+
+	if (!m_isStarted)
 	{
-		m_stack.push(&YamlDtoReader::parseStream);
+		// Nothing was parsed yet, so start with a root node
+		m_isStarted = true;
+		event = parseStream();
+	}
+	else if (m_stack.empty())
+	{
+		// A whole document was already parsed
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+	else
+	{
+		event = m_stack.back().isFlow ? parseFlow() : parseBlock();
 	}
 
-	// Pop a topmost parser from a stack
-	EventParser parser = m_stack.top();
-	m_stack.pop();
-
-	// Now parse a next event from a stream.
-	DtoEvent event = (this->*parser)();
+	// Indentation is measured while an event is parsed, so a tab found there fails this event
+	if (m_hasTabIndentation)
+	{
+		return DtoError;
+	}
 
 	return event;
 }
@@ -148,49 +228,524 @@ DtoEvent YamlDtoReader::next()
 // ** YamlDtoReader::parseStream
 DtoEvent YamlDtoReader::parseStream()
 {
-	// Consume an indentation level
-	int32 indentation = consumeIndentation();
+	m_indentation = skipBlankLines();
+
+	// Skip an optional document start marker
+	if (m_indentation == 0 && m_input.currentToken() == DtoTokenInput::Minus)
+	{
+		DtoTokenInput input = m_input;
+
+		if (input.readScalar("").text == DtoStringView::construct("---"))
+		{
+			m_input = input;
+			m_input.next();
+			skipSpaces(false);
+			m_indentation = m_input.check(DtoTokenInput::NewLine) ? skipBlankLines() : column();
+		}
+	}
+
+	if (m_indentation < 0)
+	{
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+
+	switch (m_input.currentToken().type)
+	{
+	case DtoTokenInput::BraceOpen:
+		m_input.next();
+		return openNode(DtoStringView(), DtoKeyValue, true, 0);
+
+	case DtoTokenInput::BracketOpen:
+		m_input.next();
+		return openNode(DtoStringView(), DtoSequence, true, 0);
+
+	default:
+		break;
+	}
+
+	return openNode(DtoStringView(), isSequenceEntry() ? DtoSequence : DtoKeyValue, false, m_indentation);
+}
+
+// ** YamlDtoReader::parseBlock
+DtoEvent YamlDtoReader::parseBlock()
+{
+	const Node& node = m_stack.back();
+
+	// A line with a smaller indentation closes a node
+	if (m_indentation < node.indentation)
+	{
+		return closeNode();
+	}
 
-	if (m_stack.empty())
+	if (m_indentation > node.indentation)
 	{
-		m_indentation.push(indentation);
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+
+	if (node.type == DtoSequence)
+	{
+		if (!isSequenceEntry())
+		{
+			// A sequence nested into a mapping may have the same indentation as it's parent
+			if (m_stack.size() > 1 && m_stack[m_stack.size() - 2].indentation == node.indentation)
+			{
+				return closeNode();
+			}
+
+			m_input.emitUnexpectedToken();
+			return DtoError;
+		}
+
+		int32 indentation = node.indentation;
+		DtoStringView key = itemKey();
+		m_input.next();
+		skipSpaces(false);
+		return parseBlockValue(key, indentation, true);
+	}
+
+	// Parse a mapping key
+	DtoStringView key;
+
+	switch (m_input.currentToken().type)
+	{
+	case DtoTokenInput::DoubleQuotedString:
+	case DtoTokenInput::SingleQuotedString:
+		key = m_input.consumeString().string;
+		break;
+
+	case DtoTokenInput::Colon:
+	case DtoTokenInput::Comma:
+	case DtoTokenInput::BraceOpen:
+	case DtoTokenInput::BraceClose:
+	case DtoTokenInput::BracketOpen:
+	case DtoTokenInput::BracketClose:
+		m_input.emitUnexpectedToken();
+		return DtoError;
+
+	default:
+		key = m_input.readScalar(":").text;
+		m_input.next();
 	}
 
-	if (indentation > m_indentation.top())
+	skipSpaces(false);
+
+	if (!m_input.expect(DtoTokenInput::Colon))
 	{
-		return DtoKeyValueStart;
+		return DtoError;
 	}
 
-	const DtoTokenInput::Token& token = m_input.next();
+	skipSpaces(false);
+
+	return parseBlockValue(key, node.indentation, false);
+}
+
+// ** YamlDtoReader::parseBlockValue
+DtoEvent YamlDtoReader::parseBlockValue(const DtoStringView& key, int32 indentation, bool isItem)
+{
+	const DtoTokenInput::Token& token = m_input.currentToken();
 
 	switch (token.type)
 	{
-	case DtoTokenInput::Identifier:
-		assert(0);
-		return DtoStreamStart;
+	case DtoTokenInput::NewLine:
+	case DtoTokenInput::End:
+		{
+			// A value is located on next lines, so this is either a nested block node or an empty value
+			m_indentation = skipBlankLines();
 
-	case DtoTokenInput::Minus:
-		assert(0);
-		return DtoStreamStart;
+			bool isSequence = m_indentation >= 0 && isSequenceEntry();
+
+			if (m_indentation > indentation || (isSequence && !isItem && m_indentation == indentation))
+			{
+				return openNode(key, isSequence ? DtoSequence : DtoKeyValue, false, m_indentation);
+			}
+
+			DtoValue value;
+			value.type = DtoNull;
+			return DtoEvent(key, value);
+		}
+
+	case DtoTokenInput::BraceOpen:
+		m_input.next();
+		return openNode(key, DtoKeyValue, true, 0);
+
+	case DtoTokenInput::BracketOpen:
+		m_input.next();
+		return openNode(key, DtoSequence, true, 0);
+
+	default:
+		break;
+	}
+
+	bool isQuoted = token == DtoTokenInput::DoubleQuotedString || token == DtoTokenInput::SingleQuotedString;
+
+	// A sequence entry may start a compact nested node on the same line
+	if (isItem)
+	{
+		if (isSequenceEntry())
+		{
+			m_indentation = column();
+			return openNode(key, DtoSequence, false, m_indentation);
+		}
+
+		// Look ahead for a colon to check if a scalar is actually a mapping key
+		DtoTokenInput input = m_input;
+
+		if (!isQuoted)
+		{
+			input.readScalar("");
+		}
+		input.next();
+
+		while (input.consume(DtoTokenInput::Space) || input.consume(DtoTokenInput::Tab))
+		{
+		}
+
+		if (input.check(DtoTokenInput::Colon))
+		{
+			m_indentation = column();
+			return openNode(key, DtoKeyValue, false, m_indentation);
+		}
+	}
+
+	DtoValue value;
+
+	if (isQuoted)
+	{
+		value = m_input.consumeString();
+	}
+	else
+	{
+		value = scalarValue(m_input.readScalar("").text);
+		m_input.next();
+	}
+
+	if (!finishLine())
+	{
+		return DtoError;
+	}
+
+	return DtoEvent(key, value);
+}
+
+// ** YamlDtoReader::parseFlow
+DtoEvent YamlDtoReader::parseFlow()
+{
+	Node& node = m_stack.back();
+	DtoTokenInput::TokenType closing = node.type == DtoSequence ? DtoTokenInput::BracketClose : DtoTokenInput::BraceClose;
+
+	skipSpaces(true);
+
+	// Entries are separated by commas, a trailing one is allowed
+	if (node.count && !m_input.check(closing))
+	{
+		if (!m_input.expect(DtoTokenInput::Comma))
+		{
+			return DtoError;
+		}
+
+		skipSpaces(true);
+	}
+
+	if (m_input.check(closing))
+	{
+		m_input.next();
+		return closeNode();
+	}
+
+	if (node.type == DtoSequence)
+	{
+		return parseFlowValue(itemKey());
+	}
+
+	// Parse a mapping key
+	DtoStringView key;
+
+	switch (m_input.currentToken().type)
+	{
+	case DtoTokenInput::DoubleQuotedString:
+	case DtoTokenInput::SingleQuotedString:
+		key = m_input.consumeString().string;
+		break;
+
+	case DtoTokenInput::End:
+	case DtoTokenInput::Colon:
+	case DtoTokenInput::Comma:
+	case DtoTokenInput::BraceOpen:
+	case DtoTokenInput::BraceClose:
+	case DtoTokenInput::BracketOpen:
+	case DtoTokenInput::BracketClose:
+		m_input.emitUnexpectedToken();
+		return DtoError;
+
+	default:
+		key = m_input.readScalar(",[]{}:").text;
+		m_input.next();
+	}
+
+	node.count++;
+	skipSpaces(true);
+
+	if (!m_input.expect(DtoTokenInput::Colon))
+	{
+		return DtoError;
+	}
+
+	skipSpaces(true);
+
+	return parseFlowValue(key);
+}
+
+// ** YamlDtoReader::parseFlowValue
+DtoEvent YamlDtoReader::parseFlowValue(const DtoStringView& key)
+{
+	DtoValue value;
+
+	switch (m_input.currentToken().type)
+	{
+	case DtoTokenInput::BraceOpen:
+		m_input.next();
+		return openNode(key, DtoKeyValue, true, 0);
+
+	case DtoTokenInput::BracketOpen:
+		m_input.next();
+		return openNode(key, DtoSequence, true, 0);
+
+	case DtoTokenInput::DoubleQuotedString:
+	case DtoTokenInput::SingleQuotedString:
+		return DtoEvent(key, m_input.consumeString());
+
+	case DtoTokenInput::Comma:
+	case DtoTokenInput::BraceClose:
+	case DtoTokenInput::BracketClose:
+		value.type = DtoNull;
+		return DtoEvent(key, value);
+
+	case DtoTokenInput::End:
+		m_input.emitUnexpectedToken();
+		return DtoError;
 
 	default:
+		break;
+	}
+
+	value = scalarValue(m_input.readScalar(",[]{}").text);
+	m_input.next();
+
+	return DtoEvent(key, value);
+}
+
+// ** YamlDtoReader::openNode
+DtoEvent YamlDtoReader::openNode(const DtoStringView& key, DtoValueType type, bool isFlow, int32 indentation)
+{
+	bool isRoot = m_stack.empty();
+
+	m_stack.push_back(Node(type, isFlow, indentation));
+
+	if (isRoot)
+	{
+		return DtoStreamStart;
+	}
+
+	return DtoEvent(type == DtoSequence ? DtoSequenceStart : DtoKeyValueStart, key);
+}
+
+// ** YamlDtoReader::closeNode
+DtoEvent YamlDtoReader::closeNode()
+{
+	Node node = m_stack.back();
+	m_stack.pop_back();
+
+	// Only a comment may follow a flow collection on the same line of a block node
+	if (node.isFlow && (m_stack.empty() || !m_stack.back().isFlow) && !finishLine())
+	{
+		return DtoError;
+	}
+
+	if (!m_stack.empty())
+	{
+		return node.type == DtoSequence ? DtoSequenceEnd : DtoKeyValueEnd;
+	}
+
+	// Nothing is expected after a root node
+	if (m_indentation >= 0)
+	{
+		m_input.emitUnexpectedToken();
+		return DtoError;
+	}
+
+	return DtoStreamEnd;
+}
+
+// ** YamlDtoReader::finishLine
+bool YamlDtoReader::finishLine()
+{
+	skipSpaces(false);
+
+	if (!m_input.check(DtoTokenInput::NewLine) && !m_input.check(DtoTokenInput::End))
+	{
 		m_input.emitUnexpectedToken();
+		return false;
+	}
+
+	m_indentation = skipBlankLines();
+
+	return true;
+}
+
+// ** YamlDtoReader::skipBlankLines
+int32 YamlDtoReader::skipBlankLines()
+{
+	for (;;)
+	{
+		const DtoTokenInput::Token& token = m_input.currentToken();
+
+		if (token == DtoTokenInput::End)
+		{
+			return -1;
+		}
+
+		// Skip whitespaces and line breaks at once, a current token is either a line break or nothing was read yet
+		const byte* from = token.text.value ? reinterpret_cast<const byte*>(token.text.value) + token.text.length : token.input;
+		m_input.nextNonSpace();
+
+		if (isComment())
+		{
+			m_input.skipLine();
+			continue;
+		}
+
+		if (token == DtoTokenInput::End)
+		{
+			return -1;
+		}
+
+		// Locate a beginning of a line that contains a token
+		const byte* start = token.start();
+		const byte* lineStart = start;
+
+		while (lineStart > from && lineStart[-1] != '\n')
+		{
+			lineStart--;
+		}
+
+		m_lineStart = lineStart;
+
+		// YAML forbids tabs in indentation, because their width is ambiguous
+		if (!m_hasTabIndentation && memchr(lineStart, '\t', start - lineStart))
+		{
+			m_hasTabIndentation = true;
+
+			if (g_errorHandler)
+			{
+				char message[DtoTokenInput::MaxMessageLength];
+				snprintf(message, sizeof(message), "error: %d:%d : tabs are not allowed in indentation", token.line(), token.column());
+				g_errorHandler(message);
+			}
+		}
+
+		return static_cast<int32>(start - lineStart);
+	}
+}
+
+// ** YamlDtoReader::skipSpaces
+void YamlDtoReader::skipSpaces(bool newLines)
+{
+	for (;;)
+	{
+		const DtoTokenInput::Token& token = m_input.currentToken();
+
+		if (newLines && (token == DtoTokenInput::Space || token == DtoTokenInput::Tab || token == DtoTokenInput::NewLine))
+		{
+			m_input.nextNonSpace();
+		}
+		else if (token == DtoTokenInput::Space || token == DtoTokenInput::Tab)
+		{
+			m_input.next();
+		}
+		else if (isComment())
+		{
+			m_input.skipLine();
+		}
+		else
+		{
+			return;
+		}
 	}
+}
+
+// ** YamlDtoReader::isComment
+bool YamlDtoReader::isComment() const
+{
+	const DtoTokenInput::Token& token = m_input.currentToken();
+	return token == DtoTokenInput::Nonterminal && token.text.value && token.text.value[0] == '#';
+}
+
+// ** YamlDtoReader::isSequenceEntry
+bool YamlDtoReader::isSequenceEntry() const
+{
+	if (!(m_input.currentToken() == DtoTokenInput::Minus))
+	{
+		return false;
+	}
+
+	// An entry indicator should be followed by a whitespace
+	DtoTokenInput input = m_input;
+	const DtoTokenInput::Token& token = input.next();
+
+	return token == DtoTokenInput::Space || token == DtoTokenInput::Tab || token == DtoTokenInput::NewLine || token == DtoTokenInput::End;
+}
+
+// ** YamlDtoReader::column
+int32 YamlDtoReader::column() const
+{
+	return static_cast<int32>(m_input.currentToken().start() - m_lineStart);
+}
 
-	return DtoError;
+// ** YamlDtoReader::itemKey
+DtoStringView YamlDtoReader::itemKey()
+{
+	DtoStringView key;
+	key.value = m_text;
+	key.length = sprintf_s(m_text, "%d", m_stack.back().count++);
+	return key;
 }
 
-// ** YamlDtoReader::consumeIndentation
-int32 YamlDtoReader::consumeIndentation()
+// ** YamlDtoReader::scalarValue
+DtoValue YamlDtoReader::scalarValue(const DtoStringView& text)
 {
-	int32 count = 0;
+	DtoValue result;
 
-	while (m_input.consume(DtoTokenInput::Space))
+	if (text.length == 0 || text == DtoStringView::construct("~") || isOneOf(text, "null", "Null", "NULL"))
+	{
+		result.type = DtoNull;
+	}
+	else if (isOneOf(text, "true", "True", "TRUE"))
 	{
-		count++;
+		result.type = DtoBool;
+		result.boolean = true;
 	}
+	else if (isOneOf(text, "false", "False", "FALSE"))
+	{
+		result.type = DtoBool;
+		result.boolean = false;
+	}
+	else if (text.length < 32 && isNumber(text))
+	{
+		char buffer[32];
+		strncpy_s(buffer, text.value, text.length);
 
-	return count;
+		result.type = DtoDouble;
+		result.number = atof(buffer);
+	}
+	else
+	{
+		result.type = DtoString;
+		result.string = text;
+	}
+
+	return result;
 }
 
 DTO_END
@@ -27,6 +27,8 @@ SOFTWARE.
 #ifndef __Dto_Yaml_H__
 #define __Dto_Yaml_H__
 
+#include <vector>
+
 DTO_BEGIN
 
 	//! Consumes a sequence of DTO events and produces a Yaml string.
@@ -67,6 +69,10 @@ DTO_BEGIN
 	};
 
 	//! Parses a Yaml string and produces a sequence of DTO events consumable by writer.
+	/*!
+	 Block mappings, block sequences, flow collections and plain or quoted scalars are supported.
+	 Nested nodes are tracked with an explicit node stack, so no recursion is involved.
+	 */
 	class YamlDtoReader : public DtoReader
 	{
 	public:
@@ -82,20 +88,73 @@ DTO_BEGIN
 
 	private:
 
-		//! Parses an input stream.
+		//! Parses a root node and emits a stream start event.
 		DtoEvent					parseStream();
 
-		//! Reads indentation level.
-		int32						consumeIndentation();
+		//! Parses a next entry of a block mapping or sequence.
+		DtoEvent					parseBlock();
+
+		//! Parses a next entry of a flow mapping or sequence.
+		DtoEvent					parseFlow();
+
+		//! Parses a value that follows a block mapping key or a sequence entry indicator.
+		DtoEvent					parseBlockValue(const DtoStringView& key, int32 indentation, bool isItem);
+
+		//! Parses a flow collection entry value.
+		DtoEvent					parseFlowValue(const DtoStringView& key);
+
+		//! Pushes a new node to a stack and emits a matching start event.
+		DtoEvent					openNode(const DtoStringView& key, DtoValueType type, bool isFlow, int32 indentation);
+
+		//! Pops a topmost node from a stack and emits a matching end event.
+		DtoEvent					closeNode();
+
+		//! Consumes the rest of a line that follows a block value.
+		bool						finishLine();
+
+		//! Skips blank lines and comments, returns an indentation of a next line or -1 if the end of stream is reached.
+		int32						skipBlankLines();
+
+		//! Skips whitespaces and comments, line breaks are skipped only inside flow collections.
+		void						skipSpaces(bool newLines);
+
+		//! Returns true if a current token starts a comment.
+		bool						isComment() const;
+
+		//! Returns true if a current token is a block sequence entry indicator.
+		bool						isSequenceEntry() const;
+
+		//! Returns a column of a current token.
+		int32						column() const;
+
+		//! Returns a key of a next sequence item.
+		DtoStringView				itemKey();
+
+		//! Converts a plain scalar to a DTO value.
+		static DtoValue				scalarValue(const DtoStringView& text);
 
 	private:
 
-		//! Event parsing function.
-		typedef DtoEvent (YamlDtoReader::*EventParser)();
+		//! A nested node info.
+		struct Node
+		{
+			DtoValueType			type;			//!< A node type.
+			bool					isFlow;			//!< Indicates that this is a flow collection.
+			int32					indentation;	//!< A node indentation (block nodes only).
+			int32					count;			//!< A total number of parsed entries.
+
+									//! Constructs a Node instance.
+									Node(DtoValueType type, bool isFlow, int32 indentation)
+										: type(type), isFlow(isFlow), indentation(indentation), count(0) {}
+		};
 
 		DtoTokenInput				m_input;		//!< An input token stream.
-		std::stack<EventParser>		m_stack;		//!< An event parsing stack.
-		std::stack<int32>			m_indentation;	//!< An indentation stack.
+		std::vector<Node>			m_stack;		//!< A nested node stack.
+		const byte*					m_lineStart;	//!< A beginning of a current line.
+		int32						m_indentation;	//!< An indentation of a current line.
+		bool						m_isStarted;	//!< Indicates that a stream start event was emitted.
+		bool						m_hasTabIndentation;	//!< Indicates that a line indented with tabs was found.
+		char						m_text[16];		//!< An internal temporary string buffer.
 	};
 
 DTO_END